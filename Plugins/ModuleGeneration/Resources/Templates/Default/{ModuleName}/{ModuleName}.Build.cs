@@ -6,19 +6,17 @@ public class {ModuleName} : ModuleRules
 {
 	public {ModuleName}(ReadOnlyTargetRules Target) : base(Target)
 	{
-		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+		{BuildSettings}
 
 		PublicDependencyModuleNames.AddRange(new string[] 
 			{ 
-				"Core",
-				"CoreUObject",
-				"Engine"
+				{PublicDependencies}
 			});
 		
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
-				
+				{PrivateDependencies}
 			});
 		
 		DynamicallyLoadedModuleNames.AddRange(
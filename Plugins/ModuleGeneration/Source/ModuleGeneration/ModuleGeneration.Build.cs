@@ -20,6 +20,7 @@ public class ModuleGeneration : ModuleRules
 			{
                 "Core",
 				"EditorStyle",
+				"ModuleGenerationCore",
                 "Slate", 
                 "Projects"
 			}
@@ -31,6 +32,7 @@ public class ModuleGeneration : ModuleRules
 				"Core",
                 "CoreUObject",
 				"DesktopPlatform",
+				"DirectoryWatcher",
                 "Engine",
 				"EngineSettings",
 				"GameProjectGeneration",
@@ -0,0 +1,31 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Runs Function repeatedly for at least a quarter of a second or 1000 iterations.
+	 * @return Average seconds per call
+	 */
+	template<typename FunctionType>
+	double MeasureAverageSeconds(FunctionType&& Function)
+	{
+		constexpr double MinTotalSeconds = 0.25;
+		constexpr int32 MaxIterations = 1000;
+		
+		int32 NumIterations = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		double Elapsed = 0.0;
+		do
+		{
+			Function();
+			++NumIterations;
+			Elapsed = FPlatformTime::Seconds() - StartTime;
+		}
+		while (Elapsed < MinTotalSeconds && NumIterations < MaxIterations);
+		return Elapsed / NumIterations;
+	}
+}
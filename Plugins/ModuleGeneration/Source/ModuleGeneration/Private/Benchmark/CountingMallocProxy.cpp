@@ -0,0 +1,67 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Benchmark/CountingMallocProxy.h"
+
+namespace UE::ModuleGeneration
+{
+	FCountingMallocProxy* FCountingMallocProxy::Instance = nullptr;
+
+	FCountingMallocProxy* FCountingMallocProxy::Install()
+	{
+		check(IsInGameThread());
+
+		// With -nothreading the task graph has no workers and FRunnableThread::Create only makes fake threads ticked on the game
+		// thread, so nothing can call into GMalloc while it is swapped
+		if (!Instance && !FPlatformProcess::SupportsMultithreading())
+		{
+			Instance = new FCountingMallocProxy(GMalloc);
+			GMalloc = Instance;
+		}
+		return Instance;
+	}
+
+	FCountingMallocProxy::FCountingMallocProxy(FMalloc* InUsedMalloc)
+		: UsedMalloc(InUsedMalloc)
+	{}
+
+	FCountingMallocProxy::FCounts FCountingMallocProxy::GetCounts() const
+	{
+		return { NumAllocations.load(std::memory_order_relaxed), AllocatedBytes.load(std::memory_order_relaxed) };
+	}
+
+	void* FCountingMallocProxy::Malloc(SIZE_T Size, uint32 Alignment)
+	{
+		Count(Size);
+		return UsedMalloc->Malloc(Size, Alignment);
+	}
+
+	void* FCountingMallocProxy::TryMalloc(SIZE_T Size, uint32 Alignment)
+	{
+		Count(Size);
+		return UsedMalloc->TryMalloc(Size, Alignment);
+	}
+
+	void* FCountingMallocProxy::Realloc(void* Original, SIZE_T Size, uint32 Alignment)
+	{
+		// Growing or shrinking a block counts as an allocation since it usually is one
+		if (Size > 0)
+		{
+			Count(Size);
+		}
+		return UsedMalloc->Realloc(Original, Size, Alignment);
+	}
+
+	void* FCountingMallocProxy::TryRealloc(void* Original, SIZE_T Size, uint32 Alignment)
+	{
+		if (Size > 0)
+		{
+			Count(Size);
+		}
+		return UsedMalloc->TryRealloc(Original, Size, Alignment);
+	}
+
+	void FCountingMallocProxy::Free(void* Original)
+	{
+		UsedMalloc->Free(Original);
+	}
+}
@@ -0,0 +1,82 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+#include <atomic>
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Forwards to the original GMalloc and counts allocations and allocated bytes on all threads.
+	 *
+	 * GMalloc is a plain pointer which every thread reads on every allocation, so it can only be replaced while no other thread runs:
+	 * Install refuses unless the process was started with -nothreading. Once installed the proxy is never removed, so memory allocated
+	 * before or after installation can be freed at any time. Only meant for benchmarks because of the extra atomic operations on every
+	 * allocation.
+	 */
+	class FCountingMallocProxy : public FMalloc
+	{
+	public:
+
+		struct FCounts
+		{
+			uint64 NumAllocations = 0;
+			uint64 AllocatedBytes = 0;
+
+			FCounts operator-(const FCounts& Other) const
+			{
+				return { NumAllocations - Other.NumAllocations, AllocatedBytes - Other.AllocatedBytes };
+			}
+		};
+
+		/**
+		 * Installs the proxy if needed. Must be called on the game thread.
+		 * @return The proxy, or null if other threads may be allocating, i.e. the process supports multithreading.
+		 */
+		static FCountingMallocProxy* Install();
+		/** @return The proxy if Install succeeded before */
+		static FCountingMallocProxy* Get() { return Instance; }
+
+		FCounts GetCounts() const;
+
+		//~ Begin FMalloc Interface
+		virtual void* Malloc(SIZE_T Size, uint32 Alignment) override;
+		virtual void* TryMalloc(SIZE_T Size, uint32 Alignment) override;
+		virtual void* Realloc(void* Original, SIZE_T Size, uint32 Alignment) override;
+		virtual void* TryRealloc(void* Original, SIZE_T Size, uint32 Alignment) override;
+		virtual void Free(void* Original) override;
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return UsedMalloc->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return UsedMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { UsedMalloc->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { UsedMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { UsedMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { UsedMalloc->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { UsedMalloc->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { UsedMalloc->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { UsedMalloc->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return UsedMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return UsedMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return UsedMalloc->GetDescriptiveName(); }
+		//~ End FMalloc Interface
+
+	private:
+
+		explicit FCountingMallocProxy(FMalloc* InUsedMalloc);
+
+		/** Intentionally leaked: blocks allocated through the proxy may be freed after the module is unloaded */
+		static FCountingMallocProxy* Instance;
+
+		FMalloc* UsedMalloc;
+		std::atomic<uint64> NumAllocations { 0 };
+		std::atomic<uint64> AllocatedBytes { 0 };
+
+		void Count(SIZE_T Size)
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+		}
+	};
+}
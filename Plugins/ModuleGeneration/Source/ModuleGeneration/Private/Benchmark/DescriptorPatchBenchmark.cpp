@@ -0,0 +1,135 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Benchmark/BenchmarkUtils.h"
+#include "ModuleGenerationLog.h"
+#include "NewModule/DescriptorJsonPatcher.h"
+
+#include "ModuleDescriptor.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Builds a .uproject formatted like FJsonSerializer output with NumPlugins plugin entries and a few modules. */
+	static FString MakeSyntheticDescriptor(int32 NumPlugins)
+	{
+		FString Result = TEXT("{\n\t\"FileVersion\": 3,\n\t\"EngineAssociation\": \"5.3\",\n\t\"Category\": \"\",\n\t\"Description\": \"\",\n\t\"Modules\": [\n");
+		for (int32 i = 0; i < 4; ++i)
+		{
+			Result += FString::Printf(TEXT("\t\t{\n\t\t\t\"Name\": \"GameModule%d\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}%s\n"), i, i < 3 ? TEXT(",") : TEXT(""));
+		}
+		Result += TEXT("\t],\n\t\"Plugins\": [\n");
+		for (int32 i = 0; i < NumPlugins; ++i)
+		{
+			Result += FString::Printf(TEXT("\t\t{\n\t\t\t\"Name\": \"Plugin%d\",\n\t\t\t\"Enabled\": %s,\n\t\t\t\"TargetAllowList\": [ \"Editor\" ]\n\t\t}%s\n"),
+				i, i % 3 ? TEXT("true") : TEXT("false"), i < NumPlugins - 1 ? TEXT(",") : TEXT(""));
+		}
+		Result += TEXT("\t]\n}\n");
+		return Result;
+	}
+
+	/** What AddNewModulesToFile used to do: parse the whole file into a DOM and serialize it again. */
+	static TArray<uint8> AddModuleWithJsonDom(TConstArrayView<uint8> FileBytes, const FModuleDescriptor& NewModule)
+	{
+		FString FileContents;
+		FFileHelper::BufferToString(FileContents, FileBytes.GetData(), FileBytes.Num());
+
+		TSharedPtr<FJsonObject> ProjectFileAsJson;
+		const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		FJsonSerializer::Deserialize(JsonReader, ProjectFileAsJson);
+
+		TArray<TSharedPtr<FJsonValue>> Modules = ProjectFileAsJson->GetArrayField(TEXT("Modules"));
+		const TSharedRef<FJsonObject> ModuleAsJson = MakeShared<FJsonObject>();
+		ModuleAsJson->SetStringField(TEXT("Name"), NewModule.Name.ToString());
+		ModuleAsJson->SetStringField(TEXT("Type"), EHostType::ToString(NewModule.Type));
+		ModuleAsJson->SetStringField(TEXT("LoadingPhase"), ELoadingPhase::ToString(NewModule.LoadingPhase));
+		Modules.Add(MakeShared<FJsonValueObject>(ModuleAsJson));
+		ProjectFileAsJson->SetArrayField(TEXT("Modules"), Modules);
+
+		FString OutputString;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
+		FJsonSerializer::Serialize(ProjectFileAsJson.ToSharedRef(), Writer);
+		
+		const FTCHARToUTF8 Encoded(*OutputString, OutputString.Len());
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Encoded.Get()), Encoded.Length());
+	}
+
+	/** @return Number of bytes that differ between Before and After, ignoring the common prefix and suffix */
+	static int32 CountChangedBytes(TConstArrayView<uint8> Before, TConstArrayView<uint8> After)
+	{
+		const int32 MaxCommon = FMath::Min(Before.Num(), After.Num());
+		int32 Prefix = 0;
+		while (Prefix < MaxCommon && Before[Prefix] == After[Prefix])
+		{
+			++Prefix;
+		}
+		int32 Suffix = 0;
+		while (Suffix < MaxCommon - Prefix && Before[Before.Num() - 1 - Suffix] == After[After.Num() - 1 - Suffix])
+		{
+			++Suffix;
+		}
+		return FMath::Max(Before.Num(), After.Num()) - Prefix - Suffix;
+	}
+
+	static void RunDescriptorPatchBenchmark()
+	{
+		const FModuleDescriptor NewModule(TEXT("MyBenchmarkModule"), EHostType::Runtime, ELoadingPhase::Default);
+
+		UE_LOG(LogModuleGeneration, Display, TEXT("%8s %12s %12s %12s %9s %16s %16s"),
+			TEXT("Plugins"), TEXT("Size"), TEXT("DOM (ms)"), TEXT("Splice (ms)"), TEXT("Speedup"), TEXT("DOM changed"), TEXT("Splice changed"));
+		for (const int32 NumPlugins : { 10, 100, 1000, 5000, 10000 })
+		{
+			const FString Descriptor = MakeSyntheticDescriptor(NumPlugins);
+			const FTCHARToUTF8 EncodedDescriptor(*Descriptor, Descriptor.Len());
+			const TArray<uint8> FileBytes(reinterpret_cast<const uint8*>(EncodedDescriptor.Get()), EncodedDescriptor.Length());
+
+			const TArray<uint8> DomResult = AddModuleWithJsonDom(FileBytes, NewModule);
+			const TOperationResult<TArray<uint8>> SpliceResult = SpliceModulesIntoDescriptor(FileBytes, MakeArrayView(&NewModule, 1));
+			if (SpliceResult.IsFailure())
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("SpliceModulesIntoDescriptor failed for %d plugins: %s"), NumPlugins, *SpliceResult.ErrorMessage.GetValue());
+				return;
+			}
+
+			// Both paths must produce a descriptor UE reads the same way
+			FString SplicedString;
+			FFileHelper::BufferToString(SplicedString, SpliceResult.OperationResult->GetData(), SpliceResult.OperationResult->Num());
+			TSharedPtr<FJsonObject> SplicedJson;
+			if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(SplicedString), SplicedJson)
+				|| SplicedJson->GetArrayField(TEXT("Modules")).Num() != 5
+				|| SplicedJson->GetArrayField(TEXT("Plugins")).Num() != NumPlugins)
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("SpliceModulesIntoDescriptor produced an invalid descriptor for %d plugins"), NumPlugins);
+				return;
+			}
+
+			const double DomSeconds = MeasureAverageSeconds([&FileBytes, &NewModule]()
+			{
+				const TArray<uint8> Result = AddModuleWithJsonDom(FileBytes, NewModule);
+			});
+			const double SpliceSeconds = MeasureAverageSeconds([&FileBytes, &NewModule]()
+			{
+				const TOperationResult<TArray<uint8>> Result = SpliceModulesIntoDescriptor(FileBytes, MakeArrayView(&NewModule, 1));
+			});
+
+			UE_LOG(LogModuleGeneration, Display, TEXT("%8d %10d B %12.3f %12.3f %8.1fx %14d B %14d B"),
+				NumPlugins,
+				FileBytes.Num(),
+				DomSeconds * 1000.0,
+				SpliceSeconds * 1000.0,
+				DomSeconds / FMath::Max(SpliceSeconds, UE_DOUBLE_SMALL_NUMBER),
+				CountChangedBytes(FileBytes, DomResult),
+				CountChangedBytes(FileBytes, SpliceResult.OperationResult.GetValue()));
+		}
+	}
+
+	static FAutoConsoleCommand DescriptorPatchBenchmarkCommand(
+		TEXT("ModuleGeneration.Benchmark.DescriptorPatch"),
+		TEXT("Compares splicing a module into a descriptor against round-tripping it through FJsonObject for descriptors with up to 10000 plugins."),
+		FConsoleCommandDelegate::CreateStatic(&RunDescriptorPatchBenchmark));
+}
@@ -0,0 +1,86 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Benchmark/BenchmarkUtils.h"
+#include "ModuleGenerationLog.h"
+#include "NewModule/PlaceholderSubstitution.h"
+
+#include "HAL/IConsoleManager.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Builds a template resembling a generated header: mostly code with occasional placeholders, braces and escapes. */
+	static FString MakeSyntheticTemplate(int32 TargetLength)
+	{
+		static const TCHAR* Chunk =
+			TEXT("// {Copyright}\n")
+			TEXT("\n")
+			TEXT("#pragma once\n")
+			TEXT("\n")
+			TEXT("#include \"CoreMinimal.h\"\n")
+			TEXT("\n")
+			TEXT("class {ModuleName}_API F{ModuleName}GeneratedType\n")
+			TEXT("{\n")
+			TEXT("public:\n")
+			TEXT("\tstatic constexpr const TCHAR* Name = TEXT(\"{ModuleName}\");\n")
+			TEXT("\tint32 Values[4] = { 0, 1, 2, 3 };\n")
+			TEXT("\tvoid Log() const { UE_LOG(LogTemp, Log, TEXT(\"`{Unknown} {Unknown}\")); }\n")
+			TEXT("};\n")
+			TEXT("\n");
+		
+		FString Result;
+		Result.Reserve(TargetLength + FCString::Strlen(Chunk));
+		while (Result.Len() < TargetLength)
+		{
+			Result += Chunk;
+		}
+		return Result;
+	}
+
+	static void RunSubstitutionBenchmark()
+	{
+		const FString ModuleName = TEXT("MyBenchmarkModule");
+		const FString Copyright = TEXT("Copyright Benchmark Studio. All rights reserved.");
+
+		FStringFormatNamedArguments NamedArguments;
+		NamedArguments.Add(TEXT("ModuleName"), FStringFormatArg(ModuleName));
+		NamedArguments.Add(TEXT("Copyright"), FStringFormatArg(Copyright));
+
+		const TCHAR* Names[] = { TEXT("ModuleName"), TEXT("Copyright") };
+		const FStringView Values[] = { ModuleName, Copyright };
+		const FPlaceholderNameTable NameTable(Names);
+
+		UE_LOG(LogModuleGeneration, Display, TEXT("%12s %16s %16s %10s"), TEXT("Size"), TEXT("Format (ms)"), TEXT("Substitute (ms)"), TEXT("Speedup"));
+		for (const int32 TargetLength : { 1 << 10, 16 << 10, 256 << 10, 1 << 20, 10 << 20 })
+		{
+			const FString Template = MakeSyntheticTemplate(TargetLength);
+
+			const FString Expected = FString::Format(*Template, NamedArguments);
+			const FString Actual = SubstitutePlaceholders(Template, NameTable, Values);
+			if (!Expected.Equals(Actual, ESearchCase::CaseSensitive))
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("SubstitutePlaceholders and FString::Format disagree for a template of %d characters"), Template.Len());
+				return;
+			}
+
+			const double FormatSeconds = MeasureAverageSeconds([&Template, &NamedArguments]()
+			{
+				const FString Result = FString::Format(*Template, NamedArguments);
+			});
+			const double SubstituteSeconds = MeasureAverageSeconds([&Template, &NameTable, &Values]()
+			{
+				const FString Result = SubstitutePlaceholders(Template, NameTable, Values);
+			});
+			
+			UE_LOG(LogModuleGeneration, Display, TEXT("%10d B %16.3f %16.3f %9.1fx"),
+				Template.Len() * static_cast<int32>(sizeof(TCHAR)),
+				FormatSeconds * 1000.0,
+				SubstituteSeconds * 1000.0,
+				FormatSeconds / FMath::Max(SubstituteSeconds, UE_DOUBLE_SMALL_NUMBER));
+		}
+	}
+
+	static FAutoConsoleCommand SubstitutionBenchmarkCommand(
+		TEXT("ModuleGeneration.Benchmark.Substitution"),
+		TEXT("Compares SubstitutePlaceholders against FString::Format for templates from 1 KB to 10 MB."),
+		FConsoleCommandDelegate::CreateStatic(&RunSubstitutionBenchmark));
+}
@@ -0,0 +1,675 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Commandlets/BenchmarkModuleGenerationCommandlet.h"
+
+#include "Benchmark/CountingMallocProxy.h"
+#include "ModuleGenerationLog.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleBatchCreation.h"
+#include "NewModule/ModuleDescriptorFileUtils.h"
+#include "NewModule/ModuleTemplateCache.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+#include "NewModule/NewModuleUtils.h"
+
+#include "DesktopPlatformModule.h"
+#include "GeneralProjectSettings.h"
+#include "IDesktopPlatform.h"
+#include "ModuleDescriptor.h"
+#include "ProjectDescriptor.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/OutputDeviceNull.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		struct FBenchmarkRow
+		{
+			FString Benchmark;
+			FString Case;
+			/** Number of template files, descriptor entries or calls per iteration */
+			int32 Size = 0;
+			int32 Iterations = 0;
+			double MeanMilliseconds = 0.0;
+			double MinMilliseconds = 0.0;
+			/** Unset unless allocations are counted; see FCountingMallocProxy */
+			TOptional<FCountingMallocProxy::FCounts> CountsPerIteration;
+			int64 BytesWritten = 0;
+		};
+	}
+
+	static FString MakeSyntheticDescriptor(int32 NumModules, bool bIsPlugin);
+	static FOperationResult MakeSyntheticTemplate(const FString& TemplateDirectory, int32 NumFiles);
+	static FOperationResult AddSyntheticBinaryFiles(const FString& TemplateDirectory, int32 NumFiles);
+	static int64 GetDirectorySize(const FString& Directory);
+	static FString ToCsv(const TArray<FBenchmarkRow>& Rows);
+	static TOperationResult<FString> MakeScratchProject(const FString& ScratchDirectory);
+	static TOperationResult<double> BuildModuleWithUnrealBuildTool(const FString& ProjectFilePath, const FString& ModuleName);
+
+	/**
+	 * Runs Setup and then Run until at least half a second was spent in Run, with at least 3 and at most 50 iterations.
+	 * Only Run is measured.
+	 */
+	template<typename SetupType, typename RunType>
+	static TOperationResult<FBenchmarkRow> MeasureBenchmark(const TCHAR* Benchmark, const TCHAR* Case, int32 Size, SetupType&& Setup, RunType&& Run)
+	{
+		constexpr double MinTotalSeconds = 0.5;
+		constexpr int32 MinIterations = 3;
+		constexpr int32 MaxIterations = 50;
+
+		const FCountingMallocProxy* Malloc = FCountingMallocProxy::Get();
+		FCountingMallocProxy::FCounts TotalCounts;
+		double TotalSeconds = 0.0;
+		double MinSeconds = TNumericLimits<double>::Max();
+		int32 NumIterations = 0;
+		while (NumIterations < MinIterations || (TotalSeconds < MinTotalSeconds && NumIterations < MaxIterations))
+		{
+			Setup();
+
+			const FCountingMallocProxy::FCounts CountsBefore = Malloc ? Malloc->GetCounts() : FCountingMallocProxy::FCounts();
+			const double StartTime = FPlatformTime::Seconds();
+			const FOperationResult RunOp = Run();
+			const double Elapsed = FPlatformTime::Seconds() - StartTime;
+			const FCountingMallocProxy::FCounts Counts = Malloc ? Malloc->GetCounts() - CountsBefore : FCountingMallocProxy::FCounts();
+			
+			if (RunOp.IsFailure())
+			{
+				return TOperationResult<FBenchmarkRow>::MakeFailure(FString::Printf(TEXT("%s/%s (%d) failed: %s"), Benchmark, Case, Size, *RunOp.ErrorMessage.GetValue()));
+			}
+			
+			TotalSeconds += Elapsed;
+			MinSeconds = FMath::Min(MinSeconds, Elapsed);
+			TotalCounts.NumAllocations += Counts.NumAllocations;
+			TotalCounts.AllocatedBytes += Counts.AllocatedBytes;
+			++NumIterations;
+		}
+
+		FBenchmarkRow Row;
+		Row.Benchmark = Benchmark;
+		Row.Case = Case;
+		Row.Size = Size;
+		Row.Iterations = NumIterations;
+		Row.MeanMilliseconds = TotalSeconds * 1000.0 / NumIterations;
+		Row.MinMilliseconds = MinSeconds * 1000.0;
+		if (Malloc)
+		{
+			Row.CountsPerIteration = FCountingMallocProxy::FCounts{ TotalCounts.NumAllocations / NumIterations, TotalCounts.AllocatedBytes / NumIterations };
+		}
+		return TOperationResult<FBenchmarkRow>::MakeSuccess(MoveTemp(Row));
+	}
+
+	static FOperationResult RunInstantiateBenchmarks(const FString& WorkingDirectory, TArray<FBenchmarkRow>& OutRows)
+	{
+		const FModuleDescriptor NewModule(TEXT("BenchmarkModule"), EHostType::Runtime, ELoadingPhase::Default);
+		const FString CopyrightNotice = TEXT("Copyright Benchmark Studio. All rights reserved.");
+		
+		for (const int32 NumFiles : { 4, 64, 512, 4096 })
+		{
+			const FString TemplateDirectory = FPaths::Combine(WorkingDirectory, FString::Printf(TEXT("Template%d"), NumFiles));
+			const FString OutputDirectory = FPaths::Combine(WorkingDirectory, TEXT("Output"));
+			const FOperationResult MakeTemplateOp = MakeSyntheticTemplate(TemplateDirectory, NumFiles);
+			if (MakeTemplateOp.IsFailure())
+			{
+				return MakeTemplateOp;
+			}
+
+			for (const bool bIsCached : { false, true })
+			{
+				const TOperationResult<FBenchmarkRow> BenchmarkOp = MeasureBenchmark(
+					TEXT("InstantiateModuleTemplate"), bIsCached ? TEXT("CachedTemplate") : TEXT("UncachedTemplate"), NumFiles,
+					[&OutputDirectory, bIsCached]()
+					{
+						IFileManager::Get().DeleteDirectory(*OutputDirectory, false, true);
+						if (!bIsCached)
+						{
+							FModuleTemplateCache::Get().Invalidate();
+						}
+					},
+					[&TemplateDirectory, &OutputDirectory, &NewModule, &CopyrightNotice]()
+					{
+						return InstantiateModuleTemplate(TemplateDirectory, OutputDirectory, NewModule, CopyrightNotice);
+					});
+				if (BenchmarkOp.IsFailure())
+				{
+					return FOperationResult::MakeFailure(BenchmarkOp);
+				}
+				
+				FBenchmarkRow& Row = OutRows.Add_GetRef(BenchmarkOp.OperationResult.GetValue());
+				Row.BytesWritten = GetDirectorySize(OutputDirectory);
+			}
+
+			// Generating again over the previous output only compares the files, which are all unchanged
+			const TOperationResult<FBenchmarkRow> UnchangedBenchmarkOp = MeasureBenchmark(
+				TEXT("InstantiateModuleTemplate"), TEXT("UnchangedOutput"), NumFiles,
+				[]() {},
+				[&TemplateDirectory, &OutputDirectory, &NewModule, &CopyrightNotice]()
+				{
+					return InstantiateModuleTemplate(TemplateDirectory, OutputDirectory, NewModule, CopyrightNotice);
+				});
+			if (UnchangedBenchmarkOp.IsFailure())
+			{
+				return FOperationResult::MakeFailure(UnchangedBenchmarkOp);
+			}
+			OutRows.Add(UnchangedBenchmarkOp.OperationResult.GetValue());
+
+			// Dry run: the template is cached by now, so this never touches the disk
+			const TOperationResult<FBenchmarkRow> PlanBenchmarkOp = MeasureBenchmark(
+				TEXT("PlanModuleTemplate"), TEXT("InMemory"), NumFiles,
+				[]() {},
+				[&TemplateDirectory, &OutputDirectory, &NewModule, &CopyrightNotice]()
+				{
+					const TOperationResult<FPlannedModule> PlanOp = PlanModuleTemplate(TemplateDirectory, OutputDirectory, NewModule, CopyrightNotice);
+					return PlanOp.IsSuccess() ? FOperationResult::MakeSuccess() : FOperationResult::MakeFailure(PlanOp);
+				});
+			if (PlanBenchmarkOp.IsFailure())
+			{
+				return FOperationResult::MakeFailure(PlanBenchmarkOp);
+			}
+			OutRows.Add(PlanBenchmarkOp.OperationResult.GetValue());
+
+			// Binary files are copied from the template without being loaded, so allocations should barely grow with them
+			const FOperationResult AddBinaryFilesOp = AddSyntheticBinaryFiles(TemplateDirectory, NumFiles);
+			if (AddBinaryFilesOp.IsFailure())
+			{
+				return AddBinaryFilesOp;
+			}
+			FModuleTemplateCache::Get().Invalidate();
+			const TOperationResult<FBenchmarkRow> BinaryBenchmarkOp = MeasureBenchmark(
+				TEXT("InstantiateModuleTemplate"), TEXT("WithBinaryFiles"), NumFiles * 2,
+				[&OutputDirectory]()
+				{
+					IFileManager::Get().DeleteDirectory(*OutputDirectory, false, true);
+				},
+				[&TemplateDirectory, &OutputDirectory, &NewModule, &CopyrightNotice]()
+				{
+					return InstantiateModuleTemplate(TemplateDirectory, OutputDirectory, NewModule, CopyrightNotice);
+				});
+			if (BinaryBenchmarkOp.IsFailure())
+			{
+				return FOperationResult::MakeFailure(BinaryBenchmarkOp);
+			}
+			FBenchmarkRow& BinaryRow = OutRows.Add_GetRef(BinaryBenchmarkOp.OperationResult.GetValue());
+			BinaryRow.BytesWritten = GetDirectorySize(OutputDirectory);
+
+			FModuleTemplateCache::Get().Invalidate();
+			IFileManager::Get().DeleteDirectory(*TemplateDirectory, false, true);
+			IFileManager::Get().DeleteDirectory(*OutputDirectory, false, true);
+		}
+		FModuleTemplateCache::Get().Invalidate();
+		return FOperationResult::MakeSuccess();
+	}
+
+	static FOperationResult RunDescriptorBenchmarks(const FString& WorkingDirectory, TArray<FBenchmarkRow>& OutRows)
+	{
+		const FModuleDescriptor NewModule(TEXT("BenchmarkModule"), EHostType::Runtime, ELoadingPhase::Default);
+		
+		for (const int32 NumModules : { 10, 100, 1000, 10000 })
+		{
+			for (const bool bIsPlugin : { false, true })
+			{
+				const FString InputPath = FPaths::Combine(WorkingDirectory, bIsPlugin ? TEXT("Input.uplugin") : TEXT("Input.uproject"));
+				const FString OutputPath = FPaths::Combine(WorkingDirectory, bIsPlugin ? TEXT("Output.uplugin") : TEXT("Output.uproject"));
+				if (!FFileHelper::SaveStringToFile(MakeSyntheticDescriptor(NumModules, bIsPlugin), *InputPath))
+				{
+					return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write '%s'"), *InputPath));
+				}
+
+				const TOperationResult<FBenchmarkRow> BenchmarkOp = MeasureBenchmark(
+					TEXT("AddNewModulesToFile"), bIsPlugin ? TEXT("Plugin") : TEXT("Project"), NumModules,
+					[&OutputPath]()
+					{
+						IFileManager::Get().Delete(*OutputPath, false, true, true);
+					},
+					[&InputPath, &OutputPath, &NewModule]()
+					{
+						return AddNewModulesToFile(InputPath, MakeArrayView(&NewModule, 1), OutputPath);
+					});
+				if (BenchmarkOp.IsFailure())
+				{
+					return FOperationResult::MakeFailure(BenchmarkOp);
+				}
+				
+				FBenchmarkRow& Row = OutRows.Add_GetRef(BenchmarkOp.OperationResult.GetValue());
+				Row.BytesWritten = IFileManager::Get().FileSize(*OutputPath);
+				IFileManager::Get().Delete(*InputPath, false, true, true);
+				IFileManager::Get().Delete(*OutputPath, false, true, true);
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	static FOperationResult RunPathResolutionBenchmarks(TArray<FBenchmarkRow>& OutRows)
+	{
+		// Resolution is measured on this plugin because it is the only plugin known to exist
+		const TSharedPtr<IPlugin> ThisPlugin = IPluginManager::Get().FindPlugin(TEXT("ModuleGeneration"));
+		if (!ThisPlugin.IsValid())
+		{
+			UE_LOG(LogModuleGeneration, Display, TEXT("Skipping FindUPluginFile benchmark: ModuleGeneration is not discovered by the plugin manager."));
+			return FOperationResult::MakeSuccess();
+		}
+
+		const int32 NumPlugins = IPluginManager::Get().GetDiscoveredPlugins().Num();
+		const TOperationResult<FBenchmarkRow> BuildBenchmarkOp = MeasureBenchmark(
+			TEXT("FPluginDirectoryIndex"), TEXT("MakeFromPluginManager"), NumPlugins,
+			[]() {},
+			[]()
+			{
+				const FPluginDirectoryIndex Index = FPluginDirectoryIndex::MakeFromPluginManager();
+				return Index.Num() > 0 ? FOperationResult::MakeSuccess() : FOperationResult::MakeFailure(TEXT("No plugins were indexed"));
+			});
+		if (BuildBenchmarkOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(BuildBenchmarkOp);
+		}
+		OutRows.Add(BuildBenchmarkOp.OperationResult.GetValue());
+
+		// A nested directory so the lookup walks up several segments
+		constexpr int32 CallsPerIteration = 100;
+		const FString OutputDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(ThisPlugin->GetBaseDir(), TEXT("Source/ModuleGeneration/Private/NewModule")));
+		const TOperationResult<FBenchmarkRow> BenchmarkOp = MeasureBenchmark(
+			TEXT("FindUPluginFile"), ThisPlugin->GetLoadedFrom() == EPluginLoadedFrom::Project ? TEXT("ProjectPlugin") : TEXT("EnginePlugin"), CallsPerIteration,
+			[]() {},
+			[&OutputDirectory]()
+			{
+				for (int32 i = 0; i < CallsPerIteration; ++i)
+				{
+					const TOperationResult<FString> FindOp = FindUPluginFile(OutputDirectory);
+					if (FindOp.IsFailure())
+					{
+						return FOperationResult::MakeFailure(FindOp);
+					}
+				}
+				return FOperationResult::MakeSuccess();
+			});
+		if (BenchmarkOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(BenchmarkOp);
+		}
+		OutRows.Add(BenchmarkOp.OperationResult.GetValue());
+		return FOperationResult::MakeSuccess();
+	}
+
+	/**
+	 * Creates the default template once per build variant in a scratch copy of the project and compiles it with UnrealBuildTool:
+	 * once from scratch and once after touching a single .cpp file. Compiling takes far longer than anything else here, so every
+	 * build runs once and is only a rough number; run the commandlet several times to see how much it varies.
+	 */
+	static FOperationResult RunCompileBenchmarks(const FString& WorkingDirectory, TArray<FBenchmarkRow>& OutRows)
+	{
+		// The user's project is never touched, so nothing needs restoring if a build fails or the editor crashes
+		const FString ScratchDirectory = FPaths::Combine(WorkingDirectory, TEXT("CompileProject"));
+		const TOperationResult<FString> ScratchProjectOp = MakeScratchProject(ScratchDirectory);
+		if (ScratchProjectOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(ScratchProjectOp);
+		}
+		const FString& ProjectFilePath = ScratchProjectOp.OperationResult.GetValue();
+		TArray<uint8> ProjectFileContents;
+		if (!FFileHelper::LoadFileToArray(ProjectFileContents, *ProjectFilePath))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to read '%s'"), *ProjectFilePath));
+		}
+
+		FModuleBatchSettings Settings;
+		Settings.ProjectDirectory = ScratchDirectory;
+		Settings.ModuleTemplatePath = GetDefaultModuleTemplatePath();
+		Settings.CopyrightNotice = GetDefault<UGeneralProjectSettings>()->CopyrightNotice;
+		Settings.PluginIndex = GetPluginDirectoryIndex();
+
+		// Like GetIncludeModuleMap, but with the modules of the copy, so the private PCH leaves out the copied siblings' headers
+		FIncludeModuleMap::FSettings IncludeMapSettings = FIncludeModuleMap::MakeDefaultSettings(FPaths::EngineDir(), ScratchDirectory,
+			FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("IncludeModuleMap.json")));
+		IncludeMapSettings.ScannedRoots.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectPluginsDir()));
+		TSharedPtr<const FIncludeModuleMap> IncludeMap;
+
+		for (const FModuleBuildVariant& Variant : GetModuleBuildVariants())
+		{
+			const FString ModuleName = FString::Printf(TEXT("MGBench%s"), Variant.Name);
+			const TOperationResult<FModuleCreationRequest> RequestOp = MakeModuleCreationRequest(Settings.ProjectDirectory, ModuleName, TEXT("Runtime"), TEXT("Default"), TEXT("Source"));
+			if (RequestOp.IsFailure())
+			{
+				return FOperationResult::MakeFailure(RequestOp);
+			}
+			const FModuleCreationRequest& Request = RequestOp.OperationResult.GetValue();
+			const FString ModuleDirectory = FPaths::Combine(Request.OutputDirectory, ModuleName);
+
+			// Dependencies are not minimized, so like in the editor only variants that need it analyze them
+			const bool bNeedsIncludeMap = RequiresIncludeMap(Variant.Settings, false);
+			if (bNeedsIncludeMap && !IncludeMap)
+			{
+				IncludeMap = FIncludeModuleMap::LoadOrBuild(IncludeMapSettings);
+			}
+			Settings.BuildSettings = Variant.Settings;
+			Settings.IncludeMap = bNeedsIncludeMap ? IncludeMap : nullptr;
+			const FModuleBatchResult CreateResult = CreateModules(Settings, MakeArrayView(&Request, 1));
+			FOperationResult VariantOp = FOperationResult::MakeSuccess();
+			if (!CreateResult.bIsCommitted)
+			{
+				LogModuleBatchResult(MakeArrayView(&Request, 1), CreateResult);
+				VariantOp = FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to create module for build variant %s"), Variant.Name));
+			}
+
+			TArray<FString> SourceFiles;
+			IFileManager::Get().FindFilesRecursive(SourceFiles, *ModuleDirectory, TEXT("*.cpp"), true, false);
+			for (const TCHAR* Case : { TEXT("Full"), TEXT("Incremental") })
+			{
+				if (VariantOp.IsFailure())
+				{
+					break;
+				}
+				// An incremental build after changing one implementation detail, which is what iterating on a module mostly looks like
+				if (FCString::Strcmp(Case, TEXT("Incremental")) == 0 && SourceFiles.Num() > 0)
+				{
+					IFileManager::Get().SetTimeStamp(*SourceFiles[0], FDateTime::UtcNow());
+				}
+
+				const TOperationResult<double> BuildOp = BuildModuleWithUnrealBuildTool(ProjectFilePath, ModuleName);
+				if (BuildOp.IsFailure())
+				{
+					VariantOp = FOperationResult::MakeFailure(FString::Printf(TEXT("CompileModule/%s/%s failed: %s"), Variant.Name, Case, *BuildOp.ErrorMessage.GetValue()));
+					break;
+				}
+
+				FBenchmarkRow& Row = OutRows.AddDefaulted_GetRef();
+				Row.Benchmark = TEXT("CompileModule");
+				Row.Case = FString::Printf(TEXT("%s/%s"), Variant.Name, Case);
+				Row.Size = SourceFiles.Num();
+				Row.Iterations = 1;
+				Row.MeanMilliseconds = Row.MinMilliseconds = BuildOp.OperationResult.GetValue() * 1000.0;
+				Row.BytesWritten = GetDirectorySize(ModuleDirectory);
+			}
+
+			// Every variant starts from the same copy, so the modules of earlier variants are no siblings of later ones
+			IFileManager::Get().DeleteDirectory(*ModuleDirectory, false, true);
+			if (!FFileHelper::SaveArrayToFile(ProjectFileContents, *ProjectFilePath))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to restore '%s'"), *ProjectFilePath));
+			}
+			if (VariantOp.IsFailure())
+			{
+				return VariantOp;
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	static TOperationResult<FString> ProduceResult(int32 Index, bool bFail)
+	{
+		return bFail
+			? TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("Operation %d failed"), Index))
+			: TOperationResult<FString>::MakeSuccess(FString::Printf(TEXT("Result %d"), Index));
+	}
+
+	static FOperationResult PropagateResult(int32 Index, bool bFail)
+	{
+		const TOperationResult<FString> Inner = ProduceResult(Index, bFail);
+		if (Inner.IsFailure())
+		{
+			return FOperationResult::MakeFailure(Inner);
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	static FOperationResult RunOperationResultBenchmarks(TArray<FBenchmarkRow>& OutRows)
+	{
+		constexpr int32 CallsPerIteration = 10000;
+		for (const bool bFail : { false, true })
+		{
+			const TOperationResult<FBenchmarkRow> BenchmarkOp = MeasureBenchmark(
+				TEXT("TOperationResult"), bFail ? TEXT("PropagateFailure") : TEXT("PropagateSuccess"), CallsPerIteration,
+				[]() {},
+				[bFail]()
+				{
+					int32 NumFailures = 0;
+					for (int32 i = 0; i < CallsPerIteration; ++i)
+					{
+						NumFailures += PropagateResult(i, bFail).IsFailure() ? 1 : 0;
+					}
+					return NumFailures == (bFail ? CallsPerIteration : 0)
+						? FOperationResult::MakeSuccess()
+						: FOperationResult::MakeFailure(TEXT("Results were not propagated correctly"));
+				});
+			if (BenchmarkOp.IsFailure())
+			{
+				return FOperationResult::MakeFailure(BenchmarkOp);
+			}
+			OutRows.Add(BenchmarkOp.OperationResult.GetValue());
+		}
+		return FOperationResult::MakeSuccess();
+	}
+}
+
+UBenchmarkModuleGenerationCommandlet::UBenchmarkModuleGenerationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UBenchmarkModuleGenerationCommandlet::Main(const FString& Params)
+{
+	using namespace UE::ModuleGeneration;
+
+	FString OutputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("Benchmarks"), FString::Printf(TEXT("Generation-%s.csv"), *FDateTime::Now().ToString()));
+	}
+	
+	// The proxy can only replace GMalloc while no other thread allocates, so counting requires running single-threaded, which also
+	// makes ParallelFor run inline and the timings incomparable with normal runs
+	if (FParse::Param(*Params, TEXT("CountAllocations")) && !FCountingMallocProxy::Install())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("-CountAllocations requires -nothreading"));
+		return 1;
+	}
+
+	const FString WorkingDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("ModuleGeneration"), TEXT("Benchmark")));
+	IFileManager::Get().DeleteDirectory(*WorkingDirectory, false, true);
+	IFileManager::Get().MakeDirectory(*WorkingDirectory, true);
+
+	TArray<FBenchmarkRow> Rows;
+	FOperationResult BenchmarkOp = RunInstantiateBenchmarks(WorkingDirectory, Rows);
+	if (BenchmarkOp)
+	{
+		BenchmarkOp = RunDescriptorBenchmarks(WorkingDirectory, Rows);
+	}
+	if (BenchmarkOp)
+	{
+		BenchmarkOp = RunPathResolutionBenchmarks(Rows);
+	}
+	if (BenchmarkOp)
+	{
+		BenchmarkOp = RunOperationResultBenchmarks(Rows);
+	}
+	if (BenchmarkOp && FParse::Param(*Params, TEXT("CompileVariants")))
+	{
+		BenchmarkOp = RunCompileBenchmarks(WorkingDirectory, Rows);
+	}
+	IFileManager::Get().DeleteDirectory(*WorkingDirectory, false, true);
+
+	for (const FBenchmarkRow& Row : Rows)
+	{
+		const FString Allocations = Row.CountsPerIteration
+			? FString::Printf(TEXT(" %8llu allocs %12llu B allocated"), Row.CountsPerIteration->NumAllocations, Row.CountsPerIteration->AllocatedBytes)
+			: FString();
+		UE_LOG(LogModuleGeneration, Display, TEXT("  %-26s %-18s %6d: %10.3f ms (min %10.3f ms)%s %10lld B written"),
+			*Row.Benchmark, *Row.Case, Row.Size, Row.MeanMilliseconds, Row.MinMilliseconds, *Allocations, Row.BytesWritten);
+	}
+	if (BenchmarkOp.IsFailure())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *BenchmarkOp.ErrorMessage.GetValue());
+		return 1;
+	}
+
+	if (!FFileHelper::SaveStringToFile(ToCsv(Rows), *OutputPath))
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("Failed to write benchmark results to '%s'"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogModuleGeneration, Display, TEXT("Wrote benchmark results to '%s'"), *OutputPath);
+	return 0;
+}
+
+namespace UE::ModuleGeneration
+{
+	static FString MakeSyntheticDescriptor(int32 NumModules, bool bIsPlugin)
+	{
+		FString Result = bIsPlugin
+			? TEXT("{\n\t\"FileVersion\": 3,\n\t\"Version\": 1,\n\t\"VersionName\": \"1.0\",\n\t\"FriendlyName\": \"Benchmark\",\n\t\"CanContainContent\": false,\n\t\"Modules\": [\n")
+			: TEXT("{\n\t\"FileVersion\": 3,\n\t\"EngineAssociation\": \"\",\n\t\"Category\": \"\",\n\t\"Description\": \"\",\n\t\"Modules\": [\n");
+		for (int32 i = 0; i < NumModules; ++i)
+		{
+			Result += FString::Printf(TEXT("\t\t{\n\t\t\t\"Name\": \"ExistingModule%d\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}%s\n"),
+				i, i < NumModules - 1 ? TEXT(",") : TEXT(""));
+		}
+		Result += TEXT("\t]\n}\n");
+		return Result;
+	}
+
+	static FOperationResult MakeSyntheticTemplate(const FString& TemplateDirectory, int32 NumFiles)
+	{
+		static const TCHAR* SourceContents =
+			TEXT("// {Copyright}\n")
+			TEXT("\n")
+			TEXT("#include \"{ModuleName}.h\"\n")
+			TEXT("\n")
+			TEXT("namespace {ModuleName}::Generated\n")
+			TEXT("{\n")
+			TEXT("\tstatic constexpr const TCHAR* Name = TEXT(\"{ModuleName}\");\n")
+			TEXT("\tint32 Values[4] = { 0, 1, 2, 3 };\n")
+			TEXT("}\n");
+
+		// Mirrors the real template: a Build.cs, one header and the rest spread over a few source folders
+		const FString ModuleDirectory = FPaths::Combine(TemplateDirectory, TEXT("{ModuleName}"));
+		TArray<TPair<FString, FString>> Files;
+		Files.Emplace(FPaths::Combine(ModuleDirectory, TEXT("{ModuleName}.Build.cs")), TEXT("// {Copyright}\n\nusing UnrealBuildTool;\n\npublic class {ModuleName} : ModuleRules\n{\n}\n"));
+		Files.Emplace(FPaths::Combine(ModuleDirectory, TEXT("Public"), TEXT("{ModuleName}.h")), TEXT("// {Copyright}\n\n#pragma once\n"));
+		for (int32 i = Files.Num(); i < NumFiles; ++i)
+		{
+			Files.Emplace(FPaths::Combine(ModuleDirectory, TEXT("Private"), FString::Printf(TEXT("Folder%d"), i % 16), FString::Printf(TEXT("{ModuleName}File%d.cpp"), i)), SourceContents);
+		}
+
+		for (const TPair<FString, FString>& File : Files)
+		{
+			if (!FFileHelper::SaveStringToFile(File.Value, *File.Key))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write '%s'"), *File.Key));
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	static FOperationResult AddSyntheticBinaryFiles(const FString& TemplateDirectory, int32 NumFiles)
+	{
+		// Like small textures: 16 KB each, starting with a header containing NUL bytes
+		TArray<uint8> Contents;
+		Contents.SetNumZeroed(16 * 1024);
+		FRandomStream Random(NumFiles);
+		for (int32 Index = 16; Index < Contents.Num(); ++Index)
+		{
+			Contents[Index] = static_cast<uint8>(Random.RandRange(0, 255));
+		}
+
+		for (int32 i = 0; i < NumFiles; ++i)
+		{
+			const FString FilePath = FPaths::Combine(TemplateDirectory, TEXT("{ModuleName}"), TEXT("Resources"), FString::Printf(TEXT("Icon%d.png"), i));
+			if (!FFileHelper::SaveArrayToFile(Contents, *FilePath))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write '%s'"), *FilePath));
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	static int64 GetDirectorySize(const FString& Directory)
+	{
+		int64 Result = 0;
+		IFileManager::Get().IterateDirectoryStatRecursively(*Directory, [&Result](const TCHAR*, const FFileStatData& StatData)
+		{
+			if (!StatData.bIsDirectory)
+			{
+				Result += StatData.FileSize;
+			}
+			return true;
+		});
+		return Result;
+	}
+
+	static FString ToCsv(const TArray<FBenchmarkRow>& Rows)
+	{
+		FString Result = TEXT("Benchmark,Case,Size,Iterations,MeanMs,MinMs,AllocationsPerIteration,AllocatedBytesPerIteration,BytesWritten\n");
+		for (const FBenchmarkRow& Row : Rows)
+		{
+			// Allocation columns stay empty unless allocations were counted
+			const FString Allocations = Row.CountsPerIteration
+				? FString::Printf(TEXT("%llu,%llu"), Row.CountsPerIteration->NumAllocations, Row.CountsPerIteration->AllocatedBytes)
+				: FString(TEXT(","));
+			Result += FString::Printf(TEXT("%s,%s,%d,%d,%.4f,%.4f,%s,%lld\n"),
+				*Row.Benchmark, *Row.Case, Row.Size, Row.Iterations, Row.MeanMilliseconds, Row.MinMilliseconds, *Allocations, Row.BytesWritten);
+		}
+		return Result;
+	}
+
+	static TOperationResult<FString> MakeScratchProject(const FString& ScratchDirectory)
+	{
+		// UnrealBuildTool needs the .uproject and the targets and modules in Source. Plugins can be large, so the copy refers to
+		// the project's Plugins folder instead of copying it.
+		const FString ProjectFilePath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+		const FString ScratchProjectFilePath = FPaths::Combine(ScratchDirectory, FPaths::GetCleanFilename(ProjectFilePath));
+		const FString SourceDirectory = FPaths::ConvertRelativePathToFull(FPaths::GameSourceDir());
+		IFileManager::Get().DeleteDirectory(*ScratchDirectory, false, true);
+		if (!FPlatformFileManager::Get().GetPlatformFile().CopyDirectoryTree(*FPaths::Combine(ScratchDirectory, TEXT("Source")), *SourceDirectory, true))
+		{
+			return TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("Failed to copy '%s' to '%s'"), *SourceDirectory, *ScratchDirectory));
+		}
+
+		FProjectDescriptor ProjectDescriptor;
+		FText FailReason;
+		if (!ProjectDescriptor.Load(ProjectFilePath, FailReason))
+		{
+			return TOperationResult<FString>::MakeFailure(FailReason.ToString());
+		}
+		ProjectDescriptor.AddPluginDirectory(FPaths::ConvertRelativePathToFull(FPaths::ProjectPluginsDir()));
+		if (!ProjectDescriptor.Save(ScratchProjectFilePath, FailReason))
+		{
+			return TOperationResult<FString>::MakeFailure(FailReason.ToString());
+		}
+		return TOperationResult<FString>::MakeSuccess(ScratchProjectFilePath);
+	}
+
+	static TOperationResult<double> BuildModuleWithUnrealBuildTool(const FString& ProjectFilePath, const FString& ModuleName)
+	{
+		IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+		if (DesktopPlatform == nullptr)
+		{
+			return TOperationResult<double>::MakeFailure(TEXT("The desktop platform module is not available"));
+		}
+
+		// Builds only the module, into the editor target of the project, which has the same name as the running editor's
+		const FString Arguments = FString::Printf(TEXT("%sEditor %s Development -Project=\"%s\" -Module=%s -NoHotReloadFromIDE -WaitMutex"),
+			*FPaths::GetBaseFilename(ProjectFilePath), *FPlatformMisc::GetUBTPlatform(),
+			*IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*ProjectFilePath), *ModuleName);
+		UE_LOG(LogModuleGeneration, Display, TEXT("Building: UnrealBuildTool %s"), *Arguments);
+
+		FOutputDeviceNull NullOutput;
+		int32 ReturnCode = 0;
+		FString Output;
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bLaunched = DesktopPlatform->InvokeUnrealBuildToolSync(Arguments, NullOutput, true, ReturnCode, Output);
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		if (!bLaunched || ReturnCode != 0)
+		{
+			UE_LOG(LogModuleGeneration, Display, TEXT("%s"), *Output);
+			return TOperationResult<double>::MakeFailure(FString::Printf(TEXT("UnrealBuildTool exited with code %d"), ReturnCode));
+		}
+		return TOperationResult<double>::MakeSuccess(Elapsed);
+	}
+}
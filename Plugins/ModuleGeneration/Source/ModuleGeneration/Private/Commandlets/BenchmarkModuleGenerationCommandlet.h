@@ -0,0 +1,37 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "BenchmarkModuleGenerationCommandlet.generated.h"
+
+/**
+ * Measures the module generation pipeline on synthetic inputs and writes the results to a CSV file that can be compared between commits.
+ *
+ * Usage:
+ *	UnrealEditor-Cmd.exe <Project>.uproject -run=BenchmarkModuleGeneration [-Output=<Path/To/Results.csv>] [-CompileVariants] [-CountAllocations -nothreading]
+ *
+ * Covers template instantiation for templates with a few to thousands of files, descriptor updates for descriptors with 10 to 10000
+ * module entries, .uplugin path resolution and TOperationResult propagation. Each row contains the mean and minimum wall time and
+ * the bytes written to disk. All files are created in Intermediate/ModuleGeneration/Benchmark and deleted afterwards.
+ *
+ * -CountAllocations also records allocations and allocated bytes per iteration. Counting replaces GMalloc, which is only safe while
+ * no other thread runs, so it requires -nothreading; timings of such runs are single-threaded and only comparable with each other.
+ *
+ * -CompileVariants additionally compiles the default template with every build variant (see GetModuleBuildVariants), from scratch and
+ * after touching one .cpp file, to compare PCH and unity settings. UnrealBuildTool only builds modules of a project, so the modules
+ * are created in a scratch copy of the project's Source folder and .uproject inside the working directory; the project itself is
+ * never modified.
+ */
+UCLASS()
+class UBenchmarkModuleGenerationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+
+	UBenchmarkModuleGenerationCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,120 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Commandlets/GenerateModulesCommandlet.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/ModuleBatchCreation.h"
+#include "NewModule/ModuleTemplateRegistry.h"
+#include "NewModule/NewModuleUtils.h"
+
+#include "GeneralProjectSettings.h"
+
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+
+UGenerateModulesCommandlet::UGenerateModulesCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UGenerateModulesCommandlet::Main(const FString& Params)
+{
+	using namespace UE::ModuleGeneration;
+
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bIsTimed = FModuleCreationTimings::Get().BeginRun();
+	ON_SCOPE_EXIT
+	{
+		if (bIsTimed)
+		{
+			FModuleCreationTimings::Get().EndRun();
+		}
+	};
+
+	FString ManifestPath;
+	if (!FParse::Value(*Params, TEXT("Manifest="), ManifestPath))
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("Missing -Manifest=<Path/To/Manifest.json> argument."));
+		return 1;
+	}
+	const bool bSkipProjectFiles = FParse::Param(*Params, TEXT("NoProjectFiles"));
+	FString TemplateName = DefaultModuleTemplateName;
+	FParse::Value(*Params, TEXT("Template="), TemplateName);
+	const TOperationResult<FModuleTemplateInfo> FindTemplateOp = FindModuleTemplate(GetModuleTemplatesDirectory(), TemplateName);
+	if (FindTemplateOp.IsFailure())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *FindTemplateOp.ErrorMessage.GetValue());
+		return 1;
+	}
+
+	FString BuildVariantName = DefaultModuleBuildVariantName;
+	FParse::Value(*Params, TEXT("BuildVariant="), BuildVariantName);
+	const TOperationResult<FModuleBuildSettings> FindBuildVariantOp = FindModuleBuildVariant(BuildVariantName);
+	if (FindBuildVariantOp.IsFailure())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *FindBuildVariantOp.ErrorMessage.GetValue());
+		return 1;
+	}
+
+	const TOperationResult<TArray<FModuleCreationRequest>> LoadManifestOp = LoadModuleManifest(ManifestPath, FPaths::ProjectDir());
+	if (LoadManifestOp.IsFailure())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *LoadManifestOp.ErrorMessage.GetValue());
+		return 1;
+	}
+	const TArray<FModuleCreationRequest>& Requests = LoadManifestOp.OperationResult.GetValue();
+	
+	const FOperationResult ValidateOp = ValidateModuleRequests(Requests);
+	if (ValidateOp.IsFailure())
+	{
+		UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *ValidateOp.ErrorMessage.GetValue());
+		return 1;
+	}
+	UE_LOG(LogModuleGeneration, Display, TEXT("Creating %d modules from manifest '%s'..."), Requests.Num(), *ManifestPath);
+
+	// Resolve editor state once on the game thread so the workers only touch the file system
+	FModuleBatchSettings Settings;
+	Settings.ProjectDirectory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+	Settings.ModuleTemplatePath = FindTemplateOp.OperationResult->Path;
+	Settings.CopyrightNotice = GetDefault<UGeneralProjectSettings>()->CopyrightNotice;
+	Settings.PluginIndex = GetPluginDirectoryIndex();
+	Settings.BuildSettings = FindBuildVariantOp.OperationResult.GetValue();
+	if (RequiresIncludeMap(Settings.BuildSettings, FParse::Param(*Params, TEXT("MinimizeDependencies"))))
+	{
+		Settings.IncludeMap = GetIncludeModuleMap();
+	}
+	const FModuleBatchResult Result = CreateModules(Settings, Requests);
+	const bool bIsCommitted = Result.bIsCommitted;
+
+	// Project files are regenerated exactly once
+	double ProjectFilesSeconds = 0.0;
+	if (!bSkipProjectFiles && bIsCommitted)
+	{
+		const double ProjectFilesStartTime = FPlatformTime::Seconds();
+		const FOperationResult GenerateOp = GenerateVisualStudioSolution();
+		ProjectFilesSeconds = FPlatformTime::Seconds() - ProjectFilesStartTime;
+		if (GenerateOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("%s"), *GenerateOp.ErrorMessage.GetValue());
+		}
+	}
+
+	LogModuleBatchResult(Requests, Result);
+	UE_LOG(LogModuleGeneration, Display, TEXT("Created %d of %d modules in %.2f s (templates: %.2f s, descriptors and commit: %.2f s, project files: %.2f s)"),
+		bIsCommitted ? Requests.Num() : 0,
+		Requests.Num(),
+		FPlatformTime::Seconds() - StartTime,
+		Result.InstantiateSeconds,
+		Result.DescriptorSeconds,
+		ProjectFilesSeconds);
+	if (bIsTimed)
+	{
+		FModuleCreationTimings::Get().LogSummary(FString::Printf(TEXT("%d modules from '%s'"), Requests.Num(), *ManifestPath), FPlatformTime::Seconds() - StartTime, bIsCommitted);
+	}
+
+	return bIsCommitted ? 0 : 1;
+}
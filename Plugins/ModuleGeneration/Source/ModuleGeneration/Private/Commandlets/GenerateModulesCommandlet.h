@@ -0,0 +1,35 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "GenerateModulesCommandlet.generated.h"
+
+/**
+ * Creates many modules in one run without opening the editor UI.
+ * Either all modules are created or, if any of them fails, none are.
+ *
+ * Usage:
+ *	UnrealEditor-Cmd.exe <Project>.uproject -run=GenerateModules -Manifest=<Path/To/Manifest.json> [-Template=<Name>] [-NoProjectFiles]
+ *
+ * Template is the name of a template in the plugin's Resources/Templates folder and defaults to Default.
+ *
+ * The manifest has the following layout. OutputDirectory is relative to the project directory unless absolute.
+ *	{
+ *		"Modules": [
+ *			{ "Name": "MyModule", "Type": "Runtime", "LoadingPhase": "Default", "OutputDirectory": "Source" }
+ *		]
+ *	}
+ */
+UCLASS()
+class UGenerateModulesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+
+	UGenerateModulesCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
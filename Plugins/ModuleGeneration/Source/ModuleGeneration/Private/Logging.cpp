@@ -1,5 +0,0 @@
-// Copyright Dominik Peacock. All rights reserved.
-
-#include "Logging.h"
-
-DEFINE_LOG_CATEGORY(LogModuleGeneration);
\ No newline at end of file
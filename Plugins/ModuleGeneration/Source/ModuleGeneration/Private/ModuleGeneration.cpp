@@ -3,9 +3,14 @@
 #include "ModuleGeneration.h"
 
 #include "ModuleGenerationCommands.h"
+#include "NewModule/ModuleIndex.h"
+#include "NewModule/ModuleTemplateCache.h"
 #include "NewModule/NewModuleUtils.h"
+#include "NewModule/ProjectFileRegenerator.h"
 
+#include "DirectoryWatcherModule.h"
 #include "Framework/Commands/UICommandList.h"
+#include "IDirectoryWatcher.h"
 #include "Modules/ModuleManager.h"
 #include "ToolMenus.h"
 
@@ -15,6 +20,11 @@ void FModuleGenerationModule::StartupModule()
 {
 	FModuleGenerationCommands::Register();
 
+	// Templates are loaded lazily on first use and dropped whenever they are edited on disk
+	StartWatchingTemplates();
+	// Built in the background so the new module dialog does not have to parse every descriptor when it opens
+	UE::ModuleGeneration::FModuleIndex::Get().Initialize();
+
 	PluginCommands = MakeShareable(new FUICommandList);
 	PluginCommands->MapAction(
 		FModuleGenerationCommands::Get().NewModule,
@@ -32,7 +42,48 @@ void FModuleGenerationModule::StartupModule()
 }
 
 void FModuleGenerationModule::ShutdownModule()
-{}
+{
+	UE::ModuleGeneration::FProjectFileRegenerator::Get().Shutdown();
+	UE::ModuleGeneration::FModuleIndex::Get().Shutdown();
+	StopWatchingTemplates();
+	UE::ModuleGeneration::FModuleTemplateCache::Get().Invalidate();
+}
+
+void FModuleGenerationModule::StartWatchingTemplates()
+{
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get();
+	if (DirectoryWatcher == nullptr)
+	{
+		return;
+	}
+
+	const FString TemplateDirectory = UE::ModuleGeneration::GetModuleTemplatesDirectory();
+	const bool bIsWatching = DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+		TemplateDirectory,
+		IDirectoryWatcher::FDirectoryChanged::CreateLambda([](const TArray<FFileChangeData>&)
+		{
+			UE::ModuleGeneration::FModuleTemplateCache::Get().Invalidate();
+		}),
+		TemplateDirectoryWatcherHandle,
+		IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges);
+	if (bIsWatching)
+	{
+		WatchedTemplateDirectory = TemplateDirectory;
+	}
+}
+
+void FModuleGenerationModule::StopWatchingTemplates()
+{
+	FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule ? DirectoryWatcherModule->Get() : nullptr;
+	if (DirectoryWatcher != nullptr && !WatchedTemplateDirectory.IsEmpty())
+	{
+		DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(WatchedTemplateDirectory, TemplateDirectoryWatcherHandle);
+	}
+	WatchedTemplateDirectory.Reset();
+	TemplateDirectoryWatcherHandle.Reset();
+}
 
 #undef LOCTEXT_NAMESPACE
 	
@@ -18,4 +18,11 @@ public:
 private:
 	
 	TSharedPtr<FUICommandList> PluginCommands;
+
+	/** Directory whose changes invalidate FModuleTemplateCache */
+	FString WatchedTemplateDirectory;
+	FDelegateHandle TemplateDirectoryWatcherHandle;
+
+	void StartWatchingTemplates();
+	void StopWatchingTemplates();
 };
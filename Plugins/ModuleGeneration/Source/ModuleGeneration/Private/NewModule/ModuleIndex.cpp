@@ -0,0 +1,450 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ModuleIndex.h"
+
+#include "ModuleGenerationLog.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "DirectoryWatcherModule.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "IDirectoryWatcher.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "PluginDescriptor.h"
+#include "ProjectDescriptor.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Bump when the layout of the cache file changes */
+	static constexpr int32 ModuleIndexCacheVersion = 1;
+
+	static FString NormalizeDescriptorPath(const FString& Path)
+	{
+		FString Result = FPaths::ConvertRelativePathToFull(Path);
+		FPaths::NormalizeFilename(Result);
+		return Result;
+	}
+
+	static bool IsDescriptorFile(const FString& Path)
+	{
+		return Path.EndsWith(TEXT(".uproject"), ESearchCase::IgnoreCase) || Path.EndsWith(TEXT(".uplugin"), ESearchCase::IgnoreCase);
+	}
+
+	FModuleIndex& FModuleIndex::Get()
+	{
+		static FModuleIndex Instance;
+		return Instance;
+	}
+
+	void FModuleIndex::Initialize()
+	{
+		check(IsInGameThread());
+
+		// The plugin manager already knows all descriptors so there is no need to search the disk for them
+		TArray<FString> DescriptorPaths;
+		if (FPaths::IsProjectFilePathSet())
+		{
+			DescriptorPaths.Add(NormalizeDescriptorPath(FPaths::GetProjectFilePath()));
+		}
+		for (const TSharedRef<IPlugin>& Plugin : IPluginManager::Get().GetDiscoveredPlugins())
+		{
+			if (Plugin->GetLoadedFrom() == EPluginLoadedFrom::Project)
+			{
+				DescriptorPaths.Add(NormalizeDescriptorPath(Plugin->GetDescriptorFileName()));
+			}
+		}
+
+		InitialBuildTask = UpdatePipe.Launch(UE_SOURCE_LOCATION, [this, DescriptorPaths]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			const TSharedRef<FSnapshot> NewSnapshot = BuildSnapshot(DescriptorPaths, *LoadFromDisk(), {});
+			NewSnapshot->ModuleNames = BuildModuleNames(*NewSnapshot);
+			SaveToDisk(*NewSnapshot);
+			UE_LOG(LogModuleGeneration, Verbose, TEXT("Built module index with %d modules from %d descriptors in %.2f ms"),
+				NewSnapshot->Modules.Num(), NewSnapshot->Descriptors.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			SetSnapshot(NewSnapshot);
+		});
+
+		// Queued after the project's modules so the dialog can validate names against those as soon as possible
+		EngineIndexTask = UpdatePipe.Launch(UE_SOURCE_LOCATION, [this]()
+		{
+			EngineModuleNames = LoadOrScanEngineModuleNames();
+			const TSharedRef<FSnapshot> NewSnapshot = MakeShared<FSnapshot>(*GetSnapshot());
+			NewSnapshot->ModuleNames = BuildModuleNames(*NewSnapshot);
+			SetSnapshot(NewSnapshot);
+		});
+
+		FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+		if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get())
+		{
+			WatchedDirectory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+			DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+				WatchedDirectory,
+				IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FModuleIndex::OnDirectoryChanged),
+				DirectoryWatcherHandle);
+		}
+	}
+
+	void FModuleIndex::Shutdown()
+	{
+		check(IsInGameThread());
+		
+		if (DirectoryWatcherHandle.IsValid())
+		{
+			FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+			if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule ? DirectoryWatcherModule->Get() : nullptr)
+			{
+				DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(WatchedDirectory, DirectoryWatcherHandle);
+			}
+			DirectoryWatcherHandle.Reset();
+		}
+		UpdatePipe.WaitUntilEmpty();
+	}
+
+	void FModuleIndex::WaitUntilBuilt() const
+	{
+		InitialBuildTask.Wait();
+	}
+
+	bool FModuleIndex::IsBuilt() const
+	{
+		return InitialBuildTask.IsCompleted();
+	}
+
+	bool FModuleIndex::IsEngineIndexed() const
+	{
+		return EngineIndexTask.IsCompleted();
+	}
+
+	bool FModuleIndex::ContainsModule(const FString& ModuleName) const
+	{
+		return GetSnapshot()->ModuleNames->Find(ModuleName) != INDEX_NONE;
+	}
+
+	TArray<FModuleContextInfo> FModuleIndex::GetModules() const
+	{
+		return GetSnapshot()->Modules;
+	}
+
+	TSharedRef<const FModuleNameTable> FModuleIndex::GetModuleNames() const
+	{
+		return GetSnapshot()->ModuleNames;
+	}
+
+	TSharedRef<const FModuleIndex::FSnapshot> FModuleIndex::GetSnapshot() const
+	{
+		FReadScopeLock ReadLock(SnapshotLock);
+		return Snapshot;
+	}
+
+	void FModuleIndex::SetSnapshot(TSharedRef<const FSnapshot> NewSnapshot)
+	{
+		{
+			FWriteScopeLock WriteLock(SnapshotLock);
+			Snapshot = MoveTemp(NewSnapshot);
+		}
+		AsyncTask(ENamedThreads::GameThread, [this]()
+		{
+			IndexChangedDelegate.Broadcast();
+		});
+	}
+
+	void FModuleIndex::OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+	{
+		TSet<FString> AddedOrModified;
+		TSet<FString> Removed;
+		for (const FFileChangeData& FileChange : FileChanges)
+		{
+			if (!IsDescriptorFile(FileChange.Filename))
+			{
+				continue;
+			}
+			
+			const FString DescriptorPath = NormalizeDescriptorPath(FileChange.Filename);
+			if (FileChange.Action == FFileChangeData::FCA_Removed)
+			{
+				Removed.Add(DescriptorPath);
+				AddedOrModified.Remove(DescriptorPath);
+			}
+			else
+			{
+				AddedOrModified.Add(DescriptorPath);
+				Removed.Remove(DescriptorPath);
+			}
+		}
+		if (AddedOrModified.Num() == 0 && Removed.Num() == 0)
+		{
+			return;
+		}
+
+		UpdatePipe.Launch(UE_SOURCE_LOCATION, [this, AddedOrModified = MoveTemp(AddedOrModified), Removed = MoveTemp(Removed)]()
+		{
+			const TSharedRef<const FSnapshot> Previous = GetSnapshot();
+			TArray<FString> DescriptorPaths;
+			for (const FIndexedDescriptor& Descriptor : Previous->Descriptors)
+			{
+				if (!Removed.Contains(Descriptor.DescriptorPath) && !AddedOrModified.Contains(Descriptor.DescriptorPath))
+				{
+					DescriptorPaths.Add(Descriptor.DescriptorPath);
+				}
+			}
+			DescriptorPaths.Append(AddedOrModified.Array());
+
+			const TSharedRef<FSnapshot> NewSnapshot = BuildSnapshot(DescriptorPaths, *Previous, AddedOrModified);
+			NewSnapshot->ModuleNames = BuildModuleNames(*NewSnapshot);
+			SaveToDisk(*NewSnapshot);
+			SetSnapshot(NewSnapshot);
+		});
+	}
+
+	TSharedRef<const FModuleNameTable> FModuleIndex::BuildModuleNames(const FSnapshot& ForSnapshot) const
+	{
+		TArray<FModuleNameEntry> Entries;
+		Entries.Reserve(ForSnapshot.Modules.Num() + (EngineModuleNames ? EngineModuleNames->Num() : 0));
+		for (const FIndexedDescriptor& Descriptor : ForSnapshot.Descriptors)
+		{
+			const bool bIsProject = Descriptor.DescriptorPath.EndsWith(TEXT(".uproject"), ESearchCase::IgnoreCase);
+			for (const FModuleContextInfo& Module : Descriptor.Modules)
+			{
+				Entries.Add({ Module.ModuleName, bIsProject ? EModuleLocation::Project : EModuleLocation::ProjectPlugin });
+			}
+		}
+		if (EngineModuleNames)
+		{
+			for (int32 Index = 0; Index < EngineModuleNames->Num(); ++Index)
+			{
+				Entries.Add({ FString(EngineModuleNames->GetName(Index)), EngineModuleNames->GetLocation(Index) });
+			}
+		}
+		return FModuleNameTable::Build(Entries);
+	}
+
+	TSharedRef<FModuleIndex::FSnapshot> FModuleIndex::BuildSnapshot(const TArray<FString>& DescriptorPaths, const FSnapshot& Previous, const TSet<FString>& ForceReindex)
+	{
+		TMap<FString, const FIndexedDescriptor*> PreviousDescriptors;
+		PreviousDescriptors.Reserve(Previous.Descriptors.Num());
+		for (const FIndexedDescriptor& Descriptor : Previous.Descriptors)
+		{
+			PreviousDescriptors.Add(Descriptor.DescriptorPath, &Descriptor);
+		}
+
+		// Only descriptors whose timestamp changed are parsed again
+		TArray<TOptional<FIndexedDescriptor>> Descriptors;
+		Descriptors.SetNum(DescriptorPaths.Num());
+		ParallelFor(DescriptorPaths.Num(), [&DescriptorPaths, &PreviousDescriptors, &ForceReindex, &Descriptors](int32 Index)
+		{
+			const FString& DescriptorPath = DescriptorPaths[Index];
+			const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*DescriptorPath);
+			if (Timestamp == FDateTime::MinValue())
+			{
+				// Descriptor no longer exists
+				return;
+			}
+			
+			const FIndexedDescriptor* const* PreviousDescriptor = PreviousDescriptors.Find(DescriptorPath);
+			if (PreviousDescriptor && (*PreviousDescriptor)->Timestamp == Timestamp && !ForceReindex.Contains(DescriptorPath))
+			{
+				Descriptors[Index] = **PreviousDescriptor;
+				return;
+			}
+			Descriptors[Index] = IndexDescriptor(DescriptorPath);
+		});
+
+		const TSharedRef<FSnapshot> Result = MakeShared<FSnapshot>();
+		for (TOptional<FIndexedDescriptor>& Descriptor : Descriptors)
+		{
+			if (!Descriptor.IsSet())
+			{
+				continue;
+			}
+			
+			Result->Modules.Append(Descriptor->Modules);
+			Result->Descriptors.Add(MoveTemp(Descriptor.GetValue()));
+		}
+		return Result;
+	}
+
+	TOptional<FModuleIndex::FIndexedDescriptor> FModuleIndex::IndexDescriptor(const FString& DescriptorPath)
+	{
+		FText FailReason;
+		TArray<FModuleDescriptor> ModuleDescriptors;
+		if (DescriptorPath.EndsWith(TEXT(".uproject"), ESearchCase::IgnoreCase))
+		{
+			FProjectDescriptor ProjectDescriptor;
+			if (!ProjectDescriptor.Load(DescriptorPath, FailReason))
+			{
+				UE_LOG(LogModuleGeneration, Warning, TEXT("Failed to index '%s': %s"), *DescriptorPath, *FailReason.ToString());
+				return {};
+			}
+			ModuleDescriptors = MoveTemp(ProjectDescriptor.Modules);
+		}
+		else
+		{
+			FPluginDescriptor PluginDescriptor;
+			if (!PluginDescriptor.Load(DescriptorPath, FailReason))
+			{
+				UE_LOG(LogModuleGeneration, Warning, TEXT("Failed to index '%s': %s"), *DescriptorPath, *FailReason.ToString());
+				return {};
+			}
+			ModuleDescriptors = MoveTemp(PluginDescriptor.Modules);
+		}
+
+		FIndexedDescriptor Result;
+		Result.DescriptorPath = DescriptorPath;
+		Result.Timestamp = IFileManager::Get().GetTimeStamp(*DescriptorPath);
+		const FString SourceDirectory = FPaths::Combine(FPaths::GetPath(DescriptorPath), TEXT("Source"));
+		for (const FModuleDescriptor& ModuleDescriptor : ModuleDescriptors)
+		{
+			FModuleContextInfo& Module = Result.Modules.AddDefaulted_GetRef();
+			Module.ModuleName = ModuleDescriptor.Name.ToString();
+			Module.ModuleType = ModuleDescriptor.Type;
+			Module.ModuleSourcePath = FPaths::Combine(SourceDirectory, Module.ModuleName) + TEXT("/");
+		}
+		return Result;
+	}
+
+	FString FModuleIndex::GetCacheFilePath()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("ModuleIndex.json"));
+	}
+
+	TSharedRef<FModuleIndex::FSnapshot> FModuleIndex::LoadFromDisk()
+	{
+		const TSharedRef<FSnapshot> Result = MakeShared<FSnapshot>();
+		
+		FString FileContents;
+		if (!FFileHelper::LoadFileToString(FileContents, *GetCacheFilePath()))
+		{
+			return Result;
+		}
+
+		TSharedPtr<FJsonObject> CacheAsJson;
+		const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		int32 Version = 0;
+		const TArray<TSharedPtr<FJsonValue>>* DescriptorsAsJson;
+		if (!FJsonSerializer::Deserialize(JsonReader, CacheAsJson)
+			|| !CacheAsJson.IsValid()
+			|| !CacheAsJson->TryGetNumberField(TEXT("Version"), Version)
+			|| Version != ModuleIndexCacheVersion
+			|| !CacheAsJson->TryGetArrayField(TEXT("Descriptors"), DescriptorsAsJson))
+		{
+			return Result;
+		}
+
+		for (const TSharedPtr<FJsonValue>& DescriptorValue : *DescriptorsAsJson)
+		{
+			const TSharedPtr<FJsonObject>* DescriptorAsJson;
+			FString TimestampString;
+			const TArray<TSharedPtr<FJsonValue>>* ModulesAsJson;
+			FIndexedDescriptor Descriptor;
+			if (!DescriptorValue->TryGetObject(DescriptorAsJson)
+				|| !(*DescriptorAsJson)->TryGetStringField(TEXT("Path"), Descriptor.DescriptorPath)
+				|| !(*DescriptorAsJson)->TryGetStringField(TEXT("Timestamp"), TimestampString)
+				|| !(*DescriptorAsJson)->TryGetArrayField(TEXT("Modules"), ModulesAsJson))
+			{
+				continue;
+			}
+			Descriptor.Timestamp = FDateTime(FCString::Atoi64(*TimestampString));
+
+			for (const TSharedPtr<FJsonValue>& ModuleValue : *ModulesAsJson)
+			{
+				const TSharedPtr<FJsonObject>* ModuleAsJson;
+				FString TypeString;
+				FModuleContextInfo Module;
+				if (ModuleValue->TryGetObject(ModuleAsJson)
+					&& (*ModuleAsJson)->TryGetStringField(TEXT("Name"), Module.ModuleName)
+					&& (*ModuleAsJson)->TryGetStringField(TEXT("SourcePath"), Module.ModuleSourcePath)
+					&& (*ModuleAsJson)->TryGetStringField(TEXT("Type"), TypeString))
+				{
+					Module.ModuleType = EHostType::FromString(*TypeString);
+					Descriptor.Modules.Add(MoveTemp(Module));
+				}
+			}
+			Result->Descriptors.Add(MoveTemp(Descriptor));
+		}
+		return Result;
+	}
+
+	void FModuleIndex::SaveToDisk(const FSnapshot& ToSave)
+	{
+		const TSharedRef<FJsonObject> CacheAsJson = MakeShared<FJsonObject>();
+		CacheAsJson->SetNumberField(TEXT("Version"), ModuleIndexCacheVersion);
+
+		TArray<TSharedPtr<FJsonValue>> DescriptorsAsJson;
+		DescriptorsAsJson.Reserve(ToSave.Descriptors.Num());
+		for (const FIndexedDescriptor& Descriptor : ToSave.Descriptors)
+		{
+			const TSharedRef<FJsonObject> DescriptorAsJson = MakeShared<FJsonObject>();
+			DescriptorAsJson->SetStringField(TEXT("Path"), Descriptor.DescriptorPath);
+			// Ticks do not fit into a double without losing precision
+			DescriptorAsJson->SetStringField(TEXT("Timestamp"), LexToString(Descriptor.Timestamp.GetTicks()));
+
+			TArray<TSharedPtr<FJsonValue>> ModulesAsJson;
+			for (const FModuleContextInfo& Module : Descriptor.Modules)
+			{
+				const TSharedRef<FJsonObject> ModuleAsJson = MakeShared<FJsonObject>();
+				ModuleAsJson->SetStringField(TEXT("Name"), Module.ModuleName);
+				ModuleAsJson->SetStringField(TEXT("SourcePath"), Module.ModuleSourcePath);
+				ModuleAsJson->SetStringField(TEXT("Type"), EHostType::ToString(Module.ModuleType));
+				ModulesAsJson.Add(MakeShared<FJsonValueObject>(ModuleAsJson));
+			}
+			DescriptorAsJson->SetArrayField(TEXT("Modules"), ModulesAsJson);
+			DescriptorsAsJson.Add(MakeShared<FJsonValueObject>(DescriptorAsJson));
+		}
+		CacheAsJson->SetArrayField(TEXT("Descriptors"), DescriptorsAsJson);
+
+		FString OutputString;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
+		FJsonSerializer::Serialize(CacheAsJson, Writer);
+		if (!FFileHelper::SaveStringToFile(OutputString, *GetCacheFilePath()))
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("Failed to save module index to '%s'"), *GetCacheFilePath());
+		}
+	}
+
+	TSharedRef<const FModuleNameTable> FModuleIndex::LoadOrScanEngineModuleNames()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const FString CacheFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("EngineModuleNames.bin"));
+		const FString EngineSourceDirectory = FPaths::ConvertRelativePathToFull(FPaths::EngineSourceDir());
+		const FString EnginePluginsDirectory = FPaths::ConvertRelativePathToFull(FPaths::EnginePluginsDir());
+		const FString CacheKey = MakeEngineSourceCacheKey(FPaths::EngineDir());
+
+		const TOperationResult<TSharedRef<const FModuleNameTable>> LoadOp = FModuleNameTable::Load(CacheFilePath, CacheKey);
+		if (LoadOp.IsSuccess())
+		{
+			UE_LOG(LogModuleGeneration, Verbose, TEXT("Loaded %d engine module names in %.2f ms"), LoadOp.OperationResult.GetValue()->Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			return LoadOp.OperationResult.GetValue();
+		}
+		UE_LOG(LogModuleGeneration, Verbose, TEXT("Scanning engine modules: %s"), *LoadOp.ErrorMessage.GetValue());
+
+		TArray<FIndexedSourceModule> SourceModules;
+		FindSourceModules(EngineSourceDirectory, SourceModules);
+		const int32 NumSourceModules = SourceModules.Num();
+		FindSourceModules(EnginePluginsDirectory, SourceModules);
+
+		TArray<FModuleNameEntry> Entries;
+		Entries.Reserve(SourceModules.Num());
+		for (int32 Index = 0; Index < SourceModules.Num(); ++Index)
+		{
+			Entries.Add({ MoveTemp(SourceModules[Index].Name), Index < NumSourceModules ? EModuleLocation::Engine : EModuleLocation::EnginePlugin });
+		}
+		const TSharedRef<const FModuleNameTable> Result = FModuleNameTable::Build(Entries);
+
+		const FOperationResult SaveOp = Result->Save(CacheFilePath, CacheKey);
+		if (SaveOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("%s"), *SaveOp.ErrorMessage.GetValue());
+		}
+		UE_LOG(LogModuleGeneration, Log, TEXT("Indexed %d engine module names in %.2f ms"), Result->Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		return Result;
+	}
+}
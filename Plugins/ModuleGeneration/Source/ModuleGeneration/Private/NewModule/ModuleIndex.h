@@ -0,0 +1,97 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameProjectUtils.h"
+#include "NewModule/ModuleNameTable.h"
+#include "Tasks/Pipe.h"
+#include "Tasks/Task.h"
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Index of all modules declared in the project's .uproject and the .uplugin files of project plugins.
+	 *
+	 * The index is built in the background when the plugin starts up and persisted to Saved/ModuleGeneration so later
+	 * editor sessions only re-parse descriptors whose timestamp changed. A directory watcher keeps it up to date when
+	 * descriptors are added, changed or removed.
+	 *
+	 * After that, the names of all engine and engine plugin modules are indexed too so new modules cannot shadow them and
+	 * dependencies can be searched. Engine modules are found by their .Build.cs files, which takes a few seconds, so their names
+	 * are saved to Saved/ModuleGeneration once per engine version. Name lookups and searches go through an FModuleNameTable of all
+	 * modules. Thread-safe.
+	 */
+	class FModuleIndex : public FNoncopyable
+	{
+	public:
+
+		static FModuleIndex& Get();
+
+		/** Starts building the index and watching for descriptor changes. Must be called on the game thread. */
+		void Initialize();
+		/** Stops watching and waits for pending updates. Must be called on the game thread. */
+		void Shutdown();
+
+		/** Blocks until the index has been built at least once. */
+		void WaitUntilBuilt() const;
+		bool IsBuilt() const;
+		/** @return Whether the engine's modules have been indexed yet, which completes after IsBuilt */
+		bool IsEngineIndexed() const;
+
+		/** @return Whether a module of this name exists in the project or, once indexed, the engine. Case-insensitive. */
+		bool ContainsModule(const FString& ModuleName) const;
+		/** @return All modules declared in the project */
+		TArray<FModuleContextInfo> GetModules() const;
+		/** @return The names of all project modules and, once indexed, engine modules, e.g. to search for dependencies */
+		TSharedRef<const FModuleNameTable> GetModuleNames() const;
+
+		/** Broadcast on the game thread whenever the index changes. */
+		FSimpleMulticastDelegate& OnIndexChanged() { return IndexChangedDelegate; }
+
+	private:
+
+		struct FIndexedDescriptor
+		{
+			FString DescriptorPath;
+			FDateTime Timestamp;
+			TArray<FModuleContextInfo> Modules;
+		};
+
+		/** Immutable state of the index. Replaced as a whole on every update so readers never block writers for long. */
+		struct FSnapshot
+		{
+			TArray<FIndexedDescriptor> Descriptors;
+			TArray<FModuleContextInfo> Modules;
+			/** Names of Modules and of the engine's modules */
+			TSharedRef<const FModuleNameTable> ModuleNames = FModuleNameTable::Build({});
+		};
+
+		mutable FRWLock SnapshotLock;
+		TSharedRef<const FSnapshot> Snapshot = MakeShared<FSnapshot>();
+
+		/** Serializes the initial build and incremental updates */
+		UE::Tasks::FPipe UpdatePipe{ UE_SOURCE_LOCATION };
+		UE::Tasks::FTask InitialBuildTask;
+		UE::Tasks::FTask EngineIndexTask;
+		/** Only accessed from tasks of UpdatePipe */
+		TSharedPtr<const FModuleNameTable> EngineModuleNames;
+
+		FString WatchedDirectory;
+		FDelegateHandle DirectoryWatcherHandle;
+		FSimpleMulticastDelegate IndexChangedDelegate;
+
+		TSharedRef<const FSnapshot> GetSnapshot() const;
+		void SetSnapshot(TSharedRef<const FSnapshot> NewSnapshot);
+
+		void OnDirectoryChanged(const TArray<struct FFileChangeData>& FileChanges);
+		TSharedRef<const FModuleNameTable> BuildModuleNames(const FSnapshot& ForSnapshot) const;
+		
+		static TSharedRef<FSnapshot> BuildSnapshot(const TArray<FString>& DescriptorPaths, const FSnapshot& Previous, const TSet<FString>& ForceReindex);
+		static TOptional<FIndexedDescriptor> IndexDescriptor(const FString& DescriptorPath);
+		static FString GetCacheFilePath();
+		static TSharedRef<FSnapshot> LoadFromDisk();
+		static void SaveToDisk(const FSnapshot& ToSave);
+		static TSharedRef<const FModuleNameTable> LoadOrScanEngineModuleNames();
+	};
+}
@@ -2,20 +2,27 @@
 
 #include "NewModule/NewModuleUtils.h"
 #include "NewModule/SNewModuleDialog.h"
-#include "Logging.h"
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
 
 #include "ModuleDescriptor.h"
 
-#include "Dom/JsonValue.h"
+#include "Async/Async.h"
+#include "GeneralProjectSettings.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
 #include "Kismet/KismetSystemLibrary.h"
-#include "Misc/FileHelper.h"
-#include "Misc/ScopedSlowTask.h"
-#include "Serialization/JsonReader.h"
-#include "Serialization/JsonSerializer.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Widgets/SWindow.h"
 #include "GameProjectGenerationModule.h"
-#include "ModuleTemplateFileUtils.h"
+#include "NewModule/ModuleCreationTransaction.h"
+#include "NewModule/ModuleDescriptorFileUtils.h"
+#include "NewModule/ModuleExtraction.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+#include "NewModule/ModuleTemplateRegistry.h"
+#include "NewModule/ProjectFileRegenerator.h"
 #include "Interfaces/IMainFrameModule.h"
 
 #define LOCTEXT_NAMESPACE "FModuleGenerationModule"
@@ -24,7 +31,7 @@ namespace UE::ModuleGeneration
 {
 	TSharedRef<SWindow> CreateAndShowNewModuleWindow()
 	{
-		const FVector2D WindowSize(940, 380); // 480
+		const FVector2D WindowSize(940, 610); // 480
 		const FText WindowTitle = LOCTEXT("NewModule_Title", "New C++ Module");
 
 		const TSharedRef<SWindow> AddCodeWindow =
@@ -38,9 +45,17 @@ namespace UE::ModuleGeneration
 		const TSharedRef<SNewModuleDialog> NewModuleDialog =
 			SNew(SNewModuleDialog)
 			.ParentWindow(AddCodeWindow)
-			.OnClickFinished(SNewModuleDialog::FOnRequestNewModule::CreateLambda([](const FString& Directory, const FModuleDescriptor& ModuleDescriptor)
+			.OnClickFinished(SNewModuleDialog::FOnRequestNewModule::CreateLambda([](const FString& Directory, const FModuleDescriptor& ModuleDescriptor, const FNewModuleOptions& Options, FOnModuleCreationStageChanged OnStageChanged)
 			{
-				return CreateNewModule(Directory, ModuleDescriptor);
+				return CreateNewModule(Directory, ModuleDescriptor, Options, MoveTemp(OnStageChanged));
+			}))
+			.OnRequestPlan(SNewModuleDialog::FOnRequestModulePlan::CreateLambda([](const FString& Directory, const FModuleDescriptor& ModuleDescriptor, const FNewModuleOptions& Options)
+			{
+				return PlanNewModuleAsync(Directory, ModuleDescriptor, Options);
+			}))
+			.OnCommitPlan(SNewModuleDialog::FOnCommitModulePlan::CreateLambda([](TSharedRef<const FModuleCreationPlan> Plan, FOnModuleCreationStageChanged OnStageChanged)
+			{
+				return CreateNewModule(MoveTemp(Plan), MoveTemp(OnStageChanged));
 			}));
 		AddCodeWindow->SetContent(NewModuleDialog);
 
@@ -57,35 +72,55 @@ namespace UE::ModuleGeneration
 		return AddCodeWindow;
 	}
 
-	// Declare helper functions for NewModuleModel::CreateNewModule 
-	namespace
+	namespace EModuleCreationStage
 	{
-		namespace EModuleCreationLocation
+		FText ToText(Type Stage)
 		{
-			enum Type
+			switch (Stage)
 			{
-				/**
-				 * Module was created nowhere; an error occured.
-				 */
-				Nowhere,
-				/**
-				 * In .uproject
-				 */
-				Project,
-				/**
-				 * In .uplugin
-				 */
-				Plugin
-			};
+			case Planning: return LOCTEXT("NewModule_Stage_Planning", "Computing module files and descriptor changes...");
+			case Staging: return LOCTEXT("NewModule_Stage_Staging", "Writing module and descriptor files...");
+			case Committing: return LOCTEXT("NewModule_Stage_Committing", "Moving files into place...");
+			case Finished: return LOCTEXT("NewModule_Stage_Finished", "Done. Regenerating project files in the background...");
+			default:
+				checkNoEntry();
+				return FText::GetEmpty();
+			}
 		}
 	}
 
-	static TOperationResult<EModuleCreationLocation::Type> CreateNewModuleInternal(const FString& OutputDirectory, const FModuleDescriptor& NewModule);
+	static TFuture<FOperationResult> InformUserWhenCreated(TFuture<TOperationResult<EModuleCreationLocation::Type>> CreationFuture, FName ModuleName);
+	static FOperationResult InformUserAboutCreatedModule(const TOperationResult<EModuleCreationLocation::Type>& CreationLocation, FName ModuleName);
+	static void ReportStageOnGameThread(const FOnModuleCreationStageChanged& OnStageChanged, EModuleCreationStage::Type Stage);
+	static void InvalidateIncludeModuleMap();
 	
-	FOperationResult CreateNewModule(const FString& OutputDirectory, const FModuleDescriptor& NewModule)
+	TFuture<FOperationResult> CreateNewModule(const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FNewModuleOptions& Options, FOnModuleCreationStageChanged OnStageChanged)
+	{
+		return InformUserWhenCreated(CreateNewModuleAsync(OutputDirectory, NewModule, Options, MoveTemp(OnStageChanged)), NewModule.Name);
+	}
+
+	TFuture<FOperationResult> CreateNewModule(TSharedRef<const FModuleCreationPlan> Plan, FOnModuleCreationStageChanged OnStageChanged)
+	{
+		check(Plan->Modules.Num() == 1);
+		const FName ModuleName = Plan->Modules[0].ModuleName;
+		return InformUserWhenCreated(CommitNewModulePlanAsync(MoveTemp(Plan), MoveTemp(OnStageChanged)), ModuleName);
+	}
+
+	static TFuture<FOperationResult> InformUserWhenCreated(TFuture<TOperationResult<EModuleCreationLocation::Type>> CreationFuture, FName ModuleName)
+	{
+		const TSharedRef<TPromise<FOperationResult>> Promise = MakeShared<TPromise<FOperationResult>>();
+		CreationFuture.Next([Promise, ModuleName](const TOperationResult<EModuleCreationLocation::Type>& CreationLocation)
+		{
+			AsyncTask(ENamedThreads::GameThread, [Promise, ModuleName, CreationLocation]()
+			{
+				Promise->SetValue(InformUserAboutCreatedModule(CreationLocation, ModuleName));
+			});
+		});
+		return Promise->GetFuture();
+	}
+
+	static FOperationResult InformUserAboutCreatedModule(const TOperationResult<EModuleCreationLocation::Type>& CreationLocation, FName ModuleName)
 	{
-		const TOperationResult<EModuleCreationLocation::Type> CreationLocation =
-			CreateNewModuleInternal(OutputDirectory, NewModule);
 		if (CreationLocation.IsFailure())
 		{
 			return FOperationResult::MakeFailure(CreationLocation);
@@ -94,7 +129,7 @@ namespace UE::ModuleGeneration
 		if (CreationLocation.OperationResult.GetValue() == EModuleCreationLocation::Project)
 		{
 			const FText DoneMessageUnformatted = LOCTEXT("NewModule_Done_ModuleMessage", "Sucessfully created new module.\n\nYou need to update your project's .Target.cs files by adding:\nExtraModuleNames.Add(\"{0}\")");
-			const FText DoneMessage = FText::Format(FTextFormat(DoneMessageUnformatted), FText::FromString(NewModule.Name.ToString()));
+			const FText DoneMessage = FText::Format(FTextFormat(DoneMessageUnformatted), FText::FromString(ModuleName.ToString()));
 			const FText DoneTitle = LOCTEXT("NewModule_Done_Title", "New C++ Module");
 			FMessageDialog::Open(EAppMsgType::Ok, DoneMessage, DoneTitle);
 			return FOperationResult::MakeSuccess();
@@ -102,7 +137,7 @@ namespace UE::ModuleGeneration
 		if (CreationLocation.OperationResult.GetValue() == EModuleCreationLocation::Plugin)
 		{
 			const FText DoneMessageUnformatted = LOCTEXT("NewModule_Done_PluginMessage", "Sucessfully created new module.");
-			const FText DoneMessage = FText::Format(FTextFormat(DoneMessageUnformatted), FText::FromString(NewModule.Name.ToString()));
+			const FText DoneMessage = FText::Format(FTextFormat(DoneMessageUnformatted), FText::FromString(ModuleName.ToString()));
 			const FText DoneTitle = LOCTEXT("NewModule_Done_Title", "New C++ Module");
 			FMessageDialog::Open(EAppMsgType::Ok, DoneMessage, DoneTitle);
 			return FOperationResult::MakeSuccess();
@@ -112,166 +147,298 @@ namespace UE::ModuleGeneration
 		return FOperationResult::MakeFailure(TEXT("Enum entry missing"));
 	}
 
-	TOperationResult<EModuleCreationLocation::Type> CreateNewModuleInternal(const FString& OutputDirectory, const FModuleDescriptor& NewModule)
+	TFuture<TOperationResult<EModuleCreationLocation::Type>> CreateNewModuleAsync(const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FNewModuleOptions& Options, FOnModuleCreationStageChanged OnStageChanged)
 	{
-		FScopedSlowTask ProgressBar(3, LOCTEXT("NewModule_ProgressBar_DefaultTitle", "Creating new module files..."));
-		ProgressBar.MakeDialog();
+		using FCreationResult = TOperationResult<EModuleCreationLocation::Type>;
+		check(IsInGameThread());
 		UE_LOG(LogModuleGeneration, Log, TEXT("Creating new module '%s'..."), *NewModule.Name.ToString());
+		OnStageChanged.ExecuteIfBound(EModuleCreationStage::Planning);
 
-		ProgressBar.EnterProgressFrame(1, LOCTEXT("NewModule_ProgressBar_CopyingFiles", "Copying files..."));
-		const FOperationResult CopyModuleTemplateOp = InstantiateModuleTemplate(OutputDirectory, NewModule);
-		if (!CopyModuleTemplateOp)
-		{
-			return TOperationResult<EModuleCreationLocation::Type>::MakeFailure(CopyModuleTemplateOp);
-		}
+		// The plan is committed right away, so this writes exactly what a preview of the same input would have shown
+		const TSharedRef<TPromise<FCreationResult>> Promise = MakeShared<TPromise<FCreationResult>>();
+		PlanNewModuleAsync(OutputDirectory, NewModule, Options)
+			.Next([Promise, OnStageChanged](const TOperationResult<TSharedRef<const FModuleCreationPlan>>& PlanOp)
+			{
+				if (PlanOp.IsFailure())
+				{
+					Promise->SetValue(FCreationResult::MakeFailure(PlanOp));
+					return;
+				}
+				// Runs on the worker thread which finished the plan; committing only needs the game thread to report stages
+				CommitNewModulePlanAsync(PlanOp.OperationResult.GetValue(), OnStageChanged)
+					.Next([Promise](const FCreationResult& CreationResult)
+					{
+						Promise->SetValue(CreationResult);
+					});
+			});
+		return Promise->GetFuture();
+	}
 
-		EModuleCreationLocation::Type AddedLocation;
-		if (OutputDirectory.Contains("/Plugins/"))
-		{
-			AddedLocation = EModuleCreationLocation::Plugin;
-			ProgressBar.EnterProgressFrame(1, LOCTEXT("NewModule_ProgressBar_WrittingPluginFiles", "Writting plugin files..."));
-			const FOperationResult OperationResult = AddNewModuleToUPluginJsonFile(OutputDirectory, NewModule);
-			if (!OperationResult)
+	TFuture<TOperationResult<TSharedRef<const FModuleCreationPlan>>> PlanNewModuleAsync(const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FNewModuleOptions& Options)
+	{
+		using FPlanResult = TOperationResult<TSharedRef<const FModuleCreationPlan>>;
+		check(IsInGameThread());
+
+		// Resolve editor state here; the tasks below only read from the file system
+		FModuleTemplateOptions TemplateOptions;
+		TemplateOptions.CopyrightNotice = GetDefault<UGeneralProjectSettings>()->CopyrightNotice;
+		TemplateOptions.BuildSettings = Options.BuildSettings;
+		TemplateOptions.AdditionalPrivateDependencies = Options.AdditionalDependencies;
+		const FString ModuleTemplatePath = Options.ModuleTemplatePath;
+		const bool bRequiresIncludeMap = RequiresIncludeMap(Options.BuildSettings, Options.bMinimizeDependencies);
+		const FString ProjectDirectory = UKismetSystemLibrary::GetProjectDirectory();
+		const TSharedRef<const FPluginDirectoryIndex> PluginIndex = GetPluginDirectoryIndex();
+		FModuleExtractionSettings ExtractionSettings;
+		ExtractionSettings.Source = Options.FilesToMove;
+		ExtractionSettings.NewModuleName = NewModule.Name.ToString();
+		ExtractionSettings.OutputDirectory = OutputDirectory;
+		ExtractionSettings.SourceRoots = { FPaths::Combine(ProjectDirectory, TEXT("Source")), FPaths::Combine(ProjectDirectory, TEXT("Plugins")) };
+		const FString RedirectsConfigPath = FPaths::Combine(ProjectDirectory, TEXT("Config"), TEXT("DefaultEngine.ini"));
+		ExtractionSettings.RedirectsConfigPath = IFileManager::Get().FileExists(*RedirectsConfigPath) ? RedirectsConfigPath : FString();
+
+		// Moving files scans the whole project, so it runs next to the descriptor change and the template waits for the moved files
+		UE::Tasks::TTask<TOperationResult<FModuleExtraction>> ExtractionTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[ExtractionSettings]() mutable
 			{
-				return TOperationResult<EModuleCreationLocation::Type>::MakeFailure(OperationResult);
-			}
-		}
-		else
-		{
-			AddedLocation = EModuleCreationLocation::Project;
-			ProgressBar.EnterProgressFrame(1, LOCTEXT("NewModule_ProgressBar_WrittingProjectFiles", "Writting project files..."));
-			const FOperationResult OperationResult = AddNewModuleToUProjectJsonFile(NewModule);
-			if (!OperationResult)
+				if (ExtractionSettings.Source.Files.Num() == 0)
+				{
+					return TOperationResult<FModuleExtraction>::MakeSuccess(FModuleExtraction());
+				}
+				ExtractionSettings.IncludeGraph = GetIncludeGraph();
+				return PlanModuleExtraction(ExtractionSettings);
+			});
+		UE::Tasks::TTask<TOperationResult<FPlannedModule>> ModuleTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[ModuleTemplatePath, TemplateOptions, bRequiresIncludeMap, OutputDirectory, NewModule, ExtractionTask]() mutable
 			{
-				return TOperationResult<EModuleCreationLocation::Type>::MakeFailure(OperationResult);
-			}
-		}
+				const TOperationResult<FModuleExtraction>& ExtractionOp = ExtractionTask.GetResult();
+				if (ExtractionOp.IsFailure())
+				{
+					return TOperationResult<FPlannedModule>::MakeFailure(ExtractionOp);
+				}
+				TemplateOptions.AdditionalFiles = ExtractionOp.OperationResult->NewModuleFiles;
+				// The template's default dependencies are meaningless for moved files
+				if (bRequiresIncludeMap || TemplateOptions.AdditionalFiles.Num() > 0)
+				{
+					TemplateOptions.IncludeMap = GetIncludeModuleMap();
+				}
+				return PlanModuleTemplate(ModuleTemplatePath, OutputDirectory, NewModule, TemplateOptions);
+			},
+			UE::Tasks::Prerequisites(ExtractionTask));
+		UE::Tasks::TTask<TOperationResult<FPlannedDescriptorUpdate>> DescriptorTask = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[ProjectDirectory, PluginIndex, OutputDirectory, NewModule]()
+			{
+				const TOperationResult<FString> DescriptorPath = FindModuleDescriptorFile(ProjectDirectory, *PluginIndex, OutputDirectory);
+				if (DescriptorPath.IsFailure())
+				{
+					return TOperationResult<FPlannedDescriptorUpdate>::MakeFailure(DescriptorPath);
+				}
+				return PlanDescriptorUpdate(DescriptorPath.OperationResult.GetValue(), MakeArrayView(&NewModule, 1));
+			});
 
-		ProgressBar.EnterProgressFrame(1, LOCTEXT("NewModule_ProgressBar_GeneratingVisualStudioSolutionFiles", "Generating visual studio solution..."));
-		GenerateVisualStudioSolution();
+		const TSharedRef<TPromise<FPlanResult>> Promise = MakeShared<TPromise<FPlanResult>>();
+		UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Promise, ExtractionTask, ModuleTask, DescriptorTask]() mutable
+			{
+				TOperationResult<FPlannedModule>& ModuleOp = ModuleTask.GetResult();
+				TOperationResult<FPlannedDescriptorUpdate>& DescriptorOp = DescriptorTask.GetResult();
+				if (ModuleOp.IsFailure())
+				{
+					Promise->SetValue(FPlanResult::MakeFailure(ModuleOp));
+					return;
+				}
+				if (DescriptorOp.IsFailure())
+				{
+					Promise->SetValue(FPlanResult::MakeFailure(DescriptorOp));
+					return;
+				}
+
+				const TSharedRef<FModuleCreationPlan> Plan = MakeShared<FModuleCreationPlan>();
+				Plan->Modules.Add(MoveTemp(ModuleOp.OperationResult.GetValue()));
+				Plan->DescriptorUpdates.Add(MoveTemp(DescriptorOp.OperationResult.GetValue()));
+				// The module task already failed if the extraction did
+				FModuleExtraction& Extraction = ExtractionTask.GetResult().OperationResult.GetValue();
+				if (Extraction.NewModuleFiles.Num() > 0)
+				{
+					Plan->SourceUpdates = MoveTemp(Extraction.SourceUpdates);
+					Plan->Extraction = MoveTemp(Extraction.Report);
+				}
+				Promise->SetValue(FPlanResult::MakeSuccess(Plan));
+			},
+			UE::Tasks::Prerequisites(ExtractionTask, ModuleTask, DescriptorTask));
 
-		return TOperationResult<EModuleCreationLocation::Type>::MakeSuccess(AddedLocation);
+		return Promise->GetFuture();
 	}
 
-	FOperationResult AddNewModuleToUProjectJsonFile(const FModuleDescriptor& NewModule)
+	TFuture<TOperationResult<EModuleCreationLocation::Type>> CommitNewModulePlanAsync(TSharedRef<const FModuleCreationPlan> Plan, FOnModuleCreationStageChanged OnStageChanged)
 	{
-		IFileManager& FileManager = IFileManager::Get();
-		
-		const FString ProjectDirectory = UKismetSystemLibrary::GetProjectDirectory();
-		const FString ProjectSearchRegex = FPaths::Combine(ProjectDirectory, FString("*.uproject"));
-		TArray<FString> UProjectFileNames;
-		FileManager.FindFiles(UProjectFileNames, *ProjectSearchRegex, true, false);
+		using FCreationResult = TOperationResult<EModuleCreationLocation::Type>;
+		check(Plan->Modules.Num() == 1 && Plan->DescriptorUpdates.Num() == 1);
+		const bool bIsPluginModule = FPaths::GetExtension(Plan->DescriptorUpdates[0].DescriptorPath) == TEXT("uplugin");
+		const FString RunName = FString::Printf(TEXT("module '%s'"), *Plan->Modules[0].ModuleName.ToString());
+
+		const TSharedRef<TPromise<FCreationResult>> Promise = MakeShared<TPromise<FCreationResult>>();
+		UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Promise, Plan, OnStageChanged, bIsPluginModule, RunName]()
+			{
+				// Only writing the plan is timed: planning happens for every preview, concurrently with other previews.
+				// Project files are regenerated in the background afterwards; FProjectFileRegenerator logs how long that takes
+				const double StartTime = FPlatformTime::Seconds();
+				const bool bIsTimed = FModuleCreationTimings::Get().BeginRun();
+				const auto LogTimings = [bIsTimed, &RunName, StartTime](bool bSucceeded)
+				{
+					if (bIsTimed)
+					{
+						FModuleCreationTimings::Get().LogSummary(RunName, FPlatformTime::Seconds() - StartTime, bSucceeded);
+						FModuleCreationTimings::Get().EndRun();
+					}
+				};
+
+				// All files are written to a staging area first and moved into place at the end; anything else is rolled back
+				FModuleCreationTransaction Transaction;
+				ReportStageOnGameThread(OnStageChanged, EModuleCreationStage::Staging);
+				const FOperationResult StageOp = Transaction.StagePlan(*Plan);
+				if (!StageOp)
+				{
+					Transaction.Rollback();
+					LogTimings(false);
+					Promise->SetValue(FCreationResult::MakeFailure(StageOp));
+					return;
+				}
 
-		if(UProjectFileNames.Num() == 0)
-		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to locate .uproject file for current project. Searched path: '%s'"), *ProjectSearchRegex));
-		}
-		if(UProjectFileNames.Num() > 1)
-		{
-			UE_LOG(LogModuleGeneration, Warning, TEXT("Found multiple .uproject files. Picking '%s'..."), *UProjectFileNames[0]);
-		}
+				ReportStageOnGameThread(OnStageChanged, EModuleCreationStage::Committing);
+				const FOperationResult CommitOp = Transaction.Commit();
+				LogTimings(CommitOp.IsSuccess());
+				if (!CommitOp)
+				{
+					Promise->SetValue(FCreationResult::MakeFailure(CommitOp));
+					return;
+				}
 
-		const FString PathToProjectFile = FPaths::Combine(ProjectDirectory, UProjectFileNames[0]);
-		return AddNewModuleToFile(PathToProjectFile, NewModule);
-	}
-	
-	FOperationResult AddNewModuleToUPluginJsonFile(const FString& OutputDirectory, const FModuleDescriptor& NewModule)
-	{
-		IFileManager& FileManager = IFileManager::Get();
+				// The project's modules changed, so the next analysis has to see the new one
+				InvalidateIncludeModuleMap();
 
-		FString Separator = "/Plugins/";
-		FString LeftString, RightString = "";
-		OutputDirectory.Split(Separator, &LeftString, &RightString, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
-		FString PluginName, RightPluginName = "";
-		const FString NewSeparator = "/";
-		RightString.Split(NewSeparator, &PluginName, &RightPluginName);
+				// Start UnrealBuildTool right away; it runs while the UI reports the result
+				AsyncTask(ENamedThreads::GameThread, []()
+				{
+					FProjectFileRegenerator::Get().RequestRegeneration();
+				});
+				ReportStageOnGameThread(OnStageChanged, EModuleCreationStage::Finished);
+				Promise->SetValue(FCreationResult::MakeSuccess(bIsPluginModule ? EModuleCreationLocation::Plugin : EModuleCreationLocation::Project));
+			});
 
-		const FString ProjectDirectory = UKismetSystemLibrary::GetProjectDirectory();
-		const FString PluginFolderDirectory = FPaths::Combine(ProjectDirectory, FString("Plugins"), PluginName);
-		const FString ProjectSearchRegex = FPaths::Combine(PluginFolderDirectory, FString("*.uplugin"));
-		TArray<FString> UPluginFileNames;
-		FileManager.FindFiles(UPluginFileNames, *ProjectSearchRegex, true, false);
+		return Promise->GetFuture();
+	}
 
-		if (UPluginFileNames.Num() == 0)
+	static void ReportStageOnGameThread(const FOnModuleCreationStageChanged& OnStageChanged, EModuleCreationStage::Type Stage)
+	{
+		AsyncTask(ENamedThreads::GameThread, [OnStageChanged, Stage]()
 		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to locate .uplugin file for current project. Searched path: '%s'"), *ProjectSearchRegex));
-		}
-		if (UPluginFileNames.Num() > 1)
+			OnStageChanged.ExecuteIfBound(Stage);
+		});
+	}
+
+	FOperationResult AddNewModuleToUProjectJsonFile(const FModuleDescriptor& NewModule)
+	{
+		const TOperationResult<FString> PathToProjectFile = FindUProjectFile();
+		if (PathToProjectFile.IsFailure())
 		{
-			UE_LOG(LogModuleGeneration, Warning, TEXT("Found multiple .uplugin files. Picking '%s'..."), *UPluginFileNames[0]);
+			return FOperationResult::MakeFailure(PathToProjectFile);
 		}
-
-		const FString PathToProjectFile = FPaths::Combine(PluginFolderDirectory, UPluginFileNames[0]);
-		return AddNewModuleToFile(PathToProjectFile, NewModule);
+		return AddNewModuleToFile(PathToProjectFile.OperationResult.GetValue(), NewModule);
 	}
 	
-	FOperationResult AddNewModuleToFile(const FString& FullFilePath, const FModuleDescriptor& NewModule)
+	FOperationResult AddNewModuleToUPluginJsonFile(const FString& OutputDirectory, const FModuleDescriptor& NewModule)
 	{
-		IFileManager& FileManager = IFileManager::Get();
-		
-		FString FileContents;
-		TSharedPtr<FArchive> FileReadStream(FileManager.CreateFileReader(*FullFilePath));
-		if (FileReadStream == nullptr)
-		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to create file stream to config file '%s'"), *FullFilePath));
-		}
-		const bool bCouldReadFile = FFileHelper::LoadFileToString(FileContents, *FileReadStream.Get());
-		if (!bCouldReadFile)
+		const TOperationResult<FString> PathToPluginFile = FindUPluginFile(OutputDirectory);
+		if (PathToPluginFile.IsFailure())
 		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to read config file '%s'"), *FullFilePath));
+			return FOperationResult::MakeFailure(PathToPluginFile);
 		}
+		return AddNewModuleToFile(PathToPluginFile.OperationResult.GetValue(), NewModule);
+	}
 
-		TSharedPtr<FJsonObject> ProjectFileAsJson;
-		TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(*FileContents);
-		if (!FJsonSerializer::Deserialize(JsonReader, ProjectFileAsJson))
-		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to parse JSON from config file '%s'"), *FullFilePath));
-		}
+	TOperationResult<FString> FindUProjectFile()
+	{
+		return FindUProjectFile(UKismetSystemLibrary::GetProjectDirectory());
+	}
 
-		TArray<TSharedPtr<FJsonValue>> Modules = ProjectFileAsJson->GetArrayField(TEXT("Modules"));
-		const bool bModuleAlreadyInList = [&Modules, &NewModule]()
+	TOperationResult<FString> FindUPluginFile(const FString& OutputDirectory)
+	{
+		return FindUPluginFile(*GetPluginDirectoryIndex(), OutputDirectory);
+	}
+
+	TSharedRef<const FPluginDirectoryIndex> GetPluginDirectoryIndex()
+	{
+		check(IsInGameThread());
+		static TSharedPtr<const FPluginDirectoryIndex> CachedIndex;
+		if (!CachedIndex.IsValid())
 		{
-			for (auto e : Modules)
+			static bool bIsSubscribed = false;
+			if (!bIsSubscribed)
 			{
-				const TSharedPtr<FJsonObject>* PtrToJsonObject;
-				e->TryGetObject(PtrToJsonObject);
-				if (PtrToJsonObject == nullptr)
-				{
-					continue;
-				}
-
-				TSharedPtr<FJsonObject> AsJsonObject = *PtrToJsonObject;
-				FString ModuleName;
-				if (AsJsonObject->TryGetStringField(TEXT("Name"), ModuleName)
-					&& ModuleName.Equals(NewModule.Name.ToString()))
-				{
-					return true;
-				}
+				// E.g. the New Plugin wizard creates and mounts plugins while the editor is running
+				IPluginManager::Get().OnNewPluginCreated().AddLambda([](IPlugin&) { CachedIndex.Reset(); });
+				IPluginManager::Get().OnNewPluginMounted().AddLambda([](IPlugin&) { CachedIndex.Reset(); });
+				bIsSubscribed = true;
 			}
-			return false;
-		}();
-		if (bModuleAlreadyInList)
+			CachedIndex = MakeShared<const FPluginDirectoryIndex>(FPluginDirectoryIndex::MakeFromPluginManager());
+		}
+		return CachedIndex.ToSharedRef();
+	}
+
+	static FCriticalSection IncludeModuleMapCriticalSection;
+	static TSharedPtr<const FIncludeModuleMap> CachedIncludeModuleMap;
+
+	TSharedRef<const FIncludeModuleMap> GetIncludeModuleMap()
+	{
+		FScopeLock Lock(&IncludeModuleMapCriticalSection);
+		if (!CachedIncludeModuleMap.IsValid())
 		{
-			return FOperationResult::MakeFailure(FString::Printf(TEXT("The config file at '%s' already contained an entry '%s'"), *FullFilePath, *NewModule.Name.ToString()));
+			const FString CacheFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("IncludeModuleMap.json"));
+			CachedIncludeModuleMap = FIncludeModuleMap::LoadOrBuild(FIncludeModuleMap::MakeDefaultSettings(FPaths::EngineDir(), FPaths::ProjectDir(), CacheFilePath));
 		}
+		return CachedIncludeModuleMap.ToSharedRef();
+	}
 
-		TSharedPtr<FJsonObject> ModuleAsJson(new FJsonObject);
-		ModuleAsJson->SetStringField("Name", NewModule.Name.ToString());
-		ModuleAsJson->SetStringField("Type", EHostType::ToString(NewModule.Type));
-		ModuleAsJson->SetStringField("LoadingPhase", ELoadingPhase::ToString(NewModule.LoadingPhase));
-		Modules.Add(TSharedPtr<FJsonValueObject>(new FJsonValueObject(ModuleAsJson)));
-		ProjectFileAsJson->SetArrayField("Modules", Modules);
+	static FCriticalSection IncludeGraphCriticalSection;
+	static TSharedPtr<const FIncludeGraph> CachedIncludeGraph;
 
-		FString OutputString;
-		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
-		FJsonSerializer::Serialize(ProjectFileAsJson.ToSharedRef(), Writer);
-		FFileHelper::SaveStringToFile(OutputString, *FullFilePath);
+	TSharedRef<const FIncludeGraph> GetIncludeGraph()
+	{
+		// Held while building so concurrent callers wait for one scan instead of each reading the changed files
+		FScopeLock Lock(&IncludeGraphCriticalSection);
+		const FString CacheFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ModuleGeneration"), TEXT("IncludeGraph.json"));
+		CachedIncludeGraph = FIncludeGraph::Build(FIncludeGraph::MakeDefaultSettings(FPaths::ProjectDir(), CacheFilePath), CachedIncludeGraph.Get());
+		return CachedIncludeGraph.ToSharedRef();
+	}
 
-		return FOperationResult::MakeSuccess();
+	static void InvalidateIncludeModuleMap()
+	{
+		FScopeLock Lock(&IncludeModuleMapCriticalSection);
+		CachedIncludeModuleMap.Reset();
+	}
+
+	FOperationResult InstantiateModuleTemplate(const FString& OutputDirectory, const FModuleDescriptor& NewModule)
+	{
+		return InstantiateModuleTemplate(GetDefaultModuleTemplatePath(), OutputDirectory, NewModule, GetDefault<UGeneralProjectSettings>()->CopyrightNotice);
+	}
+
+	FString GetModuleTemplatesDirectory()
+	{
+		const FString& BasePluginDirectory = IPluginManager::Get().FindPlugin("ModuleGeneration")->GetBaseDir();
+		return FPaths::Combine(BasePluginDirectory, FString("Resources"), FString("Templates"));
+	}
+
+	FString GetDefaultModuleTemplatePath()
+	{
+		const TOperationResult<FModuleTemplateInfo> FindOp = FindModuleTemplate(GetModuleTemplatesDirectory(), DefaultModuleTemplateName);
+		// If the default template is missing, instantiating reports the directory that was expected
+		return FindOp.IsSuccess() ? FindOp.OperationResult->Path : FPaths::Combine(GetModuleTemplatesDirectory(), DefaultModuleTemplateName);
 	}
 
 	FOperationResult GenerateVisualStudioSolution()
 	{
+		MODULEGENERATION_TIMED_SCOPE(ProjectFiles);
 		FText FailReason, FailLog;
 		if (!FGameProjectGenerationModule::Get().UpdateCodeProject(FailReason, FailLog))
 		{
@@ -0,0 +1,334 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ProjectFileRegenerator.h"
+
+#include "ModuleGenerationLog.h"
+
+#include "DesktopPlatformModule.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "HAL/PlatformProcess.h"
+#include "IDesktopPlatform.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/OutputDeviceNull.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "FModuleGenerationModule"
+
+namespace UE::ModuleGeneration
+{
+	FProjectFileRegenerator& FProjectFileRegenerator::Get()
+	{
+		static FProjectFileRegenerator Instance;
+		return Instance;
+	}
+
+	void FProjectFileRegenerator::RequestRegeneration()
+	{
+		check(IsInGameThread());
+
+		if (ProcessHandle.IsValid())
+		{
+			// The running generator may already have scanned the directories; run once more afterwards
+			bIsRerunRequested = true;
+			return;
+		}
+
+		// Restart the delay so a burst of requests results in a single run
+		bIsPending = true;
+		PendingStartTime = FPlatformTime::Seconds();
+		ShowProgressNotification();
+		EnsureTicking();
+	}
+
+	void FProjectFileRegenerator::Cancel()
+	{
+		check(IsInGameThread());
+		
+		bIsPending = false;
+		bIsRerunRequested = false;
+		if (ProcessHandle.IsValid())
+		{
+			FPlatformProcess::TerminateProc(ProcessHandle, true);
+			ReadProcessOutput();
+			ClosePipesAndHandle();
+			OnProcessFinished(true, INDEX_NONE);
+		}
+		else
+		{
+			CompleteProgressNotification(false, LOCTEXT("RegenerateProjectFiles_Cancelled", "Project file generation cancelled"));
+		}
+	}
+
+	void FProjectFileRegenerator::Shutdown()
+	{
+		if (TickerHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+			TickerHandle.Reset();
+		}
+		ClosePipesAndHandle();
+		bIsPending = false;
+		bIsRerunRequested = false;
+	}
+
+	bool FProjectFileRegenerator::Tick(float DeltaTime)
+	{
+		if (ProcessHandle.IsValid())
+		{
+			ReadProcessOutput();
+			if (FPlatformProcess::IsProcRunning(ProcessHandle))
+			{
+				return true;
+			}
+
+			// Drain whatever was written between the last read and the process exiting
+			ReadProcessOutput();
+			int32 ReturnCode = INDEX_NONE;
+			FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
+			ClosePipesAndHandle();
+			OnProcessFinished(false, ReturnCode);
+		}
+
+		if (bIsPending && FPlatformTime::Seconds() - PendingStartTime >= CoalesceDelaySeconds)
+		{
+			StartProcess();
+		}
+
+		const bool bKeepTicking = IsBusy();
+		if (!bKeepTicking)
+		{
+			TickerHandle.Reset();
+		}
+		return bKeepTicking;
+	}
+
+	void FProjectFileRegenerator::StartProcess()
+	{
+		bIsPending = false;
+		bIsRerunRequested = false;
+		ProcessOutput.Reset();
+		PartialLine.Reset();
+
+		IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+		if (DesktopPlatform == nullptr)
+		{
+			CompleteProgressNotification(false, LOCTEXT("RegenerateProjectFiles_NoDesktopPlatform", "Failed to regenerate project files"));
+			ShowFailureNotification(LOCTEXT("RegenerateProjectFiles_NoDesktopPlatformReason", "The desktop platform module is not available."), FString());
+			return;
+		}
+
+		// Same arguments the editor uses for File > Refresh Visual Studio Project
+		FString Arguments = TEXT("-projectfiles");
+		Arguments += FString::Printf(TEXT(" -project=\"%s\""), *IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*FPaths::GetProjectFilePath()));
+		Arguments += TEXT(" -game");
+		Arguments += FApp::IsEngineInstalled() ? TEXT(" -rocket") : TEXT(" -engine");
+		Arguments += TEXT(" -progress");
+
+		UE_LOG(LogModuleGeneration, Log, TEXT("Regenerating project files: UnrealBuildTool %s"), *Arguments);
+		FOutputDeviceNull NullOutput;
+		ProcessHandle = DesktopPlatform->InvokeUnrealBuildToolAsync(Arguments, NullOutput, ReadPipe, WritePipe, true);
+		ProcessStartTime = FPlatformTime::Seconds();
+		// UnrealBuildTool runs in its own process, so its duration is marked in Insights with bookmarks instead of a CPU scope
+		TRACE_BOOKMARK(TEXT("ModuleGeneration: UnrealBuildTool started"));
+		if (!ProcessHandle.IsValid())
+		{
+			ClosePipesAndHandle();
+			CompleteProgressNotification(false, LOCTEXT("RegenerateProjectFiles_LaunchFailed", "Failed to regenerate project files"));
+			ShowFailureNotification(LOCTEXT("RegenerateProjectFiles_LaunchFailedReason", "UnrealBuildTool could not be started."), FString());
+			return;
+		}
+
+		ShowProgressNotification();
+	}
+
+	void FProjectFileRegenerator::ReadProcessOutput()
+	{
+		if (ReadPipe == nullptr)
+		{
+			return;
+		}
+		
+		FString NewOutput = FPlatformProcess::ReadPipe(ReadPipe);
+		if (NewOutput.IsEmpty())
+		{
+			return;
+		}
+		ProcessOutput += NewOutput;
+
+		// UnrealBuildTool reports progress with lines like "@progress 'Writing project files...' 42%"
+		PartialLine += NewOutput;
+		TArray<FString> Lines;
+		PartialLine.ParseIntoArrayLines(Lines, false);
+		const bool bEndsWithNewLine = PartialLine.EndsWith(TEXT("\n"));
+		PartialLine = bEndsWithNewLine || Lines.Num() == 0 ? FString() : Lines.Pop();
+		for (const FString& Line : Lines)
+		{
+			UE_LOG(LogModuleGeneration, Verbose, TEXT("UnrealBuildTool: %s"), *Line);
+			
+			int32 PercentIndex = INDEX_NONE;
+			if (Line.StartsWith(TEXT("@progress")) && Line.FindLastChar(TEXT('%'), PercentIndex))
+			{
+				int32 NumberStart = PercentIndex;
+				while (NumberStart > 0 && FChar::IsDigit(Line[NumberStart - 1]))
+				{
+					--NumberStart;
+				}
+				if (NumberStart < PercentIndex)
+				{
+					const int32 Percent = FCString::Atoi(*Line.Mid(NumberStart, PercentIndex - NumberStart));
+					UpdateProgressNotification(FText::Format(LOCTEXT("RegenerateProjectFiles_Progress", "Regenerating project files... {0}%"), FText::AsNumber(Percent)));
+				}
+			}
+		}
+	}
+
+	void FProjectFileRegenerator::OnProcessFinished(bool bWasCancelled, int32 ReturnCode)
+	{
+		const double Duration = FPlatformTime::Seconds() - ProcessStartTime;
+		TRACE_BOOKMARK(TEXT("ModuleGeneration: UnrealBuildTool finished"));
+		if (bWasCancelled)
+		{
+			UE_LOG(LogModuleGeneration, Log, TEXT("Project file generation was cancelled after %.1f s"), Duration);
+			CompleteProgressNotification(false, LOCTEXT("RegenerateProjectFiles_Cancelled", "Project file generation cancelled"));
+			return;
+		}
+		
+		if (ReturnCode == 0)
+		{
+			UE_LOG(LogModuleGeneration, Log, TEXT("Regenerated project files in %.1f s"), Duration);
+			if (bIsRerunRequested)
+			{
+				// Keep the notification; the follow-up run reuses it
+				ScheduleRerun();
+				return;
+			}
+			
+			CompleteProgressNotification(true, LOCTEXT("RegenerateProjectFiles_Succeeded", "Project files regenerated"));
+			return;
+		}
+
+		const FString LogFilePath = FPaths::Combine(FPaths::ProjectLogDir(), TEXT("ModuleGeneration-ProjectFiles.log"));
+		FFileHelper::SaveStringToFile(ProcessOutput, *LogFilePath);
+		UE_LOG(LogModuleGeneration, Error, TEXT("Failed to regenerate project files (UnrealBuildTool exited with code %d). Log: %s\n%s"), ReturnCode, *LogFilePath, *ProcessOutput);
+
+		// Show the last few lines since they usually contain the actual error
+		TArray<FString> Lines;
+		ProcessOutput.ParseIntoArrayLines(Lines);
+		constexpr int32 MaxReasonLines = 5;
+		const int32 FirstLine = FMath::Max(0, Lines.Num() - MaxReasonLines);
+		const FString LastLines = FString::Join(TArrayView<FString>(Lines).Slice(FirstLine, Lines.Num() - FirstLine), TEXT("\n"));
+		
+		CompleteProgressNotification(false, LOCTEXT("RegenerateProjectFiles_Failed", "Failed to regenerate project files"));
+		ShowFailureNotification(
+			FText::Format(LOCTEXT("RegenerateProjectFiles_FailedReason", "UnrealBuildTool exited with code {0}. You need to regenerate the solution manually.\n\n{1}"), FText::AsNumber(ReturnCode), FText::FromString(LastLines)),
+			LogFilePath);
+
+		// The files changed since the failed run started, e.g. by fixing the .Build.cs that broke it, so the queued run may succeed.
+		// It shows its own progress notification because the failed run's one is completed.
+		if (bIsRerunRequested)
+		{
+			UE_LOG(LogModuleGeneration, Log, TEXT("Regenerating project files again because more modules were created while UnrealBuildTool was running"));
+			ScheduleRerun();
+		}
+	}
+
+	void FProjectFileRegenerator::ScheduleRerun()
+	{
+		// The requests were made long enough ago, so the coalescing delay is skipped
+		bIsRerunRequested = false;
+		bIsPending = true;
+		PendingStartTime = FPlatformTime::Seconds() - CoalesceDelaySeconds;
+	}
+
+	void FProjectFileRegenerator::ClosePipesAndHandle()
+	{
+		if (ReadPipe != nullptr || WritePipe != nullptr)
+		{
+			FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
+			ReadPipe = nullptr;
+			WritePipe = nullptr;
+		}
+		if (ProcessHandle.IsValid())
+		{
+			FPlatformProcess::CloseProc(ProcessHandle);
+			ProcessHandle.Reset();
+		}
+	}
+
+	void FProjectFileRegenerator::EnsureTicking()
+	{
+		if (!TickerHandle.IsValid())
+		{
+			TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FProjectFileRegenerator::Tick));
+		}
+	}
+
+	void FProjectFileRegenerator::ShowProgressNotification()
+	{
+		if (ProgressNotification.IsValid())
+		{
+			return;
+		}
+		
+		FNotificationInfo Info(LOCTEXT("RegenerateProjectFiles_InProgress", "Regenerating project files..."));
+		Info.bFireAndForget = false;
+		Info.ExpireDuration = 3.f;
+		Info.ButtonDetails.Add(FNotificationButtonInfo(
+			LOCTEXT("RegenerateProjectFiles_CancelButton", "Cancel"),
+			LOCTEXT("RegenerateProjectFiles_CancelButtonTooltip", "Stops regenerating the project files. You need to regenerate them manually afterwards."),
+			FSimpleDelegate::CreateRaw(this, &FProjectFileRegenerator::Cancel),
+			SNotificationItem::CS_Pending));
+		
+		ProgressNotification = FSlateNotificationManager::Get().AddNotification(Info);
+		if (const TSharedPtr<SNotificationItem> Notification = ProgressNotification.Pin())
+		{
+			Notification->SetCompletionState(SNotificationItem::CS_Pending);
+		}
+	}
+
+	void FProjectFileRegenerator::UpdateProgressNotification(const FText& Text)
+	{
+		if (const TSharedPtr<SNotificationItem> Notification = ProgressNotification.Pin())
+		{
+			Notification->SetText(Text);
+		}
+	}
+
+	void FProjectFileRegenerator::CompleteProgressNotification(bool bSucceeded, const FText& Text)
+	{
+		if (const TSharedPtr<SNotificationItem> Notification = ProgressNotification.Pin())
+		{
+			Notification->SetText(Text);
+			Notification->SetCompletionState(bSucceeded ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+			Notification->ExpireAndFadeout();
+		}
+		ProgressNotification.Reset();
+	}
+
+	void FProjectFileRegenerator::ShowFailureNotification(const FText& FailReason, const FString& LogFilePath)
+	{
+		FNotificationInfo Info(LOCTEXT("RegenerateProjectFiles_FailedTitle", "Failed to regenerate project files"));
+		Info.SubText = FailReason;
+		Info.bFireAndForget = true;
+		Info.ExpireDuration = 15.f;
+		Info.bUseSuccessFailIcons = true;
+		if (!LogFilePath.IsEmpty())
+		{
+			Info.Hyperlink = FSimpleDelegate::CreateLambda([LogFilePath]()
+			{
+				FPlatformProcess::LaunchFileInDefaultExternalApplication(*LogFilePath);
+			});
+			Info.HyperlinkText = LOCTEXT("RegenerateProjectFiles_ShowLog", "Show log");
+		}
+		
+		if (const TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info))
+		{
+			Notification->SetCompletionState(SNotificationItem::CS_Fail);
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,69 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class SNotificationItem;
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Regenerates the project files by running UnrealBuildTool in the background.
+	 *
+	 * Progress is shown in a non-modal notification which can cancel the run. Requests are coalesced: requests made shortly
+	 * after each other start a single run and any requests made while a run is in progress trigger exactly one more run, even if
+	 * the run in progress fails.
+	 * Failures are reported in a notification linking to the full UnrealBuildTool log.
+	 */
+	class FProjectFileRegenerator : public FNoncopyable
+	{
+	public:
+
+		static FProjectFileRegenerator& Get();
+
+		/** Schedules regenerating the project files. Must be called on the game thread. */
+		void RequestRegeneration();
+		/** Terminates the current run and drops any pending requests. */
+		void Cancel();
+		/** Stops tracking the current run without terminating it. Called on module shutdown. */
+		void Shutdown();
+
+		bool IsBusy() const { return bIsPending || ProcessHandle.IsValid(); }
+
+	private:
+
+		/** Requests are delayed by this much so several modules created in quick succession only cause one run */
+		static constexpr double CoalesceDelaySeconds = 0.5;
+		
+		bool bIsPending = false;
+		bool bIsRerunRequested = false;
+		double PendingStartTime = 0.0;
+		
+		FProcHandle ProcessHandle;
+		void* ReadPipe = nullptr;
+		void* WritePipe = nullptr;
+		FString ProcessOutput;
+		/** Unprocessed remainder of the last line read from the pipe */
+		FString PartialLine;
+		double ProcessStartTime = 0.0;
+		
+		FTSTicker::FDelegateHandle TickerHandle;
+		TWeakPtr<SNotificationItem> ProgressNotification;
+
+		bool Tick(float DeltaTime);
+		void StartProcess();
+		void ReadProcessOutput();
+		void OnProcessFinished(bool bWasCancelled, int32 ReturnCode);
+		/** Starts the run requested while the last one was in progress on the next tick, whether the last one succeeded or not */
+		void ScheduleRerun();
+		void ClosePipesAndHandle();
+		void EnsureTicking();
+
+		void ShowProgressNotification();
+		void UpdateProgressNotification(const FText& Text);
+		void CompleteProgressNotification(bool bSucceeded, const FText& Text);
+		void ShowFailureNotification(const FText& FailReason, const FString& LogFilePath);
+	};
+}
@@ -2,25 +2,65 @@
 
 #include "NewModule/SNewModuleDialog.h"
 
+#include "ModuleGenerationStats.h"
+#include "NewModule/ModuleIndex.h"
+#include "NewModule/NewModuleUtils.h"
+
+#include "Async/Async.h"
+
 #include "DesktopPlatformModule.h"
 #include "GameProjectUtils.h"
 #include "IDesktopPlatform.h"
+#include "Styling/CoreStyle.h"
+#include "Widgets/Images/SThrobber.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SMultiLineEditableTextBox.h"
+#include "Widgets/Input/SSearchBox.h"
 #include "Widgets/Layout/SGridPanel.h"
+#include "Widgets/Views/SListView.h"
+#include "Widgets/Views/STableRow.h"
 #include "Widgets/Workflow/SWizard.h"
 #include "Styling/AppStyle.h"
 
 #define LOCTEXT_NAMESPACE "FModuleGenerationModule"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dialog Input Validations"), STAT_ModuleGeneration_DialogValidations, STATGROUP_ModuleGeneration);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dialog Directory Checks"), STAT_ModuleGeneration_DialogDirectoryChecks, STATGROUP_ModuleGeneration);
+
+/** How long the input must stay unchanged before the output directory is checked on disk */
+static constexpr float DirectoryCheckDebounceSeconds = 0.2f;
+/** How many modules the dependency picker lists for a search */
+static constexpr int32 MaxDependencySearchResults = 50;
+
+static FText GetModuleLocationText(UE::ModuleGeneration::EModuleLocation::Type Location)
+{
+	switch (Location)
+	{
+	case UE::ModuleGeneration::EModuleLocation::Engine: return LOCTEXT("ModuleLocation_Engine", "Engine");
+	case UE::ModuleGeneration::EModuleLocation::EnginePlugin: return LOCTEXT("ModuleLocation_EnginePlugin", "Engine plugin");
+	case UE::ModuleGeneration::EModuleLocation::Project: return LOCTEXT("ModuleLocation_Project", "Project");
+	case UE::ModuleGeneration::EModuleLocation::ProjectPlugin: return LOCTEXT("ModuleLocation_ProjectPlugin", "Project plugin");
+	default: return FText::GetEmpty();
+	}
+}
+
 void SNewModuleDialog::Construct(const FArguments& InArgs)
 {
-	check(InArgs._OnClickFinished.IsBound());
+	check(InArgs._OnClickFinished.IsBound() && InArgs._OnRequestPlan.IsBound() && InArgs._OnCommitPlan.IsBound());
 	
 	PopulateAvailableModules();
 	PopulateModuleTypes();
 	PopulateLoadingPhases();
+	PopulateTemplates();
+	PopulateBuildVariants();
 	
 	OnClickFinished = InArgs._OnClickFinished;
+	OnRequestPlan = InArgs._OnRequestPlan;
+	OnCommitPlan = InArgs._OnCommitPlan;
 	OutputDirectory = FindSuitableModulePath();
+	UE::ModuleGeneration::FModuleIndex::Get().OnIndexChanged().AddSP(this, &SNewModuleDialog::OnModuleIndexChanged);
+	UpdateInput();
+	StartBuildImpactEstimate();
 	
 	ChildSlot
 	[
@@ -33,6 +73,7 @@ void SNewModuleDialog::Construct(const FArguments& InArgs)
 			+SVerticalBox::Slot()
 			[
 				SAssignNew(MainWizard, SWizard)
+				.IsEnabled(this, &SNewModuleDialog::IsInputEnabled)
 				.ShowPageList(false)
 
 				.CanFinish(this, &SNewModuleDialog::CanFinishButtonBeClicked)
@@ -54,6 +95,40 @@ void SNewModuleDialog::Construct(const FArguments& InArgs)
 				[
 					CreateMainPage()
 				]
+
+				// Shows everything that will be written before anything is
+				+SWizard::Page()
+				.CanShow(this, &SNewModuleDialog::IsInputValid)
+				.OnEnter(this, &SNewModuleDialog::OnEnterPreviewPage)
+				[
+					CreatePreviewPage()
+				]
+			]
+
+			// Progress while the module is created in the background
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0, 6, 0, 0)
+			[
+				SNew(SHorizontalBox)
+				.Visibility(this, &SNewModuleDialog::GetCreationProgressVisibility)
+
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(0, 0, 6, 0)
+				[
+					SNew(SCircularThrobber)
+					.Radius(8.f)
+				]
+
+				+SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(this, &SNewModuleDialog::GetCreationProgressText)
+				]
 			]
 		]
 	];
@@ -61,20 +136,18 @@ void SNewModuleDialog::Construct(const FArguments& InArgs)
 
 void SNewModuleDialog::PopulateAvailableModules()
 {
-	TArray<FModuleContextInfo> CurrentModules = GameProjectUtils::GetCurrentProjectModules();
+	// The index is built in the background on startup and is normally finished long before the dialog is opened
+	UE::ModuleGeneration::FModuleIndex& ModuleIndex = UE::ModuleGeneration::FModuleIndex::Get();
+	ModuleIndex.WaitUntilBuilt();
+	
+	const TArray<FModuleContextInfo> CurrentModules = ModuleIndex.GetModules();
 	check(CurrentModules.Num()); 
 
-	TArray<FModuleContextInfo> CurrentPluginModules = GameProjectUtils::GetCurrentProjectPluginModules();
-
-	CurrentModules.Append(CurrentPluginModules);
-
 	AvailableModules.Reserve(CurrentModules.Num());
 	for (const FModuleContextInfo& ModuleInfo : CurrentModules)
 	{
 		AvailableModules.Emplace(MakeShareable(new FModuleContextInfo(ModuleInfo)));
 	}
-
-	// TODO: discover engine module
 }
 
 void SNewModuleDialog::PopulateModuleTypes()
@@ -93,6 +166,37 @@ void SNewModuleDialog::PopulateLoadingPhases()
 	}
 }
 
+void SNewModuleDialog::PopulateTemplates()
+{
+	// Only lists Resources/Templates; the templates themselves are not read until a module is created
+	for (UE::ModuleGeneration::FModuleTemplateInfo& Template : UE::ModuleGeneration::FindModuleTemplates(UE::ModuleGeneration::GetModuleTemplatesDirectory()))
+	{
+		TemplateOptions.Add(MakeShared<UE::ModuleGeneration::FModuleTemplateInfo>(MoveTemp(Template)));
+	}
+
+	const TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo>* DefaultTemplate = TemplateOptions.FindByPredicate([](const TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo>& Item)
+	{
+		return Item->Name == UE::ModuleGeneration::DefaultModuleTemplateName;
+	});
+	if (DefaultTemplate)
+	{
+		SelectedTemplate = *DefaultTemplate;
+	}
+	else if (TemplateOptions.Num() > 0)
+	{
+		SelectedTemplate = TemplateOptions[0];
+	}
+}
+
+void SNewModuleDialog::PopulateBuildVariants()
+{
+	for (const UE::ModuleGeneration::FModuleBuildVariant& Variant : UE::ModuleGeneration::GetModuleBuildVariants())
+	{
+		BuildVariantOptions.Add(MakeShared<UE::ModuleGeneration::FModuleBuildVariant>(Variant));
+	}
+	SelectedBuildVariant = BuildVariantOptions[0];
+}
+
 TSharedRef<SWidget> SNewModuleDialog::CreateMainPage()
 {
 	return SNew(SVerticalBox)
@@ -239,6 +343,17 @@ TSharedRef<SWidget> SNewModuleDialog::CreateModuleDetailsPanel()
 						.Text(this, &SNewModuleDialog::GetSelectedLoadingPhaseText)
 					]
 				]
+
+				// Build impact
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(12.0f, 0.0f, 0.0f, 0.0f)
+				[
+					SNew(STextBlock)
+					.Text(this, &SNewModuleDialog::GetBuildImpactText)
+					.ToolTipText(this, &SNewModuleDialog::GetBuildImpactToolTipText)
+				]
 			]
 		]
 
@@ -296,6 +411,240 @@ TSharedRef<SWidget> SNewModuleDialog::CreateModuleDetailsPanel()
 					.Text(LOCTEXT("BrowseButtonText", "Choose folder"))
 				]
 			]
+		]
+
+		// Template label
+		+SGridPanel::Slot(0, 2)
+		.VAlign(VAlign_Center)
+		.Padding(0, 0, 12, 0)
+		[
+			SNew(STextBlock)
+			.Text(LOCTEXT("CreateModule_TemplateLabel", "Template"))
+		]
+		// Template combo box
+		+SGridPanel::Slot(1, 2)
+		.Padding(0.0f, 3.0f)
+		.VAlign(VAlign_Center)
+		.HAlign(HAlign_Left)
+		[
+			SNew(SBox)
+			.HeightOverride(EditableTextHeight)
+			[
+				SAssignNew(SelectableTemplatesComboBox, SComboBox<TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo>>)
+				.ToolTipText(LOCTEXT("CreateModule_TemplateTip", "Choose the template for your module's files. Templates are the folders and .mgtemplate archives in the plugin's Resources/Templates folder."))
+				.OptionsSource(&TemplateOptions)
+				.InitiallySelectedItem(SelectedTemplate)
+				.OnSelectionChanged(this, &SNewModuleDialog::OnSelectedTemplateChanged)
+				.OnGenerateWidget(this, &SNewModuleDialog::MakeWidgetForTemplate)
+				[
+					SNew(STextBlock)
+					.Text(this, &SNewModuleDialog::GetSelectedTemplateText)
+				]
+			]
+		]
+
+		// Dependencies label
+		+SGridPanel::Slot(0, 3)
+		.VAlign(VAlign_Center)
+		.Padding(0, 0, 12, 0)
+		[
+			SNew(STextBlock)
+			.Text(LOCTEXT("CreateModule_DependenciesLabel", "Dependencies"))
+		]
+		// Minimize dependencies check box
+		+SGridPanel::Slot(1, 3)
+		.Padding(0.0f, 3.0f)
+		.VAlign(VAlign_Center)
+		.HAlign(HAlign_Left)
+		[
+			SNew(SCheckBox)
+			.ToolTipText(LOCTEXT("CreateModule_MinimizeDependenciesTip", "Lists only the modules the new module's sources include in its .Build.cs file. Modules included by public headers become public dependencies and all others private ones. Indexing the engine's modules takes a while the first time; the index is cached in the project's Saved/ModuleGeneration folder."))
+			.IsChecked(this, &SNewModuleDialog::GetMinimizeDependenciesState)
+			.OnCheckStateChanged(this, &SNewModuleDialog::OnMinimizeDependenciesChanged)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("CreateModule_MinimizeDependencies", "Minimize dependencies"))
+			]
+		]
+
+		// Build variant label
+		+SGridPanel::Slot(0, 4)
+		.VAlign(VAlign_Center)
+		.Padding(0, 0, 12, 0)
+		[
+			SNew(STextBlock)
+			.Text(LOCTEXT("CreateModule_BuildVariantLabel", "Build settings"))
+		]
+		// Build variant combo box
+		+SGridPanel::Slot(1, 4)
+		.Padding(0.0f, 3.0f)
+		.VAlign(VAlign_Center)
+		.HAlign(HAlign_Left)
+		[
+			SNew(SBox)
+			.HeightOverride(EditableTextHeight)
+			[
+				SAssignNew(SelectableBuildVariantsComboBox, SComboBox<TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant>>)
+				.ToolTipText(LOCTEXT("CreateModule_BuildVariantTip", "Choose the PCH and unity build settings of the module's .Build.cs file. The BenchmarkModuleGeneration commandlet with -CompileVariants measures how long each variant takes to compile in your project."))
+				.OptionsSource(&BuildVariantOptions)
+				.InitiallySelectedItem(SelectedBuildVariant)
+				.OnSelectionChanged(this, &SNewModuleDialog::OnSelectedBuildVariantChanged)
+				.OnGenerateWidget(this, &SNewModuleDialog::MakeWidgetForBuildVariant)
+				[
+					SNew(STextBlock)
+					.Text(this, &SNewModuleDialog::GetSelectedBuildVariantText)
+				]
+			]
+		]
+
+		// Files to move label
+		+SGridPanel::Slot(0, 5)
+		.VAlign(VAlign_Center)
+		.Padding(0, 0, 12, 0)
+		[
+			SNew(STextBlock)
+			.Text(LOCTEXT("CreateModule_FilesToMoveLabel", "Move files"))
+		]
+		// Chosen files
+		+SGridPanel::Slot(1, 5)
+		.Padding(0.0f, 3.0f)
+		.VAlign(VAlign_Center)
+		[
+			SNew(SBox)
+			.HeightOverride(EditableTextHeight)
+			[
+				SNew(SHorizontalBox)
+
+				+SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(this, &SNewModuleDialog::GetFilesToMoveText)
+				]
+
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(6.0f, 0.0f, 0.0f, 0.0f)
+				[
+					SNew(SButton)
+					.VAlign(VAlign_Center)
+					.Visibility(this, &SNewModuleDialog::GetClearFilesToMoveVisibility)
+					.OnClicked(this, &SNewModuleDialog::HandleClearFilesToMoveButtonClicked)
+					.Text(LOCTEXT("CreateModule_ClearFilesToMove", "Clear"))
+				]
+			]
+		]
+		// Choose files button
+		+SGridPanel::Slot(2, 5)
+		.Padding(0.0f, 3.0f)
+		.VAlign(VAlign_Center)
+		[
+			SNew(SBox)
+			.HeightOverride(EditableTextHeight)
+			[
+				SNew(SHorizontalBox)
+				+SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.HAlign(HAlign_Fill)
+				.Padding(6.0f, 0.0f, 0.0f, 0.0f)
+				[
+					SNew(SButton)
+					.VAlign(VAlign_Center)
+					.OnClicked(this, &SNewModuleDialog::HandleChooseFilesToMoveButtonClicked)
+					.ToolTipText(LOCTEXT("CreateModule_ChooseFilesToMoveTooltip", "Moves source files of an existing module into the new one. Includes, export macros and .Build.cs dependencies are updated across the whole project and the dependencies of the new module are minimized. Check the preview page before creating the module."))
+					.Text(LOCTEXT("CreateModule_ChooseFilesToMove", "Choose files"))
+				]
+			]
+		]
+
+		// Dependency picker label
+		+SGridPanel::Slot(0, 6)
+		.VAlign(VAlign_Top)
+		.Padding(0, 7, 12, 0)
+		[
+			SNew(STextBlock)
+			.Text(LOCTEXT("CreateModule_AddDependenciesLabel", "Add dependencies"))
+		]
+		// Search box and results
+		+SGridPanel::Slot(1, 6)
+		.Padding(0.0f, 3.0f)
+		[
+			SNew(SVerticalBox)
+
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SBox)
+				.HeightOverride(EditableTextHeight)
+				[
+					SNew(SSearchBox)
+					.ToolTipText(LOCTEXT("CreateModule_DependencySearchTip", "Search the modules of the engine, its plugins, the project and its plugins by name. Checked modules are added to the private dependencies of the module's .Build.cs file. Clear the search to see the checked modules."))
+					.HintText(this, &SNewModuleDialog::GetDependencySearchHintText)
+					.OnTextChanged(this, &SNewModuleDialog::OnDependencySearchTextChanged)
+				]
+			]
+
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0.0f, 3.0f, 0.0f, 0.0f)
+			[
+				SNew(SBox)
+				.HeightOverride(110.f)
+				[
+					SAssignNew(DependencyListView, SListView<TSharedPtr<FDependencyPickerItem>>)
+					.ListItemsSource(&DependencyPickerItems)
+					.OnGenerateRow(this, &SNewModuleDialog::MakeDependencyPickerRow)
+					.SelectionMode(ESelectionMode::None)
+				]
+			]
+		]
+		// Chosen dependencies
+		+SGridPanel::Slot(2, 6)
+		.Padding(6.0f, 7.0f, 0.0f, 0.0f)
+		.VAlign(VAlign_Top)
+		[
+			SNew(STextBlock)
+			.Text(this, &SNewModuleDialog::GetAdditionalDependenciesText)
+		];
+}
+
+TSharedRef<SWidget> SNewModuleDialog::CreatePreviewPage()
+{
+	return SNew(SVerticalBox)
+
+		+SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0, 0, 0, 6)
+		[
+			SNew(SHorizontalBox)
+
+			+SHorizontalBox::Slot()
+			.FillWidth(1.f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("NewModule_PreviewHeader", "These files will be created. Nothing has been written yet; Create Module writes exactly what is shown."))
+			]
+
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SCircularThrobber)
+				.Radius(8.f)
+				.Visibility(this, &SNewModuleDialog::GetPlanningProgressVisibility)
+			]
+		]
+
+		+SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			SNew(SMultiLineEditableTextBox)
+			.IsReadOnly(true)
+			.AlwaysShowScrollbars(true)
+			.Font(FCoreStyle::GetDefaultFontStyle("Mono", 9))
+			.Text(this, &SNewModuleDialog::GetPreviewText)
 		];
 }
 
@@ -372,61 +721,309 @@ FString SNewModuleDialog::FindSuitableModulePath() const
 	return "";
 }
 
+UE::ModuleGeneration::FNewModuleOptions SNewModuleDialog::MakeNewModuleOptions() const
+{
+	UE::ModuleGeneration::FNewModuleOptions Result;
+	Result.ModuleTemplatePath = SelectedTemplate->Path;
+	Result.bMinimizeDependencies = bMinimizeDependencies;
+	Result.BuildSettings = SelectedBuildVariant->Settings;
+	Result.FilesToMove = FilesToMove;
+	Result.AdditionalDependencies = AdditionalDependencies;
+	return Result;
+}
+
+bool SNewModuleDialog::IsInputValid() const
+{
+	return !bIsDirectoryCheckPending && SelectedTemplate.IsValid() && IsModuleNameAvailable() && !DoesModuleDirectoryAlreadyExist() && !bAreFilesToMoveInvalid;
+}
+
 bool SNewModuleDialog::CanFinishButtonBeClicked() const
 {
-	return IsModuleNameAvailable() && !DoesModuleDirectoryAlreadyExist();
+	return !bIsCreatingModule && IsInputValid() && (!IsPreviewPageShown() || PreviewedPlan.IsValid());
+}
+
+bool SNewModuleDialog::IsPreviewPageShown() const
+{
+	return MainWizard.IsValid() && MainWizard->GetCurrentPageIndex() == 1;
+}
+
+void SNewModuleDialog::OnEnterPreviewPage()
+{
+	// The input may have changed since the page was last shown
+	const uint32 RequestId = ++PlanRequestId;
+	PreviewedPlan.Reset();
+	PreviewText = FText::GetEmpty();
+	bIsPlanning = true;
+
+	const TWeakPtr<SNewModuleDialog> WeakThis = StaticCastSharedRef<SNewModuleDialog>(AsShared());
+	OnRequestPlan.Execute(
+		OutputDirectory,
+		FModuleDescriptor(FName(*NewModuleName), SelectedHostType, SelectedLoadingPhase),
+		MakeNewModuleOptions()
+	).Next([WeakThis, RequestId](const FModulePlanResult& PlanResult)
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, PlanResult]()
+		{
+			if (const TSharedPtr<SNewModuleDialog> This = WeakThis.Pin())
+			{
+				This->OnPlanFinished(RequestId, PlanResult);
+			}
+		});
+	});
+}
+
+void SNewModuleDialog::OnPlanFinished(uint32 RequestId, const FModulePlanResult& PlanResult)
+{
+	if (RequestId != PlanRequestId)
+	{
+		return;
+	}
+	
+	bIsPlanning = false;
+	if (PlanResult.IsFailure())
+	{
+		PreviewText = FText::Format(LOCTEXT("NewModule_PlanFailed", "The module cannot be created: {0}"), FText::FromString(PlanResult.ErrorMessage.GetValue()));
+		return;
+	}
+	PreviewedPlan = PlanResult.OperationResult.GetValue();
+	PreviewText = FText::FromString(PreviewedPlan->Describe());
+}
+
+FText SNewModuleDialog::GetPreviewText() const
+{
+	return PreviewText;
+}
+
+EVisibility SNewModuleDialog::GetPlanningProgressVisibility() const
+{
+	return bIsPlanning ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
+bool SNewModuleDialog::IsInputEnabled() const
+{
+	return !bIsCreatingModule;
+}
+
+EVisibility SNewModuleDialog::GetCreationProgressVisibility() const
+{
+	return bIsCreatingModule ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
+FText SNewModuleDialog::GetCreationProgressText() const
+{
+	return CreationStageText;
 }
 
 EVisibility SNewModuleDialog::GetErrorLabelVisibility() const
 {
-	return GetErrorLabelText().IsEmpty() ? EVisibility::Collapsed : EVisibility::Visible;
+	return ErrorLabelText.IsEmpty() ? EVisibility::Collapsed : EVisibility::Visible;
 }
 
 FText SNewModuleDialog::GetErrorLabelText() const
 {
-	if(!IsModuleNameAvailable())
+	return ErrorLabelText;
+}
+
+bool SNewModuleDialog::IsModuleNameAvailable() const
+{
+	return bIsModuleNameAvailable;
+}
+
+bool SNewModuleDialog::DoesModuleDirectoryAlreadyExist() const
+{
+	return bDoesModuleDirectoryExist;
+}
+
+void SNewModuleDialog::UpdateErrorLabelText()
+{
+	if(!bIsModuleNameAvailable)
+	{
+		ErrorLabelText = FText::Format(LOCTEXT("NewModule_ModuleUnavailable", "The module '{0}' is already in use."), FText::FromString(NewModuleName));
+	}
+	else if(bDoesModuleDirectoryExist)
 	{
-		return FText::Format(LOCTEXT("NewModule_ModuleUnavailable", "The module '{0}' is already in use."), FText::FromString(NewModuleName));
+		ErrorLabelText = FText::Format(LOCTEXT("NewModule_ModuleFolderAlreadyExists", "The target directory already contains a folder named '{0}'"), FText::FromString(NewModuleName));
 	}
-	if(DoesModuleDirectoryAlreadyExist())
+	else if(!SelectedTemplate.IsValid())
 	{
-		return FText::Format(LOCTEXT("NewModule_ModuleFolderAlreadyExists", "The target directory already contains a folder named '{0}'"), FText::FromString(NewModuleName));
+		ErrorLabelText = FText::Format(LOCTEXT("NewModule_NoTemplates", "There are no module templates in '{0}'."), FText::FromString(UE::ModuleGeneration::GetModuleTemplatesDirectory()));
+	}
+	else if(bAreFilesToMoveInvalid)
+	{
+		ErrorLabelText = LOCTEXT("NewModule_FilesToMoveInvalid", "The files to move must all belong to the same module of the project.");
+	}
+	else
+	{
+		ErrorLabelText = FText::GetEmpty();
 	}
-	return FText::GetEmpty();
 }
 
-bool SNewModuleDialog::IsModuleNameAvailable() const
+EActiveTimerReturnType SNewModuleDialog::StartDirectoryCheck(double InCurrentTime, float InDeltaTime)
 {
-	const bool bDoesModuleNameExist = !AvailableModules.ContainsByPredicate([this](auto e)
+	DirectoryCheckTimer.Reset();
+	INC_DWORD_STAT(STAT_ModuleGeneration_DialogDirectoryChecks);
+
+	// Stats can take a long time on network drives so they must not block the game thread
+	const uint32 CheckId = DirectoryCheckId;
+	const FString ModuleDirectory = FPaths::Combine(OutputDirectory, NewModuleName);
+	const TWeakPtr<SNewModuleDialog> WeakThis = StaticCastSharedRef<SNewModuleDialog>(AsShared());
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, CheckId, ModuleDirectory]()
+	{
+		const bool bDirectoryExists = IFileManager::Get().DirectoryExists(*ModuleDirectory);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, CheckId, bDirectoryExists]()
 		{
-			return e->ModuleName.Equals(NewModuleName);
+			if (const TSharedPtr<SNewModuleDialog> This = WeakThis.Pin())
+			{
+				This->OnDirectoryCheckFinished(CheckId, bDirectoryExists);
+			}
 		});
+	});
+	return EActiveTimerReturnType::Stop;
+}
+
+void SNewModuleDialog::OnDirectoryCheckFinished(uint32 CheckId, bool bDirectoryExists)
+{
+	if (CheckId != DirectoryCheckId)
+	{
+		// Input changed in the meantime and another check has been scheduled
+		return;
+	}
 	
-	return bDoesModuleNameExist;
+	bIsDirectoryCheckPending = false;
+	bDoesModuleDirectoryExist = bDirectoryExists;
+	UpdateErrorLabelText();
 }
 
-bool SNewModuleDialog::DoesModuleDirectoryAlreadyExist() const
+void SNewModuleDialog::OnModuleIndexChanged()
+{
+	// Engine modules are indexed after the dialog may have opened, so the name and the search results may be stale
+	bIsModuleNameAvailable = !UE::ModuleGeneration::FModuleIndex::Get().ContainsModule(NewModuleName);
+	UpdateErrorLabelText();
+	UpdateDependencyPickerItems();
+}
+
+void SNewModuleDialog::StartBuildImpactEstimate()
+{
+	// Building the graph reads every file that changed since the last estimate, so it must not block the game thread
+	const uint32 RequestId = ++BuildImpactRequestId;
+	bIsEstimatingBuildImpact = true;
+	const UE::ModuleGeneration::FModuleExtractionSource Source = FilesToMove;
+	const TWeakPtr<SNewModuleDialog> WeakThis = StaticCastSharedRef<SNewModuleDialog>(AsShared());
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, RequestId, Source]()
+	{
+		const UE::ModuleGeneration::TOperationResult<UE::ModuleGeneration::FBuildImpactEstimate> Estimate = UE::ModuleGeneration::EstimateBuildImpact(*UE::ModuleGeneration::GetIncludeGraph(), Source);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestId, Estimate]()
+		{
+			if (const TSharedPtr<SNewModuleDialog> This = WeakThis.Pin())
+			{
+				This->OnBuildImpactEstimated(RequestId, Estimate);
+			}
+		});
+	});
+}
+
+void SNewModuleDialog::OnBuildImpactEstimated(uint32 RequestId, const UE::ModuleGeneration::TOperationResult<UE::ModuleGeneration::FBuildImpactEstimate>& Estimate)
+{
+	if (RequestId != BuildImpactRequestId)
+	{
+		return;
+	}
+
+	bIsEstimatingBuildImpact = false;
+	BuildImpact = Estimate.OperationResult;
+	BuildImpactError = Estimate.ErrorMessage.Get(FString());
+}
+
+FText SNewModuleDialog::GetBuildImpactText() const
 {
-	const bool bDoesModuleFolderExist = IFileManager::Get().DirectoryExists(*FPaths::Combine(OutputDirectory, NewModuleName));
-	return bDoesModuleFolderExist;
+	if (bIsEstimatingBuildImpact)
+	{
+		return LOCTEXT("CreateModule_EstimatingBuildImpact", "Estimating rebuilds...");
+	}
+	if (!BuildImpact.IsSet())
+	{
+		return LOCTEXT("CreateModule_BuildImpactUnknown", "Rebuilds: unknown");
+	}
+	if (FilesToMove.Files.Num() == 0)
+	{
+		return LOCTEXT("CreateModule_BuildImpactEmptyModule", "Rebuilds: own files only");
+	}
+	return FText::Format(LOCTEXT("CreateModule_BuildImpact", "Rebuilds: {0} TUs ({1}: {2} -> {3})"),
+		BuildImpact->NumNewModuleDependents, FText::FromString(FilesToMove.ModuleName), BuildImpact->NumSourceModuleDependentsBefore, BuildImpact->NumSourceModuleDependentsAfter);
+}
+
+FText SNewModuleDialog::GetBuildImpactToolTipText() const
+{
+	if (bIsEstimatingBuildImpact)
+	{
+		return LOCTEXT("CreateModule_EstimatingBuildImpactTip", "Scanning the includes of the project's modules. Only files which changed since the last scan are read.");
+	}
+	if (!BuildImpact.IsSet())
+	{
+		return FText::Format(LOCTEXT("CreateModule_BuildImpactUnknownTip", "The build impact cannot be estimated: {0}"), FText::FromString(BuildImpactError));
+	}
+	if (FilesToMove.Files.Num() == 0)
+	{
+		return FText::Format(LOCTEXT("CreateModule_BuildImpactEmptyModuleTip", "Nothing includes the new module's headers yet, so changing them only recompiles the new module's own files. The project has {0} translation units."),
+			BuildImpact->NumTranslationUnits);
+	}
+	return FText::Format(LOCTEXT("CreateModule_BuildImpactTip", "Changing a header of the new module will recompile {0} of the project's {1} translation units.\nChanging a header of {2} recompiles {3} translation units now and {4} after the move.\n{5} of the {6} translation units staying in {2} will not include any moved header."),
+		BuildImpact->NumNewModuleDependents, BuildImpact->NumTranslationUnits, FText::FromString(FilesToMove.ModuleName),
+		BuildImpact->NumSourceModuleDependentsBefore, BuildImpact->NumSourceModuleDependentsAfter,
+		BuildImpact->NumSourceModuleTranslationUnits - BuildImpact->NumSourceModuleDependentsOfMovedHeaders, BuildImpact->NumSourceModuleTranslationUnits);
 }
 
 void SNewModuleDialog::OnClickCancel()
 {
-	CloseContainingWindow();
+	if (!bIsCreatingModule)
+	{
+		CloseContainingWindow();
+	}
 }
 
 void SNewModuleDialog::OnClickFinish()
 {
-	const UE::ModuleGeneration::FOperationResult OperationResult = OnClickFinished.Execute(
-		OutputDirectory, 
-		FModuleDescriptor(FName(*NewModuleName), SelectedHostType, SelectedLoadingPhase)
-	);
+	if (bIsCreatingModule)
+	{
+		return;
+	}
+	bIsCreatingModule = true;
+	CreationStageText = FText::GetEmpty();
+
+	// The future is set on the game thread, so the continuation runs there, too
+	const TWeakPtr<SNewModuleDialog> WeakThis = StaticCastSharedRef<SNewModuleDialog>(AsShared());
+	const UE::ModuleGeneration::FOnModuleCreationStageChanged OnStageChanged = UE::ModuleGeneration::FOnModuleCreationStageChanged::CreateSP(this, &SNewModuleDialog::OnModuleCreationStageChanged);
+	TFuture<UE::ModuleGeneration::FOperationResult> CreationFuture = IsPreviewPageShown() && PreviewedPlan.IsValid()
+		? OnCommitPlan.Execute(PreviewedPlan.ToSharedRef(), OnStageChanged)
+		: OnClickFinished.Execute(
+			OutputDirectory, 
+			FModuleDescriptor(FName(*NewModuleName), SelectedHostType, SelectedLoadingPhase),
+			MakeNewModuleOptions(),
+			OnStageChanged
+		);
+	CreationFuture.Next([WeakThis](const UE::ModuleGeneration::FOperationResult& OperationResult)
+	{
+		if (const TSharedPtr<SNewModuleDialog> This = WeakThis.Pin())
+		{
+			This->OnModuleCreationFinished(OperationResult);
+		}
+	});
+}
 
+void SNewModuleDialog::OnModuleCreationStageChanged(UE::ModuleGeneration::EModuleCreationStage::Type Stage)
+{
+	CreationStageText = UE::ModuleGeneration::EModuleCreationStage::ToText(Stage);
+}
+
+void SNewModuleDialog::OnModuleCreationFinished(const UE::ModuleGeneration::FOperationResult& OperationResult)
+{
+	check(IsInGameThread());
+	bIsCreatingModule = false;
+	
 	if (!OperationResult)
 	{
 		const FText ErrorMessageUnformatted =
-				LOCTEXT("NewModule_Error_Message", "Failed to create new module.\n\n\nReason: {0}\n\nSome files may already have been created.");
+				LOCTEXT("NewModule_Error_Message", "Failed to create new module.\n\n\nReason: {0}\n\nAll changes have been rolled back.");
 		const FText ErrorMessage = FText::Format(FTextFormat(ErrorMessageUnformatted), FText::FromString(OperationResult.ErrorMessage.GetValue()));
 		const FText ErrorTitle = 
 			LOCTEXT("NewModule_Error_Title", "Error creating new C++ Module");
@@ -494,6 +1091,54 @@ FText SNewModuleDialog::GetSelectedLoadingPhaseText() const
 	return FText::Format(LOCTEXT("CreateModule_SelectedLoadingPhaseComboText", "{0}"), FText::FromString(ELoadingPhase::ToString(SelectedLoadingPhase)));
 }
 
+void SNewModuleDialog::OnSelectedTemplateChanged(TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo> Value, ESelectInfo::Type SelectInfo)
+{
+	SelectedTemplate = Value;
+	UpdateInput();
+}
+
+TSharedRef<SWidget> SNewModuleDialog::MakeWidgetForTemplate(TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo> ForTemplate) const
+{
+	return SNew(STextBlock)
+		.Text(FText::FromString(ForTemplate->Name))
+		.ToolTipText(FText::FromString(ForTemplate->Path));
+}
+
+FText SNewModuleDialog::GetSelectedTemplateText() const
+{
+	return SelectedTemplate.IsValid() ? FText::FromString(SelectedTemplate->Name) : LOCTEXT("CreateModule_NoTemplate", "None");
+}
+
+void SNewModuleDialog::OnSelectedBuildVariantChanged(TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant> Value, ESelectInfo::Type SelectInfo)
+{
+	if (Value.IsValid())
+	{
+		SelectedBuildVariant = Value;
+	}
+}
+
+TSharedRef<SWidget> SNewModuleDialog::MakeWidgetForBuildVariant(TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant> ForBuildVariant) const
+{
+	return SNew(STextBlock)
+		.Text(FText::FromString(ForBuildVariant->Name))
+		.ToolTipText(FText::FromString(ForBuildVariant->Description));
+}
+
+FText SNewModuleDialog::GetSelectedBuildVariantText() const
+{
+	return FText::FromString(SelectedBuildVariant->Name);
+}
+
+ECheckBoxState SNewModuleDialog::GetMinimizeDependenciesState() const
+{
+	return bMinimizeDependencies ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SNewModuleDialog::OnMinimizeDependenciesChanged(ECheckBoxState NewState)
+{
+	bMinimizeDependencies = NewState == ECheckBoxState::Checked;
+}
+
 FText SNewModuleDialog::GetOutputPath() const
 {
 	return FText::FromString(OutputDirectory);
@@ -537,9 +1182,217 @@ FReply SNewModuleDialog::HandleChooseFolderButtonClicked()
 	return FReply::Handled();
 }
 
+FText SNewModuleDialog::GetFilesToMoveText() const
+{
+	if (FilesToMove.Files.Num() == 0)
+	{
+		return LOCTEXT("CreateModule_NoFilesToMove", "None");
+	}
+	return FText::Format(LOCTEXT("CreateModule_FilesToMove", "{0} {0}|plural(one=file,other=files) from {1}"), FilesToMove.Files.Num(), FText::FromString(FilesToMove.ModuleName));
+}
+
+EVisibility SNewModuleDialog::GetClearFilesToMoveVisibility() const
+{
+	return FilesToMove.Files.Num() > 0 || bAreFilesToMoveInvalid ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
+FReply SNewModuleDialog::HandleChooseFilesToMoveButtonClicked()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform)
+	{
+		TSharedPtr<SWindow> ParentWindow = FSlateApplication::Get().FindWidgetWindow(AsShared());
+		void* ParentWindowWindowHandle = (ParentWindow.IsValid()) ? ParentWindow->GetNativeWindow()->GetOSWindowHandle() : nullptr;
+
+		TArray<FString> FileNames;
+		const FString Title = LOCTEXT("NewModule_ChooseFilesToMoveTitle", "Choose the files to move into the new module").ToString();
+		const bool bFilesSelected = DesktopPlatform->OpenFileDialog(
+			ParentWindowWindowHandle,
+			Title,
+			FilesToMove.ModuleDirectory.IsEmpty() ? OutputDirectory : FilesToMove.ModuleDirectory,
+			TEXT(""),
+			TEXT("C++ files (*.h;*.hpp;*.inl;*.cpp)|*.h;*.hpp;*.inl;*.cpp"),
+			EFileDialogFlags::Multiple,
+			FileNames
+		);
+
+		if (bFilesSelected && FileNames.Num() > 0)
+		{
+			SetFilesToMove(FileNames);
+		}
+	}
+
+	return FReply::Handled();
+}
+
+FReply SNewModuleDialog::HandleClearFilesToMoveButtonClicked()
+{
+	SetFilesToMove({});
+	return FReply::Handled();
+}
+
+void SNewModuleDialog::SetFilesToMove(const TArray<FString>& FilePaths)
+{
+	FilesToMove = {};
+	bAreFilesToMoveInvalid = false;
+
+	// A file belongs to the module with the deepest directory containing it
+	TSharedPtr<FModuleContextInfo> SourceModule;
+	for (const FString& FilePath : FilePaths)
+	{
+		const FString FullPath = FPaths::ConvertRelativePathToFull(FilePath);
+		TSharedPtr<FModuleContextInfo> OwningModule;
+		int32 OwningModuleDirectoryLength = 0;
+		for (const TSharedPtr<FModuleContextInfo>& Module : AvailableModules)
+		{
+			FString ModuleDirectory = FPaths::ConvertRelativePathToFull(Module->ModuleSourcePath);
+			FPaths::NormalizeDirectoryName(ModuleDirectory);
+			ModuleDirectory += TEXT("/");
+			if (ModuleDirectory.Len() > OwningModuleDirectoryLength && FullPath.StartsWith(ModuleDirectory))
+			{
+				OwningModule = Module;
+				OwningModuleDirectoryLength = ModuleDirectory.Len();
+			}
+		}
+
+		if (!OwningModule.IsValid() || (SourceModule.IsValid() && SourceModule != OwningModule))
+		{
+			FilesToMove = {};
+			bAreFilesToMoveInvalid = true;
+			break;
+		}
+		SourceModule = OwningModule;
+		FilesToMove.Files.Add(FullPath);
+	}
+
+	if (SourceModule.IsValid() && !bAreFilesToMoveInvalid)
+	{
+		FilesToMove.ModuleName = SourceModule->ModuleName;
+		FilesToMove.ModuleDirectory = FPaths::ConvertRelativePathToFull(SourceModule->ModuleSourcePath);
+		FPaths::NormalizeDirectoryName(FilesToMove.ModuleDirectory);
+	}
+	UpdateErrorLabelText();
+	StartBuildImpactEstimate();
+}
+
+void SNewModuleDialog::OnDependencySearchTextChanged(const FText& NewText)
+{
+	DependencySearchText = NewText.ToString().TrimStartAndEnd();
+	UpdateDependencyPickerItems();
+}
+
+FText SNewModuleDialog::GetDependencySearchHintText() const
+{
+	const UE::ModuleGeneration::FModuleIndex& ModuleIndex = UE::ModuleGeneration::FModuleIndex::Get();
+	if (!ModuleIndex.IsEngineIndexed())
+	{
+		return LOCTEXT("CreateModule_DependencySearchHintIndexing", "Search project modules (indexing engine modules...)");
+	}
+	return FText::Format(LOCTEXT("CreateModule_DependencySearchHint", "Search {0} modules"), ModuleIndex.GetModuleNames()->Num());
+}
+
+FText SNewModuleDialog::GetAdditionalDependenciesText() const
+{
+	if (AdditionalDependencies.Num() == 0)
+	{
+		return LOCTEXT("CreateModule_NoAdditionalDependencies", "None checked");
+	}
+	return FText::Format(LOCTEXT("CreateModule_AdditionalDependencies", "{0} checked"), AdditionalDependencies.Num());
+}
+
+void SNewModuleDialog::UpdateDependencyPickerItems()
+{
+	// The name table is searched on every keystroke; it only holds a few thousand names and indexes their trigrams
+	const TSharedRef<const UE::ModuleGeneration::FModuleNameTable> ModuleNames = UE::ModuleGeneration::FModuleIndex::Get().GetModuleNames();
+	DependencyPickerItems.Reset();
+	if (DependencySearchText.IsEmpty())
+	{
+		for (const FString& Dependency : AdditionalDependencies)
+		{
+			const int32 Index = ModuleNames->Find(Dependency);
+			const UE::ModuleGeneration::EModuleLocation::Type Location = Index != INDEX_NONE ? ModuleNames->GetLocation(Index) : UE::ModuleGeneration::EModuleLocation::Engine;
+			DependencyPickerItems.Add(MakeShared<FDependencyPickerItem>(FDependencyPickerItem{ Dependency, Location }));
+		}
+	}
+	else
+	{
+		for (const UE::ModuleGeneration::FModuleNameTable::FSearchResult& SearchResult : ModuleNames->Search(DependencySearchText, MaxDependencySearchResults))
+		{
+			DependencyPickerItems.Add(MakeShared<FDependencyPickerItem>(FDependencyPickerItem{ FString(ModuleNames->GetName(SearchResult.Index)), ModuleNames->GetLocation(SearchResult.Index) }));
+		}
+	}
+
+	if (DependencyListView.IsValid())
+	{
+		DependencyListView->RequestListRefresh();
+	}
+}
+
+TSharedRef<ITableRow> SNewModuleDialog::MakeDependencyPickerRow(TSharedPtr<FDependencyPickerItem> Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(STableRow<TSharedPtr<FDependencyPickerItem>>, OwnerTable)
+		[
+			SNew(SHorizontalBox)
+
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SCheckBox)
+				.IsChecked(this, &SNewModuleDialog::GetDependencyCheckState, Item)
+				.OnCheckStateChanged(this, &SNewModuleDialog::OnDependencyCheckStateChanged, Item)
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(Item->ModuleName))
+					.HighlightText(FText::FromString(DependencySearchText))
+				]
+			]
+
+			+SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(6.0f, 0.0f, 0.0f, 0.0f)
+			[
+				SNew(STextBlock)
+				.Text(GetModuleLocationText(Item->Location))
+				.ColorAndOpacity(FSlateColor::UseSubduedForeground())
+			]
+		];
+}
+
+ECheckBoxState SNewModuleDialog::GetDependencyCheckState(TSharedPtr<FDependencyPickerItem> Item) const
+{
+	return AdditionalDependencies.Contains(Item->ModuleName) ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SNewModuleDialog::OnDependencyCheckStateChanged(ECheckBoxState NewState, TSharedPtr<FDependencyPickerItem> Item)
+{
+	if (NewState == ECheckBoxState::Checked)
+	{
+		AdditionalDependencies.AddUnique(Item->ModuleName);
+	}
+	else
+	{
+		AdditionalDependencies.Remove(Item->ModuleName);
+	}
+}
+
 void SNewModuleDialog::UpdateInput()
 {
+	INC_DWORD_STAT(STAT_ModuleGeneration_DialogValidations);
+	
+	bIsModuleNameAvailable = !UE::ModuleGeneration::FModuleIndex::Get().ContainsModule(NewModuleName);
 
+	// Keep the previous result until the new one arrives so the error label does not flicker while typing
+	++DirectoryCheckId;
+	bIsDirectoryCheckPending = true;
+	if (DirectoryCheckTimer.IsValid())
+	{
+		UnRegisterActiveTimer(DirectoryCheckTimer.ToSharedRef());
+	}
+	DirectoryCheckTimer = RegisterActiveTimer(DirectoryCheckDebounceSeconds, FWidgetActiveTimerDelegate::CreateSP(this, &SNewModuleDialog::StartDirectoryCheck));
+	
+	UpdateErrorLabelText();
 }
 
 void SNewModuleDialog::CloseContainingWindow()
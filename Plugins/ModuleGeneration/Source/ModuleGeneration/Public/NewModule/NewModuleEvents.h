@@ -4,9 +4,71 @@
 
 #include "CoreMinimal.h"
 #include "ModuleDescriptor.h"
-#include "OperationResult.h"
+#include "NewModule/ModuleBuildSettings.h"
+#include "NewModule/ModuleExtraction.h"
+#include "NewModule/OperationResult.h"
 
-;
+namespace UE::ModuleGeneration
+{
+	namespace EModuleCreationLocation
+	{
+		enum Type
+		{
+			/**
+			 * Module was created nowhere; an error occured.
+			 */
+			Nowhere,
+			/**
+			 * In .uproject
+			 */
+			Project,
+			/**
+			 * In .uplugin
+			 */
+			Plugin
+		};
+	}
 
+	namespace EModuleCreationStage
+	{
+		enum Type
+		{
+			/**
+			 * The module files and descriptor changes are computed in memory.
+			 */
+			Planning,
+			/**
+			 * Template files and the descriptor copy are written to the staging area.
+			 */
+			Staging,
+			/**
+			 * Staged files are moved into place.
+			 */
+			Committing,
+			/**
+			 * The module was created. Project files are regenerated in the background.
+			 */
+			Finished
+		};
 
+		FText ToText(Type Stage);
+	}
 
+	/** How to create a module, apart from its descriptor and location */
+	struct FNewModuleOptions
+	{
+		/** Template directory or FModuleTemplateArchive; see FindModuleTemplates */
+		FString ModuleTemplatePath;
+		/** Whether the .Build.cs lists the modules the new sources include instead of the template's default dependencies */
+		bool bMinimizeDependencies = false;
+		/** PCH and unity settings of the .Build.cs; see GetModuleBuildVariants */
+		FModuleBuildSettings BuildSettings;
+		/** Files moved from an existing module into the new one; see PlanModuleExtraction. No files are moved if Files is empty. */
+		FModuleExtractionSource FilesToMove;
+		/** Modules added to the .Build.cs's private dependencies, e.g. chosen in the dependency picker */
+		TArray<FString> AdditionalDependencies;
+	};
+
+	/** Called on the game thread when module creation enters a new stage. */
+	DECLARE_DELEGATE_OneParam(FOnModuleCreationStageChanged, EModuleCreationStage::Type /*Stage*/);
+}
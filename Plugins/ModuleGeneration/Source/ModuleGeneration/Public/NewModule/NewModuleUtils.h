@@ -2,8 +2,14 @@
 
 #pragma once
 
-#include "OperationResult.h"
+#include "NewModule/IncludeGraph.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleCreationPlan.h"
 #include "NewModule/NewModuleEvents.h"
+#include "NewModule/PluginDirectoryIndex.h"
+#include "NewModule/OperationResult.h"
+
+#include "Async/Future.h"
 
 struct FModuleDescriptor;
 
@@ -15,13 +21,82 @@ namespace UE::ModuleGeneration
 	TSharedRef<SWindow> CreateAndShowNewModuleWindow();
 
 	/**
-	 * 
+	 * Creates a new module without blocking the game thread and tells the user about the result once it is done.
+	 * @return Future which is set on the game thread after the user was informed
+	 */
+	TFuture<FOperationResult> CreateNewModule(const FString& OutputDirectory, const FModuleDescriptor& NewModuleName, const FNewModuleOptions& Options, FOnModuleCreationStageChanged OnStageChanged = {});
+	/**
+	 * Commits a plan made by PlanNewModuleAsync, e.g. after showing it to the user, and tells the user about the result once it is done.
+	 * @return Future which is set on the game thread after the user was informed
+	 */
+	TFuture<FOperationResult> CreateNewModule(TSharedRef<const FModuleCreationPlan> Plan, FOnModuleCreationStageChanged OnStageChanged = {});
+
+	/**
+	 * Plans the module and commits the plan; see PlanNewModuleAsync and CommitNewModulePlanAsync.
+	 * Must be called on the game thread. OnStageChanged is invoked on the game thread.
+	 * @return Future which is set on a worker thread once the module was created or all changes were rolled back
+	 */
+	TFuture<TOperationResult<EModuleCreationLocation::Type>> CreateNewModuleAsync(const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FNewModuleOptions& Options, FOnModuleCreationStageChanged OnStageChanged = {});
+
+	/**
+	 * Computes the module files and the descriptor change on worker threads without writing anything. Must be called on the game thread.
+	 * @return Future which is set on a worker thread
+	 */
+	TFuture<TOperationResult<TSharedRef<const FModuleCreationPlan>>> PlanNewModuleAsync(const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FNewModuleOptions& Options);
+
+	/**
+	 * Writes the plan to the staging area as it is, commits it and queues project file regeneration. Nothing is re-read or re-generated,
+	 * so exactly what was planned ends up on disk. Fails without changes if the descriptor was modified since it was planned.
+	 * Can be called from any thread; CreateNewModuleAsync calls it from the thread its plan finished on. OnStageChanged is invoked on
+	 * the game thread.
+	 * @return Future which is set on a worker thread once the module was created or all changes were rolled back
 	 */
-	FOperationResult CreateNewModule(const FString& OutputDirectory, const FModuleDescriptor& NewModuleName);
+	TFuture<TOperationResult<EModuleCreationLocation::Type>> CommitNewModulePlanAsync(TSharedRef<const FModuleCreationPlan> Plan, FOnModuleCreationStageChanged OnStageChanged = {});
 
 	FOperationResult AddNewModuleToUProjectJsonFile(const FModuleDescriptor& NewModule);
 	FOperationResult AddNewModuleToUPluginJsonFile(const FString& OutputDirectory, const FModuleDescriptor& NewModule);
-	FOperationResult AddNewModuleToFile(const FString& FullFilePath, const FModuleDescriptor& NewModule);
+
+	/**
+	 * Finds the .uproject file of the current project.
+	 */
+	TOperationResult<FString> FindUProjectFile();
+	/**
+	 * Finds the .uplugin file of the plugin which OutputDirectory belongs to. Must be called on the game thread.
+	 */
+	TOperationResult<FString> FindUPluginFile(const FString& OutputDirectory);
+	/**
+	 * Gets the index of all plugins known to IPluginManager. Built on first use and rebuilt after plugins are created or mounted.
+	 * Must be called on the game thread; the returned index itself is immutable and can be used from any thread.
+	 */
+	TSharedRef<const FPluginDirectoryIndex> GetPluginDirectoryIndex();
+	/**
+	 * Gets the map of includes to engine and project modules. The engine modules are cached in Saved/ModuleGeneration across
+	 * editor sessions and the project modules are scanned again after a module was created.
+	 * Can be called from any thread. Blocks while the map is built, which takes a while if the engine is not cached yet.
+	 */
+	TSharedRef<const FIncludeModuleMap> GetIncludeModuleMap();
+	/**
+	 * Gets the include graph of the project's Source and Plugins folders. Every call reads the files which changed since the
+	 * previous one; the parsed includes are cached in Saved/ModuleGeneration across editor sessions.
+	 * Can be called from any thread. Blocks while the graph is built, which takes a while if nothing is cached yet.
+	 */
+	TSharedRef<const FIncludeGraph> GetIncludeGraph();
+
+	/**
+	 * Copies the default template's files to a specific location, using the project's copyright notice.
+	 */
+	FOperationResult InstantiateModuleTemplate(const FString& OutputDirectory, const FModuleDescriptor& NewModule);
+	/**
+	 * Gets the directory which FindModuleTemplates scans, i.e. this plugin's Resources/Templates folder.
+	 */
+	FString GetModuleTemplatesDirectory();
+	/**
+	 * Gets the path of the template called DefaultModuleTemplateName, preferring its packed archive if there is one.
+	 */
+	FString GetDefaultModuleTemplatePath();
 	
+	/**
+	 * Regenerates the project files synchronously. The editor UI uses FProjectFileRegenerator to do this in the background instead.
+	 */
 	FOperationResult GenerateVisualStudioSolution();
 }
\ No newline at end of file
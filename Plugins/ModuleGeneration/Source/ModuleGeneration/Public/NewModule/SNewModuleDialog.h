@@ -3,6 +3,11 @@
 #pragma once
 
 #include "NewModuleEvents.h"
+#include "NewModule/ModuleCreationPlan.h"
+#include "NewModule/ModuleNameTable.h"
+#include "NewModule/ModuleTemplateRegistry.h"
+
+#include "Async/Future.h"
 
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Widgets/SCompoundWidget.h"
@@ -15,58 +20,139 @@ class SNewModuleDialog : public SCompoundWidget
 {
 public:
 
-	DECLARE_DELEGATE_RetVal_TwoParams(UE::ModuleGeneration::FOperationResult, FOnRequestNewModule, const FString& /*OutputDirectory*/, const FModuleDescriptor& /*ClassPath*/)
+	using FModulePlanResult = UE::ModuleGeneration::TOperationResult<TSharedRef<const UE::ModuleGeneration::FModuleCreationPlan>>;
+	DECLARE_DELEGATE_RetVal_FourParams(TFuture<UE::ModuleGeneration::FOperationResult>, FOnRequestNewModule, const FString& /*OutputDirectory*/, const FModuleDescriptor& /*ClassPath*/, const UE::ModuleGeneration::FNewModuleOptions& /*Options*/, UE::ModuleGeneration::FOnModuleCreationStageChanged /*OnStageChanged*/)
+	DECLARE_DELEGATE_RetVal_ThreeParams(TFuture<FModulePlanResult>, FOnRequestModulePlan, const FString& /*OutputDirectory*/, const FModuleDescriptor& /*ClassPath*/, const UE::ModuleGeneration::FNewModuleOptions& /*Options*/)
+	DECLARE_DELEGATE_RetVal_TwoParams(TFuture<UE::ModuleGeneration::FOperationResult>, FOnCommitModulePlan, TSharedRef<const UE::ModuleGeneration::FModuleCreationPlan> /*Plan*/, UE::ModuleGeneration::FOnModuleCreationStageChanged /*OnStageChanged*/)
 	
 	SLATE_BEGIN_ARGS(SNewModuleDialog)
 	{}
 		/** A reference to the parent window */
 		SLATE_ARGUMENT(TSharedPtr<SWindow>, ParentWindow)
 		SLATE_EVENT(FOnRequestNewModule, OnClickFinished)
+		/** Computes the plan shown on the preview page. The future may be set on any thread. */
+		SLATE_EVENT(FOnRequestModulePlan, OnRequestPlan)
+		/** Called instead of OnClickFinished when finish is clicked on the preview page */
+		SLATE_EVENT(FOnCommitModulePlan, OnCommitPlan)
 	SLATE_END_ARGS()
 
 	void Construct(const FArguments& InArgs);
 
 private:
 
+	// A row of the dependency picker
+	struct FDependencyPickerItem
+	{
+		FString ModuleName;
+		UE::ModuleGeneration::EModuleLocation::Type Location;
+	};
+
 	// Widget references
 	TSharedPtr<SWizard> MainWizard;
 	TSharedPtr<SEditableTextBox> ModuleNameEditBox;
 	TSharedPtr<SComboBox<TSharedPtr<EHostType::Type>>> SelectableHostTypesComboBox;
 	TSharedPtr<SComboBox<TSharedPtr<ELoadingPhase::Type>>> SelectableLoadingPhasesComboBox;
+	TSharedPtr<SComboBox<TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo>>> SelectableTemplatesComboBox;
+	TSharedPtr<SComboBox<TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant>>> SelectableBuildVariantsComboBox;
+	TSharedPtr<SListView<TSharedPtr<FDependencyPickerItem>>> DependencyListView;
 
 	// Data sources
 	TArray<TSharedPtr<FModuleContextInfo>> AvailableModules;
 	TArray<TSharedPtr<EHostType::Type>> ModuleTypeOptions;
 	TArray<TSharedPtr<ELoadingPhase::Type>> LoadingPhaseOptions;
+	TArray<TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo>> TemplateOptions;
+	TArray<TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant>> BuildVariantOptions;
+	// Search results of the dependency picker or, without a search, the chosen dependencies
+	TArray<TSharedPtr<FDependencyPickerItem>> DependencyPickerItems;
 	
 	// Input data
 	FString OutputDirectory;
 	FString NewModuleName = TEXT("NewModule");
 	EHostType::Type SelectedHostType = EHostType::Runtime;
 	ELoadingPhase::Type SelectedLoadingPhase = ELoadingPhase::Default;
-
-	// Called by OnClickFinish when finish button is clicked
+	TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo> SelectedTemplate;
+	bool bMinimizeDependencies = false;
+	TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant> SelectedBuildVariant;
+	UE::ModuleGeneration::FModuleExtractionSource FilesToMove;
+	TArray<FString> AdditionalDependencies;
+	FString DependencySearchText;
+
+	// Called by OnClickFinish when finish button is clicked. The returned future must be set on the game thread.
 	FOnRequestNewModule OnClickFinished;
+	FOnRequestModulePlan OnRequestPlan;
+	FOnCommitModulePlan OnCommitPlan;
+
+	// Set while the module is being created in the background
+	bool bIsCreatingModule = false;
+	FText CreationStageText;
+
+	// Preview page. The plan is recomputed every time the page is entered and committed as it is.
+	TSharedPtr<const UE::ModuleGeneration::FModuleCreationPlan> PreviewedPlan;
+	FText PreviewText;
+	bool bIsPlanning = false;
+	// Incremented on every plan request so results of outdated requests are discarded
+	uint32 PlanRequestId = 0;
+
+	// Validation state. Recomputed by UpdateInput whenever the input changes so the attribute bindings, which run every frame, never touch the disk.
+	bool bIsModuleNameAvailable = true;
+	bool bDoesModuleDirectoryExist = false;
+	bool bIsDirectoryCheckPending = false;
+	// Set when the chosen files to move are not all part of the same module
+	bool bAreFilesToMoveInvalid = false;
+	FText ErrorLabelText;
+	// Incremented on every input change so results of outdated directory checks are discarded
+	uint32 DirectoryCheckId = 0;
+	TSharedPtr<FActiveTimerHandle> DirectoryCheckTimer;
+
+	// Build impact of the files to move, estimated in the background from the include graph
+	TOptional<UE::ModuleGeneration::FBuildImpactEstimate> BuildImpact;
+	FString BuildImpactError;
+	bool bIsEstimatingBuildImpact = false;
+	// Incremented on every estimate so results of outdated ones are discarded
+	uint32 BuildImpactRequestId = 0;
 
 	void PopulateAvailableModules();
 	void PopulateModuleTypes();
 	void PopulateLoadingPhases();
+	void PopulateTemplates();
+	void PopulateBuildVariants();
 
 	TSharedRef<SWidget> CreateMainPage();
 	TSharedRef<SWidget> CreateModuleDetailsPanel();
+	TSharedRef<SWidget> CreatePreviewPage();
 	TSharedRef<SWidget> CreateFooter();
 
 	FString FindSuitableModulePath() const;
+	UE::ModuleGeneration::FNewModuleOptions MakeNewModuleOptions() const;
 	
+	bool IsInputValid() const;
 	bool CanFinishButtonBeClicked() const;
+	bool IsPreviewPageShown() const;
+	void OnEnterPreviewPage();
+	void OnPlanFinished(uint32 RequestId, const FModulePlanResult& PlanResult);
+	FText GetPreviewText() const;
+	EVisibility GetPlanningProgressVisibility() const;
+	bool IsInputEnabled() const;
+	EVisibility GetCreationProgressVisibility() const;
+	FText GetCreationProgressText() const;
 	EVisibility GetErrorLabelVisibility() const;
 	FText GetErrorLabelText() const;
 	bool IsModuleNameAvailable() const;
 	bool DoesModuleDirectoryAlreadyExist() const;
+	void UpdateErrorLabelText();
+	EActiveTimerReturnType StartDirectoryCheck(double InCurrentTime, float InDeltaTime);
+	void OnDirectoryCheckFinished(uint32 CheckId, bool bDirectoryExists);
+	void OnModuleIndexChanged();
+	void StartBuildImpactEstimate();
+	void OnBuildImpactEstimated(uint32 RequestId, const UE::ModuleGeneration::TOperationResult<UE::ModuleGeneration::FBuildImpactEstimate>& Estimate);
+	FText GetBuildImpactText() const;
+	FText GetBuildImpactToolTipText() const;
 
 	// Button events
 	void OnClickCancel();
 	void OnClickFinish();
+	void OnModuleCreationStageChanged(UE::ModuleGeneration::EModuleCreationStage::Type Stage);
+	void OnModuleCreationFinished(const UE::ModuleGeneration::FOperationResult& OperationResult);
 
 	// Edit box: Module name
 	FText OnGetModuleName() const;
@@ -83,10 +169,40 @@ private:
 	TSharedRef<SWidget> MakeWidgetForSelectedLoadingPhase(TSharedPtr<ELoadingPhase::Type> ForLoadingPhase) const;
 	FText GetSelectedLoadingPhaseText() const;
 
+	// Combo box: Template
+	void OnSelectedTemplateChanged(TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo> Value, ESelectInfo::Type SelectInfo);
+	TSharedRef<SWidget> MakeWidgetForTemplate(TSharedPtr<UE::ModuleGeneration::FModuleTemplateInfo> ForTemplate) const;
+	FText GetSelectedTemplateText() const;
+
+	// Combo box: Build variant
+	void OnSelectedBuildVariantChanged(TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant> Value, ESelectInfo::Type SelectInfo);
+	TSharedRef<SWidget> MakeWidgetForBuildVariant(TSharedPtr<UE::ModuleGeneration::FModuleBuildVariant> ForBuildVariant) const;
+	FText GetSelectedBuildVariantText() const;
+
+	// Check box: Minimize dependencies
+	ECheckBoxState GetMinimizeDependenciesState() const;
+	void OnMinimizeDependenciesChanged(ECheckBoxState NewState);
+
 	// Edit box: Path
 	FText GetOutputPath() const;
 	void OnOutputPathChanged(const FText& NewText);
 	FReply HandleChooseFolderButtonClicked();
+
+	// Buttons: Files to move
+	FText GetFilesToMoveText() const;
+	EVisibility GetClearFilesToMoveVisibility() const;
+	FReply HandleChooseFilesToMoveButtonClicked();
+	FReply HandleClearFilesToMoveButtonClicked();
+	void SetFilesToMove(const TArray<FString>& FilePaths);
+
+	// Search box and list: Dependency picker
+	void OnDependencySearchTextChanged(const FText& NewText);
+	FText GetDependencySearchHintText() const;
+	FText GetAdditionalDependenciesText() const;
+	void UpdateDependencyPickerItems();
+	TSharedRef<ITableRow> MakeDependencyPickerRow(TSharedPtr<FDependencyPickerItem> Item, const TSharedRef<STableViewBase>& OwnerTable);
+	ECheckBoxState GetDependencyCheckState(TSharedPtr<FDependencyPickerItem> Item) const;
+	void OnDependencyCheckStateChanged(ECheckBoxState NewState, TSharedPtr<FDependencyPickerItem> Item);
 	
 	void UpdateInput();
 	void CloseContainingWindow();
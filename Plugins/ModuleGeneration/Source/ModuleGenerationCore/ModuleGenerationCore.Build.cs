@@ -0,0 +1,26 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+using UnrealBuildTool;
+
+/** Template instantiation and descriptor patching without any editor dependencies, shared by the editor and ModuleGenerationCli. */
+public class ModuleGenerationCore : ModuleRules
+{
+	public ModuleGenerationCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"Projects"
+			}
+			);
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Json"
+			}
+			);
+	}
+}
@@ -0,0 +1,5 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, ModuleGenerationCore);
@@ -0,0 +1,5 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ModuleGenerationLog.h"
+
+DEFINE_LOG_CATEGORY(LogModuleGeneration);
\ No newline at end of file
@@ -0,0 +1,7 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ModuleGenerationStats.h"
+
+DEFINE_STAT(STAT_ModuleGeneration_TemplateCacheHits);
+DEFINE_STAT(STAT_ModuleGeneration_TemplateCacheMisses);
+DEFINE_STAT(STAT_ModuleGeneration_TemplateCacheMemory);
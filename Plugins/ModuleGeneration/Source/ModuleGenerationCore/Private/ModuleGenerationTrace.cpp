@@ -0,0 +1,168 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ModuleGenerationTrace.h"
+
+#include "ModuleGenerationLog.h"
+
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(ModuleGenerationChannel);
+
+TRACE_DECLARE_INT_COUNTER(ModuleGeneration_TemplateFilesRead, TEXT("ModuleGeneration/TemplateFilesRead"));
+TRACE_DECLARE_MEMORY_COUNTER(ModuleGeneration_TemplateBytesRead, TEXT("ModuleGeneration/TemplateBytesRead"));
+TRACE_DECLARE_INT_COUNTER(ModuleGeneration_DirectoriesCreated, TEXT("ModuleGeneration/DirectoriesCreated"));
+TRACE_DECLARE_INT_COUNTER(ModuleGeneration_FilesWritten, TEXT("ModuleGeneration/FilesWritten"));
+TRACE_DECLARE_MEMORY_COUNTER(ModuleGeneration_BytesWritten, TEXT("ModuleGeneration/BytesWritten"));
+TRACE_DECLARE_INT_COUNTER(ModuleGeneration_FilesUnchanged, TEXT("ModuleGeneration/FilesUnchanged"));
+TRACE_DECLARE_MEMORY_COUNTER(ModuleGeneration_BytesUnchanged, TEXT("ModuleGeneration/BytesUnchanged"));
+TRACE_DECLARE_INT_COUNTER(ModuleGeneration_FilesCopied, TEXT("ModuleGeneration/FilesCopied"));
+TRACE_DECLARE_MEMORY_COUNTER(ModuleGeneration_BytesCopied, TEXT("ModuleGeneration/BytesCopied"));
+TRACE_DECLARE_MEMORY_COUNTER(ModuleGeneration_InstantiationBytes, TEXT("ModuleGeneration/InstantiationBytes"));
+
+namespace UE::ModuleGeneration
+{
+	namespace ETimedPhase
+	{
+		const TCHAR* ToString(Type Phase)
+		{
+			switch (Phase)
+			{
+			case EnumerateTemplate: return TEXT("EnumerateTemplate");
+			case ReadTemplate: return TEXT("ReadTemplate");
+			case CreateDirectories: return TEXT("CreateDirectories");
+			case Substitute: return TEXT("Substitute");
+			case AnalyzeIncludes: return TEXT("AnalyzeIncludes");
+			case WriteFiles: return TEXT("WriteFiles");
+			case CompareFiles: return TEXT("CompareFiles");
+			case ReadDescriptor: return TEXT("ReadDescriptor");
+			case PatchDescriptor: return TEXT("PatchDescriptor");
+			case WriteDescriptor: return TEXT("WriteDescriptor");
+			case Commit: return TEXT("Commit");
+			case ProjectFiles: return TEXT("ProjectFiles");
+			default:
+				checkNoEntry();
+				return TEXT("");
+			}
+		}
+	}
+
+	FModuleCreationTimings& FModuleCreationTimings::Get()
+	{
+		static FModuleCreationTimings Instance;
+		return Instance;
+	}
+
+	bool FModuleCreationTimings::BeginRun()
+	{
+		bool bWasRecording = false;
+		if (!bIsRecording.compare_exchange_strong(bWasRecording, true))
+		{
+			return false;
+		}
+
+		for (int32 Phase = 0; Phase < ETimedPhase::Num; ++Phase)
+		{
+			PhaseCycles[Phase].store(0, std::memory_order_relaxed);
+			PhaseCalls[Phase].store(0, std::memory_order_relaxed);
+		}
+		for (int32 Counter = 0; Counter < ETimedCounter::Num; ++Counter)
+		{
+			Counters[Counter].store(0, std::memory_order_relaxed);
+		}
+		PeakInstantiationBytes.store(0, std::memory_order_relaxed);
+		
+		TRACE_COUNTER_SET(ModuleGeneration_TemplateFilesRead, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_TemplateBytesRead, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_DirectoriesCreated, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_FilesWritten, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_BytesWritten, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_FilesUnchanged, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_BytesUnchanged, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_FilesCopied, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_BytesCopied, 0);
+		TRACE_COUNTER_SET(ModuleGeneration_InstantiationBytes, 0);
+		return true;
+	}
+
+	void FModuleCreationTimings::EndRun()
+	{
+		bIsRecording.store(false);
+	}
+
+	void FModuleCreationTimings::AddPhaseTime(ETimedPhase::Type Phase, uint64 Cycles)
+	{
+		if (!bIsRecording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		PhaseCycles[Phase].fetch_add(Cycles, std::memory_order_relaxed);
+		PhaseCalls[Phase].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void FModuleCreationTimings::AddCount(ETimedCounter::Type Counter, int64 Value)
+	{
+		if (!bIsRecording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		Counters[Counter].fetch_add(Value, std::memory_order_relaxed);
+		
+		switch (Counter)
+		{
+		case ETimedCounter::TemplateFilesRead: TRACE_COUNTER_ADD(ModuleGeneration_TemplateFilesRead, Value); break;
+		case ETimedCounter::TemplateBytesRead: TRACE_COUNTER_ADD(ModuleGeneration_TemplateBytesRead, Value); break;
+		case ETimedCounter::DirectoriesCreated: TRACE_COUNTER_ADD(ModuleGeneration_DirectoriesCreated, Value); break;
+		case ETimedCounter::FilesWritten: TRACE_COUNTER_ADD(ModuleGeneration_FilesWritten, Value); break;
+		case ETimedCounter::BytesWritten: TRACE_COUNTER_ADD(ModuleGeneration_BytesWritten, Value); break;
+		case ETimedCounter::FilesUnchanged: TRACE_COUNTER_ADD(ModuleGeneration_FilesUnchanged, Value); break;
+		case ETimedCounter::BytesUnchanged: TRACE_COUNTER_ADD(ModuleGeneration_BytesUnchanged, Value); break;
+		case ETimedCounter::FilesCopied: TRACE_COUNTER_ADD(ModuleGeneration_FilesCopied, Value); break;
+		case ETimedCounter::BytesCopied: TRACE_COUNTER_ADD(ModuleGeneration_BytesCopied, Value); break;
+		default: checkNoEntry(); break;
+		}
+	}
+
+	void FModuleCreationTimings::RecordInstantiationBytes(int64 Bytes)
+	{
+		if (!bIsRecording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		int64 Peak = PeakInstantiationBytes.load(std::memory_order_relaxed);
+		while (Bytes > Peak && !PeakInstantiationBytes.compare_exchange_weak(Peak, Bytes, std::memory_order_relaxed))
+		{
+		}
+		TRACE_COUNTER_SET(ModuleGeneration_InstantiationBytes, Bytes);
+	}
+
+	void FModuleCreationTimings::LogSummary(const FString& RunName, double WallSeconds, bool bSucceeded) const
+	{
+		UE_LOG(LogModuleGeneration, Log, TEXT("Timing summary for %s (%s, %.2f ms wall time):"), *RunName, bSucceeded ? TEXT("succeeded") : TEXT("failed"), WallSeconds * 1000.0);
+		UE_LOG(LogModuleGeneration, Log, TEXT("  %-20s %8s %16s"), TEXT("Phase"), TEXT("Calls"), TEXT("Thread time (ms)"));
+		for (int32 Phase = 0; Phase < ETimedPhase::Num; ++Phase)
+		{
+			const uint32 NumCalls = PhaseCalls[Phase].load(std::memory_order_relaxed);
+			if (NumCalls > 0)
+			{
+				UE_LOG(LogModuleGeneration, Log, TEXT("  %-20s %8u %16.3f"),
+					ETimedPhase::ToString(static_cast<ETimedPhase::Type>(Phase)),
+					NumCalls,
+					FPlatformTime::ToMilliseconds64(PhaseCycles[Phase].load(std::memory_order_relaxed)));
+			}
+		}
+		UE_LOG(LogModuleGeneration, Log, TEXT("  Template files read: %lld (%lld bytes), directories created: %lld, files written: %lld (%lld bytes), copied: %lld (%lld bytes), unchanged: %lld (%lld bytes)"),
+			Counters[ETimedCounter::TemplateFilesRead].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::TemplateBytesRead].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::DirectoriesCreated].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::FilesWritten].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::BytesWritten].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::FilesCopied].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::BytesCopied].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::FilesUnchanged].load(std::memory_order_relaxed),
+			Counters[ETimedCounter::BytesUnchanged].load(std::memory_order_relaxed));
+		// The process peak includes everything else the editor or tool did before, so it only bounds a single run from above
+		UE_LOG(LogModuleGeneration, Log, TEXT("  Peak memory per instantiation: %lld bytes of generated contents, process peak: %.1f MiB"),
+			PeakInstantiationBytes.load(std::memory_order_relaxed),
+			FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+	}
+}
@@ -0,0 +1,707 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/DescriptorJsonPatcher.h"
+
+#include "ModuleDescriptor.h"
+
+#include "Misc/FileHelper.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Half-open range of characters in the scanned descriptor */
+	struct FTextRange
+	{
+		int32 Start = INDEX_NONE;
+		int32 End = INDEX_NONE;
+
+		bool IsSet() const { return Start != INDEX_NONE; }
+	};
+
+	/** Everything the splice needs to know about a descriptor, in character offsets */
+	struct FDescriptorLayout
+	{
+		int32 ObjectOpen = INDEX_NONE;
+		int32 ObjectClose = INDEX_NONE;
+		/** End of the value of the last top-level member or INDEX_NONE if the object is empty */
+		int32 LastMemberEnd = INDEX_NONE;
+		/** Whitespace before the first top-level key */
+		FTextRange MemberPrefix;
+
+		/** Position of the "Modules" key or INDEX_NONE if there is no Modules array */
+		int32 ModulesKey = INDEX_NONE;
+		int32 ModulesOpen = INDEX_NONE;
+		int32 ModulesClose = INDEX_NONE;
+		/** End of the last element of the Modules array or INDEX_NONE if it is empty */
+		int32 LastModuleEnd = INDEX_NONE;
+		/** Names of the declared modules. Case-insensitive like module names on Windows. */
+		TSet<FString> ModuleNames;
+
+		/** Formatting of the first module entry */
+		FTextRange EntryPrefix;
+		FTextRange EntryMemberPrefix;
+		FTextRange EntryKeyValueSeparator;
+		FTextRange EntryClosePrefix;
+	};
+
+	/**
+	 * Lightweight scanner for the top-level object of a descriptor. Only the Modules array is looked into; other values are
+	 * skipped by matching brackets and strings. CharType is UTF8CHAR or TCHAR: JSON syntax is ASCII, so no decoding is needed.
+	 */
+	template<typename CharType>
+	class TDescriptorScanner
+	{
+	public:
+
+		explicit TDescriptorScanner(TConstArrayView<CharType> InText)
+			: Text(InText)
+		{}
+
+		/** @return Error message on failure */
+		TOptional<FString> Scan(FDescriptorLayout& OutLayout)
+		{
+			Layout = &OutLayout;
+			SkipWhitespace();
+			if (!Expect('{'))
+			{
+				return Error(TEXT("expected '{' at the start of the file"));
+			}
+			Layout->ObjectOpen = Pos++;
+			const int32 AfterOpen = Pos;
+			SkipWhitespace();
+
+			if (Peek() != '}')
+			{
+				Layout->MemberPrefix = { AfterOpen, Pos };
+				for (;;)
+				{
+					if (!ScanTopLevelMember())
+					{
+						return ErrorMessage;
+					}
+					Layout->LastMemberEnd = Pos;
+					SkipWhitespace();
+					if (Peek() == ',')
+					{
+						++Pos;
+						SkipWhitespace();
+						continue;
+					}
+					if (Peek() == '}')
+					{
+						break;
+					}
+					return Error(TEXT("expected ',' or '}' after object member"));
+				}
+			}
+			Layout->ObjectClose = Pos++;
+
+			SkipWhitespace();
+			if (Pos != Text.Num())
+			{
+				return Error(TEXT("unexpected text after the end of the object"));
+			}
+			return {};
+		}
+
+	private:
+
+		TConstArrayView<CharType> Text;
+		int32 Pos = 0;
+		FDescriptorLayout* Layout = nullptr;
+		TOptional<FString> ErrorMessage;
+
+		CharType Peek() const { return Pos < Text.Num() ? Text[Pos] : CharType(0); }
+		bool Expect(char C) const { return Peek() == CharType(C); }
+
+		TOptional<FString> Error(const TCHAR* Message)
+		{
+			if (!ErrorMessage.IsSet())
+			{
+				ErrorMessage = FString::Printf(TEXT("%s (at character %d)"), Message, Pos);
+			}
+			return ErrorMessage;
+		}
+
+		static bool IsWhitespace(CharType C)
+		{
+			return C == ' ' || C == '\t' || C == '\r' || C == '\n';
+		}
+
+		void SkipWhitespace()
+		{
+			while (Pos < Text.Num() && IsWhitespace(Text[Pos]))
+			{
+				++Pos;
+			}
+		}
+
+		bool ScanTopLevelMember()
+		{
+			const int32 KeyStart = Pos;
+			FString Key;
+			if (!ReadString(&Key) || !ReadKeyValueSeparator())
+			{
+				return false;
+			}
+
+			// FJsonObject looks up fields case-insensitively, so this finds the same array UE uses
+			if (Key.Equals(TEXT("Modules"), ESearchCase::IgnoreCase) && Peek() == '[' && Layout->ModulesKey == INDEX_NONE)
+			{
+				Layout->ModulesKey = KeyStart;
+				return ScanModulesArray();
+			}
+			return SkipValue();
+		}
+
+		bool ScanModulesArray()
+		{
+			Layout->ModulesOpen = Pos++;
+			int32 AfterSeparator = Pos;
+			SkipWhitespace();
+			if (Peek() == ']')
+			{
+				Layout->ModulesClose = Pos++;
+				return true;
+			}
+
+			for (;;)
+			{
+				const bool bIsFirstElement = Layout->LastModuleEnd == INDEX_NONE;
+				if (bIsFirstElement)
+				{
+					Layout->EntryPrefix = { AfterSeparator, Pos };
+				}
+
+				if (!(Peek() == '{' ? ScanModuleEntry(bIsFirstElement) : SkipValue()))
+				{
+					return false;
+				}
+				Layout->LastModuleEnd = Pos;
+
+				SkipWhitespace();
+				if (Peek() == ',')
+				{
+					AfterSeparator = ++Pos;
+					SkipWhitespace();
+					continue;
+				}
+				if (Peek() == ']')
+				{
+					Layout->ModulesClose = Pos++;
+					return true;
+				}
+				Error(TEXT("expected ',' or ']' in Modules array"));
+				return false;
+			}
+		}
+
+		bool ScanModuleEntry(bool bIsFirstElement)
+		{
+			++Pos;
+			int32 AfterSeparator = Pos;
+			SkipWhitespace();
+			if (Peek() == '}')
+			{
+				++Pos;
+				return true;
+			}
+
+			bool bIsFirstMember = true;
+			for (;;)
+			{
+				if (bIsFirstElement && bIsFirstMember)
+				{
+					Layout->EntryMemberPrefix = { AfterSeparator, Pos };
+				}
+
+				FString Key;
+				if (!ReadString(&Key))
+				{
+					return false;
+				}
+				const int32 KeyEnd = Pos;
+				if (!ReadKeyValueSeparator())
+				{
+					return false;
+				}
+				if (bIsFirstElement && bIsFirstMember)
+				{
+					Layout->EntryKeyValueSeparator = { KeyEnd, Pos };
+				}
+
+				if (Key.Equals(TEXT("Name"), ESearchCase::IgnoreCase) && Peek() == '"')
+				{
+					FString ModuleName;
+					if (!ReadString(&ModuleName))
+					{
+						return false;
+					}
+					Layout->ModuleNames.Add(MoveTemp(ModuleName));
+				}
+				else if (!SkipValue())
+				{
+					return false;
+				}
+
+				const int32 ValueEnd = Pos;
+				SkipWhitespace();
+				if (Peek() == ',')
+				{
+					AfterSeparator = ++Pos;
+					SkipWhitespace();
+					bIsFirstMember = false;
+					continue;
+				}
+				if (Peek() == '}')
+				{
+					if (bIsFirstElement)
+					{
+						Layout->EntryClosePrefix = { ValueEnd, Pos };
+					}
+					++Pos;
+					return true;
+				}
+				Error(TEXT("expected ',' or '}' in module entry"));
+				return false;
+			}
+		}
+
+		bool ReadKeyValueSeparator()
+		{
+			SkipWhitespace();
+			if (!Expect(':'))
+			{
+				Error(TEXT("expected ':' after key"));
+				return false;
+			}
+			++Pos;
+			SkipWhitespace();
+			return true;
+		}
+
+		/** Reads the string starting at Pos. Only decodes it if OutValue is set. */
+		bool ReadString(FString* OutValue)
+		{
+			if (!Expect('"'))
+			{
+				Error(TEXT("expected string"));
+				return false;
+			}
+			++Pos;
+
+			int32 RunStart = Pos;
+			const auto FlushRun = [this, &RunStart, OutValue]()
+			{
+				if (OutValue && Pos > RunStart)
+				{
+					const auto Converted = StringCast<TCHAR>(Text.GetData() + RunStart, Pos - RunStart);
+					OutValue->AppendChars(Converted.Get(), Converted.Length());
+				}
+			};
+
+			while (Pos < Text.Num())
+			{
+				const CharType C = Text[Pos];
+				if (C == '"')
+				{
+					FlushRun();
+					++Pos;
+					return true;
+				}
+				if (C != '\\')
+				{
+					++Pos;
+					continue;
+				}
+
+				FlushRun();
+				if (Pos + 1 >= Text.Num())
+				{
+					break;
+				}
+				const CharType Escaped = Text[Pos + 1];
+				Pos += 2;
+				if (Escaped == 'u')
+				{
+					if (Pos + 4 > Text.Num())
+					{
+						break;
+					}
+					uint32 CodeUnit = 0;
+					for (int32 i = 0; i < 4; ++i)
+					{
+						const CharType Digit = Text[Pos + i];
+						if (!FChar::IsHexDigit(static_cast<TCHAR>(Digit)))
+						{
+							Error(TEXT("invalid \\u escape sequence"));
+							return false;
+						}
+						CodeUnit = (CodeUnit << 4) | FParse::HexDigit(static_cast<TCHAR>(Digit));
+					}
+					Pos += 4;
+					if (OutValue)
+					{
+						OutValue->AppendChar(static_cast<TCHAR>(CodeUnit));
+					}
+				}
+				else if (OutValue)
+				{
+					switch (static_cast<TCHAR>(Escaped))
+					{
+					case TEXT('b'): OutValue->AppendChar(TEXT('\b')); break;
+					case TEXT('f'): OutValue->AppendChar(TEXT('\f')); break;
+					case TEXT('n'): OutValue->AppendChar(TEXT('\n')); break;
+					case TEXT('r'): OutValue->AppendChar(TEXT('\r')); break;
+					case TEXT('t'): OutValue->AppendChar(TEXT('\t')); break;
+					default: OutValue->AppendChar(static_cast<TCHAR>(Escaped)); break;
+					}
+				}
+				RunStart = Pos;
+			}
+			Error(TEXT("unterminated string"));
+			return false;
+		}
+
+		bool SkipValue()
+		{
+			const CharType C = Peek();
+			if (C == '"')
+			{
+				return ReadString(nullptr);
+			}
+			if (C == '{' || C == '[')
+			{
+				return SkipContainer();
+			}
+
+			// Numbers, true, false and null
+			const int32 LiteralStart = Pos;
+			while (Pos < Text.Num() && (FChar::IsAlnum(static_cast<TCHAR>(Text[Pos])) || Text[Pos] == '-' || Text[Pos] == '+' || Text[Pos] == '.'))
+			{
+				++Pos;
+			}
+			if (Pos == LiteralStart)
+			{
+				Error(TEXT("expected value"));
+				return false;
+			}
+			return true;
+		}
+
+		/** Skips an object or array by matching brackets. Strings are skipped as a whole so brackets inside them are ignored. */
+		bool SkipContainer()
+		{
+			TArray<CharType, TInlineAllocator<16>> ExpectedClosers;
+			do
+			{
+				const CharType C = Text[Pos];
+				if (C == '"')
+				{
+					if (!ReadString(nullptr))
+					{
+						return false;
+					}
+					continue;
+				}
+
+				if (C == '{' || C == '[')
+				{
+					ExpectedClosers.Push(C == '{' ? CharType('}') : CharType(']'));
+				}
+				else if (C == '}' || C == ']')
+				{
+					if (ExpectedClosers.Pop() != C)
+					{
+						Error(TEXT("mismatched bracket"));
+						return false;
+					}
+				}
+				++Pos;
+			}
+			while (ExpectedClosers.Num() > 0 && Pos < Text.Num());
+
+			if (ExpectedClosers.Num() > 0)
+			{
+				Error(TEXT("unterminated object or array"));
+				return false;
+			}
+			return true;
+		}
+	};
+
+	/** @return Error listing every module in NewModules which is already declared or appears more than once, if any */
+	static TOptional<FString> FindModuleNameConflicts(const TSet<FString>& ExistingModuleNames, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		TArray<FString> AlreadyDeclared;
+		TArray<FString> RequestedTwice;
+		TSet<FString> NewModuleNames;
+		NewModuleNames.Reserve(NewModules.Num());
+		for (const FModuleDescriptor& NewModule : NewModules)
+		{
+			FString NewModuleName = NewModule.Name.ToString();
+			if (ExistingModuleNames.Contains(NewModuleName))
+			{
+				AlreadyDeclared.Add(MoveTemp(NewModuleName));
+				continue;
+			}
+
+			bool bIsAlreadyInSet = false;
+			NewModuleNames.Add(NewModuleName, &bIsAlreadyInSet);
+			if (bIsAlreadyInSet)
+			{
+				RequestedTwice.AddUnique(MoveTemp(NewModuleName));
+			}
+		}
+
+		if (AlreadyDeclared.Num() == 0 && RequestedTwice.Num() == 0)
+		{
+			return {};
+		}
+		
+		TArray<FString> Conflicts;
+		if (AlreadyDeclared.Num() > 0)
+		{
+			Conflicts.Add(FString::Printf(TEXT("The file already contained entries for: %s"), *FString::Join(AlreadyDeclared, TEXT(", "))));
+		}
+		if (RequestedTwice.Num() > 0)
+		{
+			Conflicts.Add(FString::Printf(TEXT("Added more than once: %s"), *FString::Join(RequestedTwice, TEXT(", "))));
+		}
+		return FString::Join(Conflicts, TEXT("\n"));
+	}
+
+	static void AppendJsonString(FString& Out, const FString& Value)
+	{
+		Out.AppendChar(TEXT('"'));
+		for (const TCHAR C : Value)
+		{
+			if (C == TEXT('"') || C == TEXT('\\'))
+			{
+				Out.AppendChar(TEXT('\\'));
+			}
+			Out.AppendChar(C);
+		}
+		Out.AppendChar(TEXT('"'));
+	}
+
+	template<typename CharType>
+	static FString RangeToString(TConstArrayView<CharType> Text, const FTextRange& Range)
+	{
+		const auto Converted = StringCast<TCHAR>(Text.GetData() + Range.Start, Range.End - Range.Start);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	template<typename CharType>
+	static bool ContainsCrLf(TConstArrayView<CharType> Text)
+	{
+		for (int32 i = 1; i < Text.Num(); ++i)
+		{
+			if (Text[i] == '\n')
+			{
+				// Line endings are consistent in practice, so the first one decides
+				return Text[i - 1] == '\r';
+			}
+		}
+		return false;
+	}
+
+	/** @return Indentation of the line containing Position */
+	template<typename CharType>
+	static FString GetLineIndent(TConstArrayView<CharType> Text, int32 Position)
+	{
+		int32 LineStart = Position;
+		while (LineStart > 0 && Text[LineStart - 1] != '\n')
+		{
+			--LineStart;
+		}
+		int32 IndentEnd = LineStart;
+		while (IndentEnd < Position && (Text[IndentEnd] == ' ' || Text[IndentEnd] == '\t'))
+		{
+			++IndentEnd;
+		}
+		return RangeToString(Text, { LineStart, IndentEnd });
+	}
+
+	/** Whitespace and separators used when formatting the inserted entries */
+	struct FEntryFormat
+	{
+		FString EntryPrefix;
+		FString MemberPrefix;
+		FString KeyValueSeparator;
+		FString ClosePrefix;
+	};
+
+	static FString FormatModuleEntries(TConstArrayView<FModuleDescriptor> NewModules, const FEntryFormat& Format, bool bLeadingComma)
+	{
+		FString Result;
+		for (int32 i = 0; i < NewModules.Num(); ++i)
+		{
+			const FModuleDescriptor& NewModule = NewModules[i];
+			if (bLeadingComma || i > 0)
+			{
+				Result.AppendChar(TEXT(','));
+			}
+			Result += Format.EntryPrefix;
+			Result.AppendChar(TEXT('{'));
+
+			const TPair<const TCHAR*, FString> Members[] =
+			{
+				{ TEXT("Name"), NewModule.Name.ToString() },
+				{ TEXT("Type"), EHostType::ToString(NewModule.Type) },
+				{ TEXT("LoadingPhase"), ELoadingPhase::ToString(NewModule.LoadingPhase) }
+			};
+			for (int32 MemberIndex = 0; MemberIndex < MakeArrayView(Members).Num(); ++MemberIndex)
+			{
+				if (MemberIndex > 0)
+				{
+					Result.AppendChar(TEXT(','));
+				}
+				Result += Format.MemberPrefix;
+				AppendJsonString(Result, Members[MemberIndex].Key);
+				Result += Format.KeyValueSeparator;
+				AppendJsonString(Result, Members[MemberIndex].Value);
+			}
+
+			Result += Format.ClosePrefix;
+			Result.AppendChar(TEXT('}'));
+		}
+		return Result;
+	}
+
+	template<typename CharType>
+	static TOperationResult<TArray<CharType>> SpliceModules(TConstArrayView<CharType> Text, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		using FResult = TOperationResult<TArray<CharType>>;
+
+		FDescriptorLayout Layout;
+		TDescriptorScanner<CharType> Scanner(Text);
+		if (const TOptional<FString> ScanError = Scanner.Scan(Layout))
+		{
+			return FResult::MakeFailure(FString::Printf(TEXT("Failed to parse JSON: %s"), *ScanError.GetValue()));
+		}
+
+		if (const TOptional<FString> ValidationError = FindModuleNameConflicts(Layout.ModuleNames, NewModules))
+		{
+			return FResult::MakeFailure(ValidationError.GetValue());
+		}
+
+		// New entries copy the style of the first existing entry. Otherwise they follow the file's own indentation like FJsonSerializer would.
+		const FString NewLine = ContainsCrLf(Text) ? TEXT("\r\n") : TEXT("\n");
+		const FString TopLevelPrefix = Layout.MemberPrefix.IsSet() ? RangeToString(Text, Layout.MemberPrefix) : NewLine + TEXT("\t");
+		const bool bIsPrettyPrinted = TopLevelPrefix.Contains(TEXT("\n"));
+		const FString IndentUnit = [&]()
+		{
+			const FString TopLevelIndent = GetLineIndent(Text, Layout.MemberPrefix.IsSet() ? Layout.MemberPrefix.End : Layout.ObjectOpen + 1);
+			return TopLevelIndent.IsEmpty() ? FString(TEXT("\t")) : TopLevelIndent;
+		}();
+		const FString ArrayIndent = Layout.ModulesKey != INDEX_NONE ? GetLineIndent(Text, Layout.ModulesKey) : GetLineIndent(Text, Layout.MemberPrefix.IsSet() ? Layout.MemberPrefix.End : Layout.ObjectOpen + 1);
+
+		FEntryFormat Format;
+		if (bIsPrettyPrinted)
+		{
+			Format = { NewLine + ArrayIndent + IndentUnit, NewLine + ArrayIndent + IndentUnit + IndentUnit, TEXT(": "), NewLine + ArrayIndent + IndentUnit };
+		}
+		else
+		{
+			Format = { FString(), FString(), TEXT(":"), FString() };
+		}
+		if (Layout.EntryMemberPrefix.IsSet())
+		{
+			Format.MemberPrefix = RangeToString(Text, Layout.EntryMemberPrefix);
+			Format.KeyValueSeparator = RangeToString(Text, Layout.EntryKeyValueSeparator);
+			Format.ClosePrefix = RangeToString(Text, Layout.EntryClosePrefix);
+		}
+		if (Layout.EntryPrefix.IsSet())
+		{
+			Format.EntryPrefix = RangeToString(Text, Layout.EntryPrefix);
+		}
+		const FString ArrayClosePrefix = bIsPrettyPrinted ? NewLine + ArrayIndent : FString();
+
+		int32 ReplaceStart;
+		int32 ReplaceEnd;
+		FString Insertion;
+		if (Layout.LastModuleEnd != INDEX_NONE)
+		{
+			// Append after the last entry; everything around it stays as is
+			ReplaceStart = ReplaceEnd = Layout.LastModuleEnd;
+			Insertion = FormatModuleEntries(NewModules, Format, true);
+		}
+		else if (Layout.ModulesKey != INDEX_NONE)
+		{
+			// Empty array: replace the whitespace between the brackets
+			ReplaceStart = Layout.ModulesOpen + 1;
+			ReplaceEnd = Layout.ModulesClose;
+			Insertion = FormatModuleEntries(NewModules, Format, false) + ArrayClosePrefix;
+		}
+		else
+		{
+			// No Modules array: add one as the last member
+			const bool bIsEmptyObject = Layout.LastMemberEnd == INDEX_NONE;
+			ReplaceStart = ReplaceEnd = bIsEmptyObject ? Layout.ObjectOpen + 1 : Layout.LastMemberEnd;
+			Insertion = bIsEmptyObject ? TopLevelPrefix : TEXT(",") + TopLevelPrefix;
+			AppendJsonString(Insertion, TEXT("Modules"));
+			Insertion += Format.KeyValueSeparator;
+			Insertion.AppendChar(TEXT('['));
+			Insertion += FormatModuleEntries(NewModules, Format, false);
+			Insertion += ArrayClosePrefix;
+			Insertion.AppendChar(TEXT(']'));
+			if (bIsEmptyObject && bIsPrettyPrinted)
+			{
+				Insertion += NewLine;
+			}
+		}
+
+		const auto ConvertedInsertion = StringCast<CharType>(*Insertion, Insertion.Len());
+		TArray<CharType> Result;
+		Result.Reserve(Text.Num() - (ReplaceEnd - ReplaceStart) + ConvertedInsertion.Length());
+		Result.Append(Text.GetData(), ReplaceStart);
+		Result.Append(ConvertedInsertion.Get(), ConvertedInsertion.Length());
+		Result.Append(Text.GetData() + ReplaceEnd, Text.Num() - ReplaceEnd);
+		return FResult::MakeSuccess(MoveTemp(Result));
+	}
+
+	TOperationResult<TArray<uint8>> SpliceModulesIntoDescriptor(TConstArrayView<uint8> FileBytes, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		using FResult = TOperationResult<TArray<uint8>>;
+
+		const bool bIsUtf16 = FileBytes.Num() >= 2
+			&& ((FileBytes[0] == 0xFF && FileBytes[1] == 0xFE) || (FileBytes[0] == 0xFE && FileBytes[1] == 0xFF));
+		if (bIsUtf16)
+		{
+			// Rare: FFileHelper::SaveStringToFile only writes UTF-16 if the descriptor contains non-ANSI characters
+			FString Decoded;
+			FFileHelper::BufferToString(Decoded, FileBytes.GetData(), FileBytes.Num());
+			TOperationResult<TArray<TCHAR>> Spliced = SpliceModules<TCHAR>(TConstArrayView<TCHAR>(*Decoded, Decoded.Len()), NewModules);
+			if (Spliced.IsFailure())
+			{
+				return FResult::MakeFailure(Spliced);
+			}
+
+			const TArray<TCHAR>& SplicedText = Spliced.OperationResult.GetValue();
+			const FTCHARToUTF16 Encoded(SplicedText.GetData(), SplicedText.Num());
+			TArray<uint8> Result;
+			Result.Reserve(2 + Encoded.Length() * sizeof(UTF16CHAR));
+			Result.Add(0xFF);
+			Result.Add(0xFE);
+			Result.Append(reinterpret_cast<const uint8*>(Encoded.Get()), Encoded.Length() * sizeof(UTF16CHAR));
+			return FResult::MakeSuccess(MoveTemp(Result));
+		}
+
+		// UTF-8 and ANSI: non-ASCII bytes can only occur inside strings, which are copied verbatim
+		const bool bHasBom = FileBytes.Num() >= 3 && FileBytes[0] == 0xEF && FileBytes[1] == 0xBB && FileBytes[2] == 0xBF;
+		const int32 TextStart = bHasBom ? 3 : 0;
+		const TConstArrayView<UTF8CHAR> Text(reinterpret_cast<const UTF8CHAR*>(FileBytes.GetData() + TextStart), FileBytes.Num() - TextStart);
+		TOperationResult<TArray<UTF8CHAR>> Spliced = SpliceModules<UTF8CHAR>(Text, NewModules);
+		if (Spliced.IsFailure())
+		{
+			return FResult::MakeFailure(Spliced);
+		}
+
+		const TArray<UTF8CHAR>& SplicedText = Spliced.OperationResult.GetValue();
+		TArray<uint8> Result;
+		Result.Reserve(TextStart + SplicedText.Num());
+		Result.Append(FileBytes.GetData(), TextStart);
+		Result.Append(reinterpret_cast<const uint8*>(SplicedText.GetData()), SplicedText.Num());
+		return FResult::MakeSuccess(MoveTemp(Result));
+	}
+}
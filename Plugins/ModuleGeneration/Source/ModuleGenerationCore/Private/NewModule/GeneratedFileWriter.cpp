@@ -0,0 +1,196 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/GeneratedFileWriter.h"
+
+#include "ModuleGenerationTrace.h"
+
+#include "Algo/BinarySearch.h"
+#include "Dom/JsonObject.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Bump when the layout of the manifest changes */
+	static constexpr int32 GeneratedFilesManifestVersion = 2;
+
+	const TCHAR* FGeneratedFilesManifest::FileName = TEXT(".ModuleGeneration.json");
+
+	uint64 HashFileContents(TConstArrayView<uint8> Contents)
+	{
+		return FXxHash64::HashBuffer(Contents.GetData(), Contents.Num()).Hash;
+	}
+
+	TArray<uint8> EncodeFileContents(FStringView Contents)
+	{
+		TArray<uint8> Result;
+		if (FCString::IsPureAnsi(Contents.GetData(), Contents.Len()))
+		{
+			const auto AnsiContents = StringCast<ANSICHAR>(Contents.GetData(), Contents.Len());
+			Result.Append(reinterpret_cast<const uint8*>(AnsiContents.Get()), AnsiContents.Length());
+			return Result;
+		}
+
+		const auto Utf16Contents = StringCast<UTF16CHAR>(Contents.GetData(), Contents.Len());
+		const UTF16CHAR ByteOrderMark = UNICODE_BOM;
+		Result.Reserve(sizeof(UTF16CHAR) * (Utf16Contents.Length() + 1));
+		Result.Append(reinterpret_cast<const uint8*>(&ByteOrderMark), sizeof(UTF16CHAR));
+		Result.Append(reinterpret_cast<const uint8*>(Utf16Contents.Get()), Utf16Contents.Length() * sizeof(UTF16CHAR));
+		return Result;
+	}
+
+	static bool IsFileUnchanged(const FString& FilePath, int64 Size, TFunctionRef<uint64()> GetHash);
+
+	TOperationResult<EFileWriteOutcome::Type> WriteFileIfChanged(const FString& FilePath, TConstArrayView<uint8> Contents)
+	{
+		if (IsFileUnchanged(FilePath, Contents.Num(), [Contents]() { return HashFileContents(Contents); }))
+		{
+			return TOperationResult<EFileWriteOutcome::Type>::MakeSuccess(EFileWriteOutcome::Unchanged);
+		}
+
+		if (!FFileHelper::SaveArrayToFile(Contents, *FilePath))
+		{
+			return TOperationResult<EFileWriteOutcome::Type>::MakeFailure(FString::Printf(TEXT("Failed to write file '%s'"), *FilePath));
+		}
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::FilesWritten, 1);
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::BytesWritten, Contents.Num());
+		return TOperationResult<EFileWriteOutcome::Type>::MakeSuccess(EFileWriteOutcome::Written);
+	}
+
+	TOperationResult<EFileWriteOutcome::Type> CopyFileIfChanged(const FString& FilePath, const FVerbatimFileSource& Source)
+	{
+		if (IsFileUnchanged(FilePath, Source.Size, [&Source]() { return Source.Hash; }))
+		{
+			return TOperationResult<EFileWriteOutcome::Type>::MakeSuccess(EFileWriteOutcome::Unchanged);
+		}
+
+		const bool bIsCopied = Source.Path.IsEmpty()
+			? FFileHelper::SaveArrayToFile(Source.ArchiveBytes, *FilePath)
+			: FPlatformFileManager::Get().GetPlatformFile().CopyFile(*FilePath, *Source.Path);
+		if (!bIsCopied)
+		{
+			return TOperationResult<EFileWriteOutcome::Type>::MakeFailure(FString::Printf(TEXT("Failed to copy '%s' to '%s'"), Source.Path.IsEmpty() ? TEXT("the packed template file") : *Source.Path, *FilePath));
+		}
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::FilesCopied, 1);
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::BytesCopied, Source.Size);
+		return TOperationResult<EFileWriteOutcome::Type>::MakeSuccess(EFileWriteOutcome::Copied);
+	}
+
+	TOptional<FGeneratedFilesManifest> FGeneratedFilesManifest::Load(const FString& ModuleDirectory)
+	{
+		FString FileContents;
+		if (!FFileHelper::LoadFileToString(FileContents, *FPaths::Combine(ModuleDirectory, FileName), FFileHelper::EHashOptions::None, FILEREAD_Silent))
+		{
+			return {};
+		}
+
+		TSharedPtr<FJsonObject> ManifestAsJson;
+		const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		int32 Version = 0;
+		FGeneratedFilesManifest Result;
+		const TSharedPtr<FJsonObject>* PlaceholdersAsJson;
+		const TArray<TSharedPtr<FJsonValue>>* FilesAsJson;
+		if (!FJsonSerializer::Deserialize(JsonReader, ManifestAsJson)
+			|| !ManifestAsJson.IsValid()
+			|| !ManifestAsJson->TryGetNumberField(TEXT("Version"), Version)
+			|| Version != GeneratedFilesManifestVersion
+			|| !ManifestAsJson->TryGetStringField(TEXT("Template"), Result.TemplateName)
+			|| !ManifestAsJson->TryGetObjectField(TEXT("Placeholders"), PlaceholdersAsJson)
+			|| !ManifestAsJson->TryGetArrayField(TEXT("Files"), FilesAsJson))
+		{
+			return {};
+		}
+		for (int32 Placeholder = 0; Placeholder < ETemplatePlaceholder::Num; ++Placeholder)
+		{
+			if (!(*PlaceholdersAsJson)->TryGetStringField(ETemplatePlaceholder::ToString(static_cast<ETemplatePlaceholder::Type>(Placeholder)), Result.PlaceholderValues[Placeholder]))
+			{
+				return {};
+			}
+		}
+
+		// Hashes are strings because JSON numbers are doubles
+		Result.Files.Reserve(FilesAsJson->Num());
+		for (const TSharedPtr<FJsonValue>& FileValue : *FilesAsJson)
+		{
+			const TSharedPtr<FJsonObject>* FileAsJson;
+			FString Hash;
+			FFile& File = Result.Files.AddDefaulted_GetRef();
+			if (!FileValue->TryGetObject(FileAsJson)
+				|| !(*FileAsJson)->TryGetStringField(TEXT("Path"), File.RelativePath)
+				|| !(*FileAsJson)->TryGetNumberField(TEXT("Size"), File.Size)
+				|| !(*FileAsJson)->TryGetStringField(TEXT("Hash"), Hash))
+			{
+				return {};
+			}
+			LexFromString(File.Hash, *Hash);
+		}
+		Result.Files.Sort([](const FFile& Left, const FFile& Right) { return Left.RelativePath < Right.RelativePath; });
+		return Result;
+	}
+
+	FOperationResult FGeneratedFilesManifest::Save(const FString& ModuleDirectory) const
+	{
+		const TSharedRef<FJsonObject> ManifestAsJson = MakeShared<FJsonObject>();
+		ManifestAsJson->SetNumberField(TEXT("Version"), GeneratedFilesManifestVersion);
+		ManifestAsJson->SetStringField(TEXT("Template"), TemplateName);
+
+		const TSharedRef<FJsonObject> PlaceholdersAsJson = MakeShared<FJsonObject>();
+		for (int32 Placeholder = 0; Placeholder < ETemplatePlaceholder::Num; ++Placeholder)
+		{
+			PlaceholdersAsJson->SetStringField(ETemplatePlaceholder::ToString(static_cast<ETemplatePlaceholder::Type>(Placeholder)), PlaceholderValues[Placeholder]);
+		}
+		ManifestAsJson->SetObjectField(TEXT("Placeholders"), PlaceholdersAsJson);
+
+		TArray<TSharedPtr<FJsonValue>> FilesAsJson;
+		FilesAsJson.Reserve(Files.Num());
+		for (const FFile& File : Files)
+		{
+			const TSharedRef<FJsonObject> FileAsJson = MakeShared<FJsonObject>();
+			FileAsJson->SetStringField(TEXT("Path"), File.RelativePath);
+			FileAsJson->SetNumberField(TEXT("Size"), File.Size);
+			FileAsJson->SetStringField(TEXT("Hash"), LexToString(File.Hash));
+			FilesAsJson.Add(MakeShared<FJsonValueObject>(FileAsJson));
+		}
+		ManifestAsJson->SetArrayField(TEXT("Files"), FilesAsJson);
+
+		// Pretty-printed because the manifest is checked in together with the module
+		FString FileContents;
+		const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&FileContents);
+		if (!FJsonSerializer::Serialize(ManifestAsJson, JsonWriter))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to serialize the manifest of '%s'"), *ModuleDirectory));
+		}
+		const TOperationResult<EFileWriteOutcome::Type> WriteOp = WriteFileIfChanged(FPaths::Combine(ModuleDirectory, FileName), EncodeFileContents(FileContents));
+		return WriteOp.IsSuccess() ? FOperationResult::MakeSuccess() : FOperationResult::MakeFailure(WriteOp);
+	}
+
+	const FGeneratedFilesManifest::FFile* FGeneratedFilesManifest::Find(FStringView RelativePath) const
+	{
+		// FString's operator< used for sorting ignores case
+		const int32 Index = Algo::LowerBound(Files, RelativePath, [](const FFile& File, FStringView Value) { return FStringView(File.RelativePath).Compare(Value, ESearchCase::IgnoreCase) < 0; });
+		return Files.IsValidIndex(Index) && Files[Index].RelativePath == RelativePath ? &Files[Index] : nullptr;
+	}
+
+	static bool IsFileUnchanged(const FString& FilePath, int64 Size, TFunctionRef<uint64()> GetHash)
+	{
+		// FileSize is -1 for missing files, so only existing files of the same size are read
+		if (IFileManager::Get().FileSize(*FilePath) != Size)
+		{
+			return false;
+		}
+		TArray<uint8> ExistingContents;
+		if (!FFileHelper::LoadFileToArray(ExistingContents, *FilePath, FILEREAD_Silent) || HashFileContents(ExistingContents) != GetHash())
+		{
+			return false;
+		}
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::FilesUnchanged, 1);
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::BytesUnchanged, Size);
+		return true;
+	}
+}
@@ -0,0 +1,404 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/IncludeGraph.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/SourceFileUtils.h"
+
+#include "Algo/Count.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Bump when the layout of the cache file or the parsing rules change */
+	static constexpr int32 IncludeGraphCacheVersion = 1;
+
+	static int32 FindOwningModule(const TMap<FString, int32>& ModuleIndexByDirectory, FString Path);
+
+	FIncludeGraph::FSettings FIncludeGraph::MakeDefaultSettings(const FString& ProjectDirectory, const FString& CacheFilePath)
+	{
+		FSettings Result;
+		Result.SourceRoots = { FPaths::Combine(ProjectDirectory, TEXT("Source")), FPaths::Combine(ProjectDirectory, TEXT("Plugins")) };
+		Result.CacheFilePath = CacheFilePath;
+		for (FString& Root : Result.SourceRoots)
+		{
+			Root = FPaths::ConvertRelativePathToFull(Root);
+		}
+		return Result;
+	}
+
+	TSharedRef<const FIncludeGraph> FIncludeGraph::Build(const FSettings& Settings, const FIncludeGraph* Previous)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const TSharedRef<FIncludeGraph> Result = MakeShared<FIncludeGraph>();
+		Result->FindFiles(Settings.SourceRoots);
+
+		// Files which did not change keep the includes parsed last time
+		TOptional<TArray<FIncludeGraphFile>> CachedFiles;
+		if (Previous == nullptr)
+		{
+			CachedFiles = LoadCache(Settings);
+		}
+		const TConstArrayView<FIncludeGraphFile> KnownFileList = Previous ? Previous->GetFiles() : CachedFiles ? TConstArrayView<FIncludeGraphFile>(*CachedFiles) : TConstArrayView<FIncludeGraphFile>();
+		TMap<FString, const FIncludeGraphFile*> KnownFiles;
+		KnownFiles.Reserve(KnownFileList.Num());
+		for (const FIncludeGraphFile& File : KnownFileList)
+		{
+			KnownFiles.Add(File.Path, &File);
+		}
+
+		Result->ParseChangedFiles(KnownFiles);
+		Result->ResolveIncludes();
+		if (Result->NumRead > 0)
+		{
+			Result->SaveCache(Settings);
+		}
+
+		UE_LOG(LogModuleGeneration, Log, TEXT("Built include graph of %d files in %d modules in %.2f ms (%d files read, the others cached)"),
+			Result->Files.Num(), Result->Modules.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0, Result->NumRead);
+		return Result;
+	}
+
+	int32 FIncludeGraph::FindFile(const FString& Path) const
+	{
+		const int32* FileIndex = FileIndexByPath.Find(Path);
+		return FileIndex ? *FileIndex : INDEX_NONE;
+	}
+
+	int32 FIncludeGraph::FindModule(const FString& Name) const
+	{
+		const int32* ModuleIndex = ModuleIndexByName.Find(Name);
+		return ModuleIndex ? *ModuleIndex : INDEX_NONE;
+	}
+
+	TBitArray<> FIncludeGraph::FindDependents(TConstArrayView<int32> Headers) const
+	{
+		TBitArray<> Result(false, Files.Num());
+		TArray<int32> FilesToVisit;
+		for (const int32 Header : Headers)
+		{
+			if (!Result[Header])
+			{
+				Result[Header] = true;
+				FilesToVisit.Add(Header);
+			}
+		}
+		while (FilesToVisit.Num() > 0)
+		{
+			for (const int32 Includer : IncludedBy[FilesToVisit.Pop(EAllowShrinking::No)])
+			{
+				if (!Result[Includer])
+				{
+					Result[Includer] = true;
+					FilesToVisit.Add(Includer);
+				}
+			}
+		}
+		return Result;
+	}
+
+	bool FIncludeGraph::IsTranslationUnit(FStringView Path)
+	{
+		return IsSourceFile(Path) && !IsHeaderFile(Path);
+	}
+
+	void FIncludeGraph::FindFiles(TConstArrayView<FString> SourceRoots)
+	{
+		// One walk finds both the modules and their files; the stat data is what tells changed files apart. Folders without sources,
+		// e.g. every plugin's Content and Intermediate, are not entered.
+		TArray<FString> BuildFilePaths;
+		TArray<TPair<FString, FFileStatData>> SourceFiles;
+		TArray<FString> DirectoriesToVisit(SourceRoots);
+		while (DirectoriesToVisit.Num() > 0)
+		{
+			const FString Current = DirectoriesToVisit.Pop(EAllowShrinking::No);
+			IFileManager::Get().IterateDirectoryStat(*Current, [&BuildFilePaths, &SourceFiles, &DirectoriesToVisit](const TCHAR* Path, const FFileStatData& StatData)
+			{
+				if (StatData.bIsDirectory)
+				{
+					if (!IsSkippedDirectory(Path))
+					{
+						DirectoriesToVisit.Add(Path);
+					}
+					return true;
+				}
+				FString NormalizedPath = FPaths::ConvertRelativePathToFull(Path);
+				FPaths::NormalizeFilename(NormalizedPath);
+				if (GetModuleNameFromBuildFile(NormalizedPath))
+				{
+					BuildFilePaths.Add(MoveTemp(NormalizedPath));
+				}
+				else if (IsSourceFile(NormalizedPath))
+				{
+					SourceFiles.Emplace(MoveTemp(NormalizedPath), StatData);
+				}
+				return true;
+			});
+		}
+		BuildFilePaths.Sort();
+		SourceFiles.Sort([](const TPair<FString, FFileStatData>& Left, const TPair<FString, FFileStatData>& Right) { return Left.Key < Right.Key; });
+
+		TMap<FString, int32> ModuleIndexByDirectory;
+		for (const FString& BuildFilePath : BuildFilePaths)
+		{
+			const FString Directory = FPaths::GetPath(BuildFilePath);
+			if (!ModuleIndexByDirectory.Contains(Directory))
+			{
+				FString Name = GetModuleNameFromBuildFile(BuildFilePath).GetValue();
+				ModuleIndexByDirectory.Add(Directory, Modules.Num());
+				ModuleIndexByName.Add(Name, Modules.Num());
+				Modules.Add({ MoveTemp(Name), Directory });
+			}
+		}
+
+		// Nested modules own their files, so every file belongs to the closest module directory above it
+		for (TPair<FString, FFileStatData>& SourceFile : SourceFiles)
+		{
+			const int32 ModuleIndex = FindOwningModule(ModuleIndexByDirectory, SourceFile.Key);
+			if (ModuleIndex == INDEX_NONE || FileIndexByPath.Contains(SourceFile.Key))
+			{
+				continue;
+			}
+			FileIndexByPath.Add(SourceFile.Key, Files.Num());
+			FIncludeGraphFile& File = Files.AddDefaulted_GetRef();
+			File.RelativePath = SourceFile.Key.RightChop(Modules[ModuleIndex].Directory.Len() + 1);
+			File.Path = MoveTemp(SourceFile.Key);
+			File.ModuleIndex = ModuleIndex;
+			File.Timestamp = SourceFile.Value.ModificationTime;
+			File.Size = SourceFile.Value.FileSize;
+		}
+	}
+
+	void FIncludeGraph::ParseChangedFiles(const TMap<FString, const FIncludeGraphFile*>& KnownFiles)
+	{
+		TArray<bool> bWasRead;
+		bWasRead.SetNumZeroed(Files.Num());
+		ParallelFor(Files.Num(), [this, &KnownFiles, &bWasRead](int32 FileIndex)
+		{
+			FIncludeGraphFile& File = Files[FileIndex];
+			const FIncludeGraphFile* const* KnownFile = KnownFiles.Find(File.Path);
+			if (KnownFile && (*KnownFile)->Timestamp == File.Timestamp && (*KnownFile)->Size == File.Size)
+			{
+				File.ContentHash = (*KnownFile)->ContentHash;
+				File.Includes = (*KnownFile)->Includes;
+				return;
+			}
+
+			MODULEGENERATION_TIMED_SCOPE(AnalyzeIncludes);
+			TArray<uint8> Bytes;
+			bWasRead[FileIndex] = true;
+			if (!FFileHelper::LoadFileToArray(Bytes, *File.Path))
+			{
+				// Deleted since the directory was scanned; it includes nothing then
+				return;
+			}
+			File.ContentHash = FXxHash64::HashBuffer(Bytes.GetData(), Bytes.Num()).Hash;
+			// Checkouts and builds touch files without changing them
+			if (KnownFile && (*KnownFile)->ContentHash == File.ContentHash)
+			{
+				File.Includes = (*KnownFile)->Includes;
+				return;
+			}
+			FString Contents;
+			FFileHelper::BufferToString(Contents, Bytes.GetData(), Bytes.Num());
+			File.Includes = ParseIncludes(Contents);
+		});
+		NumRead = Algo::Count(bWasRead, true);
+	}
+
+	void FIncludeGraph::ResolveIncludes()
+	{
+		// Headers as the module itself includes them, and as all other modules include them. The latter are ambiguous if several
+		// modules provide the same path.
+		TArray<TMap<FString, int32>> OwnIncludesPerModule;
+		OwnIncludesPerModule.SetNum(Modules.Num());
+		TMap<FString, int32> PublicIncludes;
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			const FIncludeGraphFile& File = Files[FileIndex];
+			if (!IsHeaderFile(File.Path))
+			{
+				continue;
+			}
+			if (TOptional<FString> OwnInclude = GetModuleIncludePath(File.RelativePath, false))
+			{
+				OwnIncludesPerModule[File.ModuleIndex].Add(MoveTemp(OwnInclude.GetValue()), FileIndex);
+			}
+			if (TOptional<FString> PublicInclude = GetModuleIncludePath(File.RelativePath, true))
+			{
+				int32& Provider = PublicIncludes.FindOrAdd(MoveTemp(PublicInclude.GetValue()), FileIndex);
+				Provider = Provider == FileIndex ? FileIndex : INDEX_NONE;
+			}
+		}
+
+		ParallelFor(Files.Num(), [this, &OwnIncludesPerModule, &PublicIncludes](int32 FileIndex)
+		{
+			FIncludeGraphFile& File = Files[FileIndex];
+			const FString FileDirectory = FPaths::GetPath(File.Path);
+			const TMap<FString, int32>& OwnIncludes = OwnIncludesPerModule[File.ModuleIndex];
+			File.ResolvedIncludes.Reset(File.Includes.Num());
+			for (const FParsedInclude& Include : File.Includes)
+			{
+				FString IncludePath = Include.Path;
+				FPaths::NormalizeFilename(IncludePath);
+				FString PathNextToFile = FPaths::Combine(FileDirectory, IncludePath);
+				FPaths::CollapseRelativeDirectories(PathNextToFile);
+
+				const int32* Target = Include.bIsQuoted ? FileIndexByPath.Find(PathNextToFile) : nullptr;
+				Target = Target ? Target : OwnIncludes.Find(IncludePath);
+				Target = Target ? Target : PublicIncludes.Find(IncludePath);
+				File.ResolvedIncludes.Add(Target ? *Target : INDEX_NONE);
+			}
+		});
+
+		IncludedBy.SetNum(Files.Num());
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			for (const int32 Target : Files[FileIndex].ResolvedIncludes)
+			{
+				if (Target != INDEX_NONE && Target != FileIndex)
+				{
+					IncludedBy[Target].AddUnique(FileIndex);
+				}
+			}
+		}
+	}
+
+	TOptional<TArray<FIncludeGraphFile>> FIncludeGraph::LoadCache(const FSettings& Settings)
+	{
+		FString FileContents;
+		if (Settings.CacheFilePath.IsEmpty() || !FFileHelper::LoadFileToString(FileContents, *Settings.CacheFilePath))
+		{
+			return {};
+		}
+
+		TSharedPtr<FJsonObject> CacheAsJson;
+		const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		int32 Version = 0;
+		const TArray<TSharedPtr<FJsonValue>>* FilesAsJson;
+		if (!FJsonSerializer::Deserialize(JsonReader, CacheAsJson)
+			|| !CacheAsJson.IsValid()
+			|| !CacheAsJson->TryGetNumberField(TEXT("Version"), Version)
+			|| Version != IncludeGraphCacheVersion
+			|| !CacheAsJson->TryGetArrayField(TEXT("Files"), FilesAsJson))
+		{
+			return {};
+		}
+
+		// Timestamps and hashes are strings because JSON numbers are doubles
+		TArray<FIncludeGraphFile> Result;
+		Result.Reserve(FilesAsJson->Num());
+		for (const TSharedPtr<FJsonValue>& FileValue : *FilesAsJson)
+		{
+			const TSharedPtr<FJsonObject>* FileAsJson;
+			FString Ticks;
+			FString Hash;
+			TArray<FString> Includes;
+			FIncludeGraphFile& File = Result.AddDefaulted_GetRef();
+			if (!FileValue->TryGetObject(FileAsJson)
+				|| !(*FileAsJson)->TryGetStringField(TEXT("Path"), File.Path)
+				|| !(*FileAsJson)->TryGetStringField(TEXT("Timestamp"), Ticks)
+				|| !(*FileAsJson)->TryGetNumberField(TEXT("Size"), File.Size)
+				|| !(*FileAsJson)->TryGetStringField(TEXT("Hash"), Hash)
+				|| !(*FileAsJson)->TryGetStringArrayField(TEXT("Includes"), Includes))
+			{
+				return {};
+			}
+			int64 TimestampTicks = 0;
+			LexFromString(TimestampTicks, *Ticks);
+			File.Timestamp = FDateTime(TimestampTicks);
+			LexFromString(File.ContentHash, *Hash);
+
+			// Includes keep their delimiters, e.g. "Foo.h" or <Foo.h>
+			File.Includes.Reserve(Includes.Num());
+			for (const FString& Include : Includes)
+			{
+				if (Include.Len() < 2)
+				{
+					return {};
+				}
+				File.Includes.Add({ Include.Mid(1, Include.Len() - 2), Include[0] == TEXT('"') });
+			}
+		}
+		return Result;
+	}
+
+	void FIncludeGraph::SaveCache(const FSettings& Settings) const
+	{
+		if (Settings.CacheFilePath.IsEmpty())
+		{
+			return;
+		}
+
+		const TSharedRef<FJsonObject> CacheAsJson = MakeShared<FJsonObject>();
+		CacheAsJson->SetNumberField(TEXT("Version"), IncludeGraphCacheVersion);
+
+		TArray<TSharedPtr<FJsonValue>> FilesAsJson;
+		FilesAsJson.Reserve(Files.Num());
+		for (const FIncludeGraphFile& File : Files)
+		{
+			const TSharedRef<FJsonObject> FileAsJson = MakeShared<FJsonObject>();
+			FileAsJson->SetStringField(TEXT("Path"), File.Path);
+			FileAsJson->SetStringField(TEXT("Timestamp"), LexToString(File.Timestamp.GetTicks()));
+			FileAsJson->SetNumberField(TEXT("Size"), File.Size);
+			FileAsJson->SetStringField(TEXT("Hash"), LexToString(File.ContentHash));
+			TArray<TSharedPtr<FJsonValue>> IncludesAsJson;
+			IncludesAsJson.Reserve(File.Includes.Num());
+			for (const FParsedInclude& Include : File.Includes)
+			{
+				IncludesAsJson.Add(MakeShared<FJsonValueString>(Include.bIsQuoted
+					? FString::Printf(TEXT("\"%s\""), *Include.Path)
+					: FString::Printf(TEXT("<%s>"), *Include.Path)));
+			}
+			FileAsJson->SetArrayField(TEXT("Includes"), IncludesAsJson);
+			FilesAsJson.Add(MakeShared<FJsonValueObject>(FileAsJson));
+		}
+		CacheAsJson->SetArrayField(TEXT("Files"), FilesAsJson);
+
+		FString FileContents;
+		const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&FileContents);
+		if (!FJsonSerializer::Serialize(CacheAsJson, JsonWriter) || !FFileHelper::SaveStringToFile(FileContents, *Settings.CacheFilePath))
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("Failed to write include graph cache '%s'"), *Settings.CacheFilePath);
+		}
+	}
+
+	TOptional<FString> GetModuleIncludePath(const FString& RelativePath, bool bPublicOnly)
+	{
+		const int32 NumDirectories = bPublicOnly ? NumPublicIncludeDirectories : UE_ARRAY_COUNT(ModuleIncludeDirectoryNames);
+		for (int32 Index = 0; Index < NumDirectories; ++Index)
+		{
+			if (RelativePath.StartsWith(ModuleIncludeDirectoryNames[Index], ESearchCase::IgnoreCase))
+			{
+				return RelativePath.RightChop(FCString::Strlen(ModuleIncludeDirectoryNames[Index]));
+			}
+		}
+		return {};
+	}
+
+	static int32 FindOwningModule(const TMap<FString, int32>& ModuleIndexByDirectory, FString Path)
+	{
+		while (!Path.IsEmpty())
+		{
+			Path = FPaths::GetPath(Path);
+			if (const int32* ModuleIndex = ModuleIndexByDirectory.Find(Path))
+			{
+				return *ModuleIndex;
+			}
+			if (!Path.Contains(TEXT("/")))
+			{
+				break;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
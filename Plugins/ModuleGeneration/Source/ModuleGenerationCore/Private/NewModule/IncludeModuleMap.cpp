@@ -0,0 +1,306 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/IncludeModuleMap.h"
+
+#include "ModuleGenerationLog.h"
+#include "NewModule/SourceFileUtils.h"
+
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Bump when the layout of the cache file or the scanning rules change */
+	static constexpr int32 IncludeModuleMapCacheVersion = 1;
+
+	/** Folders whose headers are on the include path of dependent modules */
+	static const TCHAR* PublicIncludeDirectoryNames[] = { TEXT("Public"), TEXT("Classes"), TEXT("Internal") };
+
+	/** @return The newest modification time of the headers, .Build.cs files and folders below Root, skipping folders without modules */
+	static FDateTime FindNewestSourceModification(const FString& Root);
+
+	FIncludeModuleMap::FSettings FIncludeModuleMap::MakeDefaultSettings(const FString& EngineDirectory, const FString& ProjectDirectory, const FString& CacheFilePath)
+	{
+		FSettings Result;
+		Result.ScannedRoots = { FPaths::Combine(ProjectDirectory, TEXT("Source")), FPaths::Combine(ProjectDirectory, TEXT("Plugins")) };
+		Result.CachedRoots = { FPaths::Combine(EngineDirectory, TEXT("Source")), FPaths::Combine(EngineDirectory, TEXT("Plugins")) };
+		Result.CacheFilePath = CacheFilePath;
+		Result.CacheKey = MakeEngineSourceCacheKey(EngineDirectory);
+		for (FString& Root : Result.ScannedRoots)
+		{
+			Root = FPaths::ConvertRelativePathToFull(Root);
+		}
+		for (FString& Root : Result.CachedRoots)
+		{
+			Root = FPaths::ConvertRelativePathToFull(Root);
+		}
+		return Result;
+	}
+
+	TSharedRef<const FIncludeModuleMap> FIncludeModuleMap::LoadOrBuild(const FSettings& Settings)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray<FIndexedSourceModule> CachedModules;
+		bool bWasCached = false;
+		if (TOptional<TArray<FIndexedSourceModule>> LoadedModules = LoadCache(Settings))
+		{
+			CachedModules = MoveTemp(LoadedModules.GetValue());
+			bWasCached = true;
+		}
+		else
+		{
+			CachedModules = ScanRoots(Settings.CachedRoots);
+			SaveCache(Settings, CachedModules);
+		}
+
+		// Scanned modules come first so project modules win over engine modules providing the same header
+		const TSharedRef<FIncludeModuleMap> Result = MakeShared<FIncludeModuleMap>();
+		Result->Modules = ScanRoots(Settings.ScannedRoots);
+		Result->Modules.Append(MoveTemp(CachedModules));
+
+		int32 NumHeaders = 0;
+		for (const FIndexedSourceModule& Module : Result->Modules)
+		{
+			NumHeaders += Module.PublicHeaders.Num();
+		}
+		Result->ModuleIndexByInclude.Reserve(NumHeaders);
+		for (int32 ModuleIndex = 0; ModuleIndex < Result->Modules.Num(); ++ModuleIndex)
+		{
+			for (const FString& Header : Result->Modules[ModuleIndex].PublicHeaders)
+			{
+				if (!Result->ModuleIndexByInclude.Contains(Header))
+				{
+					Result->ModuleIndexByInclude.Add(Header, ModuleIndex);
+				}
+			}
+		}
+
+		UE_LOG(LogModuleGeneration, Log, TEXT("Indexed %d headers of %d modules in %.2f ms (engine modules %s)"),
+			Result->ModuleIndexByInclude.Num(), Result->Modules.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0,
+			bWasCached ? TEXT("loaded from cache") : TEXT("scanned"));
+		return Result;
+	}
+
+	const FIndexedSourceModule* FIncludeModuleMap::FindModuleForInclude(const FString& Include) const
+	{
+		const int32* ModuleIndex = ModuleIndexByInclude.Find(Include);
+		return ModuleIndex ? &Modules[*ModuleIndex] : nullptr;
+	}
+
+	TArray<FIndexedSourceModule> FIncludeModuleMap::ScanRoots(TConstArrayView<FString> Roots)
+	{
+		TArray<FIndexedSourceModule> Result;
+		for (const FString& Root : Roots)
+		{
+			FindSourceModules(Root, Result);
+		}
+
+		// Modules are independent, so their headers are listed concurrently
+		ParallelFor(Result.Num(), [&Result](int32 Index)
+		{
+			FIndexedSourceModule& Module = Result[Index];
+			for (const TCHAR* IncludeDirectoryName : PublicIncludeDirectoryNames)
+			{
+				const FString IncludeDirectory = FPaths::Combine(Module.Directory, IncludeDirectoryName);
+				const int32 PrefixLength = IncludeDirectory.Len() + 1;
+				IFileManager::Get().IterateDirectoryRecursively(*IncludeDirectory, [&Module, PrefixLength](const TCHAR* Path, bool bIsDirectory)
+				{
+					if (!bIsDirectory && IsHeaderFile(Path))
+					{
+						FString Header = FString(Path).RightChop(PrefixLength);
+						FPaths::NormalizeFilename(Header);
+						Module.PublicHeaders.Add(MoveTemp(Header));
+					}
+					return true;
+				});
+			}
+			Module.PublicHeaders.Sort();
+		});
+
+		Result.Sort([](const FIndexedSourceModule& Left, const FIndexedSourceModule& Right) { return Left.Directory < Right.Directory; });
+		return Result;
+	}
+
+	TOptional<TArray<FIndexedSourceModule>> FIncludeModuleMap::LoadCache(const FSettings& Settings)
+	{
+		FString FileContents;
+		if (Settings.CacheFilePath.IsEmpty() || !FFileHelper::LoadFileToString(FileContents, *Settings.CacheFilePath))
+		{
+			return {};
+		}
+
+		TSharedPtr<FJsonObject> CacheAsJson;
+		const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		int32 Version = 0;
+		FString CacheKey;
+		TArray<FString> Roots;
+		const TArray<TSharedPtr<FJsonValue>>* ModulesAsJson;
+		if (!FJsonSerializer::Deserialize(JsonReader, CacheAsJson)
+			|| !CacheAsJson.IsValid()
+			|| !CacheAsJson->TryGetNumberField(TEXT("Version"), Version)
+			|| Version != IncludeModuleMapCacheVersion
+			|| !CacheAsJson->TryGetStringField(TEXT("Key"), CacheKey)
+			|| CacheKey != Settings.CacheKey
+			|| !CacheAsJson->TryGetStringArrayField(TEXT("Roots"), Roots)
+			|| Roots != Settings.CachedRoots
+			|| !CacheAsJson->TryGetArrayField(TEXT("Modules"), ModulesAsJson))
+		{
+			return {};
+		}
+
+		TArray<FIndexedSourceModule> Result;
+		Result.Reserve(ModulesAsJson->Num());
+		for (const TSharedPtr<FJsonValue>& ModuleValue : *ModulesAsJson)
+		{
+			const TSharedPtr<FJsonObject>* ModuleAsJson;
+			FIndexedSourceModule Module;
+			if (!ModuleValue->TryGetObject(ModuleAsJson)
+				|| !(*ModuleAsJson)->TryGetStringField(TEXT("Name"), Module.Name)
+				|| !(*ModuleAsJson)->TryGetStringField(TEXT("Directory"), Module.Directory)
+				|| !(*ModuleAsJson)->TryGetStringArrayField(TEXT("Headers"), Module.PublicHeaders))
+			{
+				return {};
+			}
+			Result.Add(MoveTemp(Module));
+		}
+		return Result;
+	}
+
+	void FIncludeModuleMap::SaveCache(const FSettings& Settings, TConstArrayView<FIndexedSourceModule> CachedModules)
+	{
+		if (Settings.CacheFilePath.IsEmpty())
+		{
+			return;
+		}
+
+		const TSharedRef<FJsonObject> CacheAsJson = MakeShared<FJsonObject>();
+		CacheAsJson->SetNumberField(TEXT("Version"), IncludeModuleMapCacheVersion);
+		CacheAsJson->SetStringField(TEXT("Key"), Settings.CacheKey);
+
+		TArray<TSharedPtr<FJsonValue>> RootsAsJson;
+		for (const FString& Root : Settings.CachedRoots)
+		{
+			RootsAsJson.Add(MakeShared<FJsonValueString>(Root));
+		}
+		CacheAsJson->SetArrayField(TEXT("Roots"), RootsAsJson);
+
+		TArray<TSharedPtr<FJsonValue>> ModulesAsJson;
+		ModulesAsJson.Reserve(CachedModules.Num());
+		for (const FIndexedSourceModule& Module : CachedModules)
+		{
+			const TSharedRef<FJsonObject> ModuleAsJson = MakeShared<FJsonObject>();
+			ModuleAsJson->SetStringField(TEXT("Name"), Module.Name);
+			ModuleAsJson->SetStringField(TEXT("Directory"), Module.Directory);
+			TArray<TSharedPtr<FJsonValue>> HeadersAsJson;
+			HeadersAsJson.Reserve(Module.PublicHeaders.Num());
+			for (const FString& Header : Module.PublicHeaders)
+			{
+				HeadersAsJson.Add(MakeShared<FJsonValueString>(Header));
+			}
+			ModuleAsJson->SetArrayField(TEXT("Headers"), HeadersAsJson);
+			ModulesAsJson.Add(MakeShared<FJsonValueObject>(ModuleAsJson));
+		}
+		CacheAsJson->SetArrayField(TEXT("Modules"), ModulesAsJson);
+
+		FString FileContents;
+		const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&FileContents);
+		if (!FJsonSerializer::Serialize(CacheAsJson, JsonWriter) || !FFileHelper::SaveStringToFile(FileContents, *Settings.CacheFilePath))
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("Failed to write include cache '%s'"), *Settings.CacheFilePath);
+		}
+	}
+
+	void FindSourceModules(const FString& Root, TArray<FIndexedSourceModule>& OutModules)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+
+		TArray<FString> DirectoriesToVisit = { Root };
+		while (DirectoriesToVisit.Num() > 0)
+		{
+			const FString Current = DirectoriesToVisit.Pop(EAllowShrinking::No);
+
+			TOptional<FString> ModuleName;
+			TArray<FString> Subdirectories;
+			FileManager.IterateDirectory(*Current, [&ModuleName, &Subdirectories](const TCHAR* Path, bool bIsDirectory)
+			{
+				if (bIsDirectory)
+				{
+					if (!IsSkippedDirectory(Path))
+					{
+						Subdirectories.Add(Path);
+					}
+				}
+				else if (TOptional<FString> BuildFileModuleName = GetModuleNameFromBuildFile(Path))
+				{
+					ModuleName = MoveTemp(BuildFileModuleName);
+				}
+				return true;
+			});
+
+			// Modules do not contain other modules
+			if (!ModuleName)
+			{
+				DirectoriesToVisit.Append(MoveTemp(Subdirectories));
+				continue;
+			}
+
+			FIndexedSourceModule& Module = OutModules.AddDefaulted_GetRef();
+			Module.Name = MoveTemp(ModuleName.GetValue());
+			Module.Directory = Current;
+			FPaths::NormalizeDirectoryName(Module.Directory);
+		}
+	}
+
+	FString MakeEngineSourceCacheKey(const FString& EngineDirectory)
+	{
+		const FString FullEngineDirectory = FPaths::ConvertRelativePathToFull(EngineDirectory);
+		FString Result = FEngineVersion::Current().ToString(EVersionComponent::Changelist) + TEXT("|") + FullEngineDirectory;
+		if (FEngineVersion::Current().GetChangelist() == 0)
+		{
+			const FDateTime NewestModification = FMath::Max(
+				FindNewestSourceModification(FPaths::Combine(FullEngineDirectory, TEXT("Source"))),
+				FindNewestSourceModification(FPaths::Combine(FullEngineDirectory, TEXT("Plugins"))));
+			Result += FString::Printf(TEXT("|%lld"), NewestModification.GetTicks());
+		}
+		return Result;
+	}
+
+	static FDateTime FindNewestSourceModification(const FString& Root)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+
+		// Adding, removing or renaming a header or module changes the time of the folder containing it
+		FDateTime Result = FileManager.GetStatData(*Root).ModificationTime;
+		TArray<FString> DirectoriesToVisit = { Root };
+		while (DirectoriesToVisit.Num() > 0)
+		{
+			const FString Current = DirectoriesToVisit.Pop(EAllowShrinking::No);
+			FileManager.IterateDirectoryStat(*Current, [&Result, &DirectoriesToVisit](const TCHAR* Path, const FFileStatData& StatData)
+			{
+				if (StatData.bIsDirectory)
+				{
+					if (IsSkippedDirectory(Path))
+					{
+						return true;
+					}
+					DirectoriesToVisit.Add(Path);
+				}
+				else if (!IsHeaderFile(Path) && !GetModuleNameFromBuildFile(Path))
+				{
+					return true;
+				}
+				Result = FMath::Max(Result, StatData.ModificationTime);
+				return true;
+			});
+		}
+		return Result;
+	}
+}
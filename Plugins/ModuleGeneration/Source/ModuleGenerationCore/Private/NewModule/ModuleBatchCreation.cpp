@@ -0,0 +1,225 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleBatchCreation.h"
+
+#include "ModuleGenerationLog.h"
+#include "NewModule/ModuleCreationTransaction.h"
+#include "NewModule/ModuleDescriptorFileUtils.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace UE::ModuleGeneration
+{
+	TOperationResult<FModuleCreationRequest> MakeModuleCreationRequest(const FString& ProjectDirectory, const FString& Name, const FString& Type, const FString& LoadingPhase, const FString& OutputDirectory)
+	{
+		const EHostType::Type HostType = EHostType::FromString(*Type);
+		if (HostType == EHostType::Max)
+		{
+			return TOperationResult<FModuleCreationRequest>::MakeFailure(FString::Printf(TEXT("Module '%s' has invalid type '%s'"), *Name, *Type));
+		}
+		const ELoadingPhase::Type LoadingPhaseValue = ELoadingPhase::FromString(*LoadingPhase);
+		if (LoadingPhaseValue == ELoadingPhase::Max)
+		{
+			return TOperationResult<FModuleCreationRequest>::MakeFailure(FString::Printf(TEXT("Module '%s' has invalid loading phase '%s'"), *Name, *LoadingPhase));
+		}
+
+		FString FullOutputDirectory = FPaths::ConvertRelativePathToFull(ProjectDirectory, OutputDirectory);
+		FPaths::NormalizeDirectoryName(FullOutputDirectory);
+		FullOutputDirectory += TEXT("/");
+
+		return TOperationResult<FModuleCreationRequest>::MakeSuccess({ MoveTemp(FullOutputDirectory), FModuleDescriptor(FName(*Name), HostType, LoadingPhaseValue) });
+	}
+
+	TOperationResult<TArray<FModuleCreationRequest>> LoadModuleManifest(const FString& ManifestPath, const FString& ProjectDirectory)
+	{
+		FString FileContents;
+		if (!FFileHelper::LoadFileToString(FileContents, *ManifestPath))
+		{
+			return TOperationResult<TArray<FModuleCreationRequest>>::MakeFailure(FString::Printf(TEXT("Failed to read manifest file '%s'"), *ManifestPath));
+		}
+
+		TSharedPtr<FJsonObject> ManifestAsJson;
+		TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContents);
+		if (!FJsonSerializer::Deserialize(JsonReader, ManifestAsJson) || !ManifestAsJson.IsValid())
+		{
+			return TOperationResult<TArray<FModuleCreationRequest>>::MakeFailure(FString::Printf(TEXT("Failed to parse JSON from manifest file '%s'"), *ManifestPath));
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* ModulesAsJson;
+		if (!ManifestAsJson->TryGetArrayField(TEXT("Modules"), ModulesAsJson))
+		{
+			return TOperationResult<TArray<FModuleCreationRequest>>::MakeFailure(FString::Printf(TEXT("Manifest file '%s' has no 'Modules' array"), *ManifestPath));
+		}
+
+		TArray<FModuleCreationRequest> Result;
+		Result.Reserve(ModulesAsJson->Num());
+		for (const TSharedPtr<FJsonValue>& ModuleValue : *ModulesAsJson)
+		{
+			const TSharedPtr<FJsonObject>* ModuleAsJson;
+			FString Name;
+			if (!ModuleValue->TryGetObject(ModuleAsJson) || !(*ModuleAsJson)->TryGetStringField(TEXT("Name"), Name) || Name.IsEmpty())
+			{
+				return TOperationResult<TArray<FModuleCreationRequest>>::MakeFailure(FString::Printf(TEXT("Manifest file '%s' contains a module entry without a name"), *ManifestPath));
+			}
+
+			FString TypeString = EHostType::ToString(EHostType::Runtime);
+			FString LoadingPhaseString = ELoadingPhase::ToString(ELoadingPhase::Default);
+			FString OutputDirectory = TEXT("Source");
+			(*ModuleAsJson)->TryGetStringField(TEXT("Type"), TypeString);
+			(*ModuleAsJson)->TryGetStringField(TEXT("LoadingPhase"), LoadingPhaseString);
+			(*ModuleAsJson)->TryGetStringField(TEXT("OutputDirectory"), OutputDirectory);
+
+			TOperationResult<FModuleCreationRequest> RequestOp = MakeModuleCreationRequest(ProjectDirectory, Name, TypeString, LoadingPhaseString, OutputDirectory);
+			if (RequestOp.IsFailure())
+			{
+				return TOperationResult<TArray<FModuleCreationRequest>>::MakeFailure(RequestOp);
+			}
+			Result.Add(MoveTemp(RequestOp.OperationResult.GetValue()));
+		}
+		return TOperationResult<TArray<FModuleCreationRequest>>::MakeSuccess(MoveTemp(Result));
+	}
+
+	FPluginDirectoryIndex MakeProjectPluginDirectoryIndex(const FString& ProjectDirectory)
+	{
+		FPluginDirectoryIndex Result = FPluginDirectoryIndex::MakeFromPluginManager();
+		Result.AddPluginsInDirectory(FPaths::Combine(ProjectDirectory, TEXT("Plugins")));
+		Result.AddPluginsInDirectory(FPaths::Combine(ProjectDirectory, TEXT("Mods")));
+		return Result;
+	}
+
+	FOperationResult ValidateModuleRequests(TConstArrayView<FModuleCreationRequest> Requests)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		
+		TSet<FName> SeenNames;
+		SeenNames.Reserve(Requests.Num());
+		for (const FModuleCreationRequest& Request : Requests)
+		{
+			bool bIsAlreadyInSet = false;
+			SeenNames.Add(Request.Module.Name, &bIsAlreadyInSet);
+			if (bIsAlreadyInSet)
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Module '%s' is requested more than once"), *Request.Module.Name.ToString()));
+			}
+
+			const FString ModuleDirectory = FPaths::Combine(Request.OutputDirectory, Request.Module.Name.ToString());
+			if (FileManager.DirectoryExists(*ModuleDirectory))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("The target directory '%s' already exists"), *ModuleDirectory));
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	FModuleBatchResult CreateModules(const FModuleBatchSettings& Settings, TConstArrayView<FModuleCreationRequest> Requests)
+	{
+		FModuleBatchResult Result;
+		Result.Modules.SetNum(Requests.Num());
+
+		// Everything is written to staging directories and only moved into place if all modules succeed
+		FModuleCreationTransaction Transaction;
+		TArray<FString> StagingDirectories;
+		StagingDirectories.Reserve(Requests.Num());
+		for (const FModuleCreationRequest& Request : Requests)
+		{
+			const TOperationResult<FString> StageOp = Transaction.StageModule(Request.OutputDirectory, Request.Module.Name);
+			if (StageOp.IsFailure())
+			{
+				Result.TransactionError = StageOp.ErrorMessage;
+				Transaction.Rollback();
+				return Result;
+			}
+			StagingDirectories.Add(StageOp.OperationResult.GetValue());
+		}
+
+		// Instantiate all templates in parallel
+		const double InstantiateStartTime = FPlatformTime::Seconds();
+		FModuleTemplateOptions TemplateOptions;
+		TemplateOptions.CopyrightNotice = Settings.CopyrightNotice;
+		TemplateOptions.IncludeMap = Settings.IncludeMap;
+		TemplateOptions.BuildSettings = Settings.BuildSettings;
+		ParallelFor(Requests.Num(), [&Settings, &TemplateOptions, Requests, &StagingDirectories, &Result](int32 Index)
+		{
+			const double ModuleStartTime = FPlatformTime::Seconds();
+			FModuleTemplateOptions ModuleOptions = TemplateOptions;
+			ModuleOptions.SiblingModulesDirectory = Requests[Index].OutputDirectory;
+			const FOperationResult InstantiateOp = InstantiateModuleTemplate(Settings.ModuleTemplatePath, StagingDirectories[Index], Requests[Index].Module, ModuleOptions);
+			Result.Modules[Index].InstantiateSeconds = FPlatformTime::Seconds() - ModuleStartTime;
+			Result.Modules[Index].ErrorMessage = InstantiateOp.ErrorMessage;
+		});
+		Result.InstantiateSeconds = FPlatformTime::Seconds() - InstantiateStartTime;
+
+		// Group the modules by the descriptor they are added to
+		const double DescriptorStartTime = FPlatformTime::Seconds();
+		const TSharedRef<const FPluginDirectoryIndex> PluginIndex = Settings.PluginIndex.IsValid()
+			? Settings.PluginIndex.ToSharedRef()
+			: MakeShared<const FPluginDirectoryIndex>(MakeProjectPluginDirectoryIndex(Settings.ProjectDirectory));
+		TMap<FString, TArray<FModuleDescriptor>> ModulesByDescriptor;
+		for (int32 Index = 0; Index < Requests.Num(); ++Index)
+		{
+			const FModuleCreationRequest& Request = Requests[Index];
+			const TOperationResult<FString> DescriptorPath = FindModuleDescriptorFile(Settings.ProjectDirectory, *PluginIndex, Request.OutputDirectory);
+			if (DescriptorPath.IsFailure())
+			{
+				Result.Modules[Index].ErrorMessage = DescriptorPath.ErrorMessage;
+				continue;
+			}
+			ModulesByDescriptor.FindOrAdd(DescriptorPath.OperationResult.GetValue()).Add(Request.Module);
+		}
+
+		// Each descriptor is written exactly once
+		for (const TPair<FString, TArray<FModuleDescriptor>>& Pair : ModulesByDescriptor)
+		{
+			const FOperationResult StageDescriptorOp = Transaction.StageDescriptorUpdate(Pair.Key, Pair.Value);
+			if (StageDescriptorOp.IsFailure())
+			{
+				Result.TransactionError = StageDescriptorOp.ErrorMessage;
+				break;
+			}
+		}
+
+		const bool bAllModulesSucceeded = !Result.Modules.ContainsByPredicate([](const FModuleBatchResult::FModuleResult& ModuleResult) { return ModuleResult.ErrorMessage.IsSet(); });
+		if (bAllModulesSucceeded && !Result.TransactionError.IsSet())
+		{
+			Result.TransactionError = Transaction.Commit().ErrorMessage;
+		}
+		else
+		{
+			Transaction.Rollback();
+		}
+		Result.DescriptorSeconds = FPlatformTime::Seconds() - DescriptorStartTime;
+		Result.bIsCommitted = bAllModulesSucceeded && !Result.TransactionError.IsSet();
+		return Result;
+	}
+
+	void LogModuleBatchResult(TConstArrayView<FModuleCreationRequest> Requests, const FModuleBatchResult& Result)
+	{
+		for (int32 Index = 0; Index < Requests.Num(); ++Index)
+		{
+			const FModuleBatchResult::FModuleResult& ModuleResult = Result.Modules[Index];
+			if (ModuleResult.ErrorMessage.IsSet())
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("  %-32s FAILED (%.2f ms): %s"), *Requests[Index].Module.Name.ToString(), ModuleResult.InstantiateSeconds * 1000.0, *ModuleResult.ErrorMessage.GetValue());
+			}
+			else
+			{
+				UE_LOG(LogModuleGeneration, Display, TEXT("  %-32s %.2f ms"), *Requests[Index].Module.Name.ToString(), ModuleResult.InstantiateSeconds * 1000.0);
+			}
+		}
+		if (Result.TransactionError.IsSet())
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *Result.TransactionError.GetValue());
+		}
+		if (!Result.bIsCommitted)
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("No modules were created; all changes have been rolled back."));
+		}
+	}
+}
@@ -0,0 +1,218 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleBuildSettings.h"
+
+#include "ModuleGenerationTrace.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+#include "NewModule/SourceFileUtils.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Engine modules providing a shared PCH, from the one UnrealBuildTool prefers to the one it falls back to */
+	static const TCHAR* SharedPCHProviders[] = { TEXT("UnrealEd"), TEXT("Engine"), TEXT("Slate"), TEXT("CoreUObject"), TEXT("Core") };
+
+	static TSet<FString> FindModuleIncludes(const FString& ModuleDirectory, const FIncludeModuleMap& IncludeMap);
+
+	TConstArrayView<FModuleBuildVariant> GetModuleBuildVariants()
+	{
+		static const FModuleBuildVariant Variants[] =
+		{
+			{ DefaultModuleBuildVariantName, TEXT("Shared PCH once the module has enough files, unity builds as configured by the target"), { EModulePCHMode::Shared } },
+			{ TEXT("SharedPCH"), TEXT("Shared PCH for every file, however few there are"), { EModulePCHMode::Shared, {}, 1 } },
+			{ TEXT("PrivatePCH"), TEXT("Own PCH made of the headers the sibling modules include most"), { EModulePCHMode::Private, {}, 1 } },
+			{ TEXT("NoUnity"), TEXT("Shared PCH without unity builds, so touching one file recompiles only that file"), { EModulePCHMode::Shared, false, 1 } },
+			{ TEXT("NoPCH"), TEXT("No PCH; every file includes what it uses"), { EModulePCHMode::None } }
+		};
+		return Variants;
+	}
+
+	TOperationResult<FModuleBuildSettings> FindModuleBuildVariant(const FString& Name)
+	{
+		for (const FModuleBuildVariant& Variant : GetModuleBuildVariants())
+		{
+			if (Name.Equals(Variant.Name, ESearchCase::IgnoreCase))
+			{
+				return TOperationResult<FModuleBuildSettings>::MakeSuccess(Variant.Settings);
+			}
+		}
+		return TOperationResult<FModuleBuildSettings>::MakeFailure(FString::Printf(TEXT("There is no build variant called '%s'"), *Name));
+	}
+
+	FString FormatBuildSettings(const FModuleBuildSettings& Settings, const FString& ModuleName)
+	{
+		TArray<FString> Statements;
+		Statements.Add(Settings.PCHMode == EModulePCHMode::None
+			? TEXT("PCHUsage = ModuleRules.PCHUsageMode.NoPCHs;")
+			: TEXT("PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;"));
+		if (Settings.PCHMode == EModulePCHMode::Private)
+		{
+			Statements.Add(FString::Printf(TEXT("PrivatePCHHeaderFile = \"%s\";"), *GetPrivatePCHPath(ModuleName)));
+		}
+		if (Settings.MinFilesUsingPrecompiledHeader > 0)
+		{
+			Statements.Add(FString::Printf(TEXT("MinFilesUsingPrecompiledHeaderOverride = %d;"), Settings.MinFilesUsingPrecompiledHeader));
+		}
+		if (Settings.bUseUnity.IsSet())
+		{
+			Statements.Add(FString::Printf(TEXT("bUseUnity = %s;"), *Settings.bUseUnity ? TEXT("true") : TEXT("false")));
+		}
+		// The placeholder sits in the constructor body, two tabs deep, like the default template's
+		return FString::Join(Statements, TEXT("\n\t\t"));
+	}
+
+	bool RequiresIncludeMap(const FModuleBuildSettings& Settings, bool bMinimizeDependencies)
+	{
+		return bMinimizeDependencies || Settings.PCHMode == EModulePCHMode::Private;
+	}
+
+	FString GetPrivatePCHPath(const FString& ModuleName)
+	{
+		return FString::Printf(TEXT("Private/%sPCH.h"), *ModuleName);
+	}
+
+	FString FindSharedPCHProvider(TConstArrayView<FString> Dependencies)
+	{
+		for (const TCHAR* Provider : SharedPCHProviders)
+		{
+			if (Dependencies.Contains(Provider))
+			{
+				return Provider;
+			}
+		}
+		return FString();
+	}
+
+	TArray<FString> FindCommonSiblingIncludes(const FString& OutputDirectory, int32 MaxHeaders, const FIncludeModuleMap& IncludeMap)
+	{
+		// Only the modules right inside OutputDirectory are siblings, not those in nested folders
+		TArray<FIndexedSourceModule> SourceModules;
+		FindSourceModules(OutputDirectory, SourceModules);
+		FString ParentDirectory = OutputDirectory;
+		FPaths::NormalizeDirectoryName(ParentDirectory);
+		TArray<FString> ModuleDirectories;
+		for (FIndexedSourceModule& Module : SourceModules)
+		{
+			if (FPaths::IsSamePath(FPaths::GetPath(Module.Directory), ParentDirectory))
+			{
+				ModuleDirectories.Add(MoveTemp(Module.Directory));
+			}
+		}
+
+		// Modules are independent, so they are scanned concurrently
+		TArray<TSet<FString>> IncludesPerModule;
+		IncludesPerModule.SetNum(ModuleDirectories.Num());
+		ParallelFor(ModuleDirectories.Num(), [&ModuleDirectories, &IncludesPerModule, &IncludeMap](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(AnalyzeIncludes);
+			IncludesPerModule[Index] = FindModuleIncludes(ModuleDirectories[Index], IncludeMap);
+		});
+
+		TMap<FString, int32> NumModulesByInclude;
+		for (const TSet<FString>& Includes : IncludesPerModule)
+		{
+			for (const FString& Include : Includes)
+			{
+				++NumModulesByInclude.FindOrAdd(Include);
+			}
+		}
+
+		// CoreMinimal.h is always the first include of the PCH. Headers of the siblings themselves would make the new module depend
+		// on project modules next to it, so only engine and plugin modules contribute.
+		const int32 MinModules = ModuleDirectories.Num() > 1 ? 2 : 1;
+		TArray<TPair<FString, int32>> Candidates;
+		for (const TPair<FString, int32>& Pair : NumModulesByInclude)
+		{
+			const FIndexedSourceModule* Provider = IncludeMap.FindModuleForInclude(Pair.Key);
+			const bool bIsSiblingHeader = Provider && FPaths::IsUnderDirectory(Provider->Directory, OutputDirectory);
+			if (Pair.Value >= MinModules && !bIsSiblingHeader && !Pair.Key.Equals(TEXT("CoreMinimal.h"), ESearchCase::IgnoreCase))
+			{
+				Candidates.Add(Pair);
+			}
+		}
+		Candidates.Sort([](const TPair<FString, int32>& Left, const TPair<FString, int32>& Right)
+		{
+			return Left.Value != Right.Value ? Left.Value > Right.Value : Left.Key < Right.Key;
+		});
+
+		TArray<FString> Result;
+		for (int32 Index = 0; Index < Candidates.Num() && Index < MaxHeaders; ++Index)
+		{
+			Result.Add(MoveTemp(Candidates[Index].Key));
+		}
+		return Result;
+	}
+
+	FString MakePrivatePCHContents(const FString& CopyrightNotice, TConstArrayView<FString> Includes)
+	{
+		TStringBuilder<1024> Builder;
+		Builder.Appendf(TEXT("// %s\n\n#pragma once\n\n#include \"CoreMinimal.h\"\n"), *CopyrightNotice);
+		if (Includes.Num() > 0)
+		{
+			Builder.Append(TEXT("\n// Included by most modules next to this one\n"));
+			for (const FString& Include : Includes)
+			{
+				Builder.Appendf(TEXT("#include \"%s\"\n"), *Include);
+			}
+		}
+		return Builder.ToString();
+	}
+
+	static TSet<FString> FindModuleIncludes(const FString& ModuleDirectory, const FIncludeModuleMap& IncludeMap)
+	{
+		TArray<FString> RelativePaths;
+		const int32 PrefixLength = ModuleDirectory.Len() + 1;
+		IFileManager::Get().IterateDirectoryRecursively(*ModuleDirectory, [&RelativePaths, PrefixLength](const TCHAR* Path, bool bIsDirectory)
+		{
+			if (!bIsDirectory && IsSourceFile(Path))
+			{
+				FString RelativePath = FString(Path).RightChop(PrefixLength);
+				FPaths::NormalizeFilename(RelativePath);
+				RelativePaths.Add(MoveTemp(RelativePath));
+			}
+			return true;
+		});
+
+		// The module's own headers as it can include them
+		TSet<FString> OwnIncludes;
+		for (const FString& RelativePath : RelativePaths)
+		{
+			OwnIncludes.Add(RelativePath);
+			for (const TCHAR* IncludeDirectoryName : ModuleIncludeDirectoryNames)
+			{
+				if (RelativePath.StartsWith(IncludeDirectoryName, ESearchCase::IgnoreCase))
+				{
+					OwnIncludes.Add(RelativePath.RightChop(FCString::Strlen(IncludeDirectoryName)));
+				}
+			}
+		}
+
+		TSet<FString> Result;
+		FString Contents;
+		for (const FString& RelativePath : RelativePaths)
+		{
+			if (!FFileHelper::LoadFileToString(Contents, *FPaths::Combine(ModuleDirectory, RelativePath)))
+			{
+				continue;
+			}
+			for (FParsedInclude& Include : ParseIncludes(Contents))
+			{
+				FPaths::NormalizeFilename(Include.Path);
+				const bool bIsCandidate = !Include.Path.StartsWith(TEXT("."))
+					&& !Include.Path.EndsWith(TEXT(".generated.h"), ESearchCase::IgnoreCase)
+					&& !OwnIncludes.Contains(Include.Path)
+					&& IncludeMap.FindModuleForInclude(Include.Path) != nullptr;
+				if (bIsCandidate)
+				{
+					Result.Add(MoveTemp(Include.Path));
+				}
+			}
+		}
+		return Result;
+	}
+}
@@ -0,0 +1,292 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleCreationPlan.h"
+
+#include "Algo/Reverse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace ELineDiffOp
+	{
+		enum Type : uint8
+		{
+			Keep,
+			Remove,
+			Add
+		};
+	}
+
+	/** Beyond this many added and removed lines, the changed part of a file is shown as replaced instead of being aligned */
+	static constexpr int32 MaxLineDiffEdits = 2000;
+
+	static void AppendLineDiff(FStringBuilderBase& Builder, const TArray<uint8>& OriginalContents, const TArray<uint8>& NewContents);
+	/** @return The shortest edit script turning OriginalLines into NewLines, one op per kept, removed or added line */
+	static TArray<ELineDiffOp::Type> DiffLines(TConstArrayView<FString> OriginalLines, TConstArrayView<FString> NewLines);
+
+	int32 FModuleCreationPlan::GetNumFiles() const
+	{
+		int32 Result = DescriptorUpdates.Num() + SourceUpdates.Num();
+		for (const FPlannedModule& Module : Modules)
+		{
+			Result += Module.Files.Num();
+		}
+		return Result;
+	}
+
+	FString FModuleCreationPlan::Describe() const
+	{
+		TStringBuilder<4096> Builder;
+		for (const FPlannedModule& Module : Modules)
+		{
+			Builder.Appendf(TEXT("Module %s\n"), *Module.ModuleName.ToString());
+			for (const FString& RelativeDirectory : Module.RelativeDirectories)
+			{
+				Builder.Appendf(TEXT("  + %s/\n"), *FPaths::Combine(Module.OutputDirectory, RelativeDirectory));
+			}
+			for (const FPlannedFile& File : Module.Files)
+			{
+				Builder.Appendf(TEXT("  + %s (%lld bytes)\n"), *FPaths::Combine(Module.OutputDirectory, File.RelativePath), File.GetSize());
+			}
+			if (Module.Dependencies)
+			{
+				Builder.Appendf(TEXT("  Public dependencies: %s\n"), *FormatDependencyList(Module.Dependencies->PublicDependencies));
+				Builder.Appendf(TEXT("  Private dependencies: %s\n"), *FormatDependencyList(Module.Dependencies->PrivateDependencies));
+				for (const FString& Include : Module.Dependencies->UnresolvedIncludes)
+				{
+					Builder.Appendf(TEXT("  ? %s (not provided by any indexed module)\n"), *Include);
+				}
+			}
+			if (!Module.SharedPCHProvider.IsEmpty())
+			{
+				Builder.Appendf(TEXT("  Shared PCH: %s\n"), *Module.SharedPCHProvider);
+			}
+			Builder.AppendChar(TEXT('\n'));
+		}
+
+		for (const FPlannedDescriptorUpdate& Update : DescriptorUpdates)
+		{
+			Builder.Appendf(TEXT("%s\n"), *Update.DescriptorPath);
+			AppendLineDiff(Builder, Update.OriginalContents, Update.NewContents);
+			Builder.AppendChar(TEXT('\n'));
+		}
+
+		for (const FPlannedSourceUpdate& Update : SourceUpdates)
+		{
+			if (!Update.NewContents)
+			{
+				Builder.Appendf(TEXT("- %s (moved)\n"), *Update.Path);
+				continue;
+			}
+			Builder.Appendf(TEXT("%s\n"), *Update.Path);
+			AppendLineDiff(Builder, Update.OriginalContents, Update.NewContents.GetValue());
+		}
+		if (Extraction)
+		{
+			Builder.Appendf(TEXT("\nMoved %d files out of %s.\n"), Extraction->NumMovedFiles, *Extraction->SourceModuleName);
+			Builder.Appendf(TEXT("%d of the %d translation units remaining in %s include none of the moved headers.\n"),
+				Extraction->NumIndependentTranslationUnits, Extraction->NumRemainingTranslationUnits, *Extraction->SourceModuleName);
+			if (Extraction->DependentModules.Num() > 0)
+			{
+				Builder.Appendf(TEXT("Modules depending on the new module: %s\n"), *FString::Join(Extraction->DependentModules, TEXT(", ")));
+			}
+			for (const FString& Include : Extraction->IncludesOfSourceModule)
+			{
+				Builder.Appendf(TEXT("  ! Moved files still include %s of %s\n"), *Include, *Extraction->SourceModuleName);
+			}
+			for (const FString& Type : Extraction->RedirectedTypes)
+			{
+				Builder.Appendf(TEXT("  Redirected %s\n"), *Type);
+			}
+			// The editor keeps running the moved code from the source module's binary until it is rebuilt
+			Builder.Append(TEXT("Close the editor and rebuild the project afterwards.\n"));
+		}
+		return Builder.ToString();
+	}
+
+	static void AppendLineDiff(FStringBuilderBase& Builder, const TArray<uint8>& OriginalContents, const TArray<uint8>& NewContents)
+	{
+		FString OriginalText, NewText;
+		FFileHelper::BufferToString(OriginalText, OriginalContents.GetData(), OriginalContents.Num());
+		FFileHelper::BufferToString(NewText, NewContents.GetData(), NewContents.Num());
+		TArray<FString> OriginalLines, NewLines;
+		OriginalText.ParseIntoArrayLines(OriginalLines, false);
+		NewText.ParseIntoArrayLines(NewLines, false);
+
+		const TArray<ELineDiffOp::Type> Ops = DiffLines(OriginalLines, NewLines);
+		if (!Ops.ContainsByPredicate([](ELineDiffOp::Type Op) { return Op != ELineDiffOp::Keep; }))
+		{
+			Builder.Append(TEXT("  (unchanged)\n"));
+			return;
+		}
+
+		// Line indices before each op, so hunks can start anywhere
+		TArray<int32> OriginalIndices, NewIndices;
+		OriginalIndices.SetNumUninitialized(Ops.Num() + 1);
+		NewIndices.SetNumUninitialized(Ops.Num() + 1);
+		OriginalIndices[0] = NewIndices[0] = 0;
+		for (int32 Pos = 0; Pos < Ops.Num(); ++Pos)
+		{
+			OriginalIndices[Pos + 1] = OriginalIndices[Pos] + (Ops[Pos] != ELineDiffOp::Add ? 1 : 0);
+			NewIndices[Pos + 1] = NewIndices[Pos] + (Ops[Pos] != ELineDiffOp::Remove ? 1 : 0);
+		}
+
+		// Unified diff hunks; changes separated by at most twice the context share a hunk
+		constexpr int32 NumContextLines = 1;
+		int32 Pos = 0;
+		while (Pos < Ops.Num())
+		{
+			while (Pos < Ops.Num() && Ops[Pos] == ELineDiffOp::Keep)
+			{
+				++Pos;
+			}
+			if (Pos == Ops.Num())
+			{
+				break;
+			}
+
+			const int32 HunkStart = FMath::Max(0, Pos - NumContextLines);
+			int32 ChangesEnd = Pos;
+			for (;;)
+			{
+				while (ChangesEnd < Ops.Num() && Ops[ChangesEnd] != ELineDiffOp::Keep)
+				{
+					++ChangesEnd;
+				}
+				int32 NextChange = ChangesEnd;
+				while (NextChange < Ops.Num() && Ops[NextChange] == ELineDiffOp::Keep)
+				{
+					++NextChange;
+				}
+				if (NextChange == Ops.Num() || NextChange - ChangesEnd > 2 * NumContextLines)
+				{
+					break;
+				}
+				ChangesEnd = NextChange;
+			}
+			const int32 HunkEnd = FMath::Min(Ops.Num(), ChangesEnd + NumContextLines);
+
+			// Like diff -u, an empty range starts at the line before it
+			const int32 NumOriginal = OriginalIndices[HunkEnd] - OriginalIndices[HunkStart];
+			const int32 NumNew = NewIndices[HunkEnd] - NewIndices[HunkStart];
+			Builder.Appendf(TEXT("  @@ -%d,%d +%d,%d @@\n"),
+				OriginalIndices[HunkStart] + (NumOriginal > 0 ? 1 : 0), NumOriginal,
+				NewIndices[HunkStart] + (NumNew > 0 ? 1 : 0), NumNew);
+			for (int32 HunkPos = HunkStart; HunkPos < HunkEnd; ++HunkPos)
+			{
+				switch (Ops[HunkPos])
+				{
+				case ELineDiffOp::Keep: Builder.Appendf(TEXT("    %s\n"), *OriginalLines[OriginalIndices[HunkPos]]); break;
+				case ELineDiffOp::Remove: Builder.Appendf(TEXT("  - %s\n"), *OriginalLines[OriginalIndices[HunkPos]]); break;
+				case ELineDiffOp::Add: Builder.Appendf(TEXT("  + %s\n"), *NewLines[NewIndices[HunkPos]]); break;
+				}
+			}
+			Pos = HunkEnd;
+		}
+	}
+
+	static TArray<ELineDiffOp::Type> DiffLines(TConstArrayView<FString> OriginalLines, TConstArrayView<FString> NewLines)
+	{
+		// The common prefix and suffix are cheap to find and usually cover most of the file
+		int32 NumCommonLeading = 0;
+		const int32 MaxCommon = FMath::Min(OriginalLines.Num(), NewLines.Num());
+		while (NumCommonLeading < MaxCommon && OriginalLines[NumCommonLeading].Equals(NewLines[NumCommonLeading], ESearchCase::CaseSensitive))
+		{
+			++NumCommonLeading;
+		}
+		int32 NumCommonTrailing = 0;
+		while (NumCommonTrailing < MaxCommon - NumCommonLeading
+			&& OriginalLines[OriginalLines.Num() - 1 - NumCommonTrailing].Equals(NewLines[NewLines.Num() - 1 - NumCommonTrailing], ESearchCase::CaseSensitive))
+		{
+			++NumCommonTrailing;
+		}
+		const TConstArrayView<FString> Original = OriginalLines.Slice(NumCommonLeading, OriginalLines.Num() - NumCommonLeading - NumCommonTrailing);
+		const TConstArrayView<FString> New = NewLines.Slice(NumCommonLeading, NewLines.Num() - NumCommonLeading - NumCommonTrailing);
+
+		TArray<ELineDiffOp::Type> Result;
+		Result.Reserve(OriginalLines.Num() + New.Num());
+		Result.Init(ELineDiffOp::Keep, NumCommonLeading);
+
+		// Myers' algorithm: V[K] is the furthest original line reached on diagonal K = X - Y with D edits. The V of every D is kept
+		// to walk the shortest edit script back; only diagonals -D..D are stored, so memory grows with the square of the edit distance.
+		const int32 N = Original.Num();
+		const int32 M = New.Num();
+		const int32 MaxEdits = FMath::Min(N + M, MaxLineDiffEdits);
+		TArray<int32> V;
+		V.SetNumZeroed(2 * MaxEdits + 3);
+		const int32 Center = MaxEdits + 1;
+		TArray<TArray<int32>> History;
+		int32 NumEdits = INDEX_NONE;
+		for (int32 D = 0; D <= MaxEdits && NumEdits == INDEX_NONE; ++D)
+		{
+			History.Emplace(V.GetData() + Center - D, 2 * D + 1);
+			for (int32 K = -D; K <= D; K += 2)
+			{
+				int32 X = K == -D || (K != D && V[Center + K - 1] < V[Center + K + 1]) ? V[Center + K + 1] : V[Center + K - 1] + 1;
+				int32 Y = X - K;
+				while (X < N && Y < M && Original[X].Equals(New[Y], ESearchCase::CaseSensitive))
+				{
+					++X;
+					++Y;
+				}
+				V[Center + K] = X;
+				if (X >= N && Y >= M)
+				{
+					NumEdits = D;
+					break;
+				}
+			}
+		}
+
+		if (NumEdits == INDEX_NONE)
+		{
+			// Too different to be worth aligning; show the changed range as replaced
+			for (int32 Index = 0; Index < N; ++Index)
+			{
+				Result.Add(ELineDiffOp::Remove);
+			}
+			for (int32 Index = 0; Index < M; ++Index)
+			{
+				Result.Add(ELineDiffOp::Add);
+			}
+		}
+		else
+		{
+			TArray<ELineDiffOp::Type> Script;
+			int32 X = N;
+			int32 Y = M;
+			for (int32 D = NumEdits; D > 0; --D)
+			{
+				// History[D] holds diagonals -D..D of the V that step D started from
+				const TArray<int32>& PreviousV = History[D];
+				const auto GetPrevious = [&PreviousV, D](int32 K) { return PreviousV[K + D]; };
+				const int32 K = X - Y;
+				const int32 PreviousK = K == -D || (K != D && GetPrevious(K - 1) < GetPrevious(K + 1)) ? K + 1 : K - 1;
+				const int32 PreviousX = GetPrevious(PreviousK);
+				const int32 PreviousY = PreviousX - PreviousK;
+				while (X > PreviousX && Y > PreviousY)
+				{
+					Script.Add(ELineDiffOp::Keep);
+					--X;
+					--Y;
+				}
+				Script.Add(X == PreviousX ? ELineDiffOp::Add : ELineDiffOp::Remove);
+				X = PreviousX;
+				Y = PreviousY;
+			}
+			for (; X > 0; --X)
+			{
+				Script.Add(ELineDiffOp::Keep);
+			}
+			Algo::Reverse(Script);
+			Result.Append(Script);
+		}
+
+		for (int32 Index = 0; Index < NumCommonTrailing; ++Index)
+		{
+			Result.Add(ELineDiffOp::Keep);
+		}
+		return Result;
+	}
+}
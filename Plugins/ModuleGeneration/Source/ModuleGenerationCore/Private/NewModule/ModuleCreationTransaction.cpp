@@ -0,0 +1,286 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleCreationTransaction.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/ModuleDescriptorFileUtils.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include "Windows/WindowsHWrapper.h"
+	#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+namespace UE::ModuleGeneration
+{
+	static bool MoveDirectory(const FString& Destination, const FString& Source);
+	static bool ReplaceFileAtomically(const FString& Destination, const FString& Source);
+
+	FModuleCreationTransaction::FModuleCreationTransaction()
+		: TransactionId(FGuid::NewGuid())
+	{}
+
+	FModuleCreationTransaction::~FModuleCreationTransaction()
+	{
+		if (!bIsFinished)
+		{
+			Rollback();
+		}
+	}
+
+	TOperationResult<FString> FModuleCreationTransaction::StageModule(const FString& OutputDirectory, FName ModuleName)
+	{
+		check(!bIsFinished);
+		
+		const FString ModuleNameString = ModuleName.ToString();
+		const FString FinalModuleDirectory = FPaths::Combine(OutputDirectory, ModuleNameString);
+		if (IFileManager::Get().DirectoryExists(*FinalModuleDirectory))
+		{
+			return TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("The target directory '%s' already exists"), *FinalModuleDirectory));
+		}
+		
+		// Sibling of the final directory so committing is a rename on the same volume
+		const FString StagingDirectory = FPaths::Combine(OutputDirectory, FString::Printf(TEXT(".%s.%s.staging"), *ModuleNameString, *TransactionId.ToString(EGuidFormats::Short)));
+		if (!IFileManager::Get().MakeDirectory(*StagingDirectory, true))
+		{
+			return TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("Failed to create staging directory '%s'"), *StagingDirectory));
+		}
+
+		FStagedModule& StagedModule = StagedModules.AddDefaulted_GetRef();
+		StagedModule.StagingDirectory = StagingDirectory;
+		StagedModule.StagedModuleDirectory = FPaths::Combine(StagingDirectory, ModuleNameString);
+		StagedModule.FinalModuleDirectory = FinalModuleDirectory;
+		return TOperationResult<FString>::MakeSuccess(StagingDirectory);
+	}
+
+	FOperationResult FModuleCreationTransaction::StageDescriptorUpdate(const FString& DescriptorPath, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		check(!bIsFinished);
+
+		const TOperationResult<FPlannedDescriptorUpdate> PlanOp = PlanDescriptorUpdate(DescriptorPath, NewModules);
+		if (PlanOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(PlanOp);
+		}
+		return StagePlannedDescriptorUpdate(PlanOp.OperationResult.GetValue());
+	}
+
+	FOperationResult FModuleCreationTransaction::StagePlannedModule(const FPlannedModule& Module)
+	{
+		const TOperationResult<FString> StagingDirectory = StageModule(Module.OutputDirectory, Module.ModuleName);
+		if (StagingDirectory.IsFailure())
+		{
+			return FOperationResult::MakeFailure(StagingDirectory);
+		}
+		return WritePlannedModule(Module, StagingDirectory.OperationResult.GetValue());
+	}
+
+	FOperationResult FModuleCreationTransaction::StagePlannedDescriptorUpdate(const FPlannedDescriptorUpdate& Update)
+	{
+		check(!bIsFinished);
+
+		// Plans made from contents in memory have no timestamp
+		if (Update.OriginalTimestamp != FDateTime() && IFileManager::Get().GetTimeStamp(*Update.DescriptorPath) != Update.OriginalTimestamp)
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Config file '%s' was modified after the changes were planned"), *Update.DescriptorPath));
+		}
+
+		FStagedDescriptor StagedDescriptor;
+		StagedDescriptor.DescriptorPath = Update.DescriptorPath;
+		StagedDescriptor.StagedDescriptorPath = FString::Printf(TEXT("%s.%s.staging"), *Update.DescriptorPath, *TransactionId.ToString(EGuidFormats::Short));
+		StagedDescriptor.OriginalContents = Update.OriginalContents;
+
+		// Register before writing so rollback also removes partially written copies
+		const int32 Index = StagedDescriptors.Add(MoveTemp(StagedDescriptor));
+		
+		MODULEGENERATION_TIMED_SCOPE(WriteDescriptor);
+		if (!FFileHelper::SaveArrayToFile(Update.NewContents, *StagedDescriptors[Index].StagedDescriptorPath))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write config file '%s'"), *StagedDescriptors[Index].StagedDescriptorPath));
+		}
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::FilesWritten, 1);
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::BytesWritten, Update.NewContents.Num());
+		return FOperationResult::MakeSuccess();
+	}
+
+	FOperationResult FModuleCreationTransaction::StagePlannedSourceUpdate(const FPlannedSourceUpdate& Update)
+	{
+		check(!bIsFinished);
+
+		if (IFileManager::Get().GetTimeStamp(*Update.Path) != Update.OriginalTimestamp)
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("File '%s' was modified after the changes were planned"), *Update.Path));
+		}
+
+		FStagedSourceFile StagedSourceFile;
+		StagedSourceFile.Path = Update.Path;
+		StagedSourceFile.StagedPath = Update.NewContents ? FString::Printf(TEXT("%s.%s.staging"), *Update.Path, *TransactionId.ToString(EGuidFormats::Short)) : FString();
+		StagedSourceFile.OriginalContents = Update.OriginalContents;
+		const int32 Index = StagedSourceFiles.Add(MoveTemp(StagedSourceFile));
+		if (!Update.NewContents)
+		{
+			return FOperationResult::MakeSuccess();
+		}
+
+		MODULEGENERATION_TIMED_SCOPE(WriteFiles);
+		if (!FFileHelper::SaveArrayToFile(Update.NewContents.GetValue(), *StagedSourceFiles[Index].StagedPath))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write '%s'"), *StagedSourceFiles[Index].StagedPath));
+		}
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::FilesWritten, 1);
+		FModuleCreationTimings::Get().AddCount(ETimedCounter::BytesWritten, Update.NewContents->Num());
+		return FOperationResult::MakeSuccess();
+	}
+
+	FOperationResult FModuleCreationTransaction::StagePlan(const FModuleCreationPlan& Plan)
+	{
+		for (const FPlannedModule& Module : Plan.Modules)
+		{
+			const FOperationResult StageOp = StagePlannedModule(Module);
+			if (StageOp.IsFailure())
+			{
+				return StageOp;
+			}
+		}
+		for (const FPlannedDescriptorUpdate& Update : Plan.DescriptorUpdates)
+		{
+			const FOperationResult StageOp = StagePlannedDescriptorUpdate(Update);
+			if (StageOp.IsFailure())
+			{
+				return StageOp;
+			}
+		}
+		for (const FPlannedSourceUpdate& Update : Plan.SourceUpdates)
+		{
+			const FOperationResult StageOp = StagePlannedSourceUpdate(Update);
+			if (StageOp.IsFailure())
+			{
+				return StageOp;
+			}
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	FOperationResult FModuleCreationTransaction::Commit()
+	{
+		MODULEGENERATION_TIMED_SCOPE(Commit);
+		check(!bIsFinished);
+
+		for (FStagedModule& StagedModule : StagedModules)
+		{
+			if (IFileManager::Get().DirectoryExists(*StagedModule.FinalModuleDirectory))
+			{
+				Rollback();
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("The target directory '%s' already exists"), *StagedModule.FinalModuleDirectory));
+			}
+			if (!MoveDirectory(StagedModule.FinalModuleDirectory, StagedModule.StagedModuleDirectory))
+			{
+				Rollback();
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to move '%s' to '%s'"), *StagedModule.StagedModuleDirectory, *StagedModule.FinalModuleDirectory));
+			}
+			StagedModule.bIsCommitted = true;
+		}
+
+		// Moved files are removed only once their copies are in place
+		IFileManager& FileManager = IFileManager::Get();
+		for (FStagedSourceFile& StagedSourceFile : StagedSourceFiles)
+		{
+			const bool bIsReplaced = StagedSourceFile.StagedPath.IsEmpty()
+				? FileManager.Delete(*StagedSourceFile.Path, false, true, true)
+				: ReplaceFileAtomically(StagedSourceFile.Path, StagedSourceFile.StagedPath);
+			if (!bIsReplaced)
+			{
+				Rollback();
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to replace or remove '%s'"), *StagedSourceFile.Path));
+			}
+			StagedSourceFile.bIsCommitted = true;
+		}
+
+		// Descriptors go last: once they reference the new modules, the module files are already in place
+		for (FStagedDescriptor& StagedDescriptor : StagedDescriptors)
+		{
+			if (!ReplaceFileAtomically(StagedDescriptor.DescriptorPath, StagedDescriptor.StagedDescriptorPath))
+			{
+				Rollback();
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to replace config file '%s'"), *StagedDescriptor.DescriptorPath));
+			}
+			StagedDescriptor.bIsCommitted = true;
+		}
+
+		for (const FStagedModule& StagedModule : StagedModules)
+		{
+			FileManager.DeleteDirectory(*StagedModule.StagingDirectory, false, true);
+		}
+		
+		bIsFinished = true;
+		return FOperationResult::MakeSuccess();
+	}
+
+	void FModuleCreationTransaction::Rollback()
+	{
+		if (bIsFinished)
+		{
+			return;
+		}
+		bIsFinished = true;
+
+		IFileManager& FileManager = IFileManager::Get();
+		for (int32 Index = StagedDescriptors.Num() - 1; Index >= 0; --Index)
+		{
+			const FStagedDescriptor& StagedDescriptor = StagedDescriptors[Index];
+			if (StagedDescriptor.bIsCommitted && !FFileHelper::SaveArrayToFile(StagedDescriptor.OriginalContents, *StagedDescriptor.DescriptorPath))
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("Failed to restore config file '%s' while rolling back"), *StagedDescriptor.DescriptorPath);
+			}
+			FileManager.Delete(*StagedDescriptor.StagedDescriptorPath, false, false, true);
+		}
+		
+		for (int32 Index = StagedSourceFiles.Num() - 1; Index >= 0; --Index)
+		{
+			const FStagedSourceFile& StagedSourceFile = StagedSourceFiles[Index];
+			if (StagedSourceFile.bIsCommitted && !FFileHelper::SaveArrayToFile(StagedSourceFile.OriginalContents, *StagedSourceFile.Path))
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("Failed to restore '%s' while rolling back"), *StagedSourceFile.Path);
+			}
+			if (!StagedSourceFile.StagedPath.IsEmpty())
+			{
+				FileManager.Delete(*StagedSourceFile.StagedPath, false, false, true);
+			}
+		}
+		
+		for (int32 Index = StagedModules.Num() - 1; Index >= 0; --Index)
+		{
+			const FStagedModule& StagedModule = StagedModules[Index];
+			if (StagedModule.bIsCommitted && !FileManager.DeleteDirectory(*StagedModule.FinalModuleDirectory, false, true))
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("Failed to delete '%s' while rolling back"), *StagedModule.FinalModuleDirectory);
+			}
+			FileManager.DeleteDirectory(*StagedModule.StagingDirectory, false, true);
+		}
+	}
+
+	static bool MoveDirectory(const FString& Destination, const FString& Source)
+	{
+		// A plain rename since both directories are on the same volume
+		return FPlatformFileManager::Get().GetPlatformFile().MoveFile(*Destination, *Source);
+	}
+
+	static bool ReplaceFileAtomically(const FString& Destination, const FString& Source)
+	{
+#if PLATFORM_WINDOWS
+		const FString FullSource = FPaths::ConvertRelativePathToFull(Source);
+		const FString FullDestination = FPaths::ConvertRelativePathToFull(Destination);
+		return ::MoveFileExW(*FullSource, *FullDestination, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		// rename(2) replaces the destination atomically
+		return FPlatformFileManager::Get().GetPlatformFile().MoveFile(*Destination, *Source);
+#endif
+	}
+}
@@ -0,0 +1,285 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleDependencyAnalysis.h"
+
+#include "ModuleGenerationTrace.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/SourceFileUtils.h"
+
+#include "Async/ParallelFor.h"
+#include "Misc/Paths.h"
+#include "String/Find.h"
+
+namespace UE::ModuleGeneration
+{
+	static FString StripComments(FStringView Line, bool& bIsInBlockComment);
+	static TOptional<FParsedInclude> ParseIncludeDirective(FStringView Code);
+	static FString NormalizeSourcePath(FString Path);
+
+	TArray<FParsedInclude> ParseIncludes(FStringView Contents)
+	{
+		TArray<FParsedInclude> Result;
+		bool bIsInBlockComment = false;
+		int32 LineStart = 0;
+		while (LineStart < Contents.Len())
+		{
+			int32 LineEnd = LineStart;
+			while (LineEnd < Contents.Len() && Contents[LineEnd] != TEXT('\n'))
+			{
+				++LineEnd;
+			}
+
+			const FString Code = StripComments(Contents.Mid(LineStart, LineEnd - LineStart), bIsInBlockComment);
+			if (TOptional<FParsedInclude> Include = ParseIncludeDirective(Code))
+			{
+				Result.Add(MoveTemp(Include.GetValue()));
+			}
+			LineStart = LineEnd + 1;
+		}
+		return Result;
+	}
+
+	bool RewriteIncludes(FString& Contents, TFunctionRef<TOptional<FString>(int32 IncludeIndex, const FParsedInclude& Include)> NewPathForInclude)
+	{
+		TStringBuilder<4096> Result;
+		bool bIsInBlockComment = false;
+		bool bHasReplaced = false;
+		int32 IncludeIndex = 0;
+		int32 LineStart = 0;
+		while (LineStart < Contents.Len())
+		{
+			int32 LineEnd = LineStart;
+			while (LineEnd < Contents.Len() && Contents[LineEnd] != TEXT('\n'))
+			{
+				++LineEnd;
+			}
+
+			const FStringView Line = FStringView(Contents).Mid(LineStart, LineEnd - LineStart);
+			const FString Code = StripComments(Line, bIsInBlockComment);
+			const TOptional<FParsedInclude> Include = ParseIncludeDirective(Code);
+			const TOptional<FString> NewPath = Include ? NewPathForInclude(IncludeIndex++, Include.GetValue()) : TOptional<FString>();
+
+			// The path is the first quoted or bracketed text of the line since comments cannot precede the directive
+			const FString OldSpelling = Include ? FString::Printf(Include->bIsQuoted ? TEXT("\"%s\"") : TEXT("<%s>"), *Include->Path) : FString();
+			const int32 SpellingStart = NewPath ? UE::String::FindFirst(Line, OldSpelling) : INDEX_NONE;
+			if (SpellingStart != INDEX_NONE && NewPath.GetValue() != Include->Path)
+			{
+				Result.Append(Line.Left(SpellingStart));
+				Result.Appendf(Include->bIsQuoted ? TEXT("\"%s\"") : TEXT("<%s>"), *NewPath.GetValue());
+				Result.Append(Line.RightChop(SpellingStart + OldSpelling.Len()));
+				bHasReplaced = true;
+			}
+			else
+			{
+				Result.Append(Line);
+			}
+			if (LineEnd < Contents.Len())
+			{
+				Result.AppendChar(TEXT('\n'));
+			}
+			LineStart = LineEnd + 1;
+		}
+
+		if (bHasReplaced)
+		{
+			Contents = Result.ToString();
+		}
+		return bHasReplaced;
+	}
+
+	bool IsPublicSourcePath(FStringView RelativePath)
+	{
+		for (int32 Index = 0; Index < NumPublicIncludeDirectories; ++Index)
+		{
+			if (RelativePath.StartsWith(ModuleIncludeDirectoryNames[Index], ESearchCase::IgnoreCase))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	FModuleDependencies AnalyzeModuleDependencies(const FIncludeModuleMap& IncludeMap, const FString& ModuleName, TConstArrayView<FSourceFileToAnalyze> Files)
+	{
+		// The module's own files, to resolve includes relative to the including file, and its headers relative to its include folders
+		TSet<FString> OwnFiles;
+		TSet<FString> OwnIncludes;
+		for (const FSourceFileToAnalyze& File : Files)
+		{
+			const FString Path = NormalizeSourcePath(File.Path);
+			OwnFiles.Add(Path);
+			for (const TCHAR* IncludeDirectoryName : ModuleIncludeDirectoryNames)
+			{
+				if (FPaths::IsRelative(Path) && Path.StartsWith(IncludeDirectoryName, ESearchCase::IgnoreCase))
+				{
+					OwnIncludes.Add(Path.RightChop(FCString::Strlen(IncludeDirectoryName)));
+				}
+			}
+		}
+
+		TArray<TArray<FParsedInclude>> IncludesPerFile;
+		IncludesPerFile.SetNum(Files.Num());
+		ParallelFor(Files.Num(), [&Files, &IncludesPerFile](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(AnalyzeIncludes);
+			IncludesPerFile[Index] = ParseIncludes(Files[Index].Contents);
+		});
+
+		TSet<FString> PublicDependencies;
+		TSet<FString> AllDependencies;
+		TSet<FString> UnresolvedIncludes;
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			const FSourceFileToAnalyze& File = Files[FileIndex];
+			const FString FileDirectory = FPaths::GetPath(File.Path);
+			for (const FParsedInclude& Include : IncludesPerFile[FileIndex])
+			{
+				const FString IncludePath = NormalizeSourcePath(Include.Path);
+				const bool bIsOwnFile = OwnIncludes.Contains(IncludePath)
+					|| (Include.bIsQuoted && OwnFiles.Contains(NormalizeSourcePath(FPaths::Combine(FileDirectory, IncludePath))));
+				if (bIsOwnFile)
+				{
+					continue;
+				}
+
+				FString Dependency;
+				if (IncludePath.EndsWith(TEXT(".generated.h"), ESearchCase::IgnoreCase))
+				{
+					Dependency = TEXT("CoreUObject");
+				}
+				else if (const FIndexedSourceModule* Module = IncludeMap.FindModuleForInclude(IncludePath))
+				{
+					Dependency = Module->Name;
+				}
+				else
+				{
+					if (Include.bIsQuoted)
+					{
+						UnresolvedIncludes.Add(IncludePath);
+					}
+					continue;
+				}
+
+				if (Dependency != ModuleName)
+				{
+					AllDependencies.Add(Dependency);
+					if (File.bIsPublic)
+					{
+						PublicDependencies.Add(Dependency);
+					}
+				}
+			}
+		}
+
+		FModuleDependencies Result;
+		Result.PublicDependencies = PublicDependencies.Array();
+		Result.PrivateDependencies = AllDependencies.Difference(PublicDependencies).Array();
+		Result.UnresolvedIncludes = UnresolvedIncludes.Array();
+		Result.PublicDependencies.Sort();
+		Result.PrivateDependencies.Sort();
+		Result.UnresolvedIncludes.Sort();
+		return Result;
+	}
+
+	FString FormatDependencyList(TConstArrayView<FString> Modules)
+	{
+		TStringBuilder<256> Builder;
+		for (const FString& Module : Modules)
+		{
+			if (Builder.Len() > 0)
+			{
+				Builder.Append(TEXT(", "));
+			}
+			Builder.AppendChar(TEXT('"'));
+			Builder.Append(Module);
+			Builder.AppendChar(TEXT('"'));
+		}
+		return Builder.ToString();
+	}
+
+	static FString StripComments(FStringView Line, bool& bIsInBlockComment)
+	{
+		FString Result;
+		bool bIsInStringLiteral = false;
+		for (int32 Index = 0; Index < Line.Len(); ++Index)
+		{
+			const TCHAR Char = Line[Index];
+			const TCHAR NextChar = Index + 1 < Line.Len() ? Line[Index + 1] : TEXT('\0');
+			if (bIsInBlockComment)
+			{
+				if (Char == TEXT('*') && NextChar == TEXT('/'))
+				{
+					bIsInBlockComment = false;
+					++Index;
+				}
+				continue;
+			}
+
+			if (bIsInStringLiteral)
+			{
+				if (Char == TEXT('\\') && NextChar != TEXT('\0'))
+				{
+					Result.AppendChar(Char);
+					Result.AppendChar(NextChar);
+					++Index;
+					continue;
+				}
+				bIsInStringLiteral = Char != TEXT('"');
+			}
+			else if (Char == TEXT('"'))
+			{
+				bIsInStringLiteral = true;
+			}
+			else if (Char == TEXT('/') && NextChar == TEXT('/'))
+			{
+				break;
+			}
+			else if (Char == TEXT('/') && NextChar == TEXT('*'))
+			{
+				bIsInBlockComment = true;
+				++Index;
+				// A comment is equivalent to a space
+				Result.AppendChar(TEXT(' '));
+				continue;
+			}
+			Result.AppendChar(Char);
+		}
+		return Result;
+	}
+
+	static TOptional<FParsedInclude> ParseIncludeDirective(FStringView Code)
+	{
+		Code.TrimStartInline();
+		if (!Code.StartsWith(TEXT('#')))
+		{
+			return {};
+		}
+		Code.RightChopInline(1);
+		Code.TrimStartInline();
+		if (!Code.StartsWith(TEXT("include")))
+		{
+			return {};
+		}
+		Code.RightChopInline(FStringView(TEXT("include")).Len());
+		Code.TrimStartInline();
+		if (Code.IsEmpty() || (Code[0] != TEXT('"') && Code[0] != TEXT('<')))
+		{
+			return {};
+		}
+
+		const bool bIsQuoted = Code[0] == TEXT('"');
+		int32 PathEnd = INDEX_NONE;
+		if (!Code.RightChop(1).FindChar(bIsQuoted ? TEXT('"') : TEXT('>'), PathEnd) || PathEnd == 0)
+		{
+			return {};
+		}
+		return FParsedInclude{ FString(Code.Mid(1, PathEnd)), bIsQuoted };
+	}
+
+	static FString NormalizeSourcePath(FString Path)
+	{
+		FPaths::NormalizeFilename(Path);
+		FPaths::CollapseRelativeDirectories(Path);
+		return Path;
+	}
+}
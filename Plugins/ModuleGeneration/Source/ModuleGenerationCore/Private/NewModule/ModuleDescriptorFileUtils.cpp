@@ -0,0 +1,128 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleDescriptorFileUtils.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/DescriptorJsonPatcher.h"
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/PluginDirectoryIndex.h"
+
+#include "ModuleDescriptor.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	FOperationResult AddNewModuleToFile(const FString& FullFilePath, const FModuleDescriptor& NewModule)
+	{
+		return AddNewModulesToFile(FullFilePath, MakeArrayView(&NewModule, 1));
+	}
+
+	FOperationResult AddNewModulesToFile(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		return AddNewModulesToFile(FullFilePath, NewModules, FullFilePath);
+	}
+
+	FOperationResult AddNewModulesToFile(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules, const FString& OutputFilePath)
+	{
+		const TOperationResult<FPlannedDescriptorUpdate> PlanOp = PlanDescriptorUpdate(FullFilePath, NewModules);
+		if (PlanOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(PlanOp);
+		}
+		const TArray<uint8>& NewContents = PlanOp.OperationResult->NewContents;
+		
+		// OutputFilePath may be a copy that already holds these contents, e.g. when a batch is run again
+		MODULEGENERATION_TIMED_SCOPE(WriteDescriptor);
+		const TOperationResult<EFileWriteOutcome::Type> WriteOp = WriteFileIfChanged(OutputFilePath, NewContents);
+		if (WriteOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write config file '%s'"), *OutputFilePath));
+		}
+
+		return FOperationResult::MakeSuccess();
+	}
+
+	TOperationResult<FPlannedDescriptorUpdate> PlanDescriptorUpdate(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		TArray<uint8> FileContents;
+		FDateTime Timestamp;
+		{
+			MODULEGENERATION_TIMED_SCOPE(ReadDescriptor);
+			Timestamp = IFileManager::Get().GetTimeStamp(*FullFilePath);
+			if (!FFileHelper::LoadFileToArray(FileContents, *FullFilePath))
+			{
+				return TOperationResult<FPlannedDescriptorUpdate>::MakeFailure(FString::Printf(TEXT("Failed to read config file '%s'"), *FullFilePath));
+			}
+		}
+
+		TOperationResult<FPlannedDescriptorUpdate> Result = PlanDescriptorUpdate(FullFilePath, MoveTemp(FileContents), NewModules);
+		if (Result.IsSuccess())
+		{
+			Result.OperationResult->OriginalTimestamp = Timestamp;
+		}
+		return Result;
+	}
+
+	TOperationResult<FPlannedDescriptorUpdate> PlanDescriptorUpdate(const FString& FullFilePath, TArray<uint8> OriginalContents, TConstArrayView<FModuleDescriptor> NewModules)
+	{
+		// Only the new entries are inserted so the rest of the file stays byte-identical
+		TOperationResult<TArray<uint8>> PatchedContents = [&OriginalContents, NewModules]()
+		{
+			MODULEGENERATION_TIMED_SCOPE(PatchDescriptor);
+			return SpliceModulesIntoDescriptor(OriginalContents, NewModules);
+		}();
+		if (PatchedContents.IsFailure())
+		{
+			return TOperationResult<FPlannedDescriptorUpdate>::MakeFailure(FString::Printf(TEXT("Failed to update config file '%s': %s"), *FullFilePath, *PatchedContents.ErrorMessage.GetValue()));
+		}
+
+		FPlannedDescriptorUpdate Result;
+		Result.DescriptorPath = FullFilePath;
+		Result.OriginalContents = MoveTemp(OriginalContents);
+		Result.NewContents = MoveTemp(PatchedContents.OperationResult.GetValue());
+		return TOperationResult<FPlannedDescriptorUpdate>::MakeSuccess(MoveTemp(Result));
+	}
+
+	TOperationResult<FString> FindUProjectFile(const FString& ProjectDirectory)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		
+		const FString ProjectSearchRegex = FPaths::Combine(ProjectDirectory, FString("*.uproject"));
+		TArray<FString> UProjectFileNames;
+		FileManager.FindFiles(UProjectFileNames, *ProjectSearchRegex, true, false);
+
+		if(UProjectFileNames.Num() == 0)
+		{
+			return TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("Failed to locate .uproject file for current project. Searched path: '%s'"), *ProjectSearchRegex));
+		}
+		if(UProjectFileNames.Num() > 1)
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("Found multiple .uproject files. Picking '%s'..."), *UProjectFileNames[0]);
+		}
+
+		return TOperationResult<FString>::MakeSuccess(FPaths::Combine(ProjectDirectory, UProjectFileNames[0]));
+	}
+
+	TOperationResult<FString> FindUPluginFile(const FPluginDirectoryIndex& PluginIndex, const FString& OutputDirectory)
+	{
+		TOptional<FString> DescriptorPath = PluginIndex.FindPluginDescriptor(OutputDirectory);
+		if (!DescriptorPath.IsSet())
+		{
+			return TOperationResult<FString>::MakeFailure(FString::Printf(TEXT("'%s' is not part of any plugin. Searched %d plugins."), *OutputDirectory, PluginIndex.Num()));
+		}
+		return TOperationResult<FString>::MakeSuccess(MoveTemp(DescriptorPath.GetValue()));
+	}
+
+	TOperationResult<FString> FindModuleDescriptorFile(const FString& ProjectDirectory, const FPluginDirectoryIndex& PluginIndex, const FString& OutputDirectory)
+	{
+		if (TOptional<FString> PluginDescriptorPath = PluginIndex.FindPluginDescriptor(OutputDirectory))
+		{
+			return TOperationResult<FString>::MakeSuccess(MoveTemp(PluginDescriptorPath.GetValue()));
+		}
+		return FindUProjectFile(ProjectDirectory);
+	}
+}
@@ -0,0 +1,672 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleExtraction.h"
+
+#include "ModuleGenerationTrace.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+#include "NewModule/SourceFileUtils.h"
+
+#include "Algo/AnyOf.h"
+#include "Async/ParallelFor.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		/** Contents of a file which is moved or includes a moved file */
+		struct FLoadedFile
+		{
+			TArray<uint8> RawContents;
+			FString Contents;
+		};
+
+		/** Where a moved file ends up */
+		struct FMovedFile
+		{
+			/** Relative to the new module's output directory, e.g. NewModule/Public/Item.h */
+			FString NewRelativePath;
+			/** How the new module and its dependents include the file, e.g. Item.h */
+			FString NewInclude;
+		};
+	}
+
+	static TOperationResult<TArray<int32>> FindMovedFiles(const FIncludeGraph& Graph, const FModuleExtractionSource& Source);
+	static TMap<int32, FMovedFile> PlanMovedFiles(const FIncludeGraph& Graph, const TSet<int32>& MovedFiles, const FString& NewModuleName);
+	static bool IncludesAnyOf(const FIncludeGraphFile& File, const TSet<int32>& Targets);
+	static bool ReplaceWholeWord(FString& Contents, const FString& Word, const FString& Replacement);
+	/** @return Contents with every character of its comments except line breaks replaced by a space, so searches keep their offsets */
+	static FString BlankOutComments(const FString& Contents);
+	static bool AddDependencyToBuildFile(FString& Contents, const FString& Dependency, bool bIsPublic);
+	static TArray<FString> FindRedirects(const FString& HeaderContents, const FString& OldPackage, const FString& NewPackage, TArray<FString>& OutTypeNames);
+	static bool AddRedirectsToConfig(FString& Contents, TConstArrayView<FString> Redirects);
+	static TArray<uint8> EncodeLikeOriginal(const FString& Contents, const TArray<uint8>& OriginalContents);
+	static TOperationResult<FPlannedSourceUpdate> PlanTextFileUpdate(const FString& Path, TFunctionRef<bool(FString&)> Update);
+
+	TOperationResult<FModuleExtraction> PlanModuleExtraction(const FModuleExtractionSettings& Settings)
+	{
+		const FModuleExtractionSource& Source = Settings.Source;
+		if (Source.Files.Num() == 0)
+		{
+			return TOperationResult<FModuleExtraction>::MakeFailure(TEXT("No files were chosen to move into the new module"));
+		}
+
+		const TSharedRef<const FIncludeGraph> Graph = Settings.IncludeGraph.IsValid()
+			? Settings.IncludeGraph.ToSharedRef()
+			: FIncludeGraph::Build({ Settings.SourceRoots, FString() });
+		const TConstArrayView<FIncludeGraphFile> Files = Graph->GetFiles();
+		const int32 SourceModuleIndex = Graph->FindModule(Source.ModuleName);
+		TOperationResult<TArray<int32>> MovedFilesOp = FindMovedFiles(*Graph, Source);
+		if (MovedFilesOp.IsFailure())
+		{
+			return TOperationResult<FModuleExtraction>::MakeFailure(MovedFilesOp);
+		}
+		const TSet<int32> MovedFiles(MovedFilesOp.OperationResult.GetValue());
+
+		// Only the moved files and the files including them change, so only those are read
+		TArray<int32> FilesToLoad;
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			if (MovedFiles.Contains(FileIndex) || IncludesAnyOf(Files[FileIndex], MovedFiles))
+			{
+				FilesToLoad.Add(FileIndex);
+			}
+		}
+		TArray<FLoadedFile> LoadedFiles;
+		TArray<bool> bIsUpToDate;
+		LoadedFiles.SetNum(Files.Num());
+		bIsUpToDate.SetNumZeroed(Files.Num());
+		ParallelFor(FilesToLoad.Num(), [&Files, &FilesToLoad, &LoadedFiles, &bIsUpToDate](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(AnalyzeIncludes);
+			const int32 FileIndex = FilesToLoad[Index];
+			FLoadedFile& LoadedFile = LoadedFiles[FileIndex];
+			// The includes are rewritten by their index in the graph, which is only valid for the contents the graph was built from
+			bIsUpToDate[FileIndex] = FFileHelper::LoadFileToArray(LoadedFile.RawContents, *Files[FileIndex].Path)
+				&& FXxHash64::HashBuffer(LoadedFile.RawContents.GetData(), LoadedFile.RawContents.Num()).Hash == Files[FileIndex].ContentHash;
+			FFileHelper::BufferToString(LoadedFile.Contents, LoadedFile.RawContents.GetData(), LoadedFile.RawContents.Num());
+		});
+		for (const int32 FileIndex : FilesToLoad)
+		{
+			if (!bIsUpToDate[FileIndex])
+			{
+				return TOperationResult<FModuleExtraction>::MakeFailure(FString::Printf(TEXT("'%s' changed while the files to move were planned; try again"), *Files[FileIndex].Path));
+			}
+		}
+
+		// The module's entry point must stay where its .Build.cs is
+		for (const int32 FileIndex : MovedFiles)
+		{
+			const FString& Contents = LoadedFiles[FileIndex].Contents;
+			if (Contents.Contains(TEXT("IMPLEMENT_MODULE")) || Contents.Contains(TEXT("IMPLEMENT_GAME_MODULE")) || Contents.Contains(TEXT("IMPLEMENT_PRIMARY_GAME_MODULE")))
+			{
+				return TOperationResult<FModuleExtraction>::MakeFailure(FString::Printf(TEXT("'%s' implements module %s and cannot be moved"), *Files[FileIndex].Path, *Source.ModuleName));
+			}
+		}
+
+		const TMap<int32, FMovedFile> MovedFileTargets = PlanMovedFiles(*Graph, MovedFiles, Settings.NewModuleName);
+		TSet<FString> NewRelativePaths;
+		for (const TPair<int32, FMovedFile>& MovedFile : MovedFileTargets)
+		{
+			bool bIsAlreadyInSet = false;
+			NewRelativePaths.Add(MovedFile.Value.NewRelativePath, &bIsAlreadyInSet);
+			if (bIsAlreadyInSet)
+			{
+				return TOperationResult<FModuleExtraction>::MakeFailure(FString::Printf(TEXT("Several of the chosen files would be moved to '%s'"), *MovedFile.Value.NewRelativePath));
+			}
+		}
+		const FString OldExportMacro = Source.ModuleName.ToUpper() + TEXT("_API");
+		const FString NewExportMacro = Settings.NewModuleName.ToUpper() + TEXT("_API");
+
+		// Includes of a moved file, and relative includes in a moved file, no longer resolve where they used to
+		TArray<TOptional<FString>> NewContents;
+		TArray<TArray<FString>> IncludesOfSourceModulePerFile;
+		NewContents.SetNum(Files.Num());
+		IncludesOfSourceModulePerFile.SetNum(Files.Num());
+		ParallelFor(FilesToLoad.Num(), [&Files, &FilesToLoad, &LoadedFiles, &MovedFiles, &MovedFileTargets, &OldExportMacro, &NewExportMacro, SourceModuleIndex, &NewContents, &IncludesOfSourceModulePerFile](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(AnalyzeIncludes);
+			const int32 FileIndex = FilesToLoad[Index];
+			const FIncludeGraphFile& File = Files[FileIndex];
+			const bool bIsMoved = MovedFiles.Contains(FileIndex);
+
+			FString Contents = LoadedFiles[FileIndex].Contents;
+			bool bIsChanged = RewriteIncludes(Contents, [&Files, &File, &MovedFileTargets, bIsMoved, SourceModuleIndex, &IncludesOfSourceModule = IncludesOfSourceModulePerFile[FileIndex]](int32 IncludeIndex, const FParsedInclude&) -> TOptional<FString>
+			{
+				const int32 Target = File.ResolvedIncludes.IsValidIndex(IncludeIndex) ? File.ResolvedIncludes[IncludeIndex] : INDEX_NONE;
+				if (Target == INDEX_NONE)
+				{
+					return {};
+				}
+				if (const FMovedFile* MovedTarget = MovedFileTargets.Find(Target))
+				{
+					return MovedTarget->NewInclude;
+				}
+				if (!bIsMoved)
+				{
+					return {};
+				}
+
+				const FIncludeGraphFile& TargetFile = Files[Target];
+				if (TargetFile.ModuleIndex == SourceModuleIndex)
+				{
+					IncludesOfSourceModule.Add(TargetFile.RelativePath);
+				}
+				// Relative includes must be spelled out now that the including file is elsewhere
+				return GetModuleIncludePath(TargetFile.RelativePath, false);
+			});
+			if (bIsMoved)
+			{
+				bIsChanged |= ReplaceWholeWord(Contents, OldExportMacro, NewExportMacro);
+			}
+			if (bIsMoved || bIsChanged)
+			{
+				NewContents[FileIndex] = MoveTemp(Contents);
+			}
+		});
+
+		FModuleExtraction Result;
+		FModuleExtractionReport& Report = Result.Report;
+		Report.SourceModuleName = Source.ModuleName;
+		Report.NumMovedFiles = MovedFiles.Num();
+
+		TSet<FString> IncludesOfSourceModule;
+		TArray<FString> Redirects;
+		for (const int32 FileIndex : MovedFiles)
+		{
+			const FIncludeGraphFile& File = Files[FileIndex];
+			Result.NewModuleFiles.Add({ MovedFileTargets[FileIndex].NewRelativePath, EncodeLikeOriginal(NewContents[FileIndex].GetValue(), LoadedFiles[FileIndex].RawContents) });
+			Result.SourceUpdates.Add({ File.Path, LoadedFiles[FileIndex].RawContents, {}, File.Timestamp });
+			IncludesOfSourceModule.Append(IncludesOfSourceModulePerFile[FileIndex]);
+			if (IsHeaderFile(File.Path))
+			{
+				Redirects.Append(FindRedirects(LoadedFiles[FileIndex].Contents, Source.ModuleName, Settings.NewModuleName, Report.RedirectedTypes));
+			}
+		}
+		Result.NewModuleFiles.Sort([](const FPlannedFile& Left, const FPlannedFile& Right) { return Left.RelativePath < Right.RelativePath; });
+		Report.IncludesOfSourceModule = IncludesOfSourceModule.Array();
+		Report.IncludesOfSourceModule.Sort();
+		Report.RedirectedTypes.Sort();
+
+		// Modules including a moved file need the new module; public files make it a public dependency
+		TMap<int32, bool> DependentModules;
+		for (const int32 FileIndex : FilesToLoad)
+		{
+			const FIncludeGraphFile& File = Files[FileIndex];
+			if (MovedFiles.Contains(FileIndex))
+			{
+				continue;
+			}
+			if (NewContents[FileIndex])
+			{
+				Result.SourceUpdates.Add({ File.Path, LoadedFiles[FileIndex].RawContents, EncodeLikeOriginal(NewContents[FileIndex].GetValue(), LoadedFiles[FileIndex].RawContents), File.Timestamp });
+			}
+			DependentModules.FindOrAdd(File.ModuleIndex) |= IsPublicSourcePath(File.RelativePath);
+		}
+		for (const TPair<int32, bool>& Dependent : DependentModules)
+		{
+			const FIncludeGraphModule& Module = Graph->GetModules()[Dependent.Key];
+			const FString BuildFilePath = FPaths::Combine(Module.Directory, Module.Name + TEXT(".Build.cs"));
+			TOperationResult<FPlannedSourceUpdate> UpdateOp = PlanTextFileUpdate(BuildFilePath, [&Settings, bIsPublic = Dependent.Value](FString& Contents)
+			{
+				return AddDependencyToBuildFile(Contents, Settings.NewModuleName, bIsPublic);
+			});
+			if (UpdateOp.IsFailure())
+			{
+				return TOperationResult<FModuleExtraction>::MakeFailure(UpdateOp);
+			}
+			if (UpdateOp.OperationResult->NewContents)
+			{
+				Result.SourceUpdates.Add(MoveTemp(UpdateOp.OperationResult.GetValue()));
+			}
+			Report.DependentModules.Add(Module.Name);
+		}
+		Report.DependentModules.Sort();
+
+		if (Redirects.Num() > 0 && !Settings.RedirectsConfigPath.IsEmpty())
+		{
+			TOperationResult<FPlannedSourceUpdate> UpdateOp = PlanTextFileUpdate(Settings.RedirectsConfigPath, [&Redirects](FString& Contents)
+			{
+				return AddRedirectsToConfig(Contents, Redirects);
+			});
+			if (UpdateOp.IsFailure())
+			{
+				return TOperationResult<FModuleExtraction>::MakeFailure(UpdateOp);
+			}
+			if (UpdateOp.OperationResult->NewContents)
+			{
+				Result.SourceUpdates.Add(MoveTemp(UpdateOp.OperationResult.GetValue()));
+			}
+		}
+		Result.SourceUpdates.Sort([](const FPlannedSourceUpdate& Left, const FPlannedSourceUpdate& Right) { return Left.Path < Right.Path; });
+
+		const TOperationResult<FBuildImpactEstimate> ImpactOp = EstimateBuildImpact(*Graph, Source);
+		if (ImpactOp.IsSuccess())
+		{
+			const FBuildImpactEstimate& Impact = ImpactOp.OperationResult.GetValue();
+			Report.NumRemainingTranslationUnits = Impact.NumSourceModuleTranslationUnits;
+			Report.NumIndependentTranslationUnits = Impact.NumSourceModuleTranslationUnits - Impact.NumSourceModuleDependentsOfMovedHeaders;
+		}
+		return TOperationResult<FModuleExtraction>::MakeSuccess(MoveTemp(Result));
+	}
+
+	TOperationResult<FBuildImpactEstimate> EstimateBuildImpact(const FIncludeGraph& Graph, const FModuleExtractionSource& FilesToMove)
+	{
+		const TConstArrayView<FIncludeGraphFile> Files = Graph.GetFiles();
+		FBuildImpactEstimate Result;
+		for (const FIncludeGraphFile& File : Files)
+		{
+			Result.NumTranslationUnits += FIncludeGraph::IsTranslationUnit(File.Path) ? 1 : 0;
+		}
+		if (FilesToMove.Files.Num() == 0)
+		{
+			return TOperationResult<FBuildImpactEstimate>::MakeSuccess(Result);
+		}
+
+		TOperationResult<TArray<int32>> MovedFilesOp = FindMovedFiles(Graph, FilesToMove);
+		if (MovedFilesOp.IsFailure())
+		{
+			return TOperationResult<FBuildImpactEstimate>::MakeFailure(MovedFilesOp);
+		}
+		const TSet<int32> MovedFiles(MovedFilesOp.OperationResult.GetValue());
+		const int32 SourceModuleIndex = Graph.FindModule(FilesToMove.ModuleName);
+
+		// A header change recompiles every translation unit including it, directly or through other headers
+		TArray<int32> MovedHeaders;
+		TArray<int32> RemainingHeaders;
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			if (Files[FileIndex].ModuleIndex == SourceModuleIndex && IsHeaderFile(Files[FileIndex].Path))
+			{
+				(MovedFiles.Contains(FileIndex) ? MovedHeaders : RemainingHeaders).Add(FileIndex);
+			}
+		}
+		const TBitArray<> DependsOnMovedHeaders = Graph.FindDependents(MovedHeaders);
+		const TBitArray<> DependsOnRemainingHeaders = Graph.FindDependents(RemainingHeaders);
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+		{
+			const FIncludeGraphFile& File = Files[FileIndex];
+			if (!FIncludeGraph::IsTranslationUnit(File.Path))
+			{
+				continue;
+			}
+			Result.NumNewModuleDependents += DependsOnMovedHeaders[FileIndex] ? 1 : 0;
+			Result.NumSourceModuleDependentsBefore += DependsOnMovedHeaders[FileIndex] || DependsOnRemainingHeaders[FileIndex] ? 1 : 0;
+			Result.NumSourceModuleDependentsAfter += DependsOnRemainingHeaders[FileIndex] ? 1 : 0;
+			if (File.ModuleIndex == SourceModuleIndex && !MovedFiles.Contains(FileIndex))
+			{
+				++Result.NumSourceModuleTranslationUnits;
+				Result.NumSourceModuleDependentsOfMovedHeaders += DependsOnMovedHeaders[FileIndex] ? 1 : 0;
+			}
+		}
+		return TOperationResult<FBuildImpactEstimate>::MakeSuccess(Result);
+	}
+
+	static TOperationResult<TArray<int32>> FindMovedFiles(const FIncludeGraph& Graph, const FModuleExtractionSource& Source)
+	{
+		const int32 SourceModuleIndex = Graph.FindModule(Source.ModuleName);
+		if (SourceModuleIndex == INDEX_NONE)
+		{
+			return TOperationResult<TArray<int32>>::MakeFailure(FString::Printf(TEXT("Module %s is not in any of the scanned source folders"), *Source.ModuleName));
+		}
+
+		TArray<int32> Result;
+		for (const FString& FilePath : Source.Files)
+		{
+			FString NormalizedPath = FPaths::ConvertRelativePathToFull(FilePath);
+			FPaths::NormalizeFilename(NormalizedPath);
+			const int32 FileIndex = Graph.FindFile(NormalizedPath);
+			if (FileIndex == INDEX_NONE || Graph.GetFiles()[FileIndex].ModuleIndex != SourceModuleIndex)
+			{
+				return TOperationResult<TArray<int32>>::MakeFailure(FString::Printf(TEXT("'%s' is not a source file of module %s"), *FilePath, *Source.ModuleName));
+			}
+			Result.AddUnique(FileIndex);
+		}
+		return TOperationResult<TArray<int32>>::MakeSuccess(MoveTemp(Result));
+	}
+
+	static TMap<int32, FMovedFile> PlanMovedFiles(const FIncludeGraph& Graph, const TSet<int32>& MovedFiles, const FString& NewModuleName)
+	{
+		const TConstArrayView<FIncludeGraphFile> Files = Graph.GetFiles();
+
+		// Paths below the include folders, or below the module if a file is in none of them
+		TMap<int32, FString> SubPaths;
+		TArray<FString> CommonDirectories;
+		bool bIsFirst = true;
+		for (const int32 FileIndex : MovedFiles)
+		{
+			const FString& RelativePath = Files[FileIndex].RelativePath;
+			const FString SubPath = GetModuleIncludePath(RelativePath, false).Get(RelativePath);
+			TArray<FString> Directories;
+			FPaths::GetPath(SubPath).ParseIntoArray(Directories, TEXT("/"));
+			if (bIsFirst)
+			{
+				CommonDirectories = MoveTemp(Directories);
+				bIsFirst = false;
+			}
+			else
+			{
+				int32 NumCommon = 0;
+				while (NumCommon < CommonDirectories.Num() && NumCommon < Directories.Num() && CommonDirectories[NumCommon] == Directories[NumCommon])
+				{
+					++NumCommon;
+				}
+				CommonDirectories.SetNum(NumCommon);
+			}
+			SubPaths.Add(FileIndex, SubPath);
+		}
+		const FString CommonPrefix = CommonDirectories.Num() > 0 ? FString::Join(CommonDirectories, TEXT("/")) + TEXT("/") : FString();
+
+		TMap<int32, FMovedFile> Result;
+		for (const TPair<int32, FString>& SubPath : SubPaths)
+		{
+			const FIncludeGraphFile& File = Files[SubPath.Key];
+			const bool bIsIncludedByRemainingFiles = Algo::AnyOf(Graph.GetIncludedBy(SubPath.Key), [&MovedFiles](int32 Includer) { return !MovedFiles.Contains(Includer); });
+			const bool bIsPublic = IsHeaderFile(File.Path) && (GetModuleIncludePath(File.RelativePath, true).IsSet() || bIsIncludedByRemainingFiles);
+			FMovedFile& MovedFile = Result.Add(SubPath.Key);
+			MovedFile.NewInclude = SubPath.Value.RightChop(CommonPrefix.Len());
+			MovedFile.NewRelativePath = FPaths::Combine(NewModuleName, bIsPublic ? TEXT("Public") : TEXT("Private"), MovedFile.NewInclude);
+		}
+		return Result;
+	}
+
+	static bool IncludesAnyOf(const FIncludeGraphFile& File, const TSet<int32>& Targets)
+	{
+		return Algo::AnyOf(File.ResolvedIncludes, [&Targets](int32 Target) { return Targets.Contains(Target); });
+	}
+
+	static bool ReplaceWholeWord(FString& Contents, const FString& Word, const FString& Replacement)
+	{
+		const auto IsIdentifierChar = [](TCHAR Char) { return FChar::IsAlnum(Char) || Char == TEXT('_'); };
+		bool bHasReplaced = false;
+		int32 SearchStart = 0;
+		for (int32 Index = Contents.Find(Word, ESearchCase::CaseSensitive); Index != INDEX_NONE; Index = Contents.Find(Word, ESearchCase::CaseSensitive, ESearchDir::FromStart, SearchStart))
+		{
+			const int32 End = Index + Word.Len();
+			const bool bIsWholeWord = (Index == 0 || !IsIdentifierChar(Contents[Index - 1])) && (End == Contents.Len() || !IsIdentifierChar(Contents[End]));
+			if (bIsWholeWord)
+			{
+				Contents = Contents.Left(Index) + Replacement + Contents.RightChop(End);
+				bHasReplaced = true;
+			}
+			SearchStart = Index + (bIsWholeWord ? Replacement.Len() : Word.Len());
+		}
+		return bHasReplaced;
+	}
+
+	static bool AddDependencyToBuildFile(FString& Contents, const FString& Dependency, bool bIsPublic)
+	{
+		// Searches run on the code only, so names in comments neither count as dependencies nor as lists
+		const FString Code = BlankOutComments(Contents);
+		if (Code.Contains(FString::Printf(TEXT("\"%s\""), *Dependency)))
+		{
+			return false;
+		}
+
+		// Of several lists of that kind, the least nested one is the unconditional one in the constructor, not one in an if block
+		const TCHAR* LineEnding = Contents.Contains(TEXT("\r\n")) ? TEXT("\r\n") : TEXT("\n");
+		const TCHAR* ListName = bIsPublic ? TEXT("PublicDependencyModuleNames") : TEXT("PrivateDependencyModuleNames");
+		int32 ListStart = INDEX_NONE;
+		int32 ListDepth = MAX_int32;
+		int32 Depth = 0;
+		int32 DepthCountedUpTo = 0;
+		for (int32 Index = Code.Find(ListName, ESearchCase::CaseSensitive); Index != INDEX_NONE; Index = Code.Find(ListName, ESearchCase::CaseSensitive, ESearchDir::FromStart, Index + 1))
+		{
+			for (; DepthCountedUpTo < Index; ++DepthCountedUpTo)
+			{
+				Depth += Code[DepthCountedUpTo] == TEXT('{') ? 1 : Code[DepthCountedUpTo] == TEXT('}') ? -1 : 0;
+			}
+			if (Depth < ListDepth)
+			{
+				ListStart = Index;
+				ListDepth = Depth;
+			}
+		}
+
+		const int32 StatementEnd = ListStart != INDEX_NONE ? Code.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, ListStart) : INDEX_NONE;
+		if (StatementEnd != INDEX_NONE)
+		{
+			// AddRange(new string[] { ... }): the new entry goes first and is indented like the entry after it
+			const int32 BraceIndex = Code.Find(TEXT("{"), ESearchCase::CaseSensitive, ESearchDir::FromStart, ListStart);
+			if (BraceIndex != INDEX_NONE && BraceIndex < StatementEnd)
+			{
+				// Trailing whitespace after the brace does not make the list single-line
+				int32 BraceLineEnd = BraceIndex + 1;
+				while (BraceLineEnd < StatementEnd && (Code[BraceLineEnd] == TEXT('\t') || Code[BraceLineEnd] == TEXT(' ')))
+				{
+					++BraceLineEnd;
+				}
+				if (BraceLineEnd == StatementEnd || (Code[BraceLineEnd] != TEXT('\r') && Code[BraceLineEnd] != TEXT('\n')))
+				{
+					Contents.InsertAt(BraceIndex + 1, FString::Printf(TEXT(" \"%s\","), *Dependency));
+					return true;
+				}
+
+				int32 EntryStart = BraceLineEnd;
+				while (EntryStart < StatementEnd && (Code[EntryStart] == TEXT('\r') || Code[EntryStart] == TEXT('\n')))
+				{
+					++EntryStart;
+				}
+				int32 EntryIndentEnd = EntryStart;
+				while (EntryIndentEnd < StatementEnd && (Code[EntryIndentEnd] == TEXT('\t') || Code[EntryIndentEnd] == TEXT(' ')))
+				{
+					++EntryIndentEnd;
+				}
+				Contents.InsertAt(EntryStart, FString::Printf(TEXT("%s\"%s\",%s"), *Contents.Mid(EntryStart, EntryIndentEnd - EntryStart), *Dependency, LineEnding));
+				return true;
+			}
+		}
+
+		// No list of that kind yet: add a statement at the end of the constructor, which is closed by the second to last brace
+		const int32 ClassEnd = Code.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		const int32 ConstructorEnd = ClassEnd != INDEX_NONE ? Code.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromEnd, ClassEnd) : INDEX_NONE;
+		if (ConstructorEnd == INDEX_NONE)
+		{
+			return false;
+		}
+		int32 LineStart = ConstructorEnd;
+		while (LineStart > 0 && Contents[LineStart - 1] != TEXT('\n'))
+		{
+			--LineStart;
+		}
+		Contents.InsertAt(LineStart, FString::Printf(TEXT("\t\t%s.Add(\"%s\");%s"), ListName, *Dependency, LineEnding));
+		return true;
+	}
+
+	static FString BlankOutComments(const FString& Contents)
+	{
+		FString Result = Contents;
+		bool bIsInLineComment = false;
+		bool bIsInBlockComment = false;
+		bool bIsInStringLiteral = false;
+		for (int32 Index = 0; Index < Result.Len(); ++Index)
+		{
+			const TCHAR Char = Result[Index];
+			const TCHAR NextChar = Index + 1 < Result.Len() ? Result[Index + 1] : TEXT('\0');
+			if (bIsInLineComment)
+			{
+				bIsInLineComment = Char != TEXT('\n');
+			}
+			else if (bIsInBlockComment)
+			{
+				if (Char == TEXT('*') && NextChar == TEXT('/'))
+				{
+					bIsInBlockComment = false;
+					Result[Index] = Result[Index + 1] = TEXT(' ');
+					++Index;
+					continue;
+				}
+			}
+			else if (bIsInStringLiteral)
+			{
+				if (Char == TEXT('\\'))
+				{
+					++Index;
+				}
+				else
+				{
+					bIsInStringLiteral = Char != TEXT('"') && Char != TEXT('\n');
+				}
+				continue;
+			}
+			else if (Char == TEXT('"'))
+			{
+				bIsInStringLiteral = true;
+				continue;
+			}
+			else if (Char == TEXT('/') && NextChar == TEXT('/'))
+			{
+				bIsInLineComment = true;
+			}
+			else if (Char == TEXT('/') && NextChar == TEXT('*'))
+			{
+				bIsInBlockComment = true;
+				Result[Index] = Result[Index + 1] = TEXT(' ');
+				++Index;
+				continue;
+			}
+			else
+			{
+				continue;
+			}
+
+			if ((bIsInLineComment || bIsInBlockComment) && Char != TEXT('\r') && Char != TEXT('\n'))
+			{
+				Result[Index] = TEXT(' ');
+			}
+		}
+		return Result;
+	}
+
+	static TArray<FString> FindRedirects(const FString& HeaderContents, const FString& OldPackage, const FString& NewPackage, TArray<FString>& OutTypeNames)
+	{
+		struct FReflectionMacro
+		{
+			const TCHAR* Macro;
+			const TCHAR* RedirectList;
+		};
+		static const FReflectionMacro ReflectionMacros[] =
+		{
+			{ TEXT("UCLASS("), TEXT("ClassRedirects") },
+			{ TEXT("UINTERFACE("), TEXT("ClassRedirects") },
+			{ TEXT("USTRUCT("), TEXT("StructRedirects") },
+			{ TEXT("UENUM("), TEXT("EnumRedirects") }
+		};
+
+		// Macros in comments declare nothing
+		const FString Code = BlankOutComments(HeaderContents);
+		TArray<FString> Result;
+		for (const FReflectionMacro& ReflectionMacro : ReflectionMacros)
+		{
+			for (int32 Index = Code.Find(ReflectionMacro.Macro, ESearchCase::CaseSensitive); Index != INDEX_NONE;
+				Index = Code.Find(ReflectionMacro.Macro, ESearchCase::CaseSensitive, ESearchDir::FromStart, Index + 1))
+			{
+				if (Index > 0 && (FChar::IsAlnum(Code[Index - 1]) || Code[Index - 1] == TEXT('_')))
+				{
+					continue;
+				}
+
+				// Skip the specifiers, which may contain parentheses themselves, then the keywords and export macro in front of the type name
+				int32 Position = Index + FCString::Strlen(ReflectionMacro.Macro);
+				for (int32 Depth = 1; Position < Code.Len() && Depth > 0; ++Position)
+				{
+					Depth += Code[Position] == TEXT('(') ? 1 : Code[Position] == TEXT(')') ? -1 : 0;
+				}
+				FString TypeName;
+				while (Position < Code.Len())
+				{
+					while (Position < Code.Len() && !FChar::IsAlnum(Code[Position]) && Code[Position] != TEXT('_'))
+					{
+						++Position;
+					}
+					const int32 WordStart = Position;
+					while (Position < Code.Len() && (FChar::IsAlnum(Code[Position]) || Code[Position] == TEXT('_')))
+					{
+						++Position;
+					}
+					const FString Word = Code.Mid(WordStart, Position - WordStart);
+					if (Word != TEXT("class") && Word != TEXT("struct") && Word != TEXT("enum") && !Word.EndsWith(TEXT("_API")))
+					{
+						TypeName = Word;
+						break;
+					}
+				}
+				if (TypeName.IsEmpty())
+				{
+					continue;
+				}
+
+				// Script names drop the U, A and F prefixes of classes and structs; enums keep their name
+				const bool bHasPrefix = FCString::Strcmp(ReflectionMacro.RedirectList, TEXT("EnumRedirects")) != 0 && TypeName.Len() > 1;
+				const FString ScriptName = bHasPrefix ? TypeName.RightChop(1) : TypeName;
+				Result.Add(FString::Printf(TEXT("+%s=(OldName=\"/Script/%s.%s\",NewName=\"/Script/%s.%s\")"), ReflectionMacro.RedirectList, *OldPackage, *ScriptName, *NewPackage, *ScriptName));
+				OutTypeNames.Add(TypeName);
+			}
+		}
+		return Result;
+	}
+
+	static bool AddRedirectsToConfig(FString& Contents, TConstArrayView<FString> Redirects)
+	{
+		const FString Lines = FString::Join(Redirects, TEXT("\n")) + TEXT("\n");
+		const int32 SectionStart = Contents.Find(TEXT("[CoreRedirects]"), ESearchCase::IgnoreCase);
+		if (SectionStart == INDEX_NONE)
+		{
+			Contents += (Contents.IsEmpty() || Contents.EndsWith(TEXT("\n")) ? TEXT("\n[CoreRedirects]\n") : TEXT("\n\n[CoreRedirects]\n")) + Lines;
+			return true;
+		}
+		const int32 SectionLineEnd = Contents.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, SectionStart);
+		if (SectionLineEnd == INDEX_NONE)
+		{
+			Contents += TEXT("\n") + Lines;
+		}
+		else
+		{
+			Contents.InsertAt(SectionLineEnd + 1, Lines);
+		}
+		return true;
+	}
+
+	static TArray<uint8> EncodeLikeOriginal(const FString& Contents, const TArray<uint8>& OriginalContents)
+	{
+		TArray<uint8> Result;
+		if (OriginalContents.Num() >= 2 && OriginalContents[0] == 0xFF && OriginalContents[1] == 0xFE)
+		{
+			const FTCHARToUTF16 Converted(*Contents, Contents.Len());
+			Result.Append(OriginalContents.GetData(), 2);
+			Result.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length() * sizeof(UTF16CHAR));
+			return Result;
+		}
+
+		// Everything else is written as UTF-8, keeping the byte order mark if there was one
+		if (OriginalContents.Num() >= 3 && OriginalContents[0] == 0xEF && OriginalContents[1] == 0xBB && OriginalContents[2] == 0xBF)
+		{
+			Result.Append(OriginalContents.GetData(), 3);
+		}
+		const FTCHARToUTF8 Converted(*Contents, Contents.Len());
+		Result.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+		return Result;
+	}
+
+	static TOperationResult<FPlannedSourceUpdate> PlanTextFileUpdate(const FString& Path, TFunctionRef<bool(FString&)> Update)
+	{
+		FPlannedSourceUpdate Result;
+		Result.Path = Path;
+		Result.OriginalTimestamp = IFileManager::Get().GetTimeStamp(*Path);
+		if (!FFileHelper::LoadFileToArray(Result.OriginalContents, *Path))
+		{
+			return TOperationResult<FPlannedSourceUpdate>::MakeFailure(FString::Printf(TEXT("Failed to read '%s'"), *Path));
+		}
+
+		FString Contents;
+		FFileHelper::BufferToString(Contents, Result.OriginalContents.GetData(), Result.OriginalContents.Num());
+		if (Update(Contents))
+		{
+			Result.NewContents = EncodeLikeOriginal(Contents, Result.OriginalContents);
+		}
+		return TOperationResult<FPlannedSourceUpdate>::MakeSuccess(MoveTemp(Result));
+	}
+}
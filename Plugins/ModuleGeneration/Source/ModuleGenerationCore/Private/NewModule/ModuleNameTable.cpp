@@ -0,0 +1,469 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleNameTable.h"
+
+#include "Algo/AllOf.h"
+#include "Algo/BinarySearch.h"
+#include "Containers/BitArray.h"
+#include "Misc/FileHelper.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		/** "MGMN" */
+		constexpr uint32 TableMagic = 0x4E4D474D;
+		/** Bump when the layout of the file or the indexing rules change */
+		constexpr uint32 TableVersion = 1;
+
+		/** Followed by the key and the arrays in the order of their counts. All fields are little-endian. */
+		struct FTableHeader
+		{
+			uint32 Magic = TableMagic;
+			uint32 Version = TableVersion;
+			uint32 KeyLength = 0;
+			uint32 NumEntries = 0;
+			uint32 NamesSize = 0;
+			uint32 NumTrieNodes = 0;
+			uint32 NumTrigrams = 0;
+			uint32 NumPostings = 0;
+		};
+
+		namespace EMatchKind
+		{
+			enum Type : int32
+			{
+				Exact,
+				Prefix,
+				WordStart,
+				Substring,
+				Subsequence
+			};
+		}
+	}
+
+	static bool IsAsciiChar(TCHAR Char);
+	static ANSICHAR ToLowerAscii(ANSICHAR Char);
+	static uint32 MakeTrigramKey(ANSICHAR First, ANSICHAR Second, ANSICHAR Third);
+	static TOptional<int32> ScoreMatch(FAnsiStringView Name, FAnsiStringView LowerQuery);
+	template<typename T>
+	static void AppendArray(TArray<uint8>& Bytes, const TArray<T>& Array);
+	template<typename T>
+	static bool ReadArray(TConstArrayView<uint8> Bytes, uint64& InOutOffset, uint32 Num, TArray<T>& OutArray);
+
+	TSharedRef<const FModuleNameTable> FModuleNameTable::Build(TConstArrayView<FModuleNameEntry> Entries)
+	{
+		TArray<const FModuleNameEntry*> SortedEntries;
+		SortedEntries.Reserve(Entries.Num());
+		for (const FModuleNameEntry& Entry : Entries)
+		{
+			if (!Entry.Name.IsEmpty() && Entry.Name.Len() <= MAX_uint16 && Algo::AllOf(Entry.Name, &IsAsciiChar))
+			{
+				SortedEntries.Add(&Entry);
+			}
+		}
+		SortedEntries.Sort([](const FModuleNameEntry& Left, const FModuleNameEntry& Right)
+		{
+			const int32 Comparison = Left.Name.Compare(Right.Name, ESearchCase::IgnoreCase);
+			return Comparison != 0 ? Comparison < 0 : Left.Location < Right.Location;
+		});
+
+		const TSharedRef<FModuleNameTable> Result = MakeShared<FModuleNameTable>();
+		Result->Entries.Reserve(SortedEntries.Num());
+		Result->TrieNodes.AddDefaulted();
+		TArray<TPair<uint32, int32>> Trigrams;
+		const FModuleNameEntry* Previous = nullptr;
+		for (const FModuleNameEntry* SortedEntry : SortedEntries)
+		{
+			if (Previous && Previous->Location == SortedEntry->Location && Previous->Name.Equals(SortedEntry->Name, ESearchCase::IgnoreCase))
+			{
+				continue;
+			}
+			Previous = SortedEntry;
+
+			const int32 EntryIndex = Result->Entries.Num();
+			FEntry& Entry = Result->Entries.AddDefaulted_GetRef();
+			Entry.NameOffset = Result->Names.Num();
+			Entry.NameLength = static_cast<uint16>(SortedEntry->Name.Len());
+			Entry.Location = SortedEntry->Location;
+
+			TArray<ANSICHAR, TInlineAllocator<64>> LowerName;
+			for (const TCHAR Char : SortedEntry->Name)
+			{
+				Result->Names.Add(static_cast<ANSICHAR>(Char));
+				LowerName.Add(ToLowerAscii(static_cast<ANSICHAR>(Char)));
+			}
+
+			// Children are appended, so indices rather than references are kept across iterations
+			uint32 Node = 0;
+			for (const ANSICHAR Char : LowerName)
+			{
+				uint32 Child = Result->TrieNodes[Node].FirstChild;
+				while (Child != 0 && Result->TrieNodes[Child].Char != Char)
+				{
+					Child = Result->TrieNodes[Child].NextSibling;
+				}
+				if (Child == 0)
+				{
+					Child = Result->TrieNodes.Num();
+					FTrieNode& NewNode = Result->TrieNodes.AddDefaulted_GetRef();
+					NewNode.Char = Char;
+					NewNode.NextSibling = Result->TrieNodes[Node].FirstChild;
+					Result->TrieNodes[Node].FirstChild = Child;
+				}
+				Node = Child;
+			}
+			// Names differing only in their location share the node of the first of them
+			if (Result->TrieNodes[Node].Entry == INDEX_NONE)
+			{
+				Result->TrieNodes[Node].Entry = EntryIndex;
+			}
+
+			for (int32 Index = 0; Index + 2 < LowerName.Num(); ++Index)
+			{
+				Trigrams.Emplace(MakeTrigramKey(LowerName[Index], LowerName[Index + 1], LowerName[Index + 2]), EntryIndex);
+			}
+		}
+
+		// Names containing a trigram more than once are listed once
+		Trigrams.Sort([](const TPair<uint32, int32>& Left, const TPair<uint32, int32>& Right)
+		{
+			return Left.Key != Right.Key ? Left.Key < Right.Key : Left.Value < Right.Value;
+		});
+		for (int32 Index = 0; Index < Trigrams.Num(); ++Index)
+		{
+			if (Index > 0 && Trigrams[Index] == Trigrams[Index - 1])
+			{
+				continue;
+			}
+			if (Result->TrigramKeys.Num() == 0 || Result->TrigramKeys.Last() != Trigrams[Index].Key)
+			{
+				Result->TrigramKeys.Add(Trigrams[Index].Key);
+				Result->PostingOffsets.Add(Result->Postings.Num());
+			}
+			Result->Postings.Add(Trigrams[Index].Value);
+		}
+		Result->PostingOffsets.Add(Result->Postings.Num());
+		return Result;
+	}
+
+	TOperationResult<TSharedRef<const FModuleNameTable>> FModuleNameTable::Load(const FString& FilePath, const FString& Key)
+	{
+		using FLoadResult = TOperationResult<TSharedRef<const FModuleNameTable>>;
+
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *FilePath, FILEREAD_Silent))
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Failed to read module name table '%s'"), *FilePath));
+		}
+		if (Bytes.Num() < static_cast<int32>(sizeof(FTableHeader)))
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("'%s' is not a module name table"), *FilePath));
+		}
+
+		FTableHeader Header;
+		FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(FTableHeader));
+		if (Header.Magic != TableMagic)
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("'%s' is not a module name table"), *FilePath));
+		}
+		if (Header.Version != TableVersion)
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Module name table '%s' has version %u but only version %u is supported"), *FilePath, Header.Version, TableVersion));
+		}
+		if (Header.NumTrigrams >= static_cast<uint32>(MAX_int32))
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Module name table '%s' is truncated or corrupt"), *FilePath));
+		}
+
+		uint64 Offset = sizeof(FTableHeader);
+		TArray<UTF8CHAR> SavedKey;
+		const TSharedRef<FModuleNameTable> Result = MakeShared<FModuleNameTable>();
+		if (!ReadArray(Bytes, Offset, Header.KeyLength, SavedKey)
+			|| !ReadArray(Bytes, Offset, Header.NumEntries, Result->Entries)
+			|| !ReadArray(Bytes, Offset, Header.NamesSize, Result->Names)
+			|| !ReadArray(Bytes, Offset, Header.NumTrieNodes, Result->TrieNodes)
+			|| !ReadArray(Bytes, Offset, Header.NumTrigrams, Result->TrigramKeys)
+			|| !ReadArray(Bytes, Offset, Header.NumTrigrams + 1, Result->PostingOffsets)
+			|| !ReadArray(Bytes, Offset, Header.NumPostings, Result->Postings)
+			|| Offset != static_cast<uint64>(Bytes.Num()))
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Module name table '%s' is truncated or corrupt"), *FilePath));
+		}
+		const FString SavedKeyString(FUtf8StringView(SavedKey.GetData(), SavedKey.Num()));
+		if (SavedKeyString != Key)
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Module name table '%s' was built for '%s' rather than '%s'"), *FilePath, *SavedKeyString, *Key));
+		}
+
+		// Validate everything up front so lookups do not have to
+		const int32 NumEntries = Result->Entries.Num();
+		const int32 NumNodes = Result->TrieNodes.Num();
+		const bool bAreEntriesValid = Algo::AllOf(Result->Entries, [&Result](const FEntry& Entry)
+		{
+			return Entry.NameLength > 0
+				&& static_cast<uint64>(Entry.NameOffset) + Entry.NameLength <= static_cast<uint64>(Result->Names.Num())
+				&& Entry.Location <= EModuleLocation::ProjectPlugin;
+		});
+		const bool bAreNodesValid = NumNodes > 0 && Algo::AllOf(Result->TrieNodes, [NumEntries, NumNodes](const FTrieNode& Node)
+		{
+			return Node.FirstChild < static_cast<uint32>(NumNodes)
+				&& Node.NextSibling < static_cast<uint32>(NumNodes)
+				&& Node.Entry >= INDEX_NONE && Node.Entry < NumEntries;
+		});
+		bool bArePostingsValid = Result->PostingOffsets[0] == 0 && Result->PostingOffsets.Last() == static_cast<uint32>(Result->Postings.Num());
+		for (int32 Index = 1; bArePostingsValid && Index < Result->PostingOffsets.Num(); ++Index)
+		{
+			bArePostingsValid = Result->PostingOffsets[Index - 1] <= Result->PostingOffsets[Index]
+				&& (Index == 1 || Result->TrigramKeys[Index - 2] < Result->TrigramKeys[Index - 1]);
+		}
+		bArePostingsValid = bArePostingsValid && Algo::AllOf(Result->Postings, [NumEntries](int32 Posting) { return Posting >= 0 && Posting < NumEntries; });
+		if (!bAreEntriesValid || !bAreNodesValid || !bArePostingsValid)
+		{
+			return FLoadResult::MakeFailure(FString::Printf(TEXT("Module name table '%s' is truncated or corrupt"), *FilePath));
+		}
+		return FLoadResult::MakeSuccess(Result);
+	}
+
+	FOperationResult FModuleNameTable::Save(const FString& FilePath, const FString& Key) const
+	{
+		const FTCHARToUTF8 Utf8Key(*Key, Key.Len());
+
+		FTableHeader Header;
+		Header.KeyLength = Utf8Key.Length();
+		Header.NumEntries = Entries.Num();
+		Header.NamesSize = Names.Num();
+		Header.NumTrieNodes = TrieNodes.Num();
+		Header.NumTrigrams = TrigramKeys.Num();
+		Header.NumPostings = Postings.Num();
+
+		TArray<uint8> Bytes;
+		Bytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FTableHeader));
+		Bytes.Append(reinterpret_cast<const uint8*>(Utf8Key.Get()), Utf8Key.Length());
+		AppendArray(Bytes, Entries);
+		AppendArray(Bytes, Names);
+		AppendArray(Bytes, TrieNodes);
+		AppendArray(Bytes, TrigramKeys);
+		AppendArray(Bytes, PostingOffsets);
+		AppendArray(Bytes, Postings);
+		if (!FFileHelper::SaveArrayToFile(Bytes, *FilePath))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write module name table '%s'"), *FilePath));
+		}
+		return FOperationResult::MakeSuccess();
+	}
+
+	FAnsiStringView FModuleNameTable::GetName(int32 Index) const
+	{
+		const FEntry& Entry = Entries[Index];
+		return FAnsiStringView(Names.GetData() + Entry.NameOffset, Entry.NameLength);
+	}
+
+	int32 FModuleNameTable::Find(FStringView Name) const
+	{
+		const int32 Node = FindTrieNode(Name);
+		return Node != INDEX_NONE ? TrieNodes[Node].Entry : INDEX_NONE;
+	}
+
+	TArray<FModuleNameTable::FSearchResult> FModuleNameTable::Search(FStringView Query, int32 MaxResults) const
+	{
+		TArray<FSearchResult> Result;
+		if (Query.IsEmpty() || MaxResults <= 0 || !Algo::AllOf(Query, &IsAsciiChar))
+		{
+			return Result;
+		}
+
+		TArray<ANSICHAR, TInlineAllocator<64>> LowerQueryChars;
+		for (const TCHAR Char : Query)
+		{
+			LowerQueryChars.Add(ToLowerAscii(static_cast<ANSICHAR>(Char)));
+		}
+		const FAnsiStringView LowerQuery(LowerQueryChars.GetData(), LowerQueryChars.Num());
+
+		TBitArray<> Scored(false, Entries.Num());
+		auto ScoreEntry = [this, &Result, &Scored, LowerQuery](int32 Index)
+		{
+			Scored[Index] = true;
+			if (const TOptional<int32> Score = ScoreMatch(GetName(Index), LowerQuery))
+			{
+				Result.Add({ Index, *Score });
+			}
+		};
+
+		// Every name containing the query contains all of its trigrams, so the shortest posting list holds all substring matches
+		if (LowerQuery.Len() >= 3)
+		{
+			TConstArrayView<int32> Candidates;
+			bool bHasCandidates = true;
+			for (int32 Index = 0; bHasCandidates && Index + 2 < LowerQuery.Len(); ++Index)
+			{
+				const TConstArrayView<int32> TrigramPostings = FindPostings(MakeTrigramKey(LowerQuery[Index], LowerQuery[Index + 1], LowerQuery[Index + 2]));
+				bHasCandidates = TrigramPostings.Num() > 0;
+				if (Index == 0 || TrigramPostings.Num() < Candidates.Num())
+				{
+					Candidates = TrigramPostings;
+				}
+			}
+			if (bHasCandidates)
+			{
+				for (const int32 Candidate : Candidates)
+				{
+					ScoreEntry(Candidate);
+				}
+			}
+		}
+
+		// Shorter queries are not indexed, and typos only match as subsequences, so the remaining names are scanned when there are
+		// not enough results yet. Both are rare while typing and the names are contiguous, so this stays well below a millisecond.
+		if (LowerQuery.Len() < 3 || Result.Num() < MaxResults)
+		{
+			for (int32 Index = 0; Index < Entries.Num(); ++Index)
+			{
+				if (!Scored[Index])
+				{
+					ScoreEntry(Index);
+				}
+			}
+		}
+
+		// Entries are sorted by name, so ties keep their alphabetical order
+		Result.Sort([](const FSearchResult& Left, const FSearchResult& Right)
+		{
+			return Left.Score != Right.Score ? Left.Score < Right.Score : Left.Index < Right.Index;
+		});
+		if (Result.Num() > MaxResults)
+		{
+			Result.SetNum(MaxResults);
+		}
+		return Result;
+	}
+
+	int32 FModuleNameTable::FindTrieNode(FStringView Name) const
+	{
+		if (Name.IsEmpty() || TrieNodes.Num() == 0)
+		{
+			return INDEX_NONE;
+		}
+
+		uint32 Node = 0;
+		for (const TCHAR Char : Name)
+		{
+			if (!IsAsciiChar(Char))
+			{
+				return INDEX_NONE;
+			}
+
+			const ANSICHAR LowerChar = ToLowerAscii(static_cast<ANSICHAR>(Char));
+			uint32 Child = TrieNodes[Node].FirstChild;
+			while (Child != 0 && TrieNodes[Child].Char != LowerChar)
+			{
+				Child = TrieNodes[Child].NextSibling;
+			}
+			if (Child == 0)
+			{
+				return INDEX_NONE;
+			}
+			Node = Child;
+		}
+		return static_cast<int32>(Node);
+	}
+
+	TConstArrayView<int32> FModuleNameTable::FindPostings(uint32 TrigramKey) const
+	{
+		const int32 Index = Algo::BinarySearch(TrigramKeys, TrigramKey);
+		if (Index == INDEX_NONE)
+		{
+			return {};
+		}
+		return MakeArrayView(Postings.GetData() + PostingOffsets[Index], PostingOffsets[Index + 1] - PostingOffsets[Index]);
+	}
+
+	static bool IsAsciiChar(TCHAR Char)
+	{
+		return Char > 0 && static_cast<uint32>(Char) < 128;
+	}
+
+	static ANSICHAR ToLowerAscii(ANSICHAR Char)
+	{
+		return Char >= 'A' && Char <= 'Z' ? static_cast<ANSICHAR>(Char - 'A' + 'a') : Char;
+	}
+
+	static uint32 MakeTrigramKey(ANSICHAR First, ANSICHAR Second, ANSICHAR Third)
+	{
+		return static_cast<uint32>(First) | (static_cast<uint32>(Second) << 8) | (static_cast<uint32>(Third) << 16);
+	}
+
+	/** @return Lower scores for better matches, unset if Name does not match */
+	static TOptional<int32> ScoreMatch(FAnsiStringView Name, FAnsiStringView LowerQuery)
+	{
+		TOptional<EMatchKind::Type> MatchKind;
+		for (int32 Start = 0; Start + LowerQuery.Len() <= Name.Len(); ++Start)
+		{
+			int32 Matched = 0;
+			while (Matched < LowerQuery.Len() && ToLowerAscii(Name[Start + Matched]) == LowerQuery[Matched])
+			{
+				++Matched;
+			}
+			if (Matched < LowerQuery.Len())
+			{
+				continue;
+			}
+
+			if (Start == 0)
+			{
+				MatchKind = LowerQuery.Len() == Name.Len() ? EMatchKind::Exact : EMatchKind::Prefix;
+				break;
+			}
+			// Word starts are where the PascalCase humps or underscores are, e.g. Graph in BlueprintGraph
+			const bool bIsWordStart = Name[Start - 1] == '_' || (FCharAnsi::IsUpper(Name[Start]) && !FCharAnsi::IsUpper(Name[Start - 1]));
+			if (bIsWordStart)
+			{
+				MatchKind = EMatchKind::WordStart;
+				break;
+			}
+			MatchKind = EMatchKind::Substring;
+		}
+
+		if (!MatchKind)
+		{
+			int32 Matched = 0;
+			for (int32 Index = 0; Index < Name.Len() && Matched < LowerQuery.Len(); ++Index)
+			{
+				if (ToLowerAscii(Name[Index]) == LowerQuery[Matched])
+				{
+					++Matched;
+				}
+			}
+			if (Matched < LowerQuery.Len())
+			{
+				return {};
+			}
+			MatchKind = EMatchKind::Subsequence;
+		}
+
+		// Among matches of the same kind, shorter names are closer to what was typed
+		return static_cast<int32>(*MatchKind) * (MAX_uint16 + 1) + Name.Len();
+	}
+
+	template<typename T>
+	static void AppendArray(TArray<uint8>& Bytes, const TArray<T>& Array)
+	{
+		Bytes.Append(reinterpret_cast<const uint8*>(Array.GetData()), Array.Num() * sizeof(T));
+	}
+
+	template<typename T>
+	static bool ReadArray(TConstArrayView<uint8> Bytes, uint64& InOutOffset, uint32 Num, TArray<T>& OutArray)
+	{
+		const uint64 Size = static_cast<uint64>(Num) * sizeof(T);
+		if (Num > MAX_int32 || InOutOffset + Size > static_cast<uint64>(Bytes.Num()))
+		{
+			return false;
+		}
+
+		// The arrays are not necessarily aligned in the file
+		OutArray.SetNumUninitialized(Num);
+		FMemory::Memcpy(OutArray.GetData(), Bytes.GetData() + InOutOffset, Size);
+		InOutOffset += Size;
+		return true;
+	}
+}
@@ -0,0 +1,233 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateArchive.h"
+
+#include "ModuleGenerationLog.h"
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/ModuleTemplateCache.h"
+#include "NewModule/TemplateFileContents.h"
+#include "NewModule/TokenizedTemplateString.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		/** "MGTA" */
+		constexpr uint32 ArchiveMagic = 0x4154474D;
+		/** 2: file contents are stored as their original bytes instead of converted to UTF-8, with their hash */
+		constexpr uint32 ArchiveVersion = 2;
+
+		/** All fields are little-endian, like every platform the editor runs on */
+		struct FArchiveHeader
+		{
+			uint32 Magic = ArchiveMagic;
+			uint32 Version = ArchiveVersion;
+			uint32 NumDirectories = 0;
+			uint32 NumFiles = 0;
+			/** Offset of the paths and file contents from the start of the file */
+			uint32 StringsOffset = 0;
+			uint32 StringsSize = 0;
+		};
+
+		namespace EArchiveEntryFlags
+		{
+			enum Type : uint32
+			{
+				None = 0,
+				VerbatimPath = 1 << 0,
+				VerbatimContents = 1 << 1
+			};
+		}
+
+		/** Follows the header; directories come first, then files. Offsets are relative to FArchiveHeader::StringsOffset. */
+		struct FArchiveEntry
+		{
+			uint32 PathOffset = 0;
+			uint32 PathLength = 0;
+			uint32 ContentsOffset = 0;
+			uint32 ContentsLength = 0;
+			uint32 Flags = EArchiveEntryFlags::None;
+			/** Keeps ContentsHash aligned without uninitialized padding bytes in the file */
+			uint32 Padding = 0;
+			uint64 ContentsHash = 0;
+		};
+	}
+
+	static void AppendUtf8(TArray<uint8>& Strings, FStringView Text, uint32& OutOffset, uint32& OutLength);
+	template<typename T>
+	static T ReadStruct(TConstArrayView<uint8> Bytes, SIZE_T Offset);
+
+	const TCHAR* FModuleTemplateArchive::Extension = TEXT("mgtemplate");
+
+	FOperationResult FModuleTemplateArchive::Pack(const FString& ModuleTemplateDirectory, const FString& ArchivePath)
+	{
+		TArray<FString> RelativeDirectories;
+		TArray<FString> RelativeFiles;
+		const FOperationResult EnumerateOp = EnumerateModuleTemplateDirectory(ModuleTemplateDirectory, RelativeDirectories, RelativeFiles);
+		if (EnumerateOp.IsFailure())
+		{
+			return EnumerateOp;
+		}
+
+		TArray<FArchiveEntry> Entries;
+		Entries.Reserve(RelativeDirectories.Num() + RelativeFiles.Num());
+		TArray<uint8> Strings;
+		for (const FString& RelativeDirectory : RelativeDirectories)
+		{
+			FArchiveEntry& Entry = Entries.AddDefaulted_GetRef();
+			AppendUtf8(Strings, RelativeDirectory, Entry.PathOffset, Entry.PathLength);
+			Entry.Flags = FTokenizedTemplateString::IsVerbatim(RelativeDirectory) ? EArchiveEntryFlags::VerbatimPath : EArchiveEntryFlags::None;
+		}
+		for (const FString& RelativeFile : RelativeFiles)
+		{
+			TArray<uint8> FileContents;
+			const FString FullFilePath = FPaths::Combine(ModuleTemplateDirectory, RelativeFile);
+			if (!FFileHelper::LoadFileToArray(FileContents, *FullFilePath))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to read template file '%s'"), *FullFilePath));
+			}
+
+			const ETemplateFileEncoding::Type Encoding = DetectTemplateFileEncoding(FileContents);
+			const bool bAreContentsVerbatim = Encoding == ETemplateFileEncoding::Binary || FTemplateFileContents::Tokenize(FileContents, Encoding).IsVerbatim();
+			FArchiveEntry& Entry = Entries.AddDefaulted_GetRef();
+			AppendUtf8(Strings, RelativeFile, Entry.PathOffset, Entry.PathLength);
+			Entry.ContentsOffset = Strings.Num();
+			Entry.ContentsLength = FileContents.Num();
+			Entry.ContentsHash = HashFileContents(FileContents);
+			Strings.Append(FileContents);
+			Entry.Flags = (FTokenizedTemplateString::IsVerbatim(RelativeFile) ? EArchiveEntryFlags::VerbatimPath : EArchiveEntryFlags::None)
+				| (bAreContentsVerbatim ? EArchiveEntryFlags::VerbatimContents : EArchiveEntryFlags::None);
+		}
+
+		FArchiveHeader Header;
+		Header.NumDirectories = RelativeDirectories.Num();
+		Header.NumFiles = RelativeFiles.Num();
+		Header.StringsOffset = sizeof(FArchiveHeader) + Entries.Num() * sizeof(FArchiveEntry);
+		Header.StringsSize = Strings.Num();
+
+		TArray<uint8> ArchiveBytes;
+		ArchiveBytes.Reserve(Header.StringsOffset + Header.StringsSize);
+		ArchiveBytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FArchiveHeader));
+		ArchiveBytes.Append(reinterpret_cast<const uint8*>(Entries.GetData()), Entries.Num() * sizeof(FArchiveEntry));
+		ArchiveBytes.Append(Strings);
+		if (!FFileHelper::SaveArrayToFile(ArchiveBytes, *ArchivePath))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to write template archive '%s'"), *ArchivePath));
+		}
+
+		UE_LOG(LogModuleGeneration, Log, TEXT("Packed template '%s' into '%s' (%d directories, %d files, %d bytes)"), *ModuleTemplateDirectory, *ArchivePath, RelativeDirectories.Num(), RelativeFiles.Num(), ArchiveBytes.Num());
+		return FOperationResult::MakeSuccess();
+	}
+
+	TOperationResult<TUniquePtr<FModuleTemplateArchive>> FModuleTemplateArchive::Open(const FString& ArchivePath)
+	{
+		using FOpenResult = TOperationResult<TUniquePtr<FModuleTemplateArchive>>;
+		TUniquePtr<FModuleTemplateArchive> Archive(new FModuleTemplateArchive());
+
+		auto MapResult = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*ArchivePath);
+		if (MapResult.HasValue())
+		{
+			Archive->MappedFile = MapResult.StealValue();
+			Archive->MappedRegion.Reset(Archive->MappedFile->MapRegion());
+		}
+		if (Archive->MappedRegion.IsValid() && Archive->MappedRegion->GetMappedSize() <= MAX_int32)
+		{
+			Archive->Bytes = MakeArrayView(Archive->MappedRegion->GetMappedPtr(), static_cast<int32>(Archive->MappedRegion->GetMappedSize()));
+		}
+		else
+		{
+			// Not every platform file supports mapping, e.g. pak files
+			if (!FFileHelper::LoadFileToArray(Archive->LoadedBytes, *ArchivePath))
+			{
+				return FOpenResult::MakeFailure(FString::Printf(TEXT("Failed to read template archive '%s'"), *ArchivePath));
+			}
+			Archive->Bytes = Archive->LoadedBytes;
+		}
+
+		// Validate everything up front so the accessors do not have to
+		const TConstArrayView<uint8> Bytes = Archive->Bytes;
+		if (Bytes.Num() < static_cast<int32>(sizeof(FArchiveHeader)))
+		{
+			return FOpenResult::MakeFailure(FString::Printf(TEXT("'%s' is not a template archive"), *ArchivePath));
+		}
+		const FArchiveHeader Header = ReadStruct<FArchiveHeader>(Bytes, 0);
+		if (Header.Magic != ArchiveMagic)
+		{
+			return FOpenResult::MakeFailure(FString::Printf(TEXT("'%s' is not a template archive"), *ArchivePath));
+		}
+		if (Header.Version != ArchiveVersion)
+		{
+			return FOpenResult::MakeFailure(FString::Printf(TEXT("Template archive '%s' has version %u but only version %u is supported. Pack the template again."), *ArchivePath, Header.Version, ArchiveVersion));
+		}
+		const uint64 NumEntries = static_cast<uint64>(Header.NumDirectories) + Header.NumFiles;
+		const uint64 EntriesEnd = sizeof(FArchiveHeader) + NumEntries * sizeof(FArchiveEntry);
+		if (NumEntries > MAX_int32 || EntriesEnd > Header.StringsOffset || static_cast<uint64>(Header.StringsOffset) + Header.StringsSize > static_cast<uint64>(Bytes.Num()))
+		{
+			return FOpenResult::MakeFailure(FString::Printf(TEXT("Template archive '%s' is truncated or corrupt"), *ArchivePath));
+		}
+		for (uint64 EntryIndex = 0; EntryIndex < NumEntries; ++EntryIndex)
+		{
+			const FArchiveEntry Entry = ReadStruct<FArchiveEntry>(Bytes, sizeof(FArchiveHeader) + EntryIndex * sizeof(FArchiveEntry));
+			if (static_cast<uint64>(Entry.PathOffset) + Entry.PathLength > Header.StringsSize
+				|| static_cast<uint64>(Entry.ContentsOffset) + Entry.ContentsLength > Header.StringsSize)
+			{
+				return FOpenResult::MakeFailure(FString::Printf(TEXT("Template archive '%s' is truncated or corrupt"), *ArchivePath));
+			}
+		}
+
+		Archive->DirectoryCount = Header.NumDirectories;
+		Archive->FileCount = Header.NumFiles;
+		Archive->StringsOffset = Header.StringsOffset;
+		return FOpenResult::MakeSuccess(MoveTemp(Archive));
+	}
+
+	FModuleTemplateArchive::~FModuleTemplateArchive() = default;
+
+	FModuleTemplateArchive::FEntry FModuleTemplateArchive::GetDirectory(int32 Index) const
+	{
+		check(Index >= 0 && Index < DirectoryCount);
+		return GetEntry(Index);
+	}
+
+	FModuleTemplateArchive::FEntry FModuleTemplateArchive::GetFile(int32 Index) const
+	{
+		check(Index >= 0 && Index < FileCount);
+		return GetEntry(DirectoryCount + Index);
+	}
+
+	FModuleTemplateArchive::FEntry FModuleTemplateArchive::GetEntry(int32 EntryIndex) const
+	{
+		const FArchiveEntry Entry = ReadStruct<FArchiveEntry>(Bytes, sizeof(FArchiveHeader) + EntryIndex * sizeof(FArchiveEntry));
+		const UTF8CHAR* Strings = reinterpret_cast<const UTF8CHAR*>(Bytes.GetData() + StringsOffset);
+
+		FEntry Result;
+		Result.Path = FUtf8StringView(Strings + Entry.PathOffset, Entry.PathLength);
+		Result.Contents = MakeArrayView(Bytes.GetData() + StringsOffset + Entry.ContentsOffset, static_cast<int32>(Entry.ContentsLength));
+		Result.ContentsHash = Entry.ContentsHash;
+		Result.bIsPathVerbatim = (Entry.Flags & EArchiveEntryFlags::VerbatimPath) != 0;
+		Result.bAreContentsVerbatim = (Entry.Flags & EArchiveEntryFlags::VerbatimContents) != 0;
+		return Result;
+	}
+
+	static void AppendUtf8(TArray<uint8>& Strings, FStringView Text, uint32& OutOffset, uint32& OutLength)
+	{
+		const FTCHARToUTF8 Utf8Text(Text.GetData(), Text.Len());
+		OutOffset = Strings.Num();
+		OutLength = Utf8Text.Length();
+		Strings.Append(reinterpret_cast<const uint8*>(Utf8Text.Get()), Utf8Text.Length());
+	}
+
+	template<typename T>
+	static T ReadStruct(TConstArrayView<uint8> Bytes, SIZE_T Offset)
+	{
+		// Entries are not necessarily aligned in the mapped file
+		T Result;
+		FMemory::Memcpy(&Result, Bytes.GetData() + Offset, sizeof(T));
+		return Result;
+	}
+}
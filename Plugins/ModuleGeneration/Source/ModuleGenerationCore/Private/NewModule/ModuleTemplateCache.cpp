@@ -0,0 +1,286 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateCache.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationStats.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/ModuleTemplateArchive.h"
+
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		/** A template file mapped into memory, so only files with placeholders end up on the heap */
+		struct FMappedTemplateFile
+		{
+			/** Declared before Region so the region is unmapped before the file is closed */
+			TUniquePtr<IMappedFileHandle> Handle;
+			TUniquePtr<IMappedFileRegion> Region;
+			/** Used instead of the mapping if the platform file cannot map the file, e.g. because it is empty */
+			TArray<uint8> LoadedBytes;
+			TConstArrayView<uint8> Bytes;
+
+			bool Open(const FString& FilePath)
+			{
+				auto MapResult = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*FilePath);
+				if (MapResult.HasValue())
+				{
+					Handle = MapResult.StealValue();
+					Region.Reset(Handle->MapRegion());
+				}
+				if (Region.IsValid() && Region->GetMappedSize() <= MAX_int32)
+				{
+					Bytes = MakeArrayView(Region->GetMappedPtr(), static_cast<int32>(Region->GetMappedSize()));
+					return true;
+				}
+				if (!FFileHelper::LoadFileToArray(LoadedBytes, *FilePath))
+				{
+					return false;
+				}
+				Bytes = LoadedBytes;
+				return true;
+			}
+		};
+	}
+
+	static TOperationResult<TSharedRef<const FModuleTemplate>> LoadModuleTemplate(const FString& ModuleTemplateDirectory);
+	static TOperationResult<TSharedRef<const FModuleTemplate>> LoadModuleTemplateArchive(const FString& ArchivePath);
+
+	static FAutoConsoleCommand DumpTemplateCacheStatsCommand(
+		TEXT("ModuleGeneration.TemplateCache.Stats"),
+		TEXT("Prints hit/miss counts and memory used by the module template cache."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			const FModuleTemplateCache::FStats Stats = FModuleTemplateCache::Get().GetStats();
+			UE_LOG(LogModuleGeneration, Display, TEXT("Template cache: %llu hits, %llu misses, %d templates, %llu bytes held"),
+				Stats.NumHits, Stats.NumMisses, Stats.NumTemplates, static_cast<uint64>(Stats.BytesHeld));
+		}));
+
+	static FAutoConsoleCommand InvalidateTemplateCacheCommand(
+		TEXT("ModuleGeneration.TemplateCache.Invalidate"),
+		TEXT("Drops all module templates held in memory. They are reloaded from disk on next use."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FModuleTemplateCache::Get().Invalidate();
+		}));
+
+	SIZE_T FModuleTemplate::GetAllocatedSize() const
+	{
+		SIZE_T Result = Directories.GetAllocatedSize() + Files.GetAllocatedSize();
+		for (const FTokenizedTemplateString& Directory : Directories)
+		{
+			Result += Directory.GetAllocatedSize();
+		}
+		for (const FModuleTemplateFile& File : Files)
+		{
+			Result += File.RelativePath.GetAllocatedSize() + File.Contents.GetAllocatedSize() + (File.Verbatim ? File.Verbatim->Path.GetAllocatedSize() : 0);
+		}
+		return Result;
+	}
+
+	FModuleTemplateCache& FModuleTemplateCache::Get()
+	{
+		static FModuleTemplateCache Instance;
+		return Instance;
+	}
+
+	TOperationResult<TSharedRef<const FModuleTemplate>> FModuleTemplateCache::FindOrLoad(const FString& ModuleTemplatePath)
+	{
+		// Loading happens under the lock so concurrent callers do not all load the same template
+		FScopeLock ScopeLock(&Lock);
+		if (const TSharedRef<const FModuleTemplate>* CachedTemplate = Templates.Find(ModuleTemplatePath))
+		{
+			++NumHits;
+			INC_DWORD_STAT(STAT_ModuleGeneration_TemplateCacheHits);
+			return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeSuccess(*CachedTemplate);
+		}
+
+		++NumMisses;
+		INC_DWORD_STAT(STAT_ModuleGeneration_TemplateCacheMisses);
+		const TOperationResult<TSharedRef<const FModuleTemplate>> LoadOp = FPaths::GetExtension(ModuleTemplatePath) == FModuleTemplateArchive::Extension
+			? LoadModuleTemplateArchive(ModuleTemplatePath)
+			: LoadModuleTemplate(ModuleTemplatePath);
+		if (LoadOp.IsSuccess())
+		{
+			Templates.Add(ModuleTemplatePath, LoadOp.OperationResult.GetValue());
+			INC_MEMORY_STAT_BY(STAT_ModuleGeneration_TemplateCacheMemory, LoadOp.OperationResult.GetValue()->GetAllocatedSize());
+		}
+		return LoadOp;
+	}
+
+	void FModuleTemplateCache::Invalidate()
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (Templates.Num() > 0)
+		{
+			UE_LOG(LogModuleGeneration, Verbose, TEXT("Invalidating %d cached module templates"), Templates.Num());
+		}
+		Templates.Empty();
+		SET_MEMORY_STAT(STAT_ModuleGeneration_TemplateCacheMemory, 0);
+	}
+
+	FModuleTemplateCache::FStats FModuleTemplateCache::GetStats() const
+	{
+		FScopeLock ScopeLock(&Lock);
+		FStats Result;
+		Result.NumHits = NumHits;
+		Result.NumMisses = NumMisses;
+		Result.NumTemplates = Templates.Num();
+		for (const TPair<FString, TSharedRef<const FModuleTemplate>>& Pair : Templates)
+		{
+			Result.BytesHeld += Pair.Value->GetAllocatedSize();
+		}
+		return Result;
+	}
+
+	FOperationResult EnumerateModuleTemplateDirectory(const FString& ModuleTemplateDirectory, TArray<FString>& OutRelativeDirectories, TArray<FString>& OutRelativeFiles)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		
+		const FString RootDirectory = FPaths::Combine(ModuleTemplateDirectory, FString("{ModuleName}"));
+		if (!FileManager.DirectoryExists(*RootDirectory))
+		{
+			return FOperationResult::MakeFailure(FString::Printf(TEXT("Template directory '%s' does not exist"), *RootDirectory));
+		}
+
+		// Enumerate the entire tree at once
+		MODULEGENERATION_TIMED_SCOPE(EnumerateTemplate);
+		OutRelativeDirectories = { FString("{ModuleName}") };
+		OutRelativeFiles.Reset();
+		FString PathPrefix = ModuleTemplateDirectory;
+		FPaths::NormalizeDirectoryName(PathPrefix);
+		PathPrefix += TEXT("/");
+		FileManager.IterateDirectoryRecursively(*RootDirectory, [&PathPrefix, &OutRelativeDirectories, &OutRelativeFiles](const TCHAR* Path, bool bIsDirectory)
+		{
+			FString RelativePath(Path);
+			FPaths::NormalizeFilename(RelativePath);
+			RelativePath.RemoveFromStart(PathPrefix);
+			(bIsDirectory ? OutRelativeDirectories : OutRelativeFiles).Add(MoveTemp(RelativePath));
+			return true;
+		});
+		OutRelativeDirectories.Sort();
+		OutRelativeFiles.Sort();
+		return FOperationResult::MakeSuccess();
+	}
+
+	static TOperationResult<TSharedRef<const FModuleTemplate>> LoadModuleTemplate(const FString& ModuleTemplateDirectory)
+	{
+		TArray<FString> RelativeDirectories;
+		TArray<FString> RelativeFiles;
+		const FOperationResult EnumerateOp = EnumerateModuleTemplateDirectory(ModuleTemplateDirectory, RelativeDirectories, RelativeFiles);
+		if (EnumerateOp.IsFailure())
+		{
+			return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeFailure(EnumerateOp);
+		}
+
+		const TSharedRef<FModuleTemplate> Result = MakeShared<FModuleTemplate>();
+		Result->Directories.Reserve(RelativeDirectories.Num());
+		for (const FString& RelativeDirectory : RelativeDirectories)
+		{
+			Result->Directories.Add(FTokenizedTemplateString::Tokenize(RelativeDirectory));
+		}
+
+		// Map and tokenize all files concurrently; report the first failure in sorted order.
+		// Files are tokenized as the bytes they are so their encoding is kept; binary and verbatim files are only hashed.
+		Result->Files.SetNum(RelativeFiles.Num());
+		TArray<bool> FileReadResults;
+		FileReadResults.SetNumZeroed(RelativeFiles.Num());
+		ParallelFor(RelativeFiles.Num(), [&ModuleTemplateDirectory, &RelativeFiles, &Result, &FileReadResults](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(ReadTemplate);
+			const FString FilePath = FPaths::Combine(ModuleTemplateDirectory, RelativeFiles[Index]);
+			FMappedTemplateFile MappedFile;
+			if (!MappedFile.Open(FilePath))
+			{
+				return;
+			}
+			FModuleCreationTimings::Get().AddCount(ETimedCounter::TemplateFilesRead, 1);
+			FModuleCreationTimings::Get().AddCount(ETimedCounter::TemplateBytesRead, MappedFile.Bytes.Num());
+
+			FModuleTemplateFile& TemplateFile = Result->Files[Index];
+			TemplateFile.RelativePath = FTokenizedTemplateString::Tokenize(RelativeFiles[Index]);
+			const ETemplateFileEncoding::Type Encoding = DetectTemplateFileEncoding(MappedFile.Bytes);
+			if (Encoding != ETemplateFileEncoding::Binary)
+			{
+				TemplateFile.Contents = FTemplateFileContents::Tokenize(MappedFile.Bytes, Encoding);
+			}
+			if (Encoding == ETemplateFileEncoding::Binary || TemplateFile.Contents.IsVerbatim())
+			{
+				TemplateFile.Contents = FTemplateFileContents();
+				TemplateFile.Verbatim = FVerbatimFileSource{ FPaths::ConvertRelativePathToFull(FilePath), {}, nullptr, MappedFile.Bytes.Num(), HashFileContents(MappedFile.Bytes) };
+			}
+			FileReadResults[Index] = true;
+		});
+
+		const int32 FirstFailedIndex = FileReadResults.Find(false);
+		if (FirstFailedIndex != INDEX_NONE)
+		{
+			const FString FullFilePath = FPaths::Combine(ModuleTemplateDirectory, RelativeFiles[FirstFailedIndex]);
+			return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeFailure(FString::Printf(TEXT("Failed to read template file '%s'"), *FullFilePath));
+		}
+
+		UE_LOG(LogModuleGeneration, Verbose, TEXT("Loaded module template '%s' (%d files, %llu bytes)"), *ModuleTemplateDirectory, Result->Files.Num(), static_cast<uint64>(Result->GetAllocatedSize()));
+		return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeSuccess(Result);
+	}
+
+	static TOperationResult<TSharedRef<const FModuleTemplate>> LoadModuleTemplateArchive(const FString& ArchivePath)
+	{
+		TOperationResult<TUniquePtr<FModuleTemplateArchive>> OpenOp = [&ArchivePath]()
+		{
+			MODULEGENERATION_TIMED_SCOPE(EnumerateTemplate);
+			return FModuleTemplateArchive::Open(ArchivePath);
+		}();
+		if (OpenOp.IsFailure())
+		{
+			return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeFailure(OpenOp);
+		}
+		// Verbatim files keep the archive mapped so they can be written straight from it
+		const TSharedPtr<const FModuleTemplateArchive> Archive = MakeShareable(OpenOp.OperationResult.GetValue().Release());
+
+		// Verbatim text was marked when packing and does not need to be scanned for placeholders
+		const auto ToTemplateString = [](FUtf8StringView Text, bool bIsVerbatim)
+		{
+			FString AsString(Text.Len(), Text.GetData());
+			return bIsVerbatim ? FTokenizedTemplateString::MakeVerbatim(MoveTemp(AsString)) : FTokenizedTemplateString::Tokenize(AsString);
+		};
+
+		const TSharedRef<FModuleTemplate> Result = MakeShared<FModuleTemplate>();
+		Result->Directories.Reserve(Archive->NumDirectories());
+		for (int32 Index = 0; Index < Archive->NumDirectories(); ++Index)
+		{
+			const FModuleTemplateArchive::FEntry Directory = Archive->GetDirectory(Index);
+			Result->Directories.Add(ToTemplateString(Directory.Path, Directory.bIsPathVerbatim));
+		}
+
+		// Verbatim contents are not touched at all, so their pages are only read when a module is written
+		Result->Files.SetNum(Archive->NumFiles());
+		ParallelFor(Archive->NumFiles(), [&Archive, &Result, &ToTemplateString](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(ReadTemplate);
+			const FModuleTemplateArchive::FEntry File = Archive->GetFile(Index);
+			FModuleTemplateFile& TemplateFile = Result->Files[Index];
+			TemplateFile.RelativePath = ToTemplateString(File.Path, File.bIsPathVerbatim);
+			if (File.bAreContentsVerbatim)
+			{
+				TemplateFile.Verbatim = FVerbatimFileSource{ FString(), File.Contents, Archive, File.Contents.Num(), File.ContentsHash };
+				return;
+			}
+			TemplateFile.Contents = FTemplateFileContents::Tokenize(File.Contents, DetectTemplateFileEncoding(File.Contents));
+			FModuleCreationTimings::Get().AddCount(ETimedCounter::TemplateFilesRead, 1);
+			FModuleCreationTimings::Get().AddCount(ETimedCounter::TemplateBytesRead, File.Contents.Num());
+		});
+
+		UE_LOG(LogModuleGeneration, Verbose, TEXT("Loaded packed module template '%s' (%d files, %llu bytes)"), *ArchivePath, Result->Files.Num(), static_cast<uint64>(Result->GetAllocatedSize()));
+		return TOperationResult<TSharedRef<const FModuleTemplate>>::MakeSuccess(Result);
+	}
+}
@@ -0,0 +1,393 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateFileUtils.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/ModuleTemplateCache.h"
+
+#include "ModuleDescriptor.h"
+
+#include "Algo/Count.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	const TArray<FString>& GetDefaultPublicDependencies()
+	{
+		static const TArray<FString> DefaultPublicDependencies = { TEXT("Core"), TEXT("CoreUObject"), TEXT("Engine") };
+		return DefaultPublicDependencies;
+	}
+
+	static FOperationResult AddAdditionalFiles(FPlannedModule& Module, const FModuleTemplateOptions& Options);
+	static void AddPrivatePCH(FPlannedModule& Module, const FModuleTemplateOptions& Options);
+	static TOperationResult<FModuleDependencies> AnalyzePlannedModule(const FPlannedModule& Module, const FModuleTemplateOptions& Options);
+	static TArray<FString> AddAdditionalDependencies(const TArray<FString>& PublicDependencies, TArray<FString> PrivateDependencies, TConstArrayView<FString> AdditionalDependencies);
+	static void RecordPlaceholderValues(FPlannedModule& Module, const FTemplatePlaceholderValues& Values);
+	static FString LoadPlannedFileText(const FPlannedFile& File);
+
+	FOperationResult InstantiateModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FModuleTemplateOptions& Options)
+	{
+		const TOperationResult<FPlannedModule> PlanOp = PlanModuleTemplate(ModuleTemplatePath, OutputDirectory, NewModule, Options);
+		if (PlanOp.IsFailure())
+		{
+			return FOperationResult::MakeFailure(PlanOp);
+		}
+		return WritePlannedModule(PlanOp.OperationResult.GetValue(), OutputDirectory);
+	}
+
+	FOperationResult InstantiateModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FString& CopyrightNotice)
+	{
+		return InstantiateModuleTemplate(ModuleTemplatePath, OutputDirectory, NewModule, FModuleTemplateOptions{ CopyrightNotice });
+	}
+
+	TOperationResult<FPlannedModule> PlanModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FModuleTemplateOptions& Options)
+	{
+		const TOperationResult<TSharedRef<const FModuleTemplate>> FindTemplateOp = FModuleTemplateCache::Get().FindOrLoad(ModuleTemplatePath);
+		if (FindTemplateOp.IsFailure())
+		{
+			return TOperationResult<FPlannedModule>::MakeFailure(FindTemplateOp);
+		}
+		const FModuleTemplate& ModuleTemplate = *FindTemplateOp.OperationResult.GetValue();
+		
+		// Setup string replacements for files and folders
+		const FString ModuleName = NewModule.Name.ToString();
+		const TArray<FString> DefaultPrivateDependencies = AddAdditionalDependencies(GetDefaultPublicDependencies(), {}, Options.AdditionalPrivateDependencies);
+		FString PublicDependencies = FormatDependencyList(GetDefaultPublicDependencies());
+		FString PrivateDependencies = FormatDependencyList(DefaultPrivateDependencies);
+		const FString BuildSettings = FormatBuildSettings(Options.BuildSettings, ModuleName);
+		FTemplatePlaceholderValues WildcardsToReplace;
+		WildcardsToReplace[ETemplatePlaceholder::ModuleName] = ModuleName;
+		WildcardsToReplace[ETemplatePlaceholder::Copyright] = Options.CopyrightNotice;
+		WildcardsToReplace[ETemplatePlaceholder::PublicDependencies] = PublicDependencies;
+		WildcardsToReplace[ETemplatePlaceholder::PrivateDependencies] = PrivateDependencies;
+		WildcardsToReplace[ETemplatePlaceholder::BuildSettings] = BuildSettings;
+
+		FPlannedModule Result;
+		Result.OutputDirectory = OutputDirectory;
+		Result.ModuleName = NewModule.Name;
+		Result.TemplateName = FPaths::GetBaseFilename(FPaths::GetPathLeaf(ModuleTemplatePath));
+		Result.RelativeDirectories.Reserve(ModuleTemplate.Directories.Num());
+		for (const FTokenizedTemplateString& RelativeDirectory : ModuleTemplate.Directories)
+		{
+			Result.RelativeDirectories.Add(RelativeDirectory.Instantiate(WildcardsToReplace));
+		}
+
+		// Replace the placeholders in the file names and contents concurrently. Contents are substituted as UTF-8 bytes; verbatim
+		// files are copied from the template when the module is written.
+		const FUtf8PlaceholderValues Utf8WildcardsToReplace(WildcardsToReplace);
+		Result.Files.SetNum(ModuleTemplate.Files.Num());
+		ParallelFor(ModuleTemplate.Files.Num(), [&ModuleTemplate, &WildcardsToReplace, &Utf8WildcardsToReplace, &Result](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(Substitute);
+			const FModuleTemplateFile& TemplateFile = ModuleTemplate.Files[Index];
+			FPlannedFile& File = Result.Files[Index];
+			File.RelativePath = TemplateFile.RelativePath.Instantiate(WildcardsToReplace);
+			if (TemplateFile.Verbatim)
+			{
+				File.Verbatim = TemplateFile.Verbatim;
+			}
+			else
+			{
+				File.Contents = TemplateFile.Contents.Instantiate(Utf8WildcardsToReplace);
+			}
+		});
+
+		if (Options.AdditionalFiles.Num() > 0)
+		{
+			const FOperationResult AddFilesOp = AddAdditionalFiles(Result, Options);
+			if (AddFilesOp.IsFailure())
+			{
+				return TOperationResult<FPlannedModule>::MakeFailure(AddFilesOp);
+			}
+		}
+		if (Options.BuildSettings.PCHMode == EModulePCHMode::Private)
+		{
+			AddPrivatePCH(Result, Options);
+		}
+
+		if (!Options.IncludeMap)
+		{
+			if (Options.BuildSettings.PCHMode == EModulePCHMode::Shared)
+			{
+				TArray<FString> AllDependencies = GetDefaultPublicDependencies();
+				AllDependencies.Append(DefaultPrivateDependencies);
+				Result.SharedPCHProvider = FindSharedPCHProvider(AllDependencies);
+			}
+			RecordPlaceholderValues(Result, WildcardsToReplace);
+			return TOperationResult<FPlannedModule>::MakeSuccess(MoveTemp(Result));
+		}
+
+		// The sources decide the dependencies, so files listing the dependencies, i.e. the .Build.cs file, are instantiated again
+		TOperationResult<FModuleDependencies> AnalyzeOp = AnalyzePlannedModule(Result, Options);
+		if (AnalyzeOp.IsFailure())
+		{
+			return TOperationResult<FPlannedModule>::MakeFailure(AnalyzeOp);
+		}
+		Result.Dependencies = MoveTemp(AnalyzeOp.OperationResult.GetValue());
+		Result.Dependencies->PrivateDependencies = AddAdditionalDependencies(Result.Dependencies->PublicDependencies, MoveTemp(Result.Dependencies->PrivateDependencies), Options.AdditionalPrivateDependencies);
+		PublicDependencies = FormatDependencyList(Result.Dependencies->PublicDependencies);
+		PrivateDependencies = FormatDependencyList(Result.Dependencies->PrivateDependencies);
+		WildcardsToReplace[ETemplatePlaceholder::PublicDependencies] = PublicDependencies;
+		WildcardsToReplace[ETemplatePlaceholder::PrivateDependencies] = PrivateDependencies;
+		const FUtf8PlaceholderValues Utf8AnalyzedWildcards(WildcardsToReplace);
+		for (const FModuleTemplateFile& TemplateFile : ModuleTemplate.Files)
+		{
+			const FTemplateFileContents& Contents = TemplateFile.Contents;
+			if (Contents.HasPlaceholder(ETemplatePlaceholder::PublicDependencies) || Contents.HasPlaceholder(ETemplatePlaceholder::PrivateDependencies))
+			{
+				MODULEGENERATION_TIMED_SCOPE(Substitute);
+				// Added files shift the template's files, so they are matched by path. A template PCH may have been replaced.
+				const FString RelativePath = TemplateFile.RelativePath.Instantiate(WildcardsToReplace);
+				if (FPlannedFile* File = Result.Files.FindByPredicate([&RelativePath](const FPlannedFile& Candidate) { return Candidate.RelativePath == RelativePath; }))
+				{
+					File->Contents = Contents.Instantiate(Utf8AnalyzedWildcards);
+				}
+			}
+		}
+		if (Options.BuildSettings.PCHMode == EModulePCHMode::Shared)
+		{
+			TArray<FString> AllDependencies = Result.Dependencies->PublicDependencies;
+			AllDependencies.Append(Result.Dependencies->PrivateDependencies);
+			Result.SharedPCHProvider = FindSharedPCHProvider(AllDependencies);
+		}
+		RecordPlaceholderValues(Result, WildcardsToReplace);
+		
+		return TOperationResult<FPlannedModule>::MakeSuccess(MoveTemp(Result));
+	}
+
+	TOperationResult<FPlannedModule> PlanModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FString& CopyrightNotice)
+	{
+		return PlanModuleTemplate(ModuleTemplatePath, OutputDirectory, NewModule, FModuleTemplateOptions{ CopyrightNotice });
+	}
+
+	FOperationResult WritePlannedModule(const FPlannedModule& Module, const FString& TargetDirectory)
+	{
+		// Directories are sorted so parents are created before their children
+		IFileManager& FileManager = IFileManager::Get();
+		{
+			MODULEGENERATION_TIMED_SCOPE(CreateDirectories);
+			for (const FString& RelativeDirectory : Module.RelativeDirectories)
+			{
+				const FString NewDirectoryName = FPaths::Combine(TargetDirectory, RelativeDirectory);
+				if (!FileManager.DirectoryExists(*NewDirectoryName))
+				{
+					if (!FileManager.MakeDirectory(*NewDirectoryName, true))
+					{
+						return FOperationResult::MakeFailure(FString::Printf(TEXT("Failed to create directory '%s'"), *NewDirectoryName));
+					}
+					FModuleCreationTimings::Get().AddCount(ETimedCounter::DirectoriesCreated, 1);
+				}
+			}
+		}
+
+		TArray<FString> NewFilePaths;
+		NewFilePaths.Reserve(Module.Files.Num());
+		for (const FPlannedFile& File : Module.Files)
+		{
+			NewFilePaths.Add(FPaths::Combine(TargetDirectory, File.RelativePath));
+		}
+
+		// Every instantiated file is held in memory until it is written; verbatim ones never are
+		int64 InstantiationBytes = 0;
+		for (const FPlannedFile& File : Module.Files)
+		{
+			InstantiationBytes += File.Contents.Num();
+		}
+		FModuleCreationTimings::Get().RecordInstantiationBytes(InstantiationBytes);
+
+		// Write the files concurrently, skipping those which already have the same contents so their timestamps stay the same
+		TArray<TOptional<FString>> FileErrors;
+		TArray<FGeneratedFilesManifest::FFile> ManifestFiles;
+		TArray<EFileWriteOutcome::Type> Outcomes;
+		FileErrors.SetNum(Module.Files.Num());
+		ManifestFiles.SetNum(Module.Files.Num());
+		Outcomes.SetNum(Module.Files.Num());
+		ParallelFor(Module.Files.Num(), [&Module, &NewFilePaths, &FileErrors, &ManifestFiles, &Outcomes](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(WriteFiles);
+			const FPlannedFile& File = Module.Files[Index];
+			const TOperationResult<EFileWriteOutcome::Type> WriteOp = File.Verbatim
+				? CopyFileIfChanged(NewFilePaths[Index], File.Verbatim.GetValue())
+				: WriteFileIfChanged(NewFilePaths[Index], File.Contents);
+			if (WriteOp.IsFailure())
+			{
+				FileErrors[Index] = WriteOp.ErrorMessage;
+				return;
+			}
+			Outcomes[Index] = WriteOp.OperationResult.GetValue();
+			ManifestFiles[Index].Size = File.GetSize();
+			ManifestFiles[Index].Hash = File.Verbatim ? File.Verbatim->Hash : HashFileContents(File.Contents);
+		});
+
+		// Report the first failure in sorted path order so the error does not depend on scheduling
+		int32 FirstFailedIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < FileErrors.Num(); ++Index)
+		{
+			if (FileErrors[Index].IsSet() && (FirstFailedIndex == INDEX_NONE || NewFilePaths[Index] < NewFilePaths[FirstFailedIndex]))
+			{
+				FirstFailedIndex = Index;
+			}
+		}
+		if (FirstFailedIndex != INDEX_NONE)
+		{
+			return FOperationResult::MakeFailure(FileErrors[FirstFailedIndex].GetValue());
+		}
+
+		// Template paths start with the module's folder but the manifest lives in it
+		const FString ModuleFolderPrefix = Module.ModuleName.ToString() + TEXT("/");
+		FGeneratedFilesManifest Manifest;
+		Manifest.TemplateName = Module.TemplateName;
+		Manifest.PlaceholderValues = Module.PlaceholderValues;
+		for (int32 Index = 0; Index < Module.Files.Num(); ++Index)
+		{
+			FGeneratedFilesManifest::FFile& File = ManifestFiles[Index];
+			File.RelativePath = Module.Files[Index].RelativePath;
+			if (File.RelativePath.StartsWith(ModuleFolderPrefix))
+			{
+				File.RelativePath.RightChopInline(ModuleFolderPrefix.Len());
+				Manifest.Files.Add(MoveTemp(File));
+			}
+		}
+		Manifest.Files.Sort([](const FGeneratedFilesManifest::FFile& Left, const FGeneratedFilesManifest::FFile& Right) { return Left.RelativePath < Right.RelativePath; });
+		const FOperationResult ManifestOp = Manifest.Save(FPaths::Combine(TargetDirectory, Module.ModuleName.ToString()));
+		if (ManifestOp.IsFailure())
+		{
+			return ManifestOp;
+		}
+
+		UE_LOG(LogModuleGeneration, Verbose, TEXT("Wrote %d files of module %s and copied %d, %d were unchanged; %lld bytes were held in memory"),
+			Algo::CountIf(Outcomes, [](EFileWriteOutcome::Type Outcome) { return Outcome == EFileWriteOutcome::Written; }),
+			*Module.ModuleName.ToString(),
+			Algo::CountIf(Outcomes, [](EFileWriteOutcome::Type Outcome) { return Outcome == EFileWriteOutcome::Copied; }),
+			Algo::CountIf(Outcomes, [](EFileWriteOutcome::Type Outcome) { return Outcome == EFileWriteOutcome::Unchanged; }),
+			InstantiationBytes);
+
+		return FOperationResult::MakeSuccess();
+	}
+
+	static FOperationResult AddAdditionalFiles(FPlannedModule& Module, const FModuleTemplateOptions& Options)
+	{
+		TSet<FString> Directories(Module.RelativeDirectories);
+		TSet<FString> FilePaths;
+		for (const FPlannedFile& File : Module.Files)
+		{
+			FilePaths.Add(File.RelativePath);
+		}
+
+		for (const FPlannedFile& File : Options.AdditionalFiles)
+		{
+			if (FilePaths.Contains(File.RelativePath))
+			{
+				return FOperationResult::MakeFailure(FString::Printf(TEXT("'%s' is part of the template already"), *File.RelativePath));
+			}
+			FilePaths.Add(File.RelativePath);
+			Module.Files.Add(File);
+
+			// Every parent up to the module's folder must be created, too
+			for (FString Directory = FPaths::GetPath(File.RelativePath); Directory.Contains(TEXT("/")) && !Directories.Contains(Directory); Directory = FPaths::GetPath(Directory))
+			{
+				Directories.Add(Directory);
+				Module.RelativeDirectories.Add(Directory);
+			}
+		}
+		Module.RelativeDirectories.Sort();
+		Module.Files.Sort([](const FPlannedFile& Left, const FPlannedFile& Right) { return Left.RelativePath < Right.RelativePath; });
+		return FOperationResult::MakeSuccess();
+	}
+
+	static void AddPrivatePCH(FPlannedModule& Module, const FModuleTemplateOptions& Options)
+	{
+		const FString ModuleName = Module.ModuleName.ToString();
+		const FString& SiblingModulesDirectory = Options.SiblingModulesDirectory.IsEmpty() ? Module.OutputDirectory : Options.SiblingModulesDirectory;
+		// Without an include map the headers' modules could not become dependencies, so the PCH only includes CoreMinimal.h then
+		const TArray<FString> Includes = Options.IncludeMap
+			? FindCommonSiblingIncludes(SiblingModulesDirectory, Options.BuildSettings.MaxPrivatePCHHeaders, *Options.IncludeMap)
+			: TArray<FString>();
+		const FString PCHPath = FPaths::Combine(ModuleName, GetPrivatePCHPath(ModuleName));
+		const FString PCHDirectory = FPaths::GetPath(PCHPath);
+		if (!Module.RelativeDirectories.Contains(PCHDirectory))
+		{
+			Module.RelativeDirectories.Add(PCHDirectory);
+			Module.RelativeDirectories.Sort();
+		}
+
+		// The template may bring its own PCH, which is replaced
+		Module.Files.RemoveAll([&PCHPath](const FPlannedFile& File) { return File.RelativePath == PCHPath; });
+		Module.Files.Add({ PCHPath, EncodeTemplateText(MakePrivatePCHContents(Options.CopyrightNotice, Includes), ETemplateFileEncoding::Utf8) });
+		Module.Files.Sort([](const FPlannedFile& Left, const FPlannedFile& Right) { return Left.RelativePath < Right.RelativePath; });
+	}
+
+	static TOperationResult<FModuleDependencies> AnalyzePlannedModule(const FPlannedModule& Module, const FModuleTemplateOptions& Options)
+	{
+		// Planned files are relative to the output directory, i.e. start with the module's folder
+		const FString ModuleFolderPrefix = Module.ModuleName.ToString() + TEXT("/");
+		TArray<FSourceFileToAnalyze> Files;
+		Files.Reserve(Module.Files.Num() + Options.AdditionalPublicHeaders.Num());
+		for (const FPlannedFile& File : Module.Files)
+		{
+			if (!File.RelativePath.EndsWith(TEXT(".cs")))
+			{
+				FString RelativePath = File.RelativePath;
+				RelativePath.RemoveFromStart(ModuleFolderPrefix);
+				const bool bIsPublic = IsPublicSourcePath(RelativePath);
+				Files.Add({ MoveTemp(RelativePath), LoadPlannedFileText(File), bIsPublic });
+			}
+		}
+		for (const FString& HeaderPath : Options.AdditionalPublicHeaders)
+		{
+			FSourceFileToAnalyze& Header = Files.Add_GetRef({ FPaths::ConvertRelativePathToFull(HeaderPath), FString(), true });
+			if (!FFileHelper::LoadFileToString(Header.Contents, *HeaderPath))
+			{
+				return TOperationResult<FModuleDependencies>::MakeFailure(FString::Printf(TEXT("Failed to read header '%s'"), *HeaderPath));
+			}
+		}
+
+		return TOperationResult<FModuleDependencies>::MakeSuccess(AnalyzeModuleDependencies(*Options.IncludeMap, Module.ModuleName.ToString(), Files));
+	}
+
+	static TArray<FString> AddAdditionalDependencies(const TArray<FString>& PublicDependencies, TArray<FString> PrivateDependencies, TConstArrayView<FString> AdditionalDependencies)
+	{
+		// TArray<FString>::Contains compares case-insensitively, like UnrealBuildTool compares module names
+		for (const FString& Dependency : AdditionalDependencies)
+		{
+			if (!PublicDependencies.Contains(Dependency) && !PrivateDependencies.Contains(Dependency))
+			{
+				PrivateDependencies.Add(Dependency);
+			}
+		}
+		PrivateDependencies.Sort();
+		return PrivateDependencies;
+	}
+
+	static void RecordPlaceholderValues(FPlannedModule& Module, const FTemplatePlaceholderValues& Values)
+	{
+		for (int32 Placeholder = 0; Placeholder < ETemplatePlaceholder::Num; ++Placeholder)
+		{
+			Module.PlaceholderValues[Placeholder] = FString(Values[Placeholder]);
+		}
+	}
+
+	static FString LoadPlannedFileText(const FPlannedFile& File)
+	{
+		// BufferToString detects the encoding from the byte order mark like LoadFileToString
+		FString Result;
+		if (!File.Verbatim)
+		{
+			FFileHelper::BufferToString(Result, File.Contents.GetData(), File.Contents.Num());
+		}
+		else if (File.Verbatim->Path.IsEmpty())
+		{
+			FFileHelper::BufferToString(Result, File.Verbatim->ArchiveBytes.GetData(), File.Verbatim->ArchiveBytes.Num());
+		}
+		else
+		{
+			FFileHelper::LoadFileToString(Result, *File.Verbatim->Path);
+		}
+		return Result;
+	}
+}
@@ -0,0 +1,54 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateRegistry.h"
+
+#include "NewModule/ModuleTemplateArchive.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	TArray<FModuleTemplateInfo> FindModuleTemplates(const FString& TemplatesDirectory)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+
+		// TMap<FString> compares case-insensitively, like the file systems templates are usually authored on
+		TMap<FString, FModuleTemplateInfo> TemplatesByName;
+		FileManager.IterateDirectory(*TemplatesDirectory, [&FileManager, &TemplatesByName](const TCHAR* Path, bool bIsDirectory)
+		{
+			FString TemplatePath(Path);
+			FPaths::NormalizeFilename(TemplatePath);
+			if (!bIsDirectory && FPaths::GetExtension(TemplatePath) == FModuleTemplateArchive::Extension)
+			{
+				FString Name = FPaths::GetBaseFilename(TemplatePath);
+				TemplatesByName.Add(Name, { Name, MoveTemp(TemplatePath), true });
+			}
+			else if (bIsDirectory && FileManager.DirectoryExists(*FPaths::Combine(TemplatePath, TEXT("{ModuleName}"))))
+			{
+				FString Name = FPaths::GetCleanFilename(TemplatePath);
+				const FModuleTemplateInfo* Existing = TemplatesByName.Find(Name);
+				if (Existing == nullptr || !Existing->bIsPacked)
+				{
+					TemplatesByName.Add(Name, { Name, MoveTemp(TemplatePath), false });
+				}
+			}
+			return true;
+		});
+
+		TArray<FModuleTemplateInfo> Result;
+		TemplatesByName.GenerateValueArray(Result);
+		Result.Sort([](const FModuleTemplateInfo& Left, const FModuleTemplateInfo& Right) { return Left.Name < Right.Name; });
+		return Result;
+	}
+
+	TOperationResult<FModuleTemplateInfo> FindModuleTemplate(const FString& TemplatesDirectory, const FString& Name)
+	{
+		TArray<FModuleTemplateInfo> Templates = FindModuleTemplates(TemplatesDirectory);
+		if (FModuleTemplateInfo* Template = Templates.FindByPredicate([&Name](const FModuleTemplateInfo& Info) { return Info.Name.Equals(Name, ESearchCase::IgnoreCase); }))
+		{
+			return TOperationResult<FModuleTemplateInfo>::MakeSuccess(MoveTemp(*Template));
+		}
+		return TOperationResult<FModuleTemplateInfo>::MakeFailure(FString::Printf(TEXT("There is no template called '%s' in '%s'"), *Name, *TemplatesDirectory));
+	}
+}
@@ -0,0 +1,296 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateSync.h"
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleBuildSettings.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+#include "NewModule/ModuleTemplateCache.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+#include "NewModule/ModuleTemplateRegistry.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace EGeneratedFileState
+	{
+		const TCHAR* ToString(Type State)
+		{
+			switch (State)
+			{
+			case UpToDate: return TEXT("UpToDate");
+			case Outdated: return TEXT("Outdated");
+			case Added: return TEXT("Added");
+			case Edited: return TEXT("Edited");
+			case Missing: return TEXT("Missing");
+			default:
+				checkNoEntry();
+				return TEXT("");
+			}
+		}
+	}
+
+	static FGeneratedFilesManifest MakeUntrackedManifest(const FString& ModuleName, const FString& TemplateName, const FString& CopyrightNotice);
+	static void SyncModule(const FModuleTemplate& ModuleTemplate, const FGeneratedFilesManifest& Manifest, bool bApply, FModuleSyncResult& InOutResult);
+	static EGeneratedFileState::Type CompareWithDisk(const FString& FilePath, int64 ExpectedSize, uint64 ExpectedHash, const FGeneratedFilesManifest::FFile* GeneratedFile);
+
+	FModuleSyncReport SyncModulesWithTemplate(const FModuleSyncSettings& Settings)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray<FIndexedSourceModule> SourceModules;
+		FindSourceModules(FPaths::Combine(Settings.ProjectDirectory, TEXT("Source")), SourceModules);
+		FindSourceModules(FPaths::Combine(Settings.ProjectDirectory, TEXT("Plugins")), SourceModules);
+
+		// Manifests are read in parallel like the modules are compared below
+		TArray<FModuleSyncResult> Results;
+		TArray<TOptional<FGeneratedFilesManifest>> Manifests;
+		Results.SetNum(SourceModules.Num());
+		Manifests.SetNum(SourceModules.Num());
+		ParallelFor(SourceModules.Num(), [&Settings, &SourceModules, &Results, &Manifests](int32 Index)
+		{
+			MODULEGENERATION_TIMED_SCOPE(CompareFiles);
+			FModuleSyncResult& Result = Results[Index];
+			Result.ModuleName = SourceModules[Index].Name;
+			Result.ModuleDirectory = SourceModules[Index].Directory;
+			Manifests[Index] = FGeneratedFilesManifest::Load(Result.ModuleDirectory);
+			Result.bIsTracked = Manifests[Index].IsSet();
+			if (!Result.bIsTracked && Settings.UntrackedModulesTemplateName)
+			{
+				Manifests[Index] = MakeUntrackedManifest(Result.ModuleName, Settings.UntrackedModulesTemplateName.GetValue(), Settings.CopyrightNotice);
+			}
+		});
+
+		// Few templates are in use, so they are resolved once up front instead of by every task
+		TMap<FString, TOperationResult<TSharedRef<const FModuleTemplate>>> Templates;
+		for (const TOptional<FGeneratedFilesManifest>& Manifest : Manifests)
+		{
+			if (Manifest && !Templates.Contains(Manifest->TemplateName))
+			{
+				const TOperationResult<FModuleTemplateInfo> FindTemplateOp = FindModuleTemplate(Settings.TemplatesDirectory, Manifest->TemplateName);
+				Templates.Add(Manifest->TemplateName, FindTemplateOp.IsSuccess()
+					? FModuleTemplateCache::Get().FindOrLoad(FindTemplateOp.OperationResult->Path)
+					: TOperationResult<TSharedRef<const FModuleTemplate>>::MakeFailure(FindTemplateOp));
+			}
+		}
+
+		ParallelFor(SourceModules.Num(), [&Settings, &Results, &Manifests, &Templates](int32 Index)
+		{
+			if (!Manifests[Index])
+			{
+				return;
+			}
+
+			FModuleSyncResult& Result = Results[Index];
+			Result.TemplateName = Manifests[Index]->TemplateName;
+			const TOperationResult<TSharedRef<const FModuleTemplate>>& TemplateOp = Templates.FindChecked(Result.TemplateName);
+			if (TemplateOp.IsFailure())
+			{
+				Result.ErrorMessage = TemplateOp.ErrorMessage;
+				return;
+			}
+			SyncModule(*TemplateOp.OperationResult.GetValue(), Manifests[Index].GetValue(), Settings.bApply, Result);
+		});
+
+		FModuleSyncReport Report;
+		Report.Modules.Reserve(Results.Num());
+		for (int32 Index = 0; Index < Results.Num(); ++Index)
+		{
+			if (Manifests[Index])
+			{
+				Report.Modules.Add(MoveTemp(Results[Index]));
+			}
+			else
+			{
+				++Report.NumUntrackedModules;
+			}
+		}
+		Report.Modules.Sort([](const FModuleSyncResult& Left, const FModuleSyncResult& Right) { return Left.ModuleName < Right.ModuleName; });
+		Report.Seconds = FPlatformTime::Seconds() - StartTime;
+		return Report;
+	}
+
+	void LogModuleSyncReport(const FModuleSyncReport& Report, bool bApplied)
+	{
+		int32 NumDrifted = 0;
+		int32 NumFilesWritten = 0;
+		for (const FModuleSyncResult& Module : Report.Modules)
+		{
+			NumFilesWritten += Module.NumFilesWritten;
+			if (Module.ErrorMessage)
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("%s: %s"), *Module.ModuleName, *Module.ErrorMessage.GetValue());
+			}
+			if (!Module.HasDrifted())
+			{
+				continue;
+			}
+
+			++NumDrifted;
+			UE_LOG(LogModuleGeneration, Display, TEXT("%s has drifted from template '%s'%s: %d outdated, %d added, %d edited, %d missing, %d written"),
+				*Module.ModuleName,
+				*Module.TemplateName,
+				Module.bIsTracked ? TEXT("") : TEXT(" (no manifest)"),
+				Module.NumFilesByState[EGeneratedFileState::Outdated],
+				Module.NumFilesByState[EGeneratedFileState::Added],
+				Module.NumFilesByState[EGeneratedFileState::Edited],
+				Module.NumFilesByState[EGeneratedFileState::Missing],
+				Module.NumFilesWritten);
+			for (const FModuleSyncResult::FFile& File : Module.Files)
+			{
+				if (File.State != EGeneratedFileState::UpToDate)
+				{
+					UE_LOG(LogModuleGeneration, Log, TEXT("  %-9s %s"), EGeneratedFileState::ToString(File.State), *File.RelativePath);
+				}
+			}
+		}
+
+		UE_LOG(LogModuleGeneration, Display, TEXT("%d of %d modules have drifted from their template, %d files %s, %d modules without manifest skipped (%.2f s)"),
+			NumDrifted,
+			Report.Modules.Num(),
+			NumFilesWritten,
+			bApplied ? TEXT("written") : TEXT("would be written"),
+			Report.NumUntrackedModules,
+			Report.Seconds);
+	}
+
+	static FGeneratedFilesManifest MakeUntrackedManifest(const FString& ModuleName, const FString& TemplateName, const FString& CopyrightNotice)
+	{
+		// Matches what PlanModuleTemplate substitutes without an include map, additional dependencies or build variant
+		FGeneratedFilesManifest Result;
+		Result.TemplateName = TemplateName;
+		Result.PlaceholderValues[ETemplatePlaceholder::ModuleName] = ModuleName;
+		Result.PlaceholderValues[ETemplatePlaceholder::Copyright] = CopyrightNotice;
+		Result.PlaceholderValues[ETemplatePlaceholder::PublicDependencies] = FormatDependencyList(GetDefaultPublicDependencies());
+		Result.PlaceholderValues[ETemplatePlaceholder::PrivateDependencies] = FormatDependencyList({});
+		Result.PlaceholderValues[ETemplatePlaceholder::BuildSettings] = FormatBuildSettings(FModuleBuildSettings(), ModuleName);
+		return Result;
+	}
+
+	static void SyncModule(const FModuleTemplate& ModuleTemplate, const FGeneratedFilesManifest& Manifest, bool bApply, FModuleSyncResult& InOutResult)
+	{
+		// The module's current name wins over the manifest's in case it was renamed
+		FTemplatePlaceholderValues Values;
+		for (int32 Placeholder = 0; Placeholder < ETemplatePlaceholder::Num; ++Placeholder)
+		{
+			Values[Placeholder] = Manifest.PlaceholderValues[Placeholder];
+		}
+		Values[ETemplatePlaceholder::ModuleName] = InOutResult.ModuleName;
+		const FUtf8PlaceholderValues Utf8Values(Values);
+
+		// Template paths start with the module's folder but the manifest lives in it
+		const FString ModuleFolderPrefix = InOutResult.ModuleName + TEXT("/");
+		TArray<FGeneratedFilesManifest::FFile> UpToDateFiles;
+		for (const FModuleTemplateFile& TemplateFile : ModuleTemplate.Files)
+		{
+			FString RelativePath = TemplateFile.RelativePath.Instantiate(Values);
+			if (!RelativePath.StartsWith(ModuleFolderPrefix))
+			{
+				continue;
+			}
+			RelativePath.RightChopInline(ModuleFolderPrefix.Len());
+
+			// Verbatim files are compared by the size and hash recorded when the template was loaded
+			const FString FilePath = FPaths::Combine(InOutResult.ModuleDirectory, RelativePath);
+			const TArray<uint8> ExpectedContents = TemplateFile.Verbatim ? TArray<uint8>() : TemplateFile.Contents.Instantiate(Utf8Values);
+			const int64 ExpectedSize = TemplateFile.Verbatim ? TemplateFile.Verbatim->Size : ExpectedContents.Num();
+			const uint64 ExpectedHash = TemplateFile.Verbatim ? TemplateFile.Verbatim->Hash : HashFileContents(ExpectedContents);
+			EGeneratedFileState::Type State;
+			{
+				MODULEGENERATION_TIMED_SCOPE(CompareFiles);
+				State = CompareWithDisk(FilePath, ExpectedSize, ExpectedHash, Manifest.Find(RelativePath));
+				if (State == EGeneratedFileState::Added && !InOutResult.bIsTracked)
+				{
+					State = EGeneratedFileState::Missing;
+				}
+			}
+			InOutResult.Files.Add({ RelativePath, State });
+			++InOutResult.NumFilesByState[State];
+
+			bool bIsWritten = false;
+			if ((State == EGeneratedFileState::Outdated || State == EGeneratedFileState::Added) && bApply && !InOutResult.ErrorMessage)
+			{
+				MODULEGENERATION_TIMED_SCOPE(WriteFiles);
+				IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+				const TOperationResult<EFileWriteOutcome::Type> WriteOp = TemplateFile.Verbatim
+					? CopyFileIfChanged(FilePath, TemplateFile.Verbatim.GetValue())
+					: WriteFileIfChanged(FilePath, ExpectedContents);
+				if (WriteOp.IsSuccess())
+				{
+					++InOutResult.NumFilesWritten;
+					bIsWritten = true;
+				}
+				else
+				{
+					// Keep comparing so the report is complete, but write nothing else
+					InOutResult.ErrorMessage = WriteOp.ErrorMessage;
+				}
+			}
+			if (State == EGeneratedFileState::UpToDate || bIsWritten)
+			{
+				UpToDateFiles.Add({ MoveTemp(RelativePath), ExpectedSize, ExpectedHash });
+			}
+		}
+		InOutResult.Files.Sort([](const FModuleSyncResult::FFile& Left, const FModuleSyncResult::FFile& Right) { return Left.RelativePath < Right.RelativePath; });
+
+		// Modules without manifest only get one if some of their files can be tracked from now on
+		if (!bApply || (!InOutResult.bIsTracked && UpToDateFiles.IsEmpty()))
+		{
+			return;
+		}
+
+		// Entries of edited, missing and no longer generated files are kept so they are recognized if they are reverted
+		FGeneratedFilesManifest UpdatedManifest = Manifest;
+		UpdatedManifest.PlaceholderValues[ETemplatePlaceholder::ModuleName] = InOutResult.ModuleName;
+		for (FGeneratedFilesManifest::FFile& File : UpToDateFiles)
+		{
+			if (const FGeneratedFilesManifest::FFile* ExistingFile = Manifest.Find(File.RelativePath))
+			{
+				UpdatedManifest.Files[ExistingFile - Manifest.Files.GetData()] = MoveTemp(File);
+			}
+			else
+			{
+				UpdatedManifest.Files.Add(MoveTemp(File));
+			}
+		}
+		UpdatedManifest.Files.Sort([](const FGeneratedFilesManifest::FFile& Left, const FGeneratedFilesManifest::FFile& Right) { return Left.RelativePath < Right.RelativePath; });
+
+		const FOperationResult SaveOp = UpdatedManifest.Save(InOutResult.ModuleDirectory);
+		if (SaveOp.IsFailure() && !InOutResult.ErrorMessage)
+		{
+			InOutResult.ErrorMessage = SaveOp.ErrorMessage;
+		}
+	}
+
+	static EGeneratedFileState::Type CompareWithDisk(const FString& FilePath, int64 ExpectedSize, uint64 ExpectedHash, const FGeneratedFilesManifest::FFile* GeneratedFile)
+	{
+		const int64 FileSize = IFileManager::Get().FileSize(*FilePath);
+		if (FileSize < 0)
+		{
+			return GeneratedFile ? EGeneratedFileState::Missing : EGeneratedFileState::Added;
+		}
+
+		// A file can only match what the template or the manifest say if its size does, so most edited files are never read
+		const bool bCanBeUpToDate = FileSize == ExpectedSize;
+		const bool bCanBeGenerated = GeneratedFile && FileSize == GeneratedFile->Size;
+		TArray<uint8> Contents;
+		if ((!bCanBeUpToDate && !bCanBeGenerated) || !FFileHelper::LoadFileToArray(Contents, *FilePath, FILEREAD_Silent))
+		{
+			return EGeneratedFileState::Edited;
+		}
+
+		const uint64 Hash = HashFileContents(Contents);
+		if (bCanBeUpToDate && Hash == ExpectedHash)
+		{
+			return EGeneratedFileState::UpToDate;
+		}
+		return bCanBeGenerated && Hash == GeneratedFile->Hash ? EGeneratedFileState::Outdated : EGeneratedFileState::Edited;
+	}
+}
@@ -0,0 +1,331 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/PlaceholderSubstitution.h"
+
+#include "ModuleGenerationLog.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+	#include <emmintrin.h>
+	#define MODULEGENERATION_SCAN_SSE2 1
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS && PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#include <arm_neon.h>
+	#define MODULEGENERATION_SCAN_NEON 1
+#endif
+
+#ifndef MODULEGENERATION_SCAN_SSE2
+	#define MODULEGENERATION_SCAN_SSE2 0
+#endif
+#ifndef MODULEGENERATION_SCAN_NEON
+	#define MODULEGENERATION_SCAN_NEON 0
+#endif
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		constexpr uint32 OpenChar = '{';
+		constexpr uint32 CloseChar = '}';
+		constexpr uint32 EscapeChar = '`';
+	}
+	
+	/** @return The first { or ` in [Cursor, End) or End */
+	template<typename CharType>
+	static const CharType* FindNextSpecialChar(const CharType* Cursor, const CharType* const End)
+	{
+		static_assert(sizeof(CharType) == 1 || sizeof(CharType) == 2, "Only 8 and 16 bit code units are supported");
+		
+#if MODULEGENERATION_SCAN_SSE2
+		if constexpr (sizeof(CharType) == 2)
+		{
+			const __m128i Open = _mm_set1_epi16(OpenChar);
+			const __m128i Escape = _mm_set1_epi16(EscapeChar);
+			for (; End - Cursor >= 8; Cursor += 8)
+			{
+				const __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Cursor));
+				const __m128i Matches = _mm_or_si128(_mm_cmpeq_epi16(Chunk, Open), _mm_cmpeq_epi16(Chunk, Escape));
+				const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(Matches));
+				if (Mask != 0)
+				{
+					// Every 16 bit lane sets two bits of the mask
+					return Cursor + FMath::CountTrailingZeros(Mask) / 2;
+				}
+			}
+		}
+		else
+		{
+			const __m128i Open = _mm_set1_epi8(OpenChar);
+			const __m128i Escape = _mm_set1_epi8(EscapeChar);
+			for (; End - Cursor >= 16; Cursor += 16)
+			{
+				const __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Cursor));
+				const __m128i Matches = _mm_or_si128(_mm_cmpeq_epi8(Chunk, Open), _mm_cmpeq_epi8(Chunk, Escape));
+				const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(Matches));
+				if (Mask != 0)
+				{
+					return Cursor + FMath::CountTrailingZeros(Mask);
+				}
+			}
+		}
+#elif MODULEGENERATION_SCAN_NEON
+		if constexpr (sizeof(CharType) == 2)
+		{
+			const uint16x8_t Open = vdupq_n_u16(OpenChar);
+			const uint16x8_t Escape = vdupq_n_u16(EscapeChar);
+			for (; End - Cursor >= 8; Cursor += 8)
+			{
+				const uint16x8_t Chunk = vld1q_u16(reinterpret_cast<const uint16*>(Cursor));
+				const uint16x8_t Matches = vorrq_u16(vceqq_u16(Chunk, Open), vceqq_u16(Chunk, Escape));
+				if (vmaxvq_u16(Matches) != 0)
+				{
+					// The scalar loop below finds the exact position within the chunk
+					break;
+				}
+			}
+		}
+		else
+		{
+			const uint8x16_t Open = vdupq_n_u8(OpenChar);
+			const uint8x16_t Escape = vdupq_n_u8(EscapeChar);
+			for (; End - Cursor >= 16; Cursor += 16)
+			{
+				const uint8x16_t Chunk = vld1q_u8(reinterpret_cast<const uint8*>(Cursor));
+				const uint8x16_t Matches = vorrq_u8(vceqq_u8(Chunk, Open), vceqq_u8(Chunk, Escape));
+				if (vmaxvq_u8(Matches) != 0)
+				{
+					break;
+				}
+			}
+		}
+#endif
+
+		for (; Cursor < End; ++Cursor)
+		{
+			if (static_cast<uint32>(*Cursor) == OpenChar || static_cast<uint32>(*Cursor) == EscapeChar)
+			{
+				return Cursor;
+			}
+		}
+		return End;
+	}
+
+	template<typename CharType>
+	static bool IsPlaceholderWhitespace(CharType Char)
+	{
+		if constexpr (sizeof(CharType) == 1)
+		{
+			// ASCII whitespace only: bytes above 0x7F are parts of multi-byte UTF-8 sequences
+			const uint32 Code = static_cast<uint8>(Char);
+			return Code == ' ' || (Code >= '\t' && Code <= '\r');
+		}
+		else
+		{
+			return TChar<CharType>::IsWhitespace(Char);
+		}
+	}
+
+	template<typename CharType>
+	static void TokenizePlaceholdersImpl(TStringView<CharType> Template, const FPlaceholderNameTable& Names, TArray<FPlaceholderSpan>& OutSpans)
+	{
+		const CharType* const Begin = Template.GetData();
+		const CharType* const End = Begin + Template.Len();
+		
+		const auto AddLiteral = [&OutSpans, Begin](const CharType* LiteralStart, const CharType* LiteralEnd)
+		{
+			if (LiteralEnd > LiteralStart)
+			{
+				OutSpans.Add({ static_cast<int32>(LiteralStart - Begin), static_cast<int32>(LiteralEnd - LiteralStart), INDEX_NONE });
+			}
+		};
+
+		const CharType* LiteralStart = Begin;
+		const CharType* Cursor = Begin;
+		while ((Cursor = FindNextSpecialChar(Cursor, End)) != End)
+		{
+			if (static_cast<uint32>(*Cursor) == EscapeChar)
+			{
+				if (Cursor + 1 < End && (static_cast<uint32>(Cursor[1]) == OpenChar || static_cast<uint32>(Cursor[1]) == EscapeChar))
+				{
+					// Drop the escape character; the escaped character starts the next literal
+					AddLiteral(LiteralStart, Cursor);
+					LiteralStart = Cursor + 1;
+					Cursor += 2;
+				}
+				else
+				{
+					++Cursor;
+				}
+				continue;
+			}
+
+			const CharType* Token = Cursor + 1;
+			while (Token < End && IsPlaceholderWhitespace(*Token))
+			{
+				++Token;
+			}
+			const CharType* const NameStart = Token;
+			while (Token < End && !IsPlaceholderWhitespace(*Token) && static_cast<uint32>(*Token) != CloseChar && static_cast<uint32>(*Token) != OpenChar)
+			{
+				++Token;
+			}
+			const CharType* const NameEnd = Token;
+			while (Token < End && IsPlaceholderWhitespace(*Token))
+			{
+				++Token;
+			}
+
+			const bool bIsClosed = Token < End && static_cast<uint32>(*Token) == CloseChar && NameEnd > NameStart;
+			const int32 Placeholder = bIsClosed
+				? Names.Find(TStringView<CharType>(NameStart, static_cast<int32>(NameEnd - NameStart)))
+				: INDEX_NONE;
+			if (Placeholder == INDEX_NONE)
+			{
+				++Cursor;
+				continue;
+			}
+
+			AddLiteral(LiteralStart, Cursor);
+			OutSpans.Add({ static_cast<int32>(Cursor - Begin), static_cast<int32>(Token + 1 - Cursor), Placeholder });
+			Cursor = Token + 1;
+			LiteralStart = Cursor;
+		}
+		AddLiteral(LiteralStart, End);
+	}
+
+	FPlaceholderNameTable::FPlaceholderNameTable(TConstArrayView<const TCHAR*> Names)
+	{
+		LowerCaseNames.Reserve(Names.Num());
+		for (const TCHAR* Name : Names)
+		{
+			checkf(FCString::IsPureAnsi(Name), TEXT("Placeholder names must be ASCII: '%s'"), Name);
+			FString LowerCaseName = FString(Name).ToLower();
+			// Two equal names always share a slot, so no seed could ever separate them
+			checkf(!LowerCaseNames.Contains(LowerCaseName), TEXT("Placeholder names must be unique ignoring case: '%s'"), Name);
+			LowerCaseNames.Add(MoveTemp(LowerCaseName));
+		}
+		if (LowerCaseNames.Num() == 0)
+		{
+			return;
+		}
+
+		// Search for a seed which maps every name to its own slot, growing the table if none is found. Distinct names are separated
+		// long before the cap; it only stops the search from looping forever if the check above is compiled out.
+		const uint32 MinNumSlots = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(LowerCaseNames.Num()) * 2);
+		const uint32 MaxNumSlots = MinNumSlots << 8;
+		for (uint32 NumSlots = MinNumSlots; NumSlots <= MaxNumSlots; NumSlots *= 2)
+		{
+			Slots.Init(INDEX_NONE, NumSlots);
+			SlotMask = NumSlots - 1;
+			for (Seed = 0; Seed < 1024; ++Seed)
+			{
+				bool bHasCollision = false;
+				for (int32 NameIndex = 0; NameIndex < LowerCaseNames.Num() && !bHasCollision; ++NameIndex)
+				{
+					int32& Slot = Slots[Hash(FStringView(LowerCaseNames[NameIndex]), Seed) & SlotMask];
+					bHasCollision = Slot != INDEX_NONE;
+					Slot = NameIndex;
+				}
+				if (!bHasCollision)
+				{
+					return;
+				}
+				Slots.Init(INDEX_NONE, NumSlots);
+			}
+		}
+		UE_LOG(LogModuleGeneration, Fatal, TEXT("Failed to build a perfect hash table for %d placeholder names"), LowerCaseNames.Num());
+	}
+
+	int32 FPlaceholderNameTable::Find(FStringView Name) const
+	{
+		return FindImpl(Name);
+	}
+
+	int32 FPlaceholderNameTable::Find(FUtf8StringView Name) const
+	{
+		return FindImpl(Name);
+	}
+
+	template<typename CharType>
+	int32 FPlaceholderNameTable::FindImpl(TStringView<CharType> Name) const
+	{
+		if (Slots.Num() == 0)
+		{
+			return INDEX_NONE;
+		}
+		
+		const int32 NameIndex = Slots[Hash(Name, Seed) & SlotMask];
+		if (NameIndex == INDEX_NONE || Name.Len() != LowerCaseNames[NameIndex].Len())
+		{
+			return INDEX_NONE;
+		}
+
+		// Names are ASCII, so comparing ASCII lower case characters ignores case like FStringView::Equals would
+		const TCHAR* LowerCaseName = *LowerCaseNames[NameIndex];
+		for (int32 Index = 0; Index < Name.Len(); ++Index)
+		{
+			const uint32 Char = static_cast<uint32>(Name[Index]);
+			const uint32 LowerChar = Char >= 'A' && Char <= 'Z' ? Char - 'A' + 'a' : Char;
+			if (LowerChar != static_cast<uint32>(LowerCaseName[Index]))
+			{
+				return INDEX_NONE;
+			}
+		}
+		return NameIndex;
+	}
+
+	template<typename CharType>
+	uint32 FPlaceholderNameTable::Hash(TStringView<CharType> Name, uint32 Seed)
+	{
+		// FNV-1a over ASCII lower case characters
+		uint32 Result = 2166136261u ^ (Seed * 16777619u);
+		for (const CharType Char : Name)
+		{
+			const uint32 Code = static_cast<uint32>(Char);
+			const uint32 LowerChar = Code >= 'A' && Code <= 'Z' ? Code - 'A' + 'a' : Code;
+			Result = (Result ^ LowerChar) * 16777619u;
+		}
+		return Result;
+	}
+
+	void TokenizePlaceholders(FStringView Template, const FPlaceholderNameTable& Names, TArray<FPlaceholderSpan>& OutSpans)
+	{
+		TokenizePlaceholdersImpl(Template, Names, OutSpans);
+	}
+
+	void TokenizePlaceholders(FUtf8StringView Template, const FPlaceholderNameTable& Names, TArray<FPlaceholderSpan>& OutSpans)
+	{
+		TokenizePlaceholdersImpl(Template, Names, OutSpans);
+	}
+
+	FString SubstitutePlaceholders(FStringView Template, const FPlaceholderNameTable& Names, TConstArrayView<FStringView> Values)
+	{
+		check(Values.Num() == Names.Num());
+		
+		TArray<FPlaceholderSpan> Spans;
+		TokenizePlaceholders(Template, Names, Spans);
+
+		int32 ResultLength = 0;
+		for (const FPlaceholderSpan& Span : Spans)
+		{
+			ResultLength += Span.Placeholder == INDEX_NONE ? Span.Length : Values[Span.Placeholder].Len();
+		}
+		if (ResultLength == 0)
+		{
+			return FString();
+		}
+
+		FString Result;
+		auto& ResultChars = Result.GetCharArray();
+		ResultChars.SetNumUninitialized(ResultLength + 1);
+		TCHAR* Output = ResultChars.GetData();
+		for (const FPlaceholderSpan& Span : Spans)
+		{
+			const FStringView Source = Span.Placeholder == INDEX_NONE
+				? Template.Mid(Span.Start, Span.Length)
+				: Values[Span.Placeholder];
+			FMemory::Memcpy(Output, Source.GetData(), Source.Len() * sizeof(TCHAR));
+			Output += Source.Len();
+		}
+		*Output = TEXT('\0');
+		return Result;
+	}
+}
@@ -0,0 +1,92 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/PluginDirectoryIndex.h"
+
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration
+{
+	FPluginDirectoryIndex FPluginDirectoryIndex::MakeFromPluginManager()
+	{
+		// Discovered plugins include disabled ones, so modules can be added to plugins which are not enabled in this project
+		const TArray<TSharedRef<IPlugin>> Plugins = IPluginManager::Get().GetDiscoveredPlugins();
+		
+		FPluginDirectoryIndex Result;
+		Result.DescriptorsByBaseDirectory.Reserve(Plugins.Num());
+		for (const TSharedRef<IPlugin>& Plugin : Plugins)
+		{
+			Result.AddPlugin(Plugin->GetBaseDir(), Plugin->GetDescriptorFileName());
+		}
+		return Result;
+	}
+
+	void FPluginDirectoryIndex::AddPlugin(const FString& BaseDirectory, const FString& DescriptorPath)
+	{
+		DescriptorsByBaseDirectory.Add(MakeKey(BaseDirectory), FPaths::ConvertRelativePathToFull(DescriptorPath));
+	}
+
+	void FPluginDirectoryIndex::AddPluginsInDirectory(const FString& Directory)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		
+		TArray<FString> DirectoriesToVisit = { Directory };
+		while (DirectoriesToVisit.Num() > 0)
+		{
+			const FString Current = DirectoriesToVisit.Pop(EAllowShrinking::No);
+			
+			FString DescriptorPath;
+			TArray<FString> Subdirectories;
+			FileManager.IterateDirectory(*Current, [&DescriptorPath, &Subdirectories](const TCHAR* Path, bool bIsDirectory)
+			{
+				if (bIsDirectory)
+				{
+					Subdirectories.Add(Path);
+				}
+				else if (DescriptorPath.IsEmpty() && FPaths::GetExtension(Path) == TEXT("uplugin"))
+				{
+					DescriptorPath = Path;
+				}
+				return true;
+			});
+
+			// Only grouping folders are walked; the contents of a plugin are never listed
+			if (DescriptorPath.IsEmpty())
+			{
+				DirectoriesToVisit.Append(MoveTemp(Subdirectories));
+			}
+			else
+			{
+				AddPlugin(Current, DescriptorPath);
+			}
+		}
+	}
+
+	TOptional<FString> FPluginDirectoryIndex::FindPluginDescriptor(const FString& Directory) const
+	{
+		FString Candidate = MakeKey(Directory);
+		while (!Candidate.IsEmpty())
+		{
+			if (const FString* DescriptorPath = DescriptorsByBaseDirectory.Find(Candidate))
+			{
+				return *DescriptorPath;
+			}
+			
+			int32 LastSlashIndex;
+			if (!Candidate.FindLastChar(TEXT('/'), LastSlashIndex))
+			{
+				break;
+			}
+			Candidate.LeftInline(LastSlashIndex, EAllowShrinking::No);
+		}
+		return {};
+	}
+
+	FString FPluginDirectoryIndex::MakeKey(const FString& Directory)
+	{
+		FString Result = FPaths::ConvertRelativePathToFull(Directory);
+		FPaths::NormalizeDirectoryName(Result);
+		return Result;
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/SourceFileUtils.h"
+
+#include "Algo/AnyOf.h"
+#include "Misc/PathViews.h"
+
+namespace UE::ModuleGeneration
+{
+	static const TCHAR* SkippedDirectoryNames[] =
+	{
+		TEXT("Binaries"), TEXT("Config"), TEXT("Content"), TEXT("Documentation"), TEXT("Extras"), TEXT("Intermediate"),
+		TEXT("Resources"), TEXT("Saved"), TEXT("Shaders"), TEXT("ThirdParty")
+	};
+
+	bool IsHeaderFile(FStringView Path)
+	{
+		return Path.EndsWith(TEXT(".h"), ESearchCase::IgnoreCase)
+			|| Path.EndsWith(TEXT(".hpp"), ESearchCase::IgnoreCase)
+			|| Path.EndsWith(TEXT(".inl"), ESearchCase::IgnoreCase);
+	}
+
+	bool IsSourceFile(FStringView Path)
+	{
+		return IsHeaderFile(Path)
+			|| Path.EndsWith(TEXT(".cpp"), ESearchCase::IgnoreCase)
+			|| Path.EndsWith(TEXT(".c"), ESearchCase::IgnoreCase)
+			|| Path.EndsWith(TEXT(".cc"), ESearchCase::IgnoreCase);
+	}
+
+	bool IsSkippedDirectory(FStringView Path)
+	{
+		const FStringView CleanName = FPathViews::GetCleanFilename(Path);
+		return Algo::AnyOf(SkippedDirectoryNames, [CleanName](const TCHAR* Skipped) { return CleanName.Equals(Skipped, ESearchCase::IgnoreCase); });
+	}
+
+	TOptional<FString> GetModuleNameFromBuildFile(FStringView Path)
+	{
+		const FStringView BuildFileExtension = TEXT(".Build.cs");
+		const FStringView CleanName = FPathViews::GetCleanFilename(Path);
+		if (CleanName.Len() <= BuildFileExtension.Len() || !CleanName.EndsWith(BuildFileExtension, ESearchCase::IgnoreCase))
+		{
+			return {};
+		}
+		return FString(CleanName.LeftChop(BuildFileExtension.Len()));
+	}
+}
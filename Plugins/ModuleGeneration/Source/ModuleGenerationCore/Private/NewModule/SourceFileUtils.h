@@ -0,0 +1,30 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	// Shared by every file which walks source trees: unity builds compile those files as one translation unit, where file-local
+	// copies of these helpers would collide.
+
+	/** Folders of a module which are on its own include path, the public ones first */
+	inline const TCHAR* ModuleIncludeDirectoryNames[] = { TEXT("Public/"), TEXT("Classes/"), TEXT("Internal/"), TEXT("Private/") };
+	/** Number of folders at the start of ModuleIncludeDirectoryNames which are on the include path of dependent modules, too */
+	inline constexpr int32 NumPublicIncludeDirectories = 3;
+
+	/** @return Whether Path is a header, e.g. Actor.h or Actor.inl */
+	bool IsHeaderFile(FStringView Path);
+	/** @return Whether Path is a header or a translation unit */
+	bool IsSourceFile(FStringView Path);
+
+	/**
+	 * @return Whether Path is a folder which never contains modules or sources to index, e.g. Content or Intermediate. ThirdParty modules
+	 * use arbitrary include paths, so their headers cannot be mapped anyway.
+	 */
+	bool IsSkippedDirectory(FStringView Path);
+
+	/** @return The name of the module if Path is a .Build.cs file, e.g. MyModule for Source/MyModule/MyModule.Build.cs */
+	TOptional<FString> GetModuleNameFromBuildFile(FStringView Path);
+}
@@ -0,0 +1,166 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/TemplateFileContents.h"
+
+#include "NewModule/PlaceholderSubstitution.h"
+
+#include "Misc/FileHelper.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace
+	{
+		constexpr uint8 Utf8ByteOrderMark[] = { 0xEF, 0xBB, 0xBF };
+		constexpr uint8 Utf16ByteOrderMark[] = { 0xFF, 0xFE };
+		/** Same as git's heuristic for binary files */
+		constexpr int32 NumBytesScannedForNul = 8000;
+	}
+
+	static bool HasPrefix(TConstArrayView<uint8> Bytes, TConstArrayView<uint8> Prefix);
+
+	ETemplateFileEncoding::Type DetectTemplateFileEncoding(TConstArrayView<uint8> Bytes)
+	{
+		if (HasPrefix(Bytes, Utf8ByteOrderMark))
+		{
+			return ETemplateFileEncoding::Utf8Bom;
+		}
+		if (HasPrefix(Bytes, Utf16ByteOrderMark))
+		{
+			return ETemplateFileEncoding::Utf16Bom;
+		}
+		// Big-endian UTF-16 and everything else with NUL bytes is copied as is
+		return Bytes.Left(NumBytesScannedForNul).Contains(0) ? ETemplateFileEncoding::Binary : ETemplateFileEncoding::Utf8;
+	}
+
+	FUtf8PlaceholderValues::FUtf8PlaceholderValues(const FTemplatePlaceholderValues& InValues)
+	{
+		for (int32 Placeholder = 0; Placeholder < ETemplatePlaceholder::Num; ++Placeholder)
+		{
+			const FTCHARToUTF8 Utf8Value(InValues[Placeholder].GetData(), InValues[Placeholder].Len());
+			Values[Placeholder].Append(reinterpret_cast<const UTF8CHAR*>(Utf8Value.Get()), Utf8Value.Length());
+		}
+	}
+
+	FTemplateFileContents FTemplateFileContents::Tokenize(TConstArrayView<uint8> Bytes, ETemplateFileEncoding::Type Encoding)
+	{
+		check(Encoding != ETemplateFileEncoding::Binary);
+
+		// UTF-16 templates are rare, so they are converted once when loading and substituted like UTF-8 ones
+		TArray<uint8> ConvertedBytes;
+		TConstArrayView<uint8> Text = Bytes;
+		if (Encoding == ETemplateFileEncoding::Utf16Bom)
+		{
+			FString DecodedText;
+			FFileHelper::BufferToString(DecodedText, Bytes.GetData(), Bytes.Num());
+			ConvertedBytes = EncodeTemplateText(DecodedText, ETemplateFileEncoding::Utf8);
+			Text = ConvertedBytes;
+		}
+		else if (Encoding == ETemplateFileEncoding::Utf8Bom)
+		{
+			Text = Bytes.RightChop(UE_ARRAY_COUNT(Utf8ByteOrderMark));
+		}
+
+		TArray<FPlaceholderSpan> Spans;
+		const FUtf8StringView Template(reinterpret_cast<const UTF8CHAR*>(Text.GetData()), Text.Num());
+		TokenizePlaceholders(Template, GetTemplatePlaceholderNames(), Spans);
+
+		FTemplateFileContents Result;
+		Result.Encoding = Encoding;
+		Result.Segments.Reserve(Spans.Num());
+		Result.Literals.Reserve(Text.Num());
+		bool bHasPlaceholders = false;
+		for (const FPlaceholderSpan& Span : Spans)
+		{
+			if (Span.Placeholder == INDEX_NONE)
+			{
+				Result.Segments.Add({ Result.Literals.Num(), Span.Length, ETemplatePlaceholder::Num });
+				Result.Literals.Append(Text.GetData() + Span.Start, Span.Length);
+			}
+			else
+			{
+				Result.Segments.Add({ 0, 0, static_cast<ETemplatePlaceholder::Type>(Span.Placeholder) });
+				bHasPlaceholders = true;
+			}
+		}
+
+		// Escape sequences are two characters which turn into one, so unchanged literal text has the same length
+		Result.bIsVerbatim = !bHasPlaceholders && Result.Literals.Num() == Text.Num();
+		Result.Literals.Shrink();
+		return Result;
+	}
+
+	TArray<uint8> FTemplateFileContents::Instantiate(const FUtf8PlaceholderValues& Values) const
+	{
+		const bool bHasUtf8ByteOrderMark = Encoding == ETemplateFileEncoding::Utf8Bom;
+		int32 ResultLength = bHasUtf8ByteOrderMark ? static_cast<int32>(UE_ARRAY_COUNT(Utf8ByteOrderMark)) : 0;
+		for (const FSegment& Segment : Segments)
+		{
+			ResultLength += Segment.Placeholder == ETemplatePlaceholder::Num ? Segment.Length : Values[Segment.Placeholder].Len();
+		}
+
+		TArray<uint8> Result;
+		Result.Reserve(ResultLength);
+		if (bHasUtf8ByteOrderMark)
+		{
+			Result.Append(Utf8ByteOrderMark, UE_ARRAY_COUNT(Utf8ByteOrderMark));
+		}
+		for (const FSegment& Segment : Segments)
+		{
+			if (Segment.Placeholder == ETemplatePlaceholder::Num)
+			{
+				Result.Append(Literals.GetData() + Segment.Start, Segment.Length);
+			}
+			else
+			{
+				const FUtf8StringView Value = Values[Segment.Placeholder];
+				Result.Append(reinterpret_cast<const uint8*>(Value.GetData()), Value.Len());
+			}
+		}
+
+		if (Encoding == ETemplateFileEncoding::Utf16Bom)
+		{
+			return EncodeTemplateText(FString(Result.Num(), reinterpret_cast<const UTF8CHAR*>(Result.GetData())), ETemplateFileEncoding::Utf16Bom);
+		}
+		return Result;
+	}
+
+	bool FTemplateFileContents::HasPlaceholder(ETemplatePlaceholder::Type Placeholder) const
+	{
+		return Segments.ContainsByPredicate([Placeholder](const FSegment& Segment) { return Segment.Placeholder == Placeholder; });
+	}
+
+	SIZE_T FTemplateFileContents::GetAllocatedSize() const
+	{
+		return Literals.GetAllocatedSize() + Segments.GetAllocatedSize();
+	}
+
+	TArray<uint8> EncodeTemplateText(FStringView Text, ETemplateFileEncoding::Type Encoding)
+	{
+		check(Encoding != ETemplateFileEncoding::Binary);
+
+		TArray<uint8> Result;
+		if (Encoding == ETemplateFileEncoding::Utf16Bom)
+		{
+			const FTCHARToUTF16 Converted(Text.GetData(), Text.Len());
+			Result.Reserve(static_cast<int32>(UE_ARRAY_COUNT(Utf16ByteOrderMark) + Converted.Length() * sizeof(UTF16CHAR)));
+			Result.Append(Utf16ByteOrderMark, UE_ARRAY_COUNT(Utf16ByteOrderMark));
+			Result.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length() * sizeof(UTF16CHAR));
+			return Result;
+		}
+
+		const FTCHARToUTF8 Converted(Text.GetData(), Text.Len());
+		const bool bHasUtf8ByteOrderMark = Encoding == ETemplateFileEncoding::Utf8Bom;
+		Result.Reserve((bHasUtf8ByteOrderMark ? static_cast<int32>(UE_ARRAY_COUNT(Utf8ByteOrderMark)) : 0) + Converted.Length());
+		if (bHasUtf8ByteOrderMark)
+		{
+			Result.Append(Utf8ByteOrderMark, UE_ARRAY_COUNT(Utf8ByteOrderMark));
+		}
+		Result.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+		return Result;
+	}
+
+	static bool HasPrefix(TConstArrayView<uint8> Bytes, TConstArrayView<uint8> Prefix)
+	{
+		return Bytes.Num() >= Prefix.Num() && FMemory::Memcmp(Bytes.GetData(), Prefix.GetData(), Prefix.Num()) == 0;
+	}
+}
@@ -0,0 +1,120 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/TokenizedTemplateString.h"
+
+#include "NewModule/PlaceholderSubstitution.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace ETemplatePlaceholder
+	{
+		const TCHAR* ToString(Type Placeholder)
+		{
+			switch (Placeholder)
+			{
+			case ModuleName: return TEXT("ModuleName");
+			case Copyright: return TEXT("Copyright");
+			case PublicDependencies: return TEXT("PublicDependencies");
+			case PrivateDependencies: return TEXT("PrivateDependencies");
+			case BuildSettings: return TEXT("BuildSettings");
+			default:
+				checkNoEntry();
+				return TEXT("");
+			}
+		}
+	}
+
+	const FPlaceholderNameTable& GetTemplatePlaceholderNames()
+	{
+		static const FPlaceholderNameTable PlaceholderNames = []()
+		{
+			TArray<const TCHAR*> Names;
+			for (uint8 i = 0; i < ETemplatePlaceholder::Num; ++i)
+			{
+				Names.Add(ETemplatePlaceholder::ToString(static_cast<ETemplatePlaceholder::Type>(i)));
+			}
+			return FPlaceholderNameTable(Names);
+		}();
+		return PlaceholderNames;
+	}
+
+	FTokenizedTemplateString FTokenizedTemplateString::Tokenize(FStringView Template)
+	{
+		TArray<FPlaceholderSpan> Spans;
+		TokenizePlaceholders(Template, GetTemplatePlaceholderNames(), Spans);
+
+		FTokenizedTemplateString Result;
+		Result.Segments.Reserve(Spans.Num());
+		Result.Literals.Reserve(Template.Len());
+		for (const FPlaceholderSpan& Span : Spans)
+		{
+			if (Span.Placeholder == INDEX_NONE)
+			{
+				Result.Segments.Add({ Result.Literals.Len(), Span.Length, ETemplatePlaceholder::Num });
+				Result.Literals.Append(Template.GetData() + Span.Start, Span.Length);
+			}
+			else
+			{
+				Result.Segments.Add({ 0, 0, static_cast<ETemplatePlaceholder::Type>(Span.Placeholder) });
+				Result.bHasPlaceholders = true;
+			}
+		}
+
+		Result.Literals.Shrink();
+		return Result;
+	}
+
+	FTokenizedTemplateString FTokenizedTemplateString::MakeVerbatim(FString Template)
+	{
+		FTokenizedTemplateString Result;
+		if (!Template.IsEmpty())
+		{
+			Result.Segments.Add({ 0, Template.Len(), ETemplatePlaceholder::Num });
+		}
+		Result.Literals = MoveTemp(Template);
+		Result.Literals.Shrink();
+		return Result;
+	}
+
+	bool FTokenizedTemplateString::IsVerbatim(FStringView Template)
+	{
+		// Escape sequences are two characters which turn into one, so unchanged literal text has the same length
+		const FTokenizedTemplateString Tokenized = Tokenize(Template);
+		return !Tokenized.HasPlaceholders() && Tokenized.Literals.Len() == Template.Len();
+	}
+
+	FString FTokenizedTemplateString::Instantiate(const FTemplatePlaceholderValues& Values) const
+	{
+		int32 ResultLength = 0;
+		for (const FSegment& Segment : Segments)
+		{
+			ResultLength += Segment.Placeholder == ETemplatePlaceholder::Num ? Segment.Length : Values[Segment.Placeholder].Len();
+		}
+
+		FString Result;
+		Result.Reserve(ResultLength);
+		for (const FSegment& Segment : Segments)
+		{
+			if (Segment.Placeholder == ETemplatePlaceholder::Num)
+			{
+				Result.Append(*Literals + Segment.Start, Segment.Length);
+			}
+			else
+			{
+				const FStringView Value = Values[Segment.Placeholder];
+				Result.Append(Value.GetData(), Value.Len());
+			}
+		}
+		return Result;
+	}
+
+	bool FTokenizedTemplateString::HasPlaceholder(ETemplatePlaceholder::Type Placeholder) const
+	{
+		return Segments.ContainsByPredicate([Placeholder](const FSegment& Segment) { return Segment.Placeholder == Placeholder; });
+	}
+
+	SIZE_T FTokenizedTemplateString::GetAllocatedSize() const
+	{
+		return Literals.GetAllocatedSize() + Segments.GetAllocatedSize();
+	}
+}
@@ -0,0 +1,95 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/DescriptorJsonPatcher.h"
+
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "ModuleDescriptor.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationSpliceModulesTest, "ModuleGeneration.DescriptorJsonPatcher.Splice", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationSpliceModulesTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const FModuleDescriptor NewModule(TEXT("NewModule"), EHostType::Runtime, ELoadingPhase::Default);
+	const FString NewEntry = TEXT("\t\t{\n\t\t\t\"Name\": \"NewModule\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}");
+	const auto Splice = [this](const FString& Descriptor, TConstArrayView<FModuleDescriptor> NewModules) -> FString
+	{
+		const TOperationResult<TArray<uint8>> SpliceOp = SpliceModulesIntoDescriptor(ToUtf8Bytes(Descriptor), NewModules);
+		if (SpliceOp.IsFailure())
+		{
+			AddError(FString::Printf(TEXT("Splicing failed: %s"), *SpliceOp.ErrorMessage.GetValue()));
+			return FString();
+		}
+		return FromUtf8Bytes(SpliceOp.OperationResult.GetValue());
+	};
+
+	// New entries go after the last entry and copy the formatting of the first one; the rest of the file is untouched
+	const FString ExistingEntries =
+		TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": [\n")
+		TEXT("\t\t{\n\t\t\t\"Name\": \"First\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t},\n")
+		TEXT("\t\t{\n\t\t\t\"Name\": \"Second\",\n\t\t\t\"Type\": \"Editor\",\n\t\t\t\"LoadingPhase\": \"PostEngineInit\"\n\t\t}");
+	TestEqual(TEXT("Appended after the last entry"),
+		Splice(ExistingEntries + TEXT("\n\t],\n\t\"Plugins\": []\n}\n"), MakeArrayView(&NewModule, 1)),
+		ExistingEntries + TEXT(",\n") + NewEntry + TEXT("\n\t],\n\t\"Plugins\": []\n}\n"));
+
+	TestEqual(TEXT("Compact descriptor stays compact"),
+		Splice(TEXT("{\"Modules\":[{\"Name\":\"First\",\"Type\":\"Runtime\",\"LoadingPhase\":\"Default\"}]}"), MakeArrayView(&NewModule, 1)),
+		FString(TEXT("{\"Modules\":[{\"Name\":\"First\",\"Type\":\"Runtime\",\"LoadingPhase\":\"Default\"},{\"Name\":\"NewModule\",\"Type\":\"Runtime\",\"LoadingPhase\":\"Default\"}]}")));
+
+	TestEqual(TEXT("Empty array is filled"),
+		Splice(TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": []\n}"), MakeArrayView(&NewModule, 1)),
+		TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": [\n") + NewEntry + TEXT("\n\t]\n}"));
+
+	TestEqual(TEXT("Missing array is added as the last member"),
+		Splice(TEXT("{\n\t\"FileVersion\": 3\n}"), MakeArrayView(&NewModule, 1)),
+		TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": [\n") + NewEntry + TEXT("\n\t]\n}"));
+
+	const FModuleDescriptor NewModules[] = { FModuleDescriptor(TEXT("A"), EHostType::Editor), FModuleDescriptor(TEXT("B"), EHostType::Runtime, ELoadingPhase::PreDefault) };
+	TestEqual(TEXT("Several modules are added in order"),
+		Splice(TEXT("{\"Modules\":[]}"), NewModules),
+		FString(TEXT("{\"Modules\":[{\"Name\":\"A\",\"Type\":\"Editor\",\"LoadingPhase\":\"Default\"},{\"Name\":\"B\",\"Type\":\"Runtime\",\"LoadingPhase\":\"PreDefault\"}]}")));
+
+	// The byte order mark is kept and CRLF line endings are used for the new lines
+	TArray<uint8> WithBom = { 0xEF, 0xBB, 0xBF };
+	WithBom.Append(ToUtf8Bytes(TEXT("{\r\n\t\"FileVersion\": 3\r\n}")));
+	const TOperationResult<TArray<uint8>> BomOp = SpliceModulesIntoDescriptor(WithBom, MakeArrayView(&NewModule, 1));
+	if (TestTrue(TEXT("Descriptor with BOM is patched"), BomOp.IsSuccess()))
+	{
+		const TArray<uint8>& Patched = BomOp.OperationResult.GetValue();
+		TestTrue(TEXT("BOM is kept"), Patched.Num() > 3 && Patched[0] == 0xEF && Patched[1] == 0xBB && Patched[2] == 0xBF);
+		TestEqual(TEXT("CRLF is kept"), FromUtf8Bytes(TConstArrayView<uint8>(Patched).RightChop(3)),
+			TEXT("{\r\n\t\"FileVersion\": 3,\r\n\t\"Modules\": [\r\n") + NewEntry.Replace(TEXT("\n"), TEXT("\r\n")) + TEXT("\r\n\t]\r\n}"));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationSpliceModulesFailureTest, "ModuleGeneration.DescriptorJsonPatcher.Failure", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationSpliceModulesFailureTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const TArray<uint8> Descriptor = ToUtf8Bytes(TEXT("{\"Modules\":[{\"Name\":\"First\",\"Type\":\"Runtime\",\"LoadingPhase\":\"Default\"}]}"));
+
+	// Module names are compared case-insensitively
+	const FModuleDescriptor Declared(TEXT("FIRST"));
+	const TOperationResult<TArray<uint8>> DeclaredOp = SpliceModulesIntoDescriptor(Descriptor, MakeArrayView(&Declared, 1));
+	TestTrue(TEXT("Declared module is rejected"), DeclaredOp.IsFailure() && DeclaredOp.ErrorMessage->Contains(TEXT("already contained entries for: FIRST")));
+
+	const FModuleDescriptor Twice[] = { FModuleDescriptor(TEXT("New")), FModuleDescriptor(TEXT("New")) };
+	const TOperationResult<TArray<uint8>> TwiceOp = SpliceModulesIntoDescriptor(Descriptor, Twice);
+	TestTrue(TEXT("Module passed twice is rejected"), TwiceOp.IsFailure() && TwiceOp.ErrorMessage->Contains(TEXT("Added more than once: New")));
+
+	const FModuleDescriptor NewModule(TEXT("New"));
+	const TOperationResult<TArray<uint8>> MalformedOp = SpliceModulesIntoDescriptor(ToUtf8Bytes(TEXT("{\"Modules\":[{\"Name\":\"First\"")), MakeArrayView(&NewModule, 1));
+	TestTrue(TEXT("Malformed JSON is rejected"), MalformedOp.IsFailure() && MalformedOp.ErrorMessage->StartsWith(TEXT("Failed to parse JSON")));
+	return true;
+}
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleCreationPlan.h"
+
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationDescribeLineDiffTest, "ModuleGeneration.ModuleCreationPlan.LineDiff", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationDescribeLineDiffTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const auto DescribeUpdate = [](const FString& Original, const FString& New)
+	{
+		FModuleCreationPlan Plan;
+		Plan.SourceUpdates.Add({ TEXT("File.h"), ToUtf8Bytes(Original), ToUtf8Bytes(New) });
+		return Plan.Describe();
+	};
+
+	TestEqual(TEXT("Unchanged file"), DescribeUpdate(TEXT("A\nB\n"), TEXT("A\nB\n")), FString(TEXT("File.h\n  (unchanged)\n")));
+
+	// Edits far apart get their own hunks and the lines between them are not shown as replaced
+	TestEqual(TEXT("Separate hunks"), DescribeUpdate(TEXT("A\nB\nC\nD\nE\nF\nG\n"), TEXT("A\nX\nC\nD\nE\nF\nY\n")),
+		FString(TEXT("File.h\n  @@ -1,3 +1,3 @@\n    A\n  - B\n  + X\n    C\n  @@ -6,2 +6,2 @@\n    F\n  - G\n  + Y\n")));
+
+	// Edits close to each other share a hunk
+	TestEqual(TEXT("Merged hunk"), DescribeUpdate(TEXT("A\nB\nC\nD\n"), TEXT("X\nB\nC\nY\n")),
+		FString(TEXT("File.h\n  @@ -1,4 +1,4 @@\n  - A\n  + X\n    B\n    C\n  - D\n  + Y\n")));
+
+	TestEqual(TEXT("Inserted line"), DescribeUpdate(TEXT("A\nB\n"), TEXT("A\nNew\nB\n")),
+		FString(TEXT("File.h\n  @@ -1,2 +1,3 @@\n    A\n  + New\n    B\n")));
+	TestEqual(TEXT("Added to empty file"), DescribeUpdate(TEXT(""), TEXT("A\n")),
+		FString(TEXT("File.h\n  @@ -0,0 +1,1 @@\n  + A\n")));
+	TestEqual(TEXT("Case-only change"), DescribeUpdate(TEXT("a\n"), TEXT("A\n")),
+		FString(TEXT("File.h\n  @@ -1,1 +1,1 @@\n  - a\n  + A\n")));
+	return true;
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleDescriptorFileUtils.h"
+
+#include "NewModule/PluginDirectoryIndex.h"
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "ModuleDescriptor.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationAddNewModuleToFileTest, "ModuleGeneration.ModuleDescriptorFileUtils.AddNewModuleToFile", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationAddNewModuleToFileTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const FString TestDirectory = MakeTestDirectory();
+	const FString DescriptorPath = FPaths::Combine(TestDirectory, TEXT("Test.uplugin"));
+	const FString Original = TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": [\n\t\t{\n\t\t\t\"Name\": \"First\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}\n\t]\n}\n");
+	const FString Expected = TEXT("{\n\t\"FileVersion\": 3,\n\t\"Modules\": [\n\t\t{\n\t\t\t\"Name\": \"First\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t},\n\t\t{\n\t\t\t\"Name\": \"NewModule\",\n\t\t\t\"Type\": \"Editor\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}\n\t]\n}\n");
+	if (!TestTrue(TEXT("Descriptor is written"), FFileHelper::SaveArrayToFile(ToUtf8Bytes(Original), *DescriptorPath)))
+	{
+		return false;
+	}
+
+	const FModuleDescriptor NewModule(TEXT("NewModule"), EHostType::Editor);
+	const FOperationResult AddOp = AddNewModuleToFile(DescriptorPath, NewModule);
+	TestTrue(TEXT("Module is added"), AddOp.IsSuccess());
+	TArray<uint8> Contents;
+	FFileHelper::LoadFileToArray(Contents, *DescriptorPath);
+	TestEqual(TEXT("Descriptor contains the module"), FromUtf8Bytes(Contents), Expected);
+
+	// Adding the same module again must fail without touching the file
+	const FOperationResult AddAgainOp = AddNewModuleToFile(DescriptorPath, NewModule);
+	TestTrue(TEXT("Module is not added twice"), AddAgainOp.IsFailure());
+	FFileHelper::LoadFileToArray(Contents, *DescriptorPath);
+	TestEqual(TEXT("Descriptor is unchanged after a failure"), FromUtf8Bytes(Contents), Expected);
+
+	const FOperationResult MissingOp = AddNewModuleToFile(FPaths::Combine(TestDirectory, TEXT("Missing.uplugin")), NewModule);
+	TestTrue(TEXT("Missing descriptor is reported"), MissingOp.IsFailure() && MissingOp.ErrorMessage->StartsWith(TEXT("Failed to read config file")));
+
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationFindUPluginFileTest, "ModuleGeneration.ModuleDescriptorFileUtils.FindUPluginFile", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationFindUPluginFileTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	// Resolution never touches the disk, so the plugins do not need to exist
+	const FString Root = MakeTestDirectory();
+	const FString FooDescriptor = FPaths::Combine(Root, TEXT("Plugins/Gameplay/Foo/Foo.uplugin"));
+	const FString BarDescriptor = FPaths::Combine(Root, TEXT("Plugins/Bar/Bar.uplugin"));
+	FPluginDirectoryIndex PluginIndex;
+	PluginIndex.AddPlugin(FPaths::Combine(Root, TEXT("Plugins/Gameplay/Foo")), FooDescriptor);
+	PluginIndex.AddPlugin(FPaths::Combine(Root, TEXT("Plugins/Bar/")), BarDescriptor);
+
+	const auto Find = [&PluginIndex](const FString& Directory)
+	{
+		const TOperationResult<FString> FindOp = FindUPluginFile(PluginIndex, Directory);
+		return FindOp.IsSuccess() ? FindOp.OperationResult.GetValue() : FString();
+	};
+	TestEqual(TEXT("Nested module directory"), Find(FPaths::Combine(Root, TEXT("Plugins/Gameplay/Foo/Source/FooEditor/Private"))), FooDescriptor);
+	TestEqual(TEXT("Plugin base directory"), Find(FPaths::Combine(Root, TEXT("Plugins/Gameplay/Foo"))), FooDescriptor);
+	TestEqual(TEXT("Trailing slash"), Find(FPaths::Combine(Root, TEXT("Plugins/Bar/Source/"))), BarDescriptor);
+	TestEqual(TEXT("Backslashes"), Find(FPaths::Combine(Root, TEXT("Plugins\\Bar\\Source"))), BarDescriptor);
+	TestEqual(TEXT("Different case"), Find(FPaths::Combine(Root, TEXT("plugins/BAR/source"))), BarDescriptor);
+
+	// Plugins are matched by whole path segments
+	const FString SiblingDirectory = FPaths::Combine(Root, TEXT("Plugins/BarBaz/Source"));
+	const TOperationResult<FString> SiblingOp = FindUPluginFile(PluginIndex, SiblingDirectory);
+	TestTrue(TEXT("Directory sharing a prefix with a plugin is not part of it"), SiblingOp.IsFailure());
+
+	const FString ProjectDirectory = FPaths::Combine(Root, TEXT("Source/Game"));
+	const TOperationResult<FString> ProjectOp = FindUPluginFile(PluginIndex, ProjectDirectory);
+	TestTrue(TEXT("Project module directory is not part of a plugin"), ProjectOp.IsFailure() && ProjectOp.ErrorMessage->Contains(TEXT("Searched 2 plugins")));
+
+	// A plugin added for the same base directory replaces the previous one
+	const FString ReplacedDescriptor = FPaths::Combine(Root, TEXT("Plugins/Bar/Renamed.uplugin"));
+	PluginIndex.AddPlugin(FPaths::Combine(Root, TEXT("Plugins/Bar")), ReplacedDescriptor);
+	TestEqual(TEXT("Replaced plugin"), Find(FPaths::Combine(Root, TEXT("Plugins/Bar/Source"))), ReplacedDescriptor);
+	TestEqual(TEXT("Replacing does not add a plugin"), PluginIndex.Num(), 2);
+	return true;
+}
+
+#endif
@@ -0,0 +1,130 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleExtraction.h"
+
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationPlanModuleExtractionTest, "ModuleGeneration.ModuleExtraction.PlanModuleExtraction", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationPlanModuleExtractionTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	// Game loses Inventory/Item.h and Item.cpp to the new Inventory module. Ui includes the header publicly, Tools privately, and
+	// each .Build.cs lists its dependencies differently.
+	const FString ItemHeader =
+		TEXT("#pragma once\n\n#include \"CoreMinimal.h\"\n#include \"../GameTypes.h\"\n#include \"Item.generated.h\"\n\n")
+		TEXT("// UCLASS() in a comment declares nothing\n")
+		TEXT("UCLASS(BlueprintType, meta = (DisplayName = \"Item (Inventory)\"))\nclass GAME_API UItem : public UObject\n{\n\tGENERATED_BODY()\n};\n\n")
+		TEXT("USTRUCT(BlueprintType)\nstruct GAME_API FItemStack\n{\n\tGENERATED_BODY()\n};\n\n")
+		TEXT("UENUM()\nenum class EItemRarity : uint8\n{\n\tCommon\n};\n\n")
+		TEXT("#define GAME_API_X 1\n");
+	// Laid out like the default template, with trailing spaces after the opening brace, behind a conditional list of the same kind
+	const TCHAR* GameBuildFile =
+		TEXT("using UnrealBuildTool;\n\npublic class Game : ModuleRules\n{\n\tpublic Game(ReadOnlyTargetRules Target) : base(Target)\n\t{\n")
+		TEXT("\t\t// \"Inventory\" is split out of this module\n")
+		TEXT("\t\tif (Target.bBuildEditor)\n\t\t{\n\t\t\tPrivateDependencyModuleNames.AddRange(new string[] { \"UnrealEd\" });\n\t\t}\n\n")
+		TEXT("\t\tPrivateDependencyModuleNames.AddRange(new string[] \n\t\t\t{ \n\t\t\t\t\"Core\",\n\t\t\t\t\"Engine\"\n\t\t\t});\n")
+		TEXT("\t}\n}\n");
+	const TCHAR* UiBuildFile =
+		TEXT("using UnrealBuildTool;\n\npublic class Ui : ModuleRules\n{\n\tpublic Ui(ReadOnlyTargetRules Target) : base(Target)\n\t{\n")
+		TEXT("\t\tPublicDependencyModuleNames.AddRange(new string[] { \"Core\", \"Game\" });\n")
+		TEXT("\t}\n}\n");
+	const TCHAR* ToolsBuildFile =
+		TEXT("using UnrealBuildTool;\n\npublic class Tools : ModuleRules\n{\n\tpublic Tools(ReadOnlyTargetRules Target) : base(Target)\n\t{\n")
+		TEXT("\t\t/* PrivateDependencyModuleNames.AddRange(new string[] { \"Game\" }); */\n")
+		TEXT("\t\tPublicDependencyModuleNames.Add(\"Core\");\n")
+		TEXT("\t}\n}\n");
+	const TCHAR* Config = TEXT("[/Script/Engine.Engine]\nbSmoothFrameRate=True\n\n[CoreRedirects]\n+PackageRedirects=(OldName=\"/Script/OldGame\",NewName=\"/Script/Game\")\n");
+
+	const FString Root = MakeTestDirectory();
+	const TPair<const TCHAR*, const TCHAR*> Files[] =
+	{
+		{ TEXT("Source/Game/Game.Build.cs"), GameBuildFile },
+		{ TEXT("Source/Game/Public/GameTypes.h"), TEXT("#pragma once\n") },
+		{ TEXT("Source/Game/Public/Inventory/Item.h"), *ItemHeader },
+		{ TEXT("Source/Game/Private/Inventory/Item.cpp"), TEXT("#include \"Inventory/Item.h\"\n\nvoid UseItem() {}\n") },
+		{ TEXT("Source/Game/Private/GameMode.cpp"), TEXT("#include \"Inventory/Item.h\"\n#include \"GameTypes.h\"\n") },
+		{ TEXT("Source/Ui/Ui.Build.cs"), UiBuildFile },
+		{ TEXT("Source/Ui/Public/ItemWidget.h"), TEXT("#pragma once\n\n#include \"Inventory/Item.h\"\n") },
+		{ TEXT("Source/Tools/Tools.Build.cs"), ToolsBuildFile },
+		{ TEXT("Source/Tools/Private/ItemTool.cpp"), TEXT("#include \"Inventory/Item.h\"\n") },
+		{ TEXT("Config/DefaultEngine.ini"), Config }
+	};
+	WriteTextFiles(Root, Files);
+
+	FModuleExtractionSettings Settings;
+	Settings.Source.ModuleName = TEXT("Game");
+	Settings.Source.ModuleDirectory = FPaths::Combine(Root, TEXT("Source/Game"));
+	Settings.Source.Files = { FPaths::Combine(Root, TEXT("Source/Game/Public/Inventory/Item.h")), FPaths::Combine(Root, TEXT("Source/Game/Private/Inventory/Item.cpp")) };
+	Settings.NewModuleName = TEXT("Inventory");
+	Settings.OutputDirectory = FPaths::Combine(Root, TEXT("Source"));
+	Settings.SourceRoots = { FPaths::Combine(Root, TEXT("Source")) };
+	Settings.RedirectsConfigPath = FPaths::Combine(Root, TEXT("Config/DefaultEngine.ini"));
+	const TOperationResult<FModuleExtraction> ExtractionOp = PlanModuleExtraction(Settings);
+	if (!TestTrue(TEXT("Extraction is planned"), ExtractionOp.IsSuccess()))
+	{
+		AddError(ExtractionOp.ErrorMessage.Get(FString()));
+		IFileManager::Get().DeleteDirectory(*Root, false, true);
+		return false;
+	}
+	const FModuleExtraction& Extraction = ExtractionOp.OperationResult.GetValue();
+
+	// The moved files lose the folder they have in common; the relative include is spelled out and only the whole export macro is replaced
+	if (TestEqual(TEXT("Number of moved files"), Extraction.NewModuleFiles.Num(), 2))
+	{
+		TestEqual(TEXT("Moved source"), Extraction.NewModuleFiles[0].RelativePath, FString(TEXT("Inventory/Private/Item.cpp")));
+		TestEqual(TEXT("Moved header"), Extraction.NewModuleFiles[1].RelativePath, FString(TEXT("Inventory/Public/Item.h")));
+		TestEqual(TEXT("Quoted include of a moved file"), FromUtf8Bytes(Extraction.NewModuleFiles[0].Contents), FString(TEXT("#include \"Item.h\"\n\nvoid UseItem() {}\n")));
+		TestEqual(TEXT("Relative include and export macro"), FromUtf8Bytes(Extraction.NewModuleFiles[1].Contents), ItemHeader
+			.Replace(TEXT("\"../GameTypes.h\""), TEXT("\"GameTypes.h\""))
+			.Replace(TEXT("class GAME_API"), TEXT("class INVENTORY_API"))
+			.Replace(TEXT("struct GAME_API"), TEXT("struct INVENTORY_API")));
+	}
+
+	const auto FindNewContents = [this, &Extraction](const TCHAR* PathSuffix) -> FString
+	{
+		const FPlannedSourceUpdate* Update = Extraction.SourceUpdates.FindByPredicate([PathSuffix](const FPlannedSourceUpdate& Candidate) { return Candidate.Path.EndsWith(PathSuffix); });
+		if (!Update || !Update->NewContents)
+		{
+			AddError(FString::Printf(TEXT("%s is not rewritten"), PathSuffix));
+			return FString();
+		}
+		return FromUtf8Bytes(Update->NewContents.GetValue());
+	};
+	TestEqual(TEXT("Number of source updates"), Extraction.SourceUpdates.Num(), 9);
+	TestTrue(TEXT("Moved header is removed"), Extraction.SourceUpdates.ContainsByPredicate([](const FPlannedSourceUpdate& Update) { return Update.Path.EndsWith(TEXT("Game/Public/Inventory/Item.h")) && !Update.NewContents; }));
+	TestEqual(TEXT("Include in the source module"), FindNewContents(TEXT("Game/Private/GameMode.cpp")), FString(TEXT("#include \"Item.h\"\n#include \"GameTypes.h\"\n")));
+	TestEqual(TEXT("Include in another module"), FindNewContents(TEXT("Ui/Public/ItemWidget.h")), FString(TEXT("#pragma once\n\n#include \"Item.h\"\n")));
+
+	// Multi-line list with a trailing space after the brace: the entry is indented like the others, not spliced onto the brace line.
+	// The commented name does not count as a dependency and the list in the if block is left alone.
+	TestEqual(TEXT("Multi-line list"), FindNewContents(TEXT("Game/Game.Build.cs")), FString(GameBuildFile)
+		.Replace(TEXT("\t\t\t{ \n\t\t\t\t\"Core\""), TEXT("\t\t\t{ \n\t\t\t\t\"Inventory\",\n\t\t\t\t\"Core\"")));
+	TestEqual(TEXT("Single-line list"), FindNewContents(TEXT("Ui/Ui.Build.cs")), FString(UiBuildFile)
+		.Replace(TEXT("{ \"Core\", \"Game\" }"), TEXT("{ \"Inventory\", \"Core\", \"Game\" }")));
+	TestEqual(TEXT("No list outside comments"), FindNewContents(TEXT("Tools/Tools.Build.cs")), FString(ToolsBuildFile)
+		.Replace(TEXT("\t\tPublicDependencyModuleNames.Add(\"Core\");\n"), TEXT("\t\tPublicDependencyModuleNames.Add(\"Core\");\n\t\tPrivateDependencyModuleNames.Add(\"Inventory\");\n")));
+
+	// Script names drop the prefix of classes and structs but not of enums
+	TestEqual(TEXT("CoreRedirects"), FindNewContents(TEXT("Config/DefaultEngine.ini")), FString(Config).Replace(TEXT("[CoreRedirects]\n"),
+		TEXT("[CoreRedirects]\n")
+		TEXT("+ClassRedirects=(OldName=\"/Script/Game.Item\",NewName=\"/Script/Inventory.Item\")\n")
+		TEXT("+StructRedirects=(OldName=\"/Script/Game.ItemStack\",NewName=\"/Script/Inventory.ItemStack\")\n")
+		TEXT("+EnumRedirects=(OldName=\"/Script/Game.EItemRarity\",NewName=\"/Script/Inventory.EItemRarity\")\n")));
+
+	const FModuleExtractionReport& Report = Extraction.Report;
+	TestEqual(TEXT("Redirected types"), Report.RedirectedTypes, TArray<FString>{ TEXT("EItemRarity"), TEXT("FItemStack"), TEXT("UItem") });
+	TestEqual(TEXT("Dependent modules"), Report.DependentModules, TArray<FString>{ TEXT("Game"), TEXT("Tools"), TEXT("Ui") });
+	TestEqual(TEXT("Includes of the source module"), Report.IncludesOfSourceModule, TArray<FString>{ TEXT("Public/GameTypes.h") });
+
+	IFileManager::Get().DeleteDirectory(*Root, false, true);
+	return true;
+}
+
+#endif
@@ -0,0 +1,45 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+namespace UE::ModuleGeneration::Tests
+{
+	inline TArray<uint8> ToUtf8Bytes(const FString& Text)
+	{
+		const FTCHARToUTF8 Converted(*Text, Text.Len());
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	}
+
+	inline FString FromUtf8Bytes(TConstArrayView<uint8> Bytes)
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+		return FString::ConstructFromPtrSize(Converted.Get(), Converted.Length());
+	}
+
+	/** @return A new absolute directory below the automation transient directory; the caller deletes it */
+	inline FString MakeTestDirectory()
+	{
+		return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("ModuleGeneration"), FGuid::NewGuid().ToString()));
+	}
+
+	/** Writes each file's text below Root, creating the directories on the way */
+	inline void WriteTextFiles(const FString& Root, TConstArrayView<TPair<const TCHAR*, const TCHAR*>> Files)
+	{
+		for (const TPair<const TCHAR*, const TCHAR*>& File : Files)
+		{
+			FFileHelper::SaveStringToFile(File.Value, *FPaths::Combine(Root, File.Key));
+		}
+	}
+
+	inline FString LoadText(const FString& Path)
+	{
+		FString Result;
+		FFileHelper::LoadFileToString(Result, *Path);
+		return Result;
+	}
+}
@@ -0,0 +1,67 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateFileUtils.h"
+
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/ModuleTemplateCache.h"
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "ModuleDescriptor.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationInstantiateModuleTemplateTest, "ModuleGeneration.ModuleTemplateFileUtils.InstantiateModuleTemplate", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationInstantiateModuleTemplateTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const FString TestDirectory = MakeTestDirectory();
+	const FString TemplateDirectory = FPaths::Combine(TestDirectory, TEXT("Template"));
+	const FString OutputDirectory = FPaths::Combine(TestDirectory, TEXT("Output"));
+
+	// Placeholders in paths and contents, an escaped and an unknown placeholder and a binary file with braces in it
+	const TPair<const TCHAR*, const TCHAR*> TextFiles[] =
+	{
+		{ TEXT("{ModuleName}/{ModuleName}.Build.cs"), TEXT("// {Copyright}\n\npublic class {ModuleName} : ModuleRules\n{\n\t// { PublicDependencies }\n\t// `{ModuleName} {Unknown}\n}\n") },
+		{ TEXT("{ModuleName}/Public/{ModuleName}.h"), TEXT("// {Copyright}\n\n#pragma once\n") },
+		{ TEXT("{ModuleName}/Private/Verbatim.txt"), TEXT("No placeholders\n") }
+	};
+	WriteTextFiles(TemplateDirectory, TextFiles);
+	TArray<uint8> BinaryContents = { 0x89, 'P', 'N', 'G', 0x00, '{', 'M', 'o', 'd', 'u', 'l', 'e', 'N', 'a', 'm', 'e', '}', 0x00 };
+	FFileHelper::SaveArrayToFile(BinaryContents, *FPaths::Combine(TemplateDirectory, TEXT("{ModuleName}/Resources/Icon.png")));
+
+	const FModuleDescriptor NewModule(TEXT("MyModule"));
+	const FString CopyrightNotice = TEXT("Copyright Test Studio. All rights reserved.");
+	const FOperationResult InstantiateOp = InstantiateModuleTemplate(TemplateDirectory, OutputDirectory, NewModule, CopyrightNotice);
+	TestTrue(TEXT("Template is instantiated"), InstantiateOp.IsSuccess());
+
+	const FString ModuleDirectory = FPaths::Combine(OutputDirectory, TEXT("MyModule"));
+	TestEqual(TEXT(".Build.cs"), LoadText(FPaths::Combine(ModuleDirectory, TEXT("MyModule.Build.cs"))),
+		FString(TEXT("// Copyright Test Studio. All rights reserved.\n\npublic class MyModule : ModuleRules\n{\n\t// \"Core\", \"CoreUObject\", \"Engine\"\n\t// {ModuleName} {Unknown}\n}\n")));
+	TestEqual(TEXT("Header"), LoadText(FPaths::Combine(ModuleDirectory, TEXT("Public/MyModule.h"))), FString(TEXT("// Copyright Test Studio. All rights reserved.\n\n#pragma once\n")));
+	TestEqual(TEXT("Text file without placeholders"), LoadText(FPaths::Combine(ModuleDirectory, TEXT("Private/Verbatim.txt"))), FString(TEXT("No placeholders\n")));
+	TArray<uint8> CopiedBinary;
+	FFileHelper::LoadFileToArray(CopiedBinary, *FPaths::Combine(ModuleDirectory, TEXT("Resources/Icon.png")));
+	TestTrue(TEXT("Binary file is copied byte for byte"), CopiedBinary == BinaryContents);
+
+	// Every template file is written once, next to the manifest recording them
+	TArray<FString> OutputFiles;
+	IFileManager::Get().FindFilesRecursive(OutputFiles, *OutputDirectory, TEXT("*"), true, false);
+	TestEqual(TEXT("Number of output files"), OutputFiles.Num(), static_cast<int32>(UE_ARRAY_COUNT(TextFiles)) + 2);
+	TestTrue(TEXT("Manifest is written"), FPaths::FileExists(FPaths::Combine(ModuleDirectory, FGeneratedFilesManifest::FileName)));
+	TestFalse(TEXT("No placeholder is left in the output paths"), OutputFiles.ContainsByPredicate([](const FString& Path) { return Path.Contains(TEXT("{")); }));
+
+	const FOperationResult MissingTemplateOp = InstantiateModuleTemplate(FPaths::Combine(TestDirectory, TEXT("Missing")), OutputDirectory, NewModule, CopyrightNotice);
+	TestTrue(TEXT("Missing template is reported"), MissingTemplateOp.IsFailure());
+
+	FModuleTemplateCache::Get().Invalidate();
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+	return true;
+}
+
+#endif
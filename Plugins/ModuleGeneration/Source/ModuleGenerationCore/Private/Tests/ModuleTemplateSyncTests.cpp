@@ -0,0 +1,141 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/ModuleTemplateSync.h"
+
+#include "NewModule/GeneratedFileWriter.h"
+#include "NewModule/ModuleTemplateCache.h"
+#include "NewModule/ModuleTemplateFileUtils.h"
+#include "Tests/ModuleGenerationTestUtils.h"
+
+#include "ModuleDescriptor.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationSyncModulesWithTemplateTest, "ModuleGeneration.ModuleTemplateSync.SyncModulesWithTemplate", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationSyncModulesWithTemplateTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+	using namespace UE::ModuleGeneration::Tests;
+
+	const FString TestDirectory = MakeTestDirectory();
+	const FString TemplatesDirectory = FPaths::Combine(TestDirectory, TEXT("Templates"));
+	const FString TemplateDirectory = FPaths::Combine(TemplatesDirectory, TEXT("Basic"));
+	const FString ProjectDirectory = FPaths::Combine(TestDirectory, TEXT("Project"));
+	const FString TrackedDirectory = FPaths::Combine(ProjectDirectory, TEXT("Source/Tracked"));
+	const FString UntrackedDirectory = FPaths::Combine(ProjectDirectory, TEXT("Source/Untracked"));
+	const FString CopyrightNotice = TEXT("Copyright Test Studio. All rights reserved.");
+
+	const TPair<const TCHAR*, const TCHAR*> OriginalTemplateFiles[] =
+	{
+		{ TEXT("{ModuleName}/{ModuleName}.Build.cs"), TEXT("// {Copyright}\n\npublic class {ModuleName} : ModuleRules\n{\n}\n") },
+		{ TEXT("{ModuleName}/Public/{ModuleName}.h"), TEXT("#pragma once\n") },
+		{ TEXT("{ModuleName}/Private/{ModuleName}.cpp"), TEXT("#include \"{ModuleName}.h\"\n") },
+		{ TEXT("{ModuleName}/Private/Helpers.h"), TEXT("#pragma once\n") }
+	};
+	WriteTextFiles(TemplateDirectory, OriginalTemplateFiles);
+	if (!TestTrue(TEXT("Tracked module is generated"), InstantiateModuleTemplate(TemplateDirectory, FPaths::Combine(ProjectDirectory, TEXT("Source")), FModuleDescriptor(TEXT("Tracked")), CopyrightNotice).IsSuccess()))
+	{
+		FModuleTemplateCache::Get().Invalidate();
+		IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+		return false;
+	}
+
+	// The template changes the header and the source and gains a file. The user edits the source and deletes the helper header.
+	// The untracked module only has the .Build.cs the template generates for it.
+	const TCHAR* EditedSource = TEXT("#include \"Tracked.h\"\n\nvoid Edited() {}\n");
+	const TPair<const TCHAR*, const TCHAR*> ChangedTemplateFiles[] =
+	{
+		{ TEXT("{ModuleName}/Public/{ModuleName}.h"), TEXT("#pragma once\n\n#include \"CoreMinimal.h\"\n") },
+		{ TEXT("{ModuleName}/Private/{ModuleName}.cpp"), TEXT("#include \"{ModuleName}.h\"\n#include \"Helpers.h\"\n") },
+		{ TEXT("{ModuleName}/Private/Added.h"), TEXT("#pragma once\n") }
+	};
+	WriteTextFiles(TemplateDirectory, ChangedTemplateFiles);
+	FModuleTemplateCache::Get().Invalidate();
+	const TPair<const TCHAR*, const TCHAR*> ProjectFiles[] =
+	{
+		{ TEXT("Source/Tracked/Private/Tracked.cpp"), EditedSource },
+		{ TEXT("Source/Untracked/Untracked.Build.cs"), TEXT("// Copyright Test Studio. All rights reserved.\n\npublic class Untracked : ModuleRules\n{\n}\n") }
+	};
+	WriteTextFiles(ProjectDirectory, ProjectFiles);
+	IFileManager::Get().Delete(*FPaths::Combine(TrackedDirectory, TEXT("Private/Helpers.h")));
+
+	const auto DescribeFiles = [](const FModuleSyncResult& Module)
+	{
+		FString Result;
+		for (const FModuleSyncResult::FFile& File : Module.Files)
+		{
+			Result += FString::Printf(TEXT("%s %s\n"), *File.RelativePath, EGeneratedFileState::ToString(File.State));
+		}
+		return Result;
+	};
+
+	FModuleSyncSettings Settings;
+	Settings.ProjectDirectory = ProjectDirectory;
+	Settings.TemplatesDirectory = TemplatesDirectory;
+	Settings.UntrackedModulesTemplateName = TEXT("Basic");
+	Settings.CopyrightNotice = CopyrightNotice;
+	const FModuleSyncReport CompareReport = SyncModulesWithTemplate(Settings);
+	if (TestEqual(TEXT("Number of compared modules"), CompareReport.Modules.Num(), 2))
+	{
+		const FModuleSyncResult& Tracked = CompareReport.Modules[0];
+		TestTrue(TEXT("Module with manifest is tracked"), Tracked.bIsTracked);
+		TestEqual(TEXT("States of a tracked module"), DescribeFiles(Tracked), FString(TEXT(
+			"Private/Added.h Added\n"
+			"Private/Helpers.h Missing\n"
+			"Private/Tracked.cpp Edited\n"
+			"Public/Tracked.h Outdated\n"
+			"Tracked.Build.cs UpToDate\n")));
+
+		// Without a manifest nothing tells a file that was never generated from one the user deleted
+		const FModuleSyncResult& Untracked = CompareReport.Modules[1];
+		TestFalse(TEXT("Module without manifest is untracked"), Untracked.bIsTracked);
+		TestEqual(TEXT("States of an untracked module"), DescribeFiles(Untracked), FString(TEXT(
+			"Private/Added.h Missing\n"
+			"Private/Helpers.h Missing\n"
+			"Private/Untracked.cpp Missing\n"
+			"Public/Untracked.h Missing\n"
+			"Untracked.Build.cs UpToDate\n")));
+		TestEqual(TEXT("Comparing writes nothing"), Tracked.NumFilesWritten + Untracked.NumFilesWritten, 0);
+	}
+	TestFalse(TEXT("Comparing adds no files"), FPaths::FileExists(FPaths::Combine(TrackedDirectory, TEXT("Private/Added.h"))));
+	TestFalse(TEXT("Comparing writes no manifest"), FPaths::FileExists(FPaths::Combine(UntrackedDirectory, FGeneratedFilesManifest::FileName)));
+
+	Settings.bApply = true;
+	const FModuleSyncReport ApplyReport = SyncModulesWithTemplate(Settings);
+	if (TestEqual(TEXT("Number of applied modules"), ApplyReport.Modules.Num(), 2))
+	{
+		TestEqual(TEXT("Outdated and added files are written"), ApplyReport.Modules[0].NumFilesWritten, 2);
+		TestEqual(TEXT("Nothing is written to an untracked module"), ApplyReport.Modules[1].NumFilesWritten, 0);
+		TestFalse(TEXT("Applying succeeds"), ApplyReport.Modules[0].ErrorMessage.IsSet() || ApplyReport.Modules[1].ErrorMessage.IsSet());
+	}
+	TestEqual(TEXT("Outdated file is updated"), LoadText(FPaths::Combine(TrackedDirectory, TEXT("Public/Tracked.h"))), FString(TEXT("#pragma once\n\n#include \"CoreMinimal.h\"\n")));
+	TestEqual(TEXT("Added file is written"), LoadText(FPaths::Combine(TrackedDirectory, TEXT("Private/Added.h"))), FString(TEXT("#pragma once\n")));
+	TestEqual(TEXT("Edited file is left alone"), LoadText(FPaths::Combine(TrackedDirectory, TEXT("Private/Tracked.cpp"))), FString(EditedSource));
+	TestFalse(TEXT("Missing file is not restored"), FPaths::FileExists(FPaths::Combine(TrackedDirectory, TEXT("Private/Helpers.h"))));
+	TestFalse(TEXT("Missing file of an untracked module is not written"), FPaths::FileExists(FPaths::Combine(UntrackedDirectory, TEXT("Public/Untracked.h"))));
+
+	// The edited and missing files keep the entries of what was generated, so they are recognized again if they are reverted
+	const TOptional<FGeneratedFilesManifest> TrackedManifest = FGeneratedFilesManifest::Load(TrackedDirectory);
+	if (TestTrue(TEXT("Tracked manifest is kept"), TrackedManifest.IsSet()))
+	{
+		const TArray<uint8> GeneratedSource = ToUtf8Bytes(TEXT("#include \"Tracked.h\"\n"));
+		const FGeneratedFilesManifest::FFile* SourceEntry = TrackedManifest->Find(TEXT("Private/Tracked.cpp"));
+		TestTrue(TEXT("Entry of the edited file is kept"), SourceEntry && SourceEntry->Size == GeneratedSource.Num() && SourceEntry->Hash == HashFileContents(GeneratedSource));
+		TestNotNull(TEXT("Entry of the missing file is kept"), TrackedManifest->Find(TEXT("Private/Helpers.h")));
+		TestNotNull(TEXT("Added file is tracked"), TrackedManifest->Find(TEXT("Private/Added.h")));
+	}
+	const TOptional<FGeneratedFilesManifest> UntrackedManifest = FGeneratedFilesManifest::Load(UntrackedDirectory);
+	if (TestTrue(TEXT("Untracked module gets a manifest"), UntrackedManifest.IsSet()) && TestEqual(TEXT("Manifest lists the up to date files"), UntrackedManifest->Files.Num(), 1))
+	{
+		TestEqual(TEXT("Tracked file of a formerly untracked module"), UntrackedManifest->Files[0].RelativePath, FString(TEXT("Untracked.Build.cs")));
+	}
+
+	FModuleTemplateCache::Get().Invalidate();
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+	return true;
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/OperationResult.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationOperationResultSuccessTest, "ModuleGeneration.OperationResult.Success", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationOperationResultSuccessTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+
+	const FOperationResult VoidOp = FOperationResult::MakeSuccess();
+	TestTrue(TEXT("Void success is a success"), VoidOp.IsSuccess());
+	TestFalse(TEXT("Void success is not a failure"), VoidOp.IsFailure());
+	TestTrue(TEXT("Void success converts to true"), static_cast<bool>(VoidOp));
+	TestFalse(TEXT("Void success has no error"), VoidOp.ErrorMessage.IsSet());
+
+	const TOperationResult<int32> IntOp = TOperationResult<int32>::MakeSuccess(42);
+	TestTrue(TEXT("Value success is a success"), IntOp.IsSuccess());
+	TestTrue(TEXT("Value success holds the value"), IntOp.OperationResult.IsSet() && IntOp.OperationResult.GetValue() == 42);
+
+	// FString results must not be mistaken for error messages
+	const TOperationResult<FString> StringOp = TOperationResult<FString>::MakeSuccess(TEXT("Result"));
+	TestTrue(TEXT("String success is a success"), StringOp.IsSuccess());
+	TestEqual(TEXT("String success holds the value"), StringOp.OperationResult.Get(FString()), FString(TEXT("Result")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationOperationResultFailureTest, "ModuleGeneration.OperationResult.Failure", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationOperationResultFailureTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+
+	const FOperationResult VoidOp = FOperationResult::MakeFailure(TEXT("Void failed"));
+	TestTrue(TEXT("Void failure is a failure"), VoidOp.IsFailure());
+	TestFalse(TEXT("Void failure converts to false"), static_cast<bool>(VoidOp));
+	TestEqual(TEXT("Void failure keeps the message"), VoidOp.ErrorMessage.Get(FString()), FString(TEXT("Void failed")));
+
+	const TOperationResult<FString> StringOp = TOperationResult<FString>::MakeFailure(TEXT("String failed"));
+	TestTrue(TEXT("String failure is a failure"), StringOp.IsFailure());
+	TestFalse(TEXT("String failure has no value"), StringOp.OperationResult.IsSet());
+	TestEqual(TEXT("String failure keeps the message"), StringOp.ErrorMessage.Get(FString()), FString(TEXT("String failed")));
+
+	// Failures are propagated between result types without losing the message
+	const TOperationResult<int32> IntOp = TOperationResult<int32>::MakeFailure(StringOp);
+	TestTrue(TEXT("Propagated failure is a failure"), IntOp.IsFailure());
+	TestFalse(TEXT("Propagated failure has no value"), IntOp.OperationResult.IsSet());
+	TestEqual(TEXT("Propagated failure keeps the message"), IntOp.ErrorMessage.Get(FString()), FString(TEXT("String failed")));
+
+	const FOperationResult PropagatedVoidOp = FOperationResult::MakeFailure(IntOp);
+	TestTrue(TEXT("Failure propagated to void is a failure"), PropagatedVoidOp.IsFailure());
+	TestEqual(TEXT("Failure propagated to void keeps the message"), PropagatedVoidOp.ErrorMessage.Get(FString()), FString(TEXT("String failed")));
+	return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "NewModule/PlaceholderSubstitution.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationPlaceholderNameTableTest, "ModuleGeneration.PlaceholderSubstitution.NameTable", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationPlaceholderNameTableTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+
+	const TCHAR* Names[] = { TEXT("ModuleName"), TEXT("Copyright"), TEXT("PublicDependencies"), TEXT("PrivateDependencies"), TEXT("BuildSettings") };
+	const FPlaceholderNameTable NameTable(Names);
+	TestEqual(TEXT("Number of names"), NameTable.Num(), static_cast<int32>(UE_ARRAY_COUNT(Names)));
+	for (int32 Index = 0; Index < static_cast<int32>(UE_ARRAY_COUNT(Names)); ++Index)
+	{
+		TestEqual(FString::Printf(TEXT("Index of %s"), Names[Index]), NameTable.Find(FStringView(Names[Index])), Index);
+	}
+	TestEqual(TEXT("Lookups ignore case"), NameTable.Find(FStringView(TEXT("mODULEnAME"))), 0);
+	TestEqual(TEXT("UTF-8 lookups"), NameTable.Find(FUtf8StringView(UTF8TEXT("copyright"))), 1);
+	TestEqual(TEXT("Unknown name"), NameTable.Find(FStringView(TEXT("Unknown"))), INDEX_NONE);
+	TestEqual(TEXT("Prefix of a name"), NameTable.Find(FStringView(TEXT("Module"))), INDEX_NONE);
+	TestEqual(TEXT("Empty name"), NameTable.Find(FStringView()), INDEX_NONE);
+
+	const FPlaceholderNameTable EmptyTable(TConstArrayView<const TCHAR*>{});
+	TestEqual(TEXT("Empty table"), EmptyTable.Find(FStringView(TEXT("ModuleName"))), INDEX_NONE);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModuleGenerationSubstitutePlaceholdersTest, "ModuleGeneration.PlaceholderSubstitution.MatchesFormat", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FModuleGenerationSubstitutePlaceholdersTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::ModuleGeneration;
+
+	// SubstitutePlaceholders replaces FString::Format, so both must produce the same text for every template
+	const FString ModuleName = TEXT("MyModule");
+	const FString Copyright = TEXT("Copyright \u00C9diteur {Studio}. All rights reserved.");
+	FStringFormatNamedArguments NamedArguments;
+	NamedArguments.Add(TEXT("ModuleName"), FStringFormatArg(ModuleName));
+	NamedArguments.Add(TEXT("Copyright"), FStringFormatArg(Copyright));
+	const TCHAR* Names[] = { TEXT("ModuleName"), TEXT("Copyright") };
+	const FStringView Values[] = { ModuleName, Copyright };
+	const FPlaceholderNameTable NameTable(Names);
+
+	const auto TestMatchesFormat = [&](const FString& Template)
+	{
+		const FString Expected = FString::Format(*Template, NamedArguments);
+		const FString Actual = SubstitutePlaceholders(Template, NameTable, Values);
+		if (!Actual.Equals(Expected, ESearchCase::CaseSensitive))
+		{
+			AddError(FString::Printf(TEXT("'%s' became '%s' instead of '%s'"), *Template, *Actual, *Expected));
+		}
+	};
+
+	const TCHAR* Templates[] =
+	{
+		TEXT(""),
+		TEXT("No placeholders"),
+		TEXT("{ModuleName}"),
+		TEXT("{ModuleName}{Copyright}"),
+		TEXT("// {Copyright}\nclass {MODULENAME}_API F{modulename}\n{\n};\n"),
+		TEXT("{ ModuleName }{\tCopyright\n}"),
+		TEXT("{Unknown} { } {} {Module Name}"),
+		TEXT("Unmatched { and } and {ModuleName"),
+		TEXT("Nested {{ModuleName}} and {Module{ModuleName}}"),
+		TEXT("Escaped `{ModuleName} and `` and `{ and a lone ` here"),
+		TEXT("Trailing escape `"),
+		TEXT("Non-ASCII \u00FC\u4E2D {ModuleName} \u00DF")
+	};
+	for (const TCHAR* Template : Templates)
+	{
+		TestMatchesFormat(Template);
+	}
+
+	// The scan handles 8 or 16 characters at a time, so special characters are placed at and around every chunk boundary
+	for (int32 Position = 0; Position < 40; ++Position)
+	{
+		for (const TCHAR* Special : { TEXT("{ModuleName}"), TEXT("`{"), TEXT("``"), TEXT("{"), TEXT("}") })
+		{
+			TestMatchesFormat(FString::ChrN(Position, TEXT('x')) + Special + FString::ChrN(40 - Position, TEXT('y')));
+		}
+	}
+	return true;
+}
+
+#endif
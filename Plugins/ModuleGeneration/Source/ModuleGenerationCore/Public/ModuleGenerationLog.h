@@ -4,4 +4,4 @@
 
 #include "CoreMinimal.h"
 
-DECLARE_LOG_CATEGORY_EXTERN(LogModuleGeneration, Log, All);
\ No newline at end of file
+MODULEGENERATIONCORE_API DECLARE_LOG_CATEGORY_EXTERN(LogModuleGeneration, Log, All);
\ No newline at end of file
@@ -0,0 +1,12 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("ModuleGeneration"), STATGROUP_ModuleGeneration, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Template Cache Hits"), STAT_ModuleGeneration_TemplateCacheHits, STATGROUP_ModuleGeneration, MODULEGENERATIONCORE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Template Cache Misses"), STAT_ModuleGeneration_TemplateCacheMisses, STATGROUP_ModuleGeneration, MODULEGENERATIONCORE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Template Cache Memory"), STAT_ModuleGeneration_TemplateCacheMemory, STATGROUP_ModuleGeneration, MODULEGENERATIONCORE_API);
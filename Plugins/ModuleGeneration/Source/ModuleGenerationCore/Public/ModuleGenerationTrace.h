@@ -0,0 +1,124 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+#include <atomic>
+
+/** Enable with -trace=cpu,ModuleGeneration to see where module creation spends its time in Unreal Insights */
+UE_TRACE_CHANNEL_EXTERN(ModuleGenerationChannel, MODULEGENERATIONCORE_API);
+
+namespace UE::ModuleGeneration
+{
+	/** Phases of module creation which are timed separately */
+	namespace ETimedPhase
+	{
+		enum Type
+		{
+			EnumerateTemplate,
+			ReadTemplate,
+			CreateDirectories,
+			Substitute,
+			AnalyzeIncludes,
+			WriteFiles,
+			/** Comparing existing modules with their template; see SyncModulesWithTemplate */
+			CompareFiles,
+			ReadDescriptor,
+			PatchDescriptor,
+			WriteDescriptor,
+			Commit,
+			ProjectFiles,
+			Num
+		};
+
+		MODULEGENERATIONCORE_API const TCHAR* ToString(Type Phase);
+	}
+
+	namespace ETimedCounter
+	{
+		enum Type
+		{
+			TemplateFilesRead,
+			TemplateBytesRead,
+			DirectoriesCreated,
+			FilesWritten,
+			BytesWritten,
+			/** Generated files skipped because they already had the same contents */
+			FilesUnchanged,
+			BytesUnchanged,
+			/** Verbatim template files copied instead of instantiated in memory; see CopyFileIfChanged */
+			FilesCopied,
+			BytesCopied,
+			Num
+		};
+	}
+
+	/**
+	 * Accumulates the time spent in each phase and a few counters over one module creation run, on all threads, so a summary can be
+	 * logged at the end. Nothing is recorded outside a run, so e.g. the editor's previews and background include analysis do not end
+	 * up in the summary of the next module. Only one run is recorded at a time, and work other threads do while it is in progress is
+	 * counted in it too: the editor only times committing a plan, during which the dialog blocks input, and batch creation (commandlet
+	 * or command line tool) creates all of its modules in one run.
+	 */
+	class MODULEGENERATIONCORE_API FModuleCreationTimings : public FNoncopyable
+	{
+	public:
+
+		static FModuleCreationTimings& Get();
+
+		/**
+		 * Clears all timings and counters and records until EndRun.
+		 * @return False without changes if another run is in progress; the caller must not call EndRun or log a summary then
+		 */
+		bool BeginRun();
+		void EndRun();
+
+		void AddPhaseTime(ETimedPhase::Type Phase, uint64 Cycles);
+		void AddCount(ETimedCounter::Type Counter, int64 Value);
+		/** Records how many bytes of generated contents one module held in memory before it was written; the largest is logged */
+		void RecordInstantiationBytes(int64 Bytes);
+
+		/**
+		 * Logs the thread time and number of calls of each phase, all counters and the peak memory to LogModuleGeneration.
+		 * Phases running on several threads at once can add up to more than the wall time.
+		 */
+		void LogSummary(const FString& RunName, double WallSeconds, bool bSucceeded) const;
+
+	private:
+
+		std::atomic<uint64> PhaseCycles[ETimedPhase::Num] = {};
+		std::atomic<uint32> PhaseCalls[ETimedPhase::Num] = {};
+		std::atomic<int64> Counters[ETimedCounter::Num] = {};
+		std::atomic<int64> PeakInstantiationBytes = 0;
+		std::atomic<bool> bIsRecording = false;
+	};
+
+	/** Adds the time until the end of the scope to a phase of FModuleCreationTimings */
+	class FScopedPhaseTimer : public FNoncopyable
+	{
+	public:
+
+		explicit FScopedPhaseTimer(ETimedPhase::Type InPhase)
+			: Phase(InPhase)
+			, StartCycles(FPlatformTime::Cycles64())
+		{}
+
+		~FScopedPhaseTimer()
+		{
+			FModuleCreationTimings::Get().AddPhaseTime(Phase, FPlatformTime::Cycles64() - StartCycles);
+		}
+
+	private:
+
+		ETimedPhase::Type Phase;
+		uint64 StartCycles;
+	};
+}
+
+/** Times the rest of the scope as Phase for the summary and emits a CPU scope named after it on ModuleGenerationChannel */
+#define MODULEGENERATION_TIMED_SCOPE(Phase) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("ModuleGeneration::" #Phase, ModuleGenerationChannel); \
+	const UE::ModuleGeneration::FScopedPhaseTimer PREPROCESSOR_JOIN(PhaseTimer, __LINE__)(UE::ModuleGeneration::ETimedPhase::Phase)
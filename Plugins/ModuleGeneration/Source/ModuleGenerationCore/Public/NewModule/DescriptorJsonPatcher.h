@@ -0,0 +1,23 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+
+struct FModuleDescriptor;
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Inserts NewModules into the top-level "Modules" array of the .uproject or .uplugin file contained in FileBytes.
+	 *
+	 * Unlike round-tripping the file through FJsonObject, the array is located with a lexical scan and only the new entries are
+	 * spliced in. They are formatted like the first existing entry, so the result is byte-identical to the input except for the
+	 * insertion. The array is created if the descriptor does not have one yet.
+	 * UTF-8 files (with or without BOM) are patched in place; UTF-16 files are written back as UTF-16 LE with BOM.
+	 *
+	 * Fails if the JSON is malformed, or if any of NewModules is already declared or passed twice. The error lists all such modules.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<TArray<uint8>> SpliceModulesIntoDescriptor(TConstArrayView<uint8> FileBytes, TConstArrayView<FModuleDescriptor> NewModules);
+}
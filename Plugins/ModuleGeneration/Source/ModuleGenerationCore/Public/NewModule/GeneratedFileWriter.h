@@ -0,0 +1,78 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+#include "NewModule/TemplateFileContents.h"
+#include "NewModule/TokenizedTemplateString.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace EFileWriteOutcome
+	{
+		enum Type : uint8
+		{
+			Written,
+			/** Copied from a verbatim template file; see CopyFileIfChanged */
+			Copied,
+			/** The file already had the same contents, so it was not touched */
+			Unchanged
+		};
+	}
+
+	/** Hash of file contents used to detect unchanged files. Not cryptographic. */
+	MODULEGENERATIONCORE_API uint64 HashFileContents(TConstArrayView<uint8> Contents);
+
+	/** @return Contents encoded like FFileHelper::SaveStringToFile does: one byte per character if pure ANSI, UTF-16 with BOM otherwise */
+	MODULEGENERATIONCORE_API TArray<uint8> EncodeFileContents(FStringView Contents);
+
+	/**
+	 * Writes Contents to FilePath unless the file already holds the same bytes. Rewriting identical files would update their
+	 * timestamps, which makes UnrealBuildTool recompile everything including them and the editor's directory watchers report them
+	 * as changed. Only files of the same size are read and hashed, so changed files cost no more than before.
+	 * Adds to the FilesWritten and BytesWritten or FilesUnchanged and BytesUnchanged counters of FModuleCreationTimings.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<EFileWriteOutcome::Type> WriteFileIfChanged(const FString& FilePath, TConstArrayView<uint8> Contents);
+
+	/**
+	 * Like WriteFileIfChanged for a template file which is copied as it is. Files of a template directory are copied by the platform
+	 * file, which lets the OS copy them without passing them through this process where it can, and files of a packed template
+	 * are written straight from the mapped archive. Neither is read into memory.
+	 * Adds to the FilesCopied and BytesCopied or FilesUnchanged and BytesUnchanged counters of FModuleCreationTimings.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<EFileWriteOutcome::Type> CopyFileIfChanged(const FString& FilePath, const FVerbatimFileSource& Source);
+
+	/**
+	 * Sizes and hashes of the files generated for a module, kept next to them in the module's folder so later runs can tell which
+	 * files still are as generated and which were edited since.
+	 */
+	struct MODULEGENERATIONCORE_API FGeneratedFilesManifest
+	{
+		struct FFile
+		{
+			/** Relative to the module's folder, e.g. Private/MyModule.cpp */
+			FString RelativePath;
+			int64 Size = 0;
+			uint64 Hash = 0;
+		};
+
+		/** Name of the manifest in the module's folder */
+		static const TCHAR* FileName;
+
+		/** Template the files were generated from, e.g. Default */
+		FString TemplateName;
+		/** What the template's placeholders were replaced with, so the template can be instantiated again the same way */
+		TStaticArray<FString, ETemplatePlaceholder::Num> PlaceholderValues;
+		/** Sorted by RelativePath */
+		TArray<FFile> Files;
+
+		/** @return The manifest in ModuleDirectory, unset if there is none or it cannot be parsed */
+		static TOptional<FGeneratedFilesManifest> Load(const FString& ModuleDirectory);
+		/** Writes the manifest to ModuleDirectory unless it is unchanged */
+		FOperationResult Save(const FString& ModuleDirectory) const;
+
+		/** @return The entry for RelativePath or nullptr */
+		const FFile* Find(FStringView RelativePath) const;
+	};
+}
@@ -0,0 +1,104 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+
+#include "Containers/BitArray.h"
+
+namespace UE::ModuleGeneration
+{
+	struct FIncludeGraphModule
+	{
+		FString Name;
+		/** Absolute and normalized, without trailing slash */
+		FString Directory;
+	};
+
+	struct FIncludeGraphFile
+	{
+		/** Absolute and normalized */
+		FString Path;
+		int32 ModuleIndex = INDEX_NONE;
+		/** Relative to the module's directory, e.g. Public/Foo/Bar.h */
+		FString RelativePath;
+		FDateTime Timestamp;
+		int64 Size = 0;
+		/** Hash of the file's bytes. Files whose timestamp changed but whose hash did not are not parsed again. */
+		uint64 ContentHash = 0;
+		TArray<FParsedInclude> Includes;
+		/** Indexed like Includes. INDEX_NONE for includes of files outside the graph, e.g. engine headers. */
+		TArray<int32> ResolvedIncludes;
+	};
+
+	/**
+	 * Which source files include which, for all modules below a set of source roots such as the project's Source and Plugins
+	 * folders. Includes resolve like the compiler resolves them: next to the including file, then in the including module's own
+	 * folders, then in the public folders of all other modules.
+	 *
+	 * The parsed includes are cached on disk together with each file's timestamp, size and content hash, so building the graph
+	 * again only reads the files which changed; the files are read and parsed in parallel. Nested modules own the files below
+	 * them. Folders without indexable sources, such as Content, Intermediate and ThirdParty, are not entered. Immutable once built, so
+	 * it can be shared between threads.
+	 */
+	class MODULEGENERATIONCORE_API FIncludeGraph
+	{
+	public:
+
+		struct FSettings
+		{
+			/** Absolute directories whose modules are scanned */
+			TArray<FString> SourceRoots;
+			/** Where the parsed includes are kept between runs. Nothing is cached if empty. */
+			FString CacheFilePath;
+		};
+
+		/** Scans the project's Source and Plugins folders */
+		static FSettings MakeDefaultSettings(const FString& ProjectDirectory, const FString& CacheFilePath);
+
+		/**
+		 * Scans the source roots and parses the files which changed since Previous was built or, without Previous, since the cache
+		 * was written. The cache is saved if any file had to be read.
+		 */
+		static TSharedRef<const FIncludeGraph> Build(const FSettings& Settings, const FIncludeGraph* Previous = nullptr);
+
+		TConstArrayView<FIncludeGraphModule> GetModules() const { return Modules; }
+		TConstArrayView<FIncludeGraphFile> GetFiles() const { return Files; }
+		/** @return The files which include FileIndex directly */
+		TConstArrayView<int32> GetIncludedBy(int32 FileIndex) const { return IncludedBy[FileIndex]; }
+		/** @return Index of the file at the absolute, normalized Path or INDEX_NONE */
+		int32 FindFile(const FString& Path) const;
+		/** @return Index of the module called Name or INDEX_NONE */
+		int32 FindModule(const FString& Name) const;
+		/** @return How many files Build read instead of taking their includes from the previous graph or the cache */
+		int32 NumReadFiles() const { return NumRead; }
+
+		/** @return A bit per file which is set for Headers and for every file including one of them, directly or transitively */
+		TBitArray<> FindDependents(TConstArrayView<int32> Headers) const;
+
+		/** @return Whether Path is compiled on its own rather than only included, i.e. whether it is a translation unit */
+		static bool IsTranslationUnit(FStringView Path);
+
+	private:
+
+		TArray<FIncludeGraphModule> Modules;
+		TArray<FIncludeGraphFile> Files;
+		TArray<TArray<int32>> IncludedBy;
+		TMap<FString, int32> ModuleIndexByName;
+		TMap<FString, int32> FileIndexByPath;
+		int32 NumRead = 0;
+
+		void FindFiles(TConstArrayView<FString> SourceRoots);
+		void ParseChangedFiles(const TMap<FString, const FIncludeGraphFile*>& KnownFiles);
+		void ResolveIncludes();
+		static TOptional<TArray<FIncludeGraphFile>> LoadCache(const FSettings& Settings);
+		void SaveCache(const FSettings& Settings) const;
+	};
+
+	/**
+	 * @return How files include the file at RelativePath of their own module (bPublicOnly false) or of another module (bPublicOnly
+	 * true), e.g. Foo/Bar.h for Public/Foo/Bar.h. Unset if the file is not in one of the module's include folders.
+	 */
+	MODULEGENERATIONCORE_API TOptional<FString> GetModuleIncludePath(const FString& RelativePath, bool bPublicOnly);
+}
@@ -0,0 +1,75 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	/** A module found by scanning a source tree for .Build.cs files */
+	struct FIndexedSourceModule
+	{
+		FString Name;
+		/** Absolute directory containing the .Build.cs file */
+		FString Directory;
+		/** Headers in the module's Public, Classes and Internal folders as they are included, e.g. GameFramework/Actor.h */
+		TArray<FString> PublicHeaders;
+	};
+
+	/**
+	 * Maps include paths to the modules which provide them, e.g. GameFramework/Actor.h to Engine.
+	 *
+	 * Built by scanning source trees for .Build.cs files and listing the headers in each module's public include folders, one
+	 * module per task. Engine trees do not change between runs of the same engine version so they are cached on disk; project
+	 * trees are small and scanned every time. Immutable once built, so it can be shared between threads.
+	 */
+	class MODULEGENERATIONCORE_API FIncludeModuleMap
+	{
+	public:
+
+		struct FSettings
+		{
+			/** Scanned on every build, e.g. the project's Source and Plugins folders */
+			TArray<FString> ScannedRoots;
+			/** Loaded from CacheFilePath if CacheKey matches and scanned and saved otherwise, e.g. the engine's Source and Plugins folders */
+			TArray<FString> CachedRoots;
+			FString CacheFilePath;
+			/** Identifies the contents of CachedRoots, e.g. the engine version */
+			FString CacheKey;
+		};
+
+		/** Scans the project's Source and Plugins folders and caches the engine's Source and Plugins folders; see MakeEngineSourceCacheKey. */
+		static FSettings MakeDefaultSettings(const FString& EngineDirectory, const FString& ProjectDirectory, const FString& CacheFilePath);
+
+		static TSharedRef<const FIncludeModuleMap> LoadOrBuild(const FSettings& Settings);
+
+		/** @return The module providing Include, or nullptr. If several modules provide it, project modules take precedence. */
+		const FIndexedSourceModule* FindModuleForInclude(const FString& Include) const;
+
+		TConstArrayView<FIndexedSourceModule> GetModules() const { return Modules; }
+		int32 NumHeaders() const { return ModuleIndexByInclude.Num(); }
+
+	private:
+
+		TArray<FIndexedSourceModule> Modules;
+		/** TMap<FString> hashes and compares case-insensitively, like the compilers on the platforms the editor runs on */
+		TMap<FString, int32> ModuleIndexByInclude;
+
+		static TArray<FIndexedSourceModule> ScanRoots(TConstArrayView<FString> Roots);
+		static TOptional<TArray<FIndexedSourceModule>> LoadCache(const FSettings& Settings);
+		static void SaveCache(const FSettings& Settings, TConstArrayView<FIndexedSourceModule> CachedModules);
+	};
+
+	/**
+	 * Finds the modules below Root by their .Build.cs files, without listing their headers. Folders which never contain modules,
+	 * such as Content, Intermediate and ThirdParty, are skipped, and so are the folders below a module.
+	 */
+	MODULEGENERATIONCORE_API void FindSourceModules(const FString& Root, TArray<FIndexedSourceModule>& OutModules);
+
+	/**
+	 * @return Key for data derived from the engine's Source and Plugins folders: the engine version and directory. Engines built from
+	 * source report changelist 0 and change without a version bump, so for them it also contains the newest modification time of the
+	 * headers, .Build.cs files and folders, which requires walking both trees.
+	 */
+	MODULEGENERATIONCORE_API FString MakeEngineSourceCacheKey(const FString& EngineDirectory);
+}
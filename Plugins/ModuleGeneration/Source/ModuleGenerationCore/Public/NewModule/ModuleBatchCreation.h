@@ -0,0 +1,90 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModuleDescriptor.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleBuildSettings.h"
+#include "NewModule/OperationResult.h"
+#include "NewModule/PluginDirectoryIndex.h"
+
+namespace UE::ModuleGeneration
+{
+	/** A module to create as part of a batch */
+	struct FModuleCreationRequest
+	{
+		/** Absolute directory which will contain the module's folder. Ends with a slash. */
+		FString OutputDirectory;
+		FModuleDescriptor Module;
+	};
+
+	/** Everything batch creation would otherwise get from the running editor */
+	struct FModuleBatchSettings
+	{
+		/** Directory containing the .uproject file */
+		FString ProjectDirectory;
+		/** Template directory containing the {ModuleName} folder or FModuleTemplateArchive; see FindModuleTemplates */
+		FString ModuleTemplatePath;
+		FString CopyrightNotice;
+		/** Decides which .uplugin a module is added to. If unset, see MakeProjectPluginDirectoryIndex. */
+		TSharedPtr<const FPluginDirectoryIndex> PluginIndex;
+		/** If set, the dependencies of each module are computed from its includes; see FModuleTemplateOptions::IncludeMap */
+		TSharedPtr<const FIncludeModuleMap> IncludeMap;
+		/** Substituted for {BuildSettings}; see FindModuleBuildVariant */
+		FModuleBuildSettings BuildSettings;
+	};
+
+	struct FModuleBatchResult
+	{
+		struct FModuleResult
+		{
+			double InstantiateSeconds = 0.0;
+			TOptional<FString> ErrorMessage;
+		};
+
+		/** Indexed like the requests */
+		TArray<FModuleResult> Modules;
+		/** Set if staging or committing failed for reasons not specific to one module */
+		TOptional<FString> TransactionError;
+		/** Either all modules were created or none */
+		bool bIsCommitted = false;
+		double InstantiateSeconds = 0.0;
+		double DescriptorSeconds = 0.0;
+	};
+
+	/**
+	 * Makes a request from the string representation used in manifests and on the command line.
+	 * OutputDirectory is relative to ProjectDirectory unless absolute.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FModuleCreationRequest> MakeModuleCreationRequest(const FString& ProjectDirectory, const FString& Name, const FString& Type, const FString& LoadingPhase, const FString& OutputDirectory);
+
+	/**
+	 * Reads a manifest with the following layout. Type, LoadingPhase and OutputDirectory are optional.
+	 *	{
+	 *		"Modules": [
+	 *			{ "Name": "MyModule", "Type": "Runtime", "LoadingPhase": "Default", "OutputDirectory": "Source" }
+	 *		]
+	 *	}
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<TArray<FModuleCreationRequest>> LoadModuleManifest(const FString& ManifestPath, const FString& ProjectDirectory);
+
+	/**
+	 * Indexes the plugins known to IPluginManager and, since programs do not discover project plugins, the plugins in the
+	 * project's Plugins and Mods folders.
+	 */
+	MODULEGENERATIONCORE_API FPluginDirectoryIndex MakeProjectPluginDirectoryIndex(const FString& ProjectDirectory);
+
+	/** Fails if a module is requested twice or its directory already exists. */
+	MODULEGENERATIONCORE_API FOperationResult ValidateModuleRequests(TConstArrayView<FModuleCreationRequest> Requests);
+
+	/**
+	 * Creates all modules and adds them to their .uproject or .uplugin files in a single transaction: either all modules are created
+	 * or, if any of them fails, none are. Templates are instantiated in parallel and each descriptor is written exactly once.
+	 * Does not regenerate project files. Does not access any editor state.
+	 */
+	MODULEGENERATIONCORE_API FModuleBatchResult CreateModules(const FModuleBatchSettings& Settings, TConstArrayView<FModuleCreationRequest> Requests);
+
+	/** Logs the outcome of every module and the transaction to LogModuleGeneration. */
+	MODULEGENERATIONCORE_API void LogModuleBatchResult(TConstArrayView<FModuleCreationRequest> Requests, const FModuleBatchResult& Result);
+}
@@ -0,0 +1,84 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+
+namespace UE::ModuleGeneration
+{
+	class FIncludeModuleMap;
+
+	namespace EModulePCHMode
+	{
+		enum Type : uint8
+		{
+			/** UnrealBuildTool picks the shared PCH of the largest dependency; see FindSharedPCHProvider */
+			Shared,
+			/** The module gets its own PCH made of the headers its sibling modules include most; see FindCommonSiblingIncludes */
+			Private,
+			/** Every file includes what it needs itself */
+			None
+		};
+	}
+
+	/** Compile throughput settings written to a module's .Build.cs through the {BuildSettings} placeholder */
+	struct FModuleBuildSettings
+	{
+		EModulePCHMode::Type PCHMode = EModulePCHMode::Shared;
+		/** bUseUnity; unset keeps the target's setting */
+		TOptional<bool> bUseUnity;
+		/** MinFilesUsingPrecompiledHeaderOverride; 0 keeps UnrealBuildTool's default, which skips the PCH for modules with few files */
+		int32 MinFilesUsingPrecompiledHeader = 0;
+		/** Maximum number of headers in a private PCH */
+		int32 MaxPrivatePCHHeaders = 16;
+	};
+
+	/** Named build settings which can be picked in the UI and on the command line and compared with the compile benchmark */
+	struct FModuleBuildVariant
+	{
+		const TCHAR* Name;
+		const TCHAR* Description;
+		FModuleBuildSettings Settings;
+	};
+
+	/** Name of the variant whose .Build.cs matches what modules were generated with before variants existed */
+	inline const TCHAR* DefaultModuleBuildVariantName = TEXT("Default");
+
+	/** @return All variants. The first one is DefaultModuleBuildVariantName. */
+	MODULEGENERATIONCORE_API TConstArrayView<FModuleBuildVariant> GetModuleBuildVariants();
+	/** Finds the variant called Name. Case-insensitive. */
+	MODULEGENERATIONCORE_API TOperationResult<FModuleBuildSettings> FindModuleBuildVariant(const FString& Name);
+
+	/**
+	 * @return The .Build.cs statements for Settings, one per line and indented for the constructor body, e.g.
+	 *	PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+	 */
+	MODULEGENERATIONCORE_API FString FormatBuildSettings(const FModuleBuildSettings& Settings, const FString& ModuleName);
+
+	/**
+	 * @return Whether modules created with Settings need an include map to analyze their dependencies. A private PCH includes headers
+	 * of other modules, which only dependency analysis adds as dependencies, so it needs one even if dependencies are not minimized.
+	 */
+	MODULEGENERATIONCORE_API bool RequiresIncludeMap(const FModuleBuildSettings& Settings, bool bMinimizeDependencies);
+
+	/** @return Path of a module's private PCH relative to its directory, e.g. Private/MyModulePCH.h */
+	MODULEGENERATIONCORE_API FString GetPrivatePCHPath(const FString& ModuleName);
+
+	/**
+	 * @return The engine module whose shared PCH UnrealBuildTool picks for a module with the given direct dependencies, or an empty string.
+	 * Only the engine's own shared PCHs are considered; dependencies which pull one in transitively are not.
+	 */
+	MODULEGENERATIONCORE_API FString FindSharedPCHProvider(TConstArrayView<FString> Dependencies);
+
+	/**
+	 * Finds the headers included by the most modules in OutputDirectory, i.e. the siblings of a module created there. A header counts
+	 * once per module and must be included by at least two of them, or by the only one; generated headers are skipped. Only headers
+	 * IncludeMap resolves to a module outside OutputDirectory are considered, so the PCH only contains stable engine and plugin
+	 * headers whose modules dependency analysis can add to the new module. Sorted by the number of modules including them, most first.
+	 */
+	MODULEGENERATIONCORE_API TArray<FString> FindCommonSiblingIncludes(const FString& OutputDirectory, int32 MaxHeaders, const FIncludeModuleMap& IncludeMap);
+
+	/** @return Contents of a private PCH including Includes after CoreMinimal.h */
+	MODULEGENERATIONCORE_API FString MakePrivatePCHContents(const FString& CopyrightNotice, TConstArrayView<FString> Includes);
+}
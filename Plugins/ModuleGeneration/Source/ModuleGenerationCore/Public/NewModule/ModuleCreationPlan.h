@@ -0,0 +1,107 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+#include "NewModule/TemplateFileContents.h"
+#include "NewModule/TokenizedTemplateString.h"
+
+namespace UE::ModuleGeneration
+{
+	struct FPlannedFile
+	{
+		/** Relative to the module's output directory, e.g. MyModule/Private/MyModule.cpp */
+		FString RelativePath;
+		/** Final bytes with all placeholders replaced, encoded like the template file; empty if Verbatim is set */
+		TArray<uint8> Contents;
+		/** Set for template files which are copied as they are instead of being held in memory */
+		TOptional<FVerbatimFileSource> Verbatim;
+
+		int64 GetSize() const { return Verbatim ? Verbatim->Size : Contents.Num(); }
+	};
+
+	/** The files of one module, computed in memory from its template */
+	struct FPlannedModule
+	{
+		/** Directory which will contain the module's folder */
+		FString OutputDirectory;
+		FName ModuleName;
+		/** Relative to OutputDirectory. Sorted so parents come before their children. */
+		TArray<FString> RelativeDirectories;
+		/** Sorted by template path */
+		TArray<FPlannedFile> Files;
+		/** Set if the dependencies were computed from the module's includes; see FModuleTemplateOptions::IncludeMap */
+		TOptional<FModuleDependencies> Dependencies;
+		/** Module whose shared PCH UnrealBuildTool is expected to use; empty if the module has its own PCH or none */
+		FString SharedPCHProvider;
+		/** Name of the template, e.g. Default, and what its placeholders were replaced with; kept in the module's FGeneratedFilesManifest */
+		FString TemplateName;
+		TStaticArray<FString, ETemplatePlaceholder::Num> PlaceholderValues;
+	};
+
+	/** The new contents of a .uproject or .uplugin file */
+	struct FPlannedDescriptorUpdate
+	{
+		FString DescriptorPath;
+		TArray<uint8> OriginalContents;
+		TArray<uint8> NewContents;
+		/** Timestamp of DescriptorPath when OriginalContents was read; committing fails if the file has changed since */
+		FDateTime OriginalTimestamp;
+	};
+
+	/** An existing source, .Build.cs or config file which is rewritten or removed when files are moved into a new module */
+	struct FPlannedSourceUpdate
+	{
+		FString Path;
+		TArray<uint8> OriginalContents;
+		/** Unset if the file is removed because it moved into the new module */
+		TOptional<TArray<uint8>> NewContents;
+		/** Timestamp of Path when OriginalContents was read; committing fails if the file has changed since */
+		FDateTime OriginalTimestamp;
+	};
+
+	/** What moving files out of an existing module changes; see PlanModuleExtraction */
+	struct FModuleExtractionReport
+	{
+		/** Module the files are moved out of */
+		FString SourceModuleName;
+		int32 NumMovedFiles = 0;
+		/** .cpp files which stay in the source module */
+		int32 NumRemainingTranslationUnits = 0;
+		/** Remaining .cpp files which include none of the moved headers, directly or through other headers, so changing the moved files no longer recompiles them */
+		int32 NumIndependentTranslationUnits = 0;
+		/** Modules whose .Build.cs gets the new module as dependency. Sorted. */
+		TArray<FString> DependentModules;
+		/** Headers of the source module which moved files still include. The new module then depends on the source module, which depends on it in turn if it includes moved headers. Sorted. */
+		TArray<FString> IncludesOfSourceModule;
+		/** Reflected types which get a CoreRedirect because their script package changes. Sorted. */
+		TArray<FString> RedirectedTypes;
+	};
+
+	/**
+	 * Everything creating modules would write to disk, computed in memory without writing anything.
+	 *
+	 * The editor shows a plan to the user before creating the module and then commits exactly that plan, so what is written is
+	 * byte-for-byte what was previewed. Plans are also cheap to compute repeatedly because nothing touches the disk once the
+	 * template is cached.
+	 */
+	struct MODULEGENERATIONCORE_API FModuleCreationPlan
+	{
+		TArray<FPlannedModule> Modules;
+		TArray<FPlannedDescriptorUpdate> DescriptorUpdates;
+		/** Files outside the new modules which change because files are moved into one of them */
+		TArray<FPlannedSourceUpdate> SourceUpdates;
+		/** Set if files are moved into the new module */
+		TOptional<FModuleExtractionReport> Extraction;
+
+		/** @return Number of files the plan writes or removes, including descriptors */
+		int32 GetNumFiles() const;
+
+		/**
+		 * Lists every directory and file that would be created with its size and the analyzed dependencies and PCH of each module,
+		 * followed by a line diff of each descriptor and the files changed by moving files into the module.
+		 */
+		FString Describe() const;
+	};
+}
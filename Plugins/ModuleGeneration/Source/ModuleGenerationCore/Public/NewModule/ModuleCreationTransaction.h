@@ -0,0 +1,107 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/ModuleCreationPlan.h"
+#include "NewModule/OperationResult.h"
+
+struct FModuleDescriptor;
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Stages new module directories and descriptor changes next to their final location and commits them with renames.
+	 *
+	 * Module files are written into a hidden staging directory next to the final module directory and descriptor changes
+	 * are written to a copy next to the .uproject/.uplugin file. Commit moves the module directories into place and then
+	 * atomically replaces the descriptors. If anything fails, or the transaction is destroyed without being committed,
+	 * all staged and already committed changes are rolled back.
+	 */
+	class MODULEGENERATIONCORE_API FModuleCreationTransaction : public FNoncopyable
+	{
+	public:
+
+		FModuleCreationTransaction();
+		~FModuleCreationTransaction();
+
+		/**
+		 * Creates the staging directory for a module which will end up in OutputDirectory/ModuleName.
+		 * @return The directory to instantiate the module template into in place of OutputDirectory
+		 */
+		TOperationResult<FString> StageModule(const FString& OutputDirectory, FName ModuleName);
+
+		/**
+		 * Writes a copy of the descriptor at DescriptorPath which contains NewModules.
+		 */
+		FOperationResult StageDescriptorUpdate(const FString& DescriptorPath, TConstArrayView<FModuleDescriptor> NewModules);
+
+		/**
+		 * Writes the planned module files to a new staging directory as they are.
+		 */
+		FOperationResult StagePlannedModule(const FPlannedModule& Module);
+
+		/**
+		 * Writes the planned descriptor contents to a copy of the descriptor as they are.
+		 * Fails if the descriptor was modified after the plan was made.
+		 */
+		FOperationResult StagePlannedDescriptorUpdate(const FPlannedDescriptorUpdate& Update);
+
+		/**
+		 * Writes the planned contents of an existing file to a copy next to it, or marks it for removal if it has no new contents.
+		 * Fails if the file was modified after the plan was made.
+		 */
+		FOperationResult StagePlannedSourceUpdate(const FPlannedSourceUpdate& Update);
+
+		/**
+		 * Stages all modules, descriptor updates and source updates of the plan. Commit then writes exactly what the plan contains.
+		 */
+		FOperationResult StagePlan(const FModuleCreationPlan& Plan);
+
+		/**
+		 * Moves all staged modules to their final location, replaces or removes the updated sources and replaces the descriptors.
+		 * Rolls back on failure.
+		 */
+		FOperationResult Commit();
+
+		/**
+		 * Reverts everything done by this transaction. Called automatically if the transaction is destroyed without a successful commit.
+		 */
+		void Rollback();
+
+	private:
+
+		struct FStagedModule
+		{
+			FString StagingDirectory;
+			FString StagedModuleDirectory;
+			FString FinalModuleDirectory;
+			bool bIsCommitted = false;
+		};
+
+		struct FStagedDescriptor
+		{
+			FString DescriptorPath;
+			FString StagedDescriptorPath;
+			/** Contents before the transaction; used for restoring the descriptor when rolling back after it was replaced */
+			TArray<uint8> OriginalContents;
+			bool bIsCommitted = false;
+		};
+
+		struct FStagedSourceFile
+		{
+			FString Path;
+			/** Empty if the file is removed */
+			FString StagedPath;
+			/** Contents before the transaction; used for restoring the file when rolling back after it was replaced or removed */
+			TArray<uint8> OriginalContents;
+			bool bIsCommitted = false;
+		};
+
+		FGuid TransactionId;
+		TArray<FStagedModule> StagedModules;
+		TArray<FStagedDescriptor> StagedDescriptors;
+		TArray<FStagedSourceFile> StagedSourceFiles;
+		bool bIsFinished = false;
+	};
+}
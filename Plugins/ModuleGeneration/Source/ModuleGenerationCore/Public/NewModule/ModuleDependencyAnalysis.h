@@ -0,0 +1,61 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	class FIncludeModuleMap;
+
+	struct FParsedInclude
+	{
+		/** Text between the quotes or angle brackets, e.g. GameFramework/Actor.h */
+		FString Path;
+		/** Whether the include used quotes instead of angle brackets */
+		bool bIsQuoted = true;
+	};
+
+	struct FSourceFileToAnalyze
+	{
+		/** Relative to the module's directory, e.g. Private/MyModule.cpp, for files of the module; otherwise absolute */
+		FString Path;
+		FString Contents;
+		/** Whether other modules can include the file, i.e. whether its dependencies must be public */
+		bool bIsPublic = false;
+	};
+
+	struct FModuleDependencies
+	{
+		/** Modules included by public files. Sorted. */
+		TArray<FString> PublicDependencies;
+		/** Modules only included by private files. Sorted. */
+		TArray<FString> PrivateDependencies;
+		/** Quoted includes which neither the module itself nor FIncludeModuleMap provide. Angle bracket includes are assumed to be system headers. */
+		TArray<FString> UnresolvedIncludes;
+	};
+
+	/** @return The #include directives of Contents, ignoring those in comments. Conditional compilation is not evaluated. */
+	MODULEGENERATIONCORE_API TArray<FParsedInclude> ParseIncludes(FStringView Contents);
+
+	/**
+	 * Replaces the path of every #include directive for which NewPathForInclude returns a value and keeps everything else as it is.
+	 * Directives are numbered like the result of ParseIncludes for the same contents.
+	 * @return Whether any path was replaced
+	 */
+	MODULEGENERATIONCORE_API bool RewriteIncludes(FString& Contents, TFunctionRef<TOptional<FString>(int32 IncludeIndex, const FParsedInclude& Include)> NewPathForInclude);
+
+	/** @return Whether a file at RelativePath, relative to its module's directory, is in a folder other modules can include from */
+	MODULEGENERATIONCORE_API bool IsPublicSourcePath(FStringView RelativePath);
+
+	/**
+	 * Finds the modules that Files of module ModuleName include. A module is a public dependency if any public file includes it
+	 * and a private dependency otherwise, which is the smallest set of dependencies that compiles: dependencies that are only
+	 * needed privately do not leak into the modules depending on ModuleName.
+	 * Includes resolve to ModuleName itself first, then to the modules in IncludeMap. *.generated.h files need CoreUObject.
+	 */
+	MODULEGENERATIONCORE_API FModuleDependencies AnalyzeModuleDependencies(const FIncludeModuleMap& IncludeMap, const FString& ModuleName, TConstArrayView<FSourceFileToAnalyze> Files);
+
+	/** @return Modules as they appear in a .Build.cs file, e.g. "Core", "CoreUObject" */
+	MODULEGENERATIONCORE_API FString FormatDependencyList(TConstArrayView<FString> Modules);
+}
@@ -0,0 +1,48 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/ModuleCreationPlan.h"
+#include "NewModule/OperationResult.h"
+
+struct FModuleDescriptor;
+
+namespace UE::ModuleGeneration
+{
+	class FPluginDirectoryIndex;
+	
+	MODULEGENERATIONCORE_API FOperationResult AddNewModuleToFile(const FString& FullFilePath, const FModuleDescriptor& NewModule);
+	/**
+	 * Adds several modules to a .uproject or .uplugin file with a single read and a single write.
+	 * All modules are validated before anything is written; the error lists every module which is already declared or passed more than once.
+	 */
+	MODULEGENERATIONCORE_API FOperationResult AddNewModulesToFile(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules);
+	/**
+	 * Reads the .uproject or .uplugin file at FullFilePath, adds the modules and writes the result to OutputFilePath.
+	 */
+	MODULEGENERATIONCORE_API FOperationResult AddNewModulesToFile(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules, const FString& OutputFilePath);
+
+	/**
+	 * Reads the .uproject or .uplugin file at FullFilePath and computes its contents after adding the modules without writing anything.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FPlannedDescriptorUpdate> PlanDescriptorUpdate(const FString& FullFilePath, TConstArrayView<FModuleDescriptor> NewModules);
+	/**
+	 * Computes the contents of the descriptor after adding the modules from OriginalContents, which is not read from disk.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FPlannedDescriptorUpdate> PlanDescriptorUpdate(const FString& FullFilePath, TArray<uint8> OriginalContents, TConstArrayView<FModuleDescriptor> NewModules);
+
+	/**
+	 * Finds the .uproject file in ProjectDirectory.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FString> FindUProjectFile(const FString& ProjectDirectory);
+	/**
+	 * Finds the .uplugin file of the plugin which OutputDirectory belongs to. Does not access the disk.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FString> FindUPluginFile(const FPluginDirectoryIndex& PluginIndex, const FString& OutputDirectory);
+	/**
+	 * Finds the descriptor a module created in OutputDirectory is added to: the .uplugin file of the plugin containing
+	 * OutputDirectory or, if it is not part of any plugin, the project's .uproject file.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FString> FindModuleDescriptorFile(const FString& ProjectDirectory, const FPluginDirectoryIndex& PluginIndex, const FString& OutputDirectory);
+}
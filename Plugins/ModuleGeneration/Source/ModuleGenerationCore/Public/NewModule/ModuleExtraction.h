@@ -0,0 +1,82 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/IncludeGraph.h"
+#include "NewModule/ModuleCreationPlan.h"
+#include "NewModule/OperationResult.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Files to move out of an existing module */
+	struct FModuleExtractionSource
+	{
+		FString ModuleName;
+		/** Directory containing the module's .Build.cs file */
+		FString ModuleDirectory;
+		/** Absolute paths of the files to move. All must be sources of the module. */
+		TArray<FString> Files;
+	};
+
+	struct FModuleExtractionSettings
+	{
+		FModuleExtractionSource Source;
+		FString NewModuleName;
+		/** Directory which will contain the new module's folder */
+		FString OutputDirectory;
+		/** Directories whose modules are scanned for includes of the moved files, e.g. the project's Source and Plugins folders */
+		TArray<FString> SourceRoots;
+		/** Graph of the modules below SourceRoots, e.g. a cached one. Built without a cache if null. */
+		TSharedPtr<const FIncludeGraph> IncludeGraph;
+		/** Existing config file which gets CoreRedirects for moved reflected types, e.g. the project's Config/DefaultEngine.ini. Skipped if empty. */
+		FString RedirectsConfigPath;
+	};
+
+	struct FModuleExtraction
+	{
+		/** The moved files with updated includes and export macros; see FModuleTemplateOptions::AdditionalFiles */
+		TArray<FPlannedFile> NewModuleFiles;
+		/** Removes the moved files and updates the includes, .Build.cs files and redirects of everything else. Sorted by path. */
+		TArray<FPlannedSourceUpdate> SourceUpdates;
+		FModuleExtractionReport Report;
+	};
+
+	/**
+	 * Plans moving Source.Files into a new module without writing anything.
+	 *
+	 * Headers which are public in the source module or included by any file staying behind go to the new module's Public folder,
+	 * everything else to its Private folder. The folders the moved files have in common are dropped, e.g. Public/Inventory/Item.h
+	 * and Private/Inventory/Item.cpp become Public/Item.h and Private/Item.cpp. The source module's export macro is replaced with
+	 * the new module's.
+	 *
+	 * Every include which the include graph resolves to a moved file is rewritten to the file's new path and every module including
+	 * a moved file gets the new module as dependency in its .Build.cs, which is public if a public file includes it. Only the
+	 * files which change are read; they must not have changed since the graph was built.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FModuleExtraction> PlanModuleExtraction(const FModuleExtractionSettings& Settings);
+
+	/** Translation units which recompile when headers change, before and after moving files into a new module */
+	struct FBuildImpactEstimate
+	{
+		/** All translation units of the include graph */
+		int32 NumTranslationUnits = 0;
+		/** Translation units including a moved header, i.e. recompiled whenever a header of the new module changes. Files added by the template are not counted. */
+		int32 NumNewModuleDependents = 0;
+		/** Translation units including any header of the source module, i.e. its rebuild fan-out, before the files are moved */
+		int32 NumSourceModuleDependentsBefore = 0;
+		/** The source module's rebuild fan-out once the moved headers belong to the new module */
+		int32 NumSourceModuleDependentsAfter = 0;
+		/** Translation units staying in the source module */
+		int32 NumSourceModuleTranslationUnits = 0;
+		/** Translation units staying in the source module which still include a moved header */
+		int32 NumSourceModuleDependentsOfMovedHeaders = 0;
+	};
+
+	/**
+	 * Estimates how moving FilesToMove changes what recompiles by walking Graph backwards from the moved headers and from the
+	 * headers staying in the source module. A move rewrites includes but does not remove them, so the graph stays the same and only
+	 * the module boundary changes. If no files are moved, only NumTranslationUnits is set.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FBuildImpactEstimate> EstimateBuildImpact(const FIncludeGraph& Graph, const FModuleExtractionSource& FilesToMove);
+}
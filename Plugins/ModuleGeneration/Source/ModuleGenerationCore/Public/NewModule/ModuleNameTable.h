@@ -0,0 +1,101 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+
+namespace UE::ModuleGeneration
+{
+	namespace EModuleLocation
+	{
+		enum Type : uint8
+		{
+			/** Engine/Source */
+			Engine,
+			/** Engine/Plugins */
+			EnginePlugin,
+			/** The project's Source folder */
+			Project,
+			/** The project's Plugins folder */
+			ProjectPlugin
+		};
+	}
+
+	struct FModuleNameEntry
+	{
+		/** Module names are C# and C++ identifiers, so they are ASCII */
+		FString Name;
+		EModuleLocation::Type Location = EModuleLocation::Engine;
+	};
+
+	/**
+	 * Immutable index of module names for collision checks and search as you type, sized for every module of the engine and the
+	 * project, i.e. several thousand names.
+	 *
+	 * The names are stored once in a single string table sorted case-insensitively. A trie over the lower-case names answers
+	 * lookups in time proportional to the length of the name, and an index of the trigrams in each name narrows searches down to
+	 * the names containing the query before they are ranked. The table is saved to and loaded from a single binary file without
+	 * rebuilding either index.
+	 */
+	class MODULEGENERATIONCORE_API FModuleNameTable
+	{
+	public:
+
+		struct FSearchResult
+		{
+			int32 Index = INDEX_NONE;
+			/** Lower is better: exact matches, then prefixes, then matches at a word start, then substrings, then subsequences */
+			int32 Score = 0;
+		};
+
+		/** Names which are empty, not ASCII or appear twice with the same location are skipped */
+		static TSharedRef<const FModuleNameTable> Build(TConstArrayView<FModuleNameEntry> Entries);
+		/** Loads a table saved with the same Key, e.g. the engine version the names were scanned from */
+		static TOperationResult<TSharedRef<const FModuleNameTable>> Load(const FString& FilePath, const FString& Key);
+		FOperationResult Save(const FString& FilePath, const FString& Key) const;
+
+		int32 Num() const { return Entries.Num(); }
+		/** Entries are sorted by name, case-insensitively */
+		FAnsiStringView GetName(int32 Index) const;
+		EModuleLocation::Type GetLocation(int32 Index) const { return static_cast<EModuleLocation::Type>(Entries[Index].Location); }
+
+		/** @return Index of the first module called Name, ignoring case, or INDEX_NONE */
+		int32 Find(FStringView Name) const;
+		/** @return At most MaxResults modules matching Query, ignoring case, best first. Empty for an empty query. */
+		TArray<FSearchResult> Search(FStringView Query, int32 MaxResults) const;
+
+	private:
+
+		struct FEntry
+		{
+			uint32 NameOffset = 0;
+			uint16 NameLength = 0;
+			uint8 Location = 0;
+			uint8 Padding = 0;
+		};
+
+		/** First-child, next-sibling encoding; node 0 is the root */
+		struct FTrieNode
+		{
+			uint32 FirstChild = 0;
+			uint32 NextSibling = 0;
+			/** First entry whose name ends at this node, or INDEX_NONE */
+			int32 Entry = INDEX_NONE;
+			/** Lower-case */
+			ANSICHAR Char = 0;
+			uint8 Padding[3] = {};
+		};
+
+		TArray<FEntry> Entries;
+		TArray<ANSICHAR> Names;
+		TArray<FTrieNode> TrieNodes;
+		/** Sorted trigram keys; the entries containing TrigramKeys[i] are Postings[PostingOffsets[i]] to Postings[PostingOffsets[i + 1]] */
+		TArray<uint32> TrigramKeys;
+		TArray<uint32> PostingOffsets;
+		TArray<int32> Postings;
+
+		int32 FindTrieNode(FStringView Name) const;
+		TConstArrayView<int32> FindPostings(uint32 TrigramKey) const;
+	};
+}
@@ -0,0 +1,72 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * A module template packed into a single file, so using it costs one open instead of walking the template's directory tree.
+	 *
+	 * The file starts with a header and a table with the path of every directory and file, followed by the UTF-8 text of all paths
+	 * and the bytes of all files exactly as they are in the template directory, whatever their encoding. Each entry records whether
+	 * its path and contents contain placeholders or escape sequences; verbatim paths are not tokenized when the template is loaded
+	 * and verbatim contents, which include binary files, are not even read until they are written into a module. The file is
+	 * memory-mapped where the platform supports it so only the parts which are accessed are read.
+	 */
+	class MODULEGENERATIONCORE_API FModuleTemplateArchive : public FNoncopyable
+	{
+	public:
+
+		/** File extension of packed templates, without the dot */
+		static const TCHAR* Extension;
+
+		struct FEntry
+		{
+			/** Relative to the template directory, e.g. {ModuleName}/Private/{ModuleName}.cpp */
+			FUtf8StringView Path;
+			/** The file's bytes; empty for directories */
+			TConstArrayView<uint8> Contents;
+			/** HashFileContents of Contents, computed when packing */
+			uint64 ContentsHash = 0;
+			bool bIsPathVerbatim = false;
+			bool bAreContentsVerbatim = false;
+		};
+
+		/** Packs the template in ModuleTemplateDirectory, which contains the {ModuleName} folder, into a file at ArchivePath. */
+		static FOperationResult Pack(const FString& ModuleTemplateDirectory, const FString& ArchivePath);
+		/** Opens and validates the archive at ArchivePath. File contents are not read until they are accessed. */
+		static TOperationResult<TUniquePtr<FModuleTemplateArchive>> Open(const FString& ArchivePath);
+
+		~FModuleTemplateArchive();
+
+		int32 NumDirectories() const { return DirectoryCount; }
+		int32 NumFiles() const { return FileCount; }
+		/** Directories are sorted so parents come before their children */
+		FEntry GetDirectory(int32 Index) const;
+		/** Files are sorted by path */
+		FEntry GetFile(int32 Index) const;
+
+	private:
+
+		FModuleTemplateArchive() = default;
+
+		/** Declared before MappedRegion so the region is unmapped before the file is closed */
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+		/** Used instead of the mapping if the platform file cannot map the archive */
+		TArray<uint8> LoadedBytes;
+		TConstArrayView<uint8> Bytes;
+
+		int32 DirectoryCount = 0;
+		int32 FileCount = 0;
+		uint32 StringsOffset = 0;
+
+		FEntry GetEntry(int32 EntryIndex) const;
+	};
+}
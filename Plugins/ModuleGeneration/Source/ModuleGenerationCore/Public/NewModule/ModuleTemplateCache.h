@@ -0,0 +1,79 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+#include "NewModule/TemplateFileContents.h"
+#include "NewModule/TokenizedTemplateString.h"
+
+namespace UE::ModuleGeneration
+{
+	struct FModuleTemplateFile
+	{
+		/** Path relative to the template directory, e.g. {ModuleName}/Private/{ModuleName}.cpp */
+		FTokenizedTemplateString RelativePath;
+		/** Empty if Verbatim is set */
+		FTemplateFileContents Contents;
+		/** Set for binary files and files without placeholders, which are copied instead of being instantiated */
+		TOptional<FVerbatimFileSource> Verbatim;
+	};
+
+	/**
+	 * All directories and files of a module template, ready to be instantiated without reading the template again. Only files
+	 * with placeholders are held in memory; verbatim files are copied from the template when a module is written.
+	 */
+	struct MODULEGENERATIONCORE_API FModuleTemplate
+	{
+		/** Paths relative to the template directory. Sorted so parents come before their children. */
+		TArray<FTokenizedTemplateString> Directories;
+		/** Sorted by template path */
+		TArray<FModuleTemplateFile> Files;
+
+		SIZE_T GetAllocatedSize() const;
+	};
+
+	/**
+	 * Lists the directories and files of the template in ModuleTemplateDirectory relative to it, starting with the {ModuleName} folder.
+	 * Both lists are sorted so parents come before their children.
+	 */
+	MODULEGENERATIONCORE_API FOperationResult EnumerateModuleTemplateDirectory(const FString& ModuleTemplateDirectory, TArray<FString>& OutRelativeDirectories, TArray<FString>& OutRelativeFiles);
+
+	/**
+	 * Keeps tokenized module templates in memory so instantiating a template does not read from disk.
+	 * Templates are loaded lazily and kept until Invalidate is called; the editor does so whenever the template directory changes
+	 * on disk. Thread-safe.
+	 */
+	class MODULEGENERATIONCORE_API FModuleTemplateCache
+	{
+	public:
+
+		struct FStats
+		{
+			uint64 NumHits = 0;
+			uint64 NumMisses = 0;
+			int32 NumTemplates = 0;
+			SIZE_T BytesHeld = 0;
+		};
+
+		static FModuleTemplateCache& Get();
+
+		/**
+		 * Gets the template at ModuleTemplatePath, which is either a directory containing the {ModuleName} folder or a packed
+		 * FModuleTemplateArchive. Loads it from disk if it is not cached.
+		 */
+		TOperationResult<TSharedRef<const FModuleTemplate>> FindOrLoad(const FString& ModuleTemplatePath);
+
+		/** Drops all cached templates. */
+		void Invalidate();
+
+		FStats GetStats() const;
+
+	private:
+
+		mutable FCriticalSection Lock;
+		TMap<FString, TSharedRef<const FModuleTemplate>> Templates;
+		uint64 NumHits = 0;
+		uint64 NumMisses = 0;
+	};
+}
@@ -0,0 +1,60 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/ModuleBuildSettings.h"
+#include "NewModule/ModuleCreationPlan.h"
+#include "NewModule/OperationResult.h"
+
+struct FModuleDescriptor;
+
+namespace UE::ModuleGeneration
+{
+	class FIncludeModuleMap;
+
+	/** Public dependencies of templates using {PublicDependencies} when the dependencies are not analyzed */
+	MODULEGENERATIONCORE_API const TArray<FString>& GetDefaultPublicDependencies();
+
+	struct FModuleTemplateOptions
+	{
+		FString CopyrightNotice;
+		/**
+		 * If set, {PublicDependencies} and {PrivateDependencies} are the modules the instantiated sources and AdditionalPublicHeaders
+		 * include; see AnalyzeModuleDependencies. Otherwise they are GetDefaultPublicDependencies() and nothing.
+		 */
+		TSharedPtr<const FIncludeModuleMap> IncludeMap;
+		/** Absolute paths of headers which are analyzed as public files of the new module, e.g. headers about to be moved into it */
+		TArray<FString> AdditionalPublicHeaders;
+		/** Modules chosen by the user, e.g. in the dependency picker, added to {PrivateDependencies} unless they already are a dependency */
+		TArray<FString> AdditionalPrivateDependencies;
+		/** Files added next to the template's, e.g. by PlanModuleExtraction. Paths start with the module's folder like FPlannedFile's. Must not collide with template files. */
+		TArray<FPlannedFile> AdditionalFiles;
+		/**
+		 * Substituted for {BuildSettings}. A private PCH is added to the module's Private folder; see FindCommonSiblingIncludes. It only
+		 * includes more than CoreMinimal.h if IncludeMap is set, because dependency analysis adds the modules providing its headers.
+		 */
+		FModuleBuildSettings BuildSettings;
+		/** Directory whose modules the private PCH is made for; the output directory if empty, which is wrong when writing to a staging directory */
+		FString SiblingModulesDirectory;
+	};
+
+	/**
+	 * Copies the template modules files from ModuleTemplatePath, a template directory or FModuleTemplateArchive, to a specific location.
+	 * Does not access any editor state so it is safe to call from worker threads and outside the editor.
+	 */
+	MODULEGENERATIONCORE_API FOperationResult InstantiateModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FModuleTemplateOptions& Options);
+	MODULEGENERATIONCORE_API FOperationResult InstantiateModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FString& CopyrightNotice);
+
+	/**
+	 * Computes the directories and file contents InstantiateModuleTemplate would write to OutputDirectory without writing anything.
+	 * Only reads from disk if the template is not cached yet, Options has AdditionalPublicHeaders or the module gets a private PCH.
+	 */
+	MODULEGENERATIONCORE_API TOperationResult<FPlannedModule> PlanModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FModuleTemplateOptions& Options);
+	MODULEGENERATIONCORE_API TOperationResult<FPlannedModule> PlanModuleTemplate(const FString& ModuleTemplatePath, const FString& OutputDirectory, const FModuleDescriptor& NewModule, const FString& CopyrightNotice);
+	/**
+	 * Writes the planned directories and files to TargetDirectory, which is used in place of the plan's OutputDirectory so
+	 * FModuleCreationTransaction can write to its staging directory.
+	 */
+	MODULEGENERATIONCORE_API FOperationResult WritePlannedModule(const FPlannedModule& Module, const FString& TargetDirectory);
+}
@@ -0,0 +1,31 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/OperationResult.h"
+
+namespace UE::ModuleGeneration
+{
+	/** Name of the template used when none is chosen */
+	inline const TCHAR* DefaultModuleTemplateName = TEXT("Default");
+
+	struct FModuleTemplateInfo
+	{
+		/** Directory or archive name without extension, e.g. Default */
+		FString Name;
+		/** Directory containing the {ModuleName} folder or FModuleTemplateArchive file; can be passed to InstantiateModuleTemplate */
+		FString Path;
+		bool bIsPacked = false;
+	};
+
+	/**
+	 * Lists the templates in TemplatesDirectory, i.e. every subdirectory containing a {ModuleName} folder and every packed
+	 * FModuleTemplateArchive. Only TemplatesDirectory itself is listed; the template trees are not walked.
+	 * A packed template takes precedence over a directory of the same name. Sorted by name.
+	 */
+	MODULEGENERATIONCORE_API TArray<FModuleTemplateInfo> FindModuleTemplates(const FString& TemplatesDirectory);
+
+	/** Finds the template called Name in TemplatesDirectory. Case-insensitive. */
+	MODULEGENERATIONCORE_API TOperationResult<FModuleTemplateInfo> FindModuleTemplate(const FString& TemplatesDirectory, const FString& Name);
+}
@@ -0,0 +1,96 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	/** How a file of an existing module compares to what its template generates now */
+	namespace EGeneratedFileState
+	{
+		enum Type : uint8
+		{
+			/** Same bytes as the template generates */
+			UpToDate,
+			/** Unchanged since it was generated but the template generates something else now; re-applied */
+			Outdated,
+			/** Generated by the template now but not when the module was created; re-applied */
+			Added,
+			/** Differs from the template and from what was generated, i.e. edited by the user or never generated; left alone */
+			Edited,
+			/** Does not exist although it was generated, or the module has no manifest; left alone */
+			Missing,
+
+			Num
+		};
+
+		MODULEGENERATIONCORE_API const TCHAR* ToString(Type State);
+	}
+
+	/** Which modules are compared with which template */
+	struct FModuleSyncSettings
+	{
+		/** Modules in the project's Source and Plugins folders are synced */
+		FString ProjectDirectory;
+		/** Directory containing the templates; see FindModuleTemplates */
+		FString TemplatesDirectory;
+		/**
+		 * Modules without FGeneratedFilesManifest are skipped unless set, in which case they are compared with this template using
+		 * CopyrightNotice and the default dependencies and build settings. Their files can only be UpToDate, Edited or Missing, and
+		 * applying only writes a manifest listing the files which are UpToDate.
+		 */
+		TOptional<FString> UntrackedModulesTemplateName;
+		FString CopyrightNotice;
+		/** Write Outdated and Added files and update the manifests. Otherwise the modules are only compared. */
+		bool bApply = false;
+	};
+
+	struct FModuleSyncResult
+	{
+		struct FFile
+		{
+			/** Relative to the module's directory, e.g. Private/MyModule.cpp */
+			FString RelativePath;
+			EGeneratedFileState::Type State = EGeneratedFileState::UpToDate;
+		};
+
+		FString ModuleName;
+		/** Absolute directory containing the .Build.cs file */
+		FString ModuleDirectory;
+		FString TemplateName;
+		/** Whether the module had a FGeneratedFilesManifest before it was synced */
+		bool bIsTracked = false;
+		/** Every file the template generates. Sorted by path. */
+		TArray<FFile> Files;
+		TStaticArray<int32, EGeneratedFileState::Num> NumFilesByState{ InPlace, 0 };
+		int32 NumFilesWritten = 0;
+		/** Set if the module could not be compared or applying failed half-way */
+		TOptional<FString> ErrorMessage;
+
+		/** @return Whether any file is not UpToDate */
+		bool HasDrifted() const { return NumFilesByState[EGeneratedFileState::UpToDate] != Files.Num(); }
+	};
+
+	struct FModuleSyncReport
+	{
+		/** Sorted by name */
+		TArray<FModuleSyncResult> Modules;
+		/** Modules skipped because they have no manifest; see FModuleSyncSettings::UntrackedModulesTemplateName */
+		int32 NumUntrackedModules = 0;
+		double Seconds = 0.0;
+	};
+
+	/**
+	 * Instantiates the template of every module in the project again, with the placeholder values recorded in the module's
+	 * FGeneratedFilesManifest, and compares the result with the files on disk. Files which the user has not touched since they
+	 * were generated are brought up to date if Settings.bApply is set; edited files are never overwritten.
+	 *
+	 * Modules are compared in parallel, one task per module. Files are hashed, and only read at all if their size matches the
+	 * template's output or the manifest, so comparing hundreds of modules takes about as long as listing their directories.
+	 */
+	MODULEGENERATIONCORE_API FModuleSyncReport SyncModulesWithTemplate(const FModuleSyncSettings& Settings);
+
+	/** Logs the drifted modules with their files, and a summary, to LogModuleGeneration. */
+	MODULEGENERATIONCORE_API void LogModuleSyncReport(const FModuleSyncReport& Report, bool bApplied);
+}
@@ -38,7 +38,7 @@ namespace UE::ModuleGeneration
 
 		static TOperationResult<T> MakeFailure(FString Failure)
 		{
-			return TOperationResult(Failure);
+			return TOperationResult(FFailureTag(), MoveTemp(Failure));
 		}
 
 		template<typename Other>
@@ -49,10 +49,13 @@ namespace UE::ModuleGeneration
 		}
 
 	private:
+		/** Distinguishes the failure constructor from the success constructor when T is FString */
+		struct FFailureTag {};
+		
 		TOperationResult(T Result)
 			: OperationResult(MoveTemp(Result))
 		{}
-		TOperationResult(FString ErrorMessage = {})
+		TOperationResult(FFailureTag, FString ErrorMessage)
 			: FBaseOperationResult(MoveTemp(ErrorMessage))
 		{}
 	};
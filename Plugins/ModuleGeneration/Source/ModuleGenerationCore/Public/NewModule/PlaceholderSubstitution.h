@@ -0,0 +1,67 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Perfect hash table of placeholder names, e.g. ModuleName for {ModuleName}.
+	 * Names must be ASCII. Lookups are case-insensitive, like the keys of FStringFormatNamedArguments.
+	 */
+	class MODULEGENERATIONCORE_API FPlaceholderNameTable
+	{
+	public:
+
+		explicit FPlaceholderNameTable(TConstArrayView<const TCHAR*> Names);
+
+		/** @return Index of Name in the names passed to the constructor or INDEX_NONE */
+		int32 Find(FStringView Name) const;
+		int32 Find(FUtf8StringView Name) const;
+
+		int32 Num() const { return LowerCaseNames.Num(); }
+
+	private:
+
+		TArray<FString> LowerCaseNames;
+		/** Maps hash slots to indices into LowerCaseNames; INDEX_NONE for empty slots */
+		TArray<int32> Slots;
+		uint32 Seed = 0;
+		uint32 SlotMask = 0;
+
+		template<typename CharType>
+		int32 FindImpl(TStringView<CharType> Name) const;
+		template<typename CharType>
+		static uint32 Hash(TStringView<CharType> Name, uint32 Seed);
+	};
+
+	/**
+	 * A span of a template: either literal text that is copied as is or a placeholder that is replaced.
+	 */
+	struct FPlaceholderSpan
+	{
+		/** Offset and length of the text in the template. For placeholders this includes the braces. */
+		int32 Start = 0;
+		int32 Length = 0;
+		/** Index into FPlaceholderNameTable or INDEX_NONE for literal text */
+		int32 Placeholder = INDEX_NONE;
+	};
+
+	/**
+	 * Splits Template into literal and placeholder spans following the syntax of FString::Format with named arguments:
+	 * - {Name}, optionally with whitespace inside the braces, is a placeholder if Name is in Names
+	 * - Unknown placeholders and unmatched braces are literal text
+	 * - `{ and `` are escape sequences for { and `
+	 * Literal text is only split at placeholders and escape sequences.
+	 */
+	MODULEGENERATIONCORE_API void TokenizePlaceholders(FStringView Template, const FPlaceholderNameTable& Names, TArray<FPlaceholderSpan>& OutSpans);
+	/** Same for UTF-8 text, with offsets in bytes. Bytes of multi-byte sequences never equal braces, backticks or whitespace. */
+	MODULEGENERATIONCORE_API void TokenizePlaceholders(FUtf8StringView Template, const FPlaceholderNameTable& Names, TArray<FPlaceholderSpan>& OutSpans);
+
+	/**
+	 * Replaces the placeholders in Template with Values, which is indexed like Names.
+	 * Produces the same result as FString::Format but scans for braces with SIMD and allocates the result once with its exact size.
+	 */
+	MODULEGENERATIONCORE_API FString SubstitutePlaceholders(FStringView Template, const FPlaceholderNameTable& Names, TConstArrayView<FStringView> Values);
+}
@@ -0,0 +1,43 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	/**
+	 * Maps plugin base directories to their .uplugin files so the plugin owning a directory can be found without touching the disk.
+	 *
+	 * Lookups walk up the directory one segment at a time and return the deepest plugin containing it, so nested layouts such as
+	 * Plugins/Gameplay/Foo/Source resolve to Foo. Plugins cannot contain other plugins, so the deepest match is the only one.
+	 * Paths are compared case-insensitively.
+	 */
+	class MODULEGENERATIONCORE_API FPluginDirectoryIndex
+	{
+	public:
+
+		/** Indexes every plugin discovered by IPluginManager: engine, project, marketplace and mod plugins. */
+		static FPluginDirectoryIndex MakeFromPluginManager();
+
+		/** Adds a plugin; replaces any plugin previously added for BaseDirectory. */
+		void AddPlugin(const FString& BaseDirectory, const FString& DescriptorPath);
+		/**
+		 * Finds the .uplugin files below Directory on disk and adds their plugins. Plugin directories themselves are not descended into.
+		 * Used where IPluginManager does not know the project's plugins, e.g. in ModuleGenerationCli.
+		 */
+		void AddPluginsInDirectory(const FString& Directory);
+
+		/** @return The .uplugin file of the plugin containing Directory, or nothing if it does not belong to any indexed plugin */
+		TOptional<FString> FindPluginDescriptor(const FString& Directory) const;
+
+		int32 Num() const { return DescriptorsByBaseDirectory.Num(); }
+
+	private:
+
+		/** Keys are absolute without a trailing slash. TMap<FString> hashes and compares case-insensitively. */
+		TMap<FString, FString> DescriptorsByBaseDirectory;
+
+		static FString MakeKey(const FString& Directory);
+	};
+}
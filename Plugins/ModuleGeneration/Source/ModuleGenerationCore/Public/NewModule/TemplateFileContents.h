@@ -0,0 +1,106 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NewModule/TokenizedTemplateString.h"
+
+namespace UE::ModuleGeneration
+{
+	class FModuleTemplateArchive;
+
+	/** How the bytes of a template file are encoded. Generated files keep the encoding of their template file. */
+	namespace ETemplateFileEncoding
+	{
+		enum Type : uint8
+		{
+			/** UTF-8 without byte order mark, which includes ASCII. Bytes which are not valid UTF-8 are kept as they are. */
+			Utf8,
+			Utf8Bom,
+			/** Little-endian with byte order mark, as FFileHelper::SaveStringToFile writes text which is not ANSI */
+			Utf16Bom,
+			/** Anything else, e.g. icons or .uasset files. Never scanned for placeholders. */
+			Binary
+		};
+	}
+
+	/**
+	 * @return The encoding of a file from its byte order mark. Files without one are UTF-8 unless a NUL byte occurs in their first
+	 * 8000 bytes, which text never contains but nearly every binary format does; git tells text from binary files the same way.
+	 */
+	MODULEGENERATIONCORE_API ETemplateFileEncoding::Type DetectTemplateFileEncoding(TConstArrayView<uint8> Bytes);
+
+	/** Placeholder values converted to UTF-8 once, so every file of a module is instantiated without converting them again */
+	class MODULEGENERATIONCORE_API FUtf8PlaceholderValues
+	{
+	public:
+
+		explicit FUtf8PlaceholderValues(const FTemplatePlaceholderValues& InValues);
+
+		FUtf8StringView operator[](int32 Placeholder) const { return FUtf8StringView(Values[Placeholder].GetData(), Values[Placeholder].Num()); }
+
+	private:
+
+		TStaticArray<TArray<UTF8CHAR>, ETemplatePlaceholder::Num> Values;
+	};
+
+	/**
+	 * The text of a template file split into literal spans and placeholder slots, like FTokenizedTemplateString, but kept as the
+	 * UTF-8 bytes of the file instead of being converted to UTF-16 when loading and back when writing. Instantiating it yields the
+	 * bytes of the generated file in the template file's encoding, including its byte order mark.
+	 */
+	class MODULEGENERATIONCORE_API FTemplateFileContents
+	{
+	public:
+
+		FTemplateFileContents() = default;
+
+		/** Bytes must be the whole file, including its byte order mark, and Encoding must not be Binary. */
+		static FTemplateFileContents Tokenize(TConstArrayView<uint8> Bytes, ETemplateFileEncoding::Type Encoding);
+
+		/** Replaces all placeholder slots with the given values. The result is allocated with its exact size unless it is UTF-16. */
+		TArray<uint8> Instantiate(const FUtf8PlaceholderValues& Values) const;
+
+		/** @return Whether the file contains neither placeholders nor escape sequences, i.e. instantiating it yields the file itself */
+		bool IsVerbatim() const { return bIsVerbatim; }
+		bool HasPlaceholder(ETemplatePlaceholder::Type Placeholder) const;
+		ETemplateFileEncoding::Type GetEncoding() const { return Encoding; }
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+
+		struct FSegment
+		{
+			/** Span of literal text in Literals; unused for placeholders */
+			int32 Start = 0;
+			int32 Length = 0;
+			/** ETemplatePlaceholder::Num for literal text */
+			ETemplatePlaceholder::Type Placeholder = ETemplatePlaceholder::Num;
+		};
+
+		/** UTF-8 literal text of all segments, without byte order mark */
+		TArray<uint8> Literals;
+		TArray<FSegment> Segments;
+		ETemplateFileEncoding::Type Encoding = ETemplateFileEncoding::Utf8;
+		bool bIsVerbatim = true;
+	};
+
+	/**
+	 * A template file which is copied into new modules as it is, because it is binary or contains no placeholders. Its contents
+	 * are not kept in memory: it is copied from the template directory, or written straight from the memory-mapped archive.
+	 */
+	struct FVerbatimFileSource
+	{
+		/** Absolute path of the template file; empty if the file is part of Archive */
+		FString Path;
+		/** The file's bytes inside Archive, which keeps them mapped */
+		TConstArrayView<uint8> ArchiveBytes;
+		TSharedPtr<const FModuleTemplateArchive> Archive;
+		int64 Size = 0;
+		/** See HashFileContents */
+		uint64 Hash = 0;
+	};
+
+	/** @return Text encoded as a file with the given encoding, which must not be Binary */
+	MODULEGENERATIONCORE_API TArray<uint8> EncodeTemplateText(FStringView Text, ETemplateFileEncoding::Type Encoding);
+}
@@ -0,0 +1,78 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UE::ModuleGeneration
+{
+	class FPlaceholderNameTable;
+
+	/**
+	 * Placeholders that can be used in template file names and contents, e.g. {ModuleName}.
+	 */
+	namespace ETemplatePlaceholder
+	{
+		enum Type : uint8
+		{
+			ModuleName,
+			Copyright,
+			/** Comma separated, quoted module names, e.g. "Core", "CoreUObject" */
+			PublicDependencies,
+			PrivateDependencies,
+			/** .Build.cs statements such as PCHUsage; see FormatBuildSettings */
+			BuildSettings,
+
+			Num
+		};
+
+		/** Name of the placeholder as it appears between the braces */
+		MODULEGENERATIONCORE_API const TCHAR* ToString(Type Placeholder);
+	}
+
+	/** Values to substitute, indexed by ETemplatePlaceholder::Type */
+	using FTemplatePlaceholderValues = TStaticArray<FStringView, ETemplatePlaceholder::Num>;
+
+	/** The names of all ETemplatePlaceholder values, indexed the same way */
+	MODULEGENERATIONCORE_API const FPlaceholderNameTable& GetTemplatePlaceholderNames();
+
+	/**
+	 * A template string split into literal spans and placeholder slots.
+	 * Instantiating it is a single concatenation pass with the same result as FString::Format with the equivalent named arguments.
+	 */
+	class MODULEGENERATIONCORE_API FTokenizedTemplateString
+	{
+	public:
+
+		FTokenizedTemplateString() = default;
+		
+		static FTokenizedTemplateString Tokenize(FStringView Template);
+		/** Wraps Template without scanning it. Only valid if IsVerbatim(Template). */
+		static FTokenizedTemplateString MakeVerbatim(FString Template);
+		/** @return Whether Template contains neither placeholders nor escape sequences, i.e. instantiating it yields Template itself */
+		static bool IsVerbatim(FStringView Template);
+
+		/** Replaces all placeholder slots with the given values. The result is allocated with its exact size. */
+		FString Instantiate(const FTemplatePlaceholderValues& Values) const;
+
+		bool HasPlaceholders() const { return bHasPlaceholders; }
+		bool HasPlaceholder(ETemplatePlaceholder::Type Placeholder) const;
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+
+		struct FSegment
+		{
+			/** Span of literal text in Literals; unused for placeholders */
+			int32 Start = 0;
+			int32 Length = 0;
+			/** ETemplatePlaceholder::Num for literal text */
+			ETemplatePlaceholder::Type Placeholder = ETemplatePlaceholder::Num;
+		};
+
+		/** Literal text of all segments */
+		FString Literals;
+		TArray<FSegment> Segments;
+		bool bHasPlaceholders = false;
+	};
+}
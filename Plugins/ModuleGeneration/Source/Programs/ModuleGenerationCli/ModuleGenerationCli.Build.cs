@@ -0,0 +1,18 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+using UnrealBuildTool;
+
+public class ModuleGenerationCli : ModuleRules
+{
+	public ModuleGenerationCli(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"ModuleGenerationCore",
+				"Projects"
+			}
+			);
+	}
+}
@@ -0,0 +1,31 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+using UnrealBuildTool;
+
+/**
+ * Headless command line tool which creates modules without starting the editor.
+ * Links only ModuleGenerationCore and the engine's Core, Json and Projects modules.
+ */
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class ModuleGenerationCliTarget : TargetRules
+{
+	public ModuleGenerationCliTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "ModuleGenerationCli";
+		DefaultBuildSettings = BuildSettingsVersion.Latest;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Latest;
+
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bUseLoggingInShipping = true;
+		bIsBuildingConsoleApplication = true;
+
+		bCompileWithPluginSupport = true;
+		EnablePlugins.Add("ModuleGeneration");
+	}
+}
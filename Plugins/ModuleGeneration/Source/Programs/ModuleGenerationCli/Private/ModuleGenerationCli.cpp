@@ -0,0 +1,300 @@
+// Copyright Dominik Peacock. All rights reserved.
+
+#include "ModuleGenerationLog.h"
+#include "ModuleGenerationTrace.h"
+#include "NewModule/IncludeModuleMap.h"
+#include "NewModule/ModuleBatchCreation.h"
+#include "NewModule/ModuleDependencyAnalysis.h"
+#include "NewModule/ModuleTemplateArchive.h"
+#include "NewModule/ModuleTemplateRegistry.h"
+#include "NewModule/ModuleTemplateSync.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "RequiredProgramMainCPPInclude.h"
+
+IMPLEMENT_APPLICATION(ModuleGenerationCli, "ModuleGenerationCli");
+
+namespace UE::ModuleGeneration
+{
+	static const TCHAR* CliUsage = TEXT(
+		"Usage:\n"
+		"\tModuleGenerationCli -Project=<Path/To/Project.uproject> -Name=<ModuleName> [-Type=Runtime] [-LoadingPhase=Default] [-OutputDirectory=Source]\n"
+		"\tModuleGenerationCli -Project=<Path/To/Project.uproject> -Manifest=<Path/To/Manifest.json>\n"
+		"\tModuleGenerationCli -PackTemplate=<Path/To/TemplateDirectory> [-Output=<Path/To/Name.mgtemplate>]\n"
+		"\tModuleGenerationCli -Project=<Path/To/Project.uproject> -AnalyzeHeaders=<Path/To/A.h>+<Path/To/B.h>\n"
+		"\tModuleGenerationCli -Project=<Path/To/Project.uproject> -SyncTemplate [-Apply] [-IncludeUntracked]\n"
+		"Options:\n"
+		"\t-Template=<Name>        Template to create the modules from. Defaults to 'Default'.\n"
+		"\t-Templates=<Directory>  Directory containing the templates. Defaults to the ModuleGeneration plugin's Resources/Templates folder.\n"
+		"\t-Copyright=<Text>       Copyright notice for the new files. Defaults to the CopyrightNotice in the project's Config/DefaultGame.ini.\n"
+		"\t-MinimizeDependencies   List only the modules the new sources include in each .Build.cs instead of the template's defaults.\n"
+		"\t-BuildVariant=<Name>    PCH and unity settings of each .Build.cs: Default, SharedPCH, PrivatePCH, NoUnity or NoPCH.\n"
+		"Project files are not regenerated; run GenerateProjectFiles or build with UnrealBuildTool afterwards.\n"
+		"-AnalyzeHeaders prints the public dependencies a module containing the headers needs without creating anything.\n"
+		"-SyncTemplate lists the modules whose files differ from their template. -Apply rewrites the files nobody edited since they were\n"
+		"generated. -IncludeUntracked also compares modules generated before manifests existed with -Template.");
+
+	static FString MakeFullPathFromWorkingDirectory(const FString& Path);
+	static FString FindDefaultModuleTemplatesDirectory(const FString& ProjectDirectory);
+	static FString ReadCopyrightNotice(const FString& ProjectDirectory);
+	static int32 PackModuleTemplate(const TCHAR* CommandLine, const FString& TemplateDirectory);
+	static TSharedRef<const FIncludeModuleMap> LoadIncludeModuleMap(const FString& ProjectDirectory);
+	static int32 AnalyzeHeaders(const FString& ProjectDirectory, const FString& HeaderList);
+	static int32 SyncTemplate(const TCHAR* CommandLine, const FString& ProjectDirectory);
+
+	static int32 RunModuleGenerationCli(const TCHAR* CommandLine)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		// The tool does one thing per process, so the run lasts until it exits
+		FModuleCreationTimings::Get().BeginRun();
+
+		FString PackTemplateDirectory;
+		if (FParse::Value(CommandLine, TEXT("PackTemplate="), PackTemplateDirectory))
+		{
+			return PackModuleTemplate(CommandLine, MakeFullPathFromWorkingDirectory(PackTemplateDirectory));
+		}
+
+		FString ProjectPath;
+		if (!FParse::Value(CommandLine, TEXT("Project="), ProjectPath))
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("Missing -Project argument.\n%s"), CliUsage);
+			return 1;
+		}
+		ProjectPath = MakeFullPathFromWorkingDirectory(ProjectPath);
+		const FString ProjectDirectory = FPaths::GetExtension(ProjectPath) == TEXT("uproject") ? FPaths::GetPath(ProjectPath) : ProjectPath;
+
+		FString HeaderList;
+		if (FParse::Value(CommandLine, TEXT("AnalyzeHeaders="), HeaderList, false))
+		{
+			return AnalyzeHeaders(ProjectDirectory, HeaderList);
+		}
+		if (FParse::Param(CommandLine, TEXT("SyncTemplate")))
+		{
+			return SyncTemplate(CommandLine, ProjectDirectory);
+		}
+
+		// Gather the requests
+		FString ManifestPath, ModuleName;
+		TArray<FModuleCreationRequest> Requests;
+		if (FParse::Value(CommandLine, TEXT("Manifest="), ManifestPath))
+		{
+			TOperationResult<TArray<FModuleCreationRequest>> LoadManifestOp = LoadModuleManifest(MakeFullPathFromWorkingDirectory(ManifestPath), ProjectDirectory);
+			if (LoadManifestOp.IsFailure())
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *LoadManifestOp.ErrorMessage.GetValue());
+				return 1;
+			}
+			Requests = MoveTemp(LoadManifestOp.OperationResult.GetValue());
+		}
+		else if (FParse::Value(CommandLine, TEXT("Name="), ModuleName))
+		{
+			FString TypeString = EHostType::ToString(EHostType::Runtime);
+			FString LoadingPhaseString = ELoadingPhase::ToString(ELoadingPhase::Default);
+			FString OutputDirectory = TEXT("Source");
+			FParse::Value(CommandLine, TEXT("Type="), TypeString);
+			FParse::Value(CommandLine, TEXT("LoadingPhase="), LoadingPhaseString);
+			FParse::Value(CommandLine, TEXT("OutputDirectory="), OutputDirectory);
+
+			TOperationResult<FModuleCreationRequest> RequestOp = MakeModuleCreationRequest(ProjectDirectory, ModuleName, TypeString, LoadingPhaseString, OutputDirectory);
+			if (RequestOp.IsFailure())
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *RequestOp.ErrorMessage.GetValue());
+				return 1;
+			}
+			Requests.Add(MoveTemp(RequestOp.OperationResult.GetValue()));
+		}
+		else
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("Missing -Name or -Manifest argument.\n%s"), CliUsage);
+			return 1;
+		}
+
+		const FOperationResult ValidateOp = ValidateModuleRequests(Requests);
+		if (ValidateOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *ValidateOp.ErrorMessage.GetValue());
+			return 1;
+		}
+
+		// Resolve what the editor would otherwise provide
+		FModuleBatchSettings Settings;
+		Settings.ProjectDirectory = ProjectDirectory;
+		FString TemplatesDirectory;
+		TemplatesDirectory = FParse::Value(CommandLine, TEXT("Templates="), TemplatesDirectory)
+			? MakeFullPathFromWorkingDirectory(TemplatesDirectory)
+			: FindDefaultModuleTemplatesDirectory(ProjectDirectory);
+		FString TemplateName = DefaultModuleTemplateName;
+		FParse::Value(CommandLine, TEXT("Template="), TemplateName);
+		TOperationResult<FModuleTemplateInfo> FindTemplateOp = FindModuleTemplate(TemplatesDirectory, TemplateName);
+		if (FindTemplateOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *FindTemplateOp.ErrorMessage.GetValue());
+			return 1;
+		}
+		Settings.ModuleTemplatePath = FindTemplateOp.OperationResult->Path;
+		if (!FParse::Value(CommandLine, TEXT("Copyright="), Settings.CopyrightNotice))
+		{
+			Settings.CopyrightNotice = ReadCopyrightNotice(ProjectDirectory);
+		}
+		FString BuildVariantName = DefaultModuleBuildVariantName;
+		FParse::Value(CommandLine, TEXT("BuildVariant="), BuildVariantName);
+		const TOperationResult<FModuleBuildSettings> FindBuildVariantOp = FindModuleBuildVariant(BuildVariantName);
+		if (FindBuildVariantOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *FindBuildVariantOp.ErrorMessage.GetValue());
+			return 1;
+		}
+		Settings.BuildSettings = FindBuildVariantOp.OperationResult.GetValue();
+		if (RequiresIncludeMap(Settings.BuildSettings, FParse::Param(CommandLine, TEXT("MinimizeDependencies"))))
+		{
+			Settings.IncludeMap = LoadIncludeModuleMap(ProjectDirectory);
+		}
+
+		UE_LOG(LogModuleGeneration, Display, TEXT("Creating %d modules in '%s' from template '%s'..."), Requests.Num(), *ProjectDirectory, *Settings.ModuleTemplatePath);
+		const FModuleBatchResult Result = CreateModules(Settings, Requests);
+
+		LogModuleBatchResult(Requests, Result);
+		UE_LOG(LogModuleGeneration, Display, TEXT("Created %d of %d modules in %.2f s (templates: %.2f s, descriptors and commit: %.2f s)"),
+			Result.bIsCommitted ? Requests.Num() : 0,
+			Requests.Num(),
+			FPlatformTime::Seconds() - StartTime,
+			Result.InstantiateSeconds,
+			Result.DescriptorSeconds);
+		FModuleCreationTimings::Get().LogSummary(FString::Printf(TEXT("%d modules"), Requests.Num()), FPlatformTime::Seconds() - StartTime, Result.bIsCommitted);
+
+		return Result.bIsCommitted ? 0 : 1;
+	}
+
+	static FString MakeFullPathFromWorkingDirectory(const FString& Path)
+	{
+		// FPaths::ConvertRelativePathToFull resolves against the executable's directory, which is not what a shell user expects
+		FString FullPath = FPaths::ConvertRelativePathToFull(FPlatformProcess::GetCurrentWorkingDirectory(), Path);
+		FPaths::NormalizeDirectoryName(FullPath);
+		return FullPath;
+	}
+
+	static FString FindDefaultModuleTemplatesDirectory(const FString& ProjectDirectory)
+	{
+		// The tool is built into the plugin's Binaries/<Platform> folder; fall back to a project plugin of the same name
+		const FString Candidates[] =
+		{
+			FPaths::ConvertRelativePathToFull(FPaths::Combine(FPlatformProcess::BaseDir(), TEXT("../../Resources/Templates"))),
+			FPaths::Combine(ProjectDirectory, TEXT("Plugins/ModuleGeneration/Resources/Templates"))
+		};
+		for (const FString& Candidate : Candidates)
+		{
+			if (IFileManager::Get().DirectoryExists(*Candidate))
+			{
+				return Candidate;
+			}
+		}
+		return Candidates[0];
+	}
+
+	static FString ReadCopyrightNotice(const FString& ProjectDirectory)
+	{
+		// Reads the file directly instead of loading the project's config hierarchy, which needs the engine
+		FConfigFile GameConfig;
+		GameConfig.Read(FPaths::Combine(ProjectDirectory, TEXT("Config/DefaultGame.ini")));
+		FString CopyrightNotice;
+		GameConfig.GetString(TEXT("/Script/EngineSettings.GeneralProjectSettings"), TEXT("CopyrightNotice"), CopyrightNotice);
+		return CopyrightNotice;
+	}
+
+	static int32 PackModuleTemplate(const TCHAR* CommandLine, const FString& TemplateDirectory)
+	{
+		FString ArchivePath;
+		ArchivePath = FParse::Value(CommandLine, TEXT("Output="), ArchivePath)
+			? MakeFullPathFromWorkingDirectory(ArchivePath)
+			: FPaths::SetExtension(TemplateDirectory, FModuleTemplateArchive::Extension);
+
+		const FOperationResult PackOp = FModuleTemplateArchive::Pack(TemplateDirectory, ArchivePath);
+		if (PackOp.IsFailure())
+		{
+			UE_LOG(LogModuleGeneration, Error, TEXT("%s"), *PackOp.ErrorMessage.GetValue());
+			return 1;
+		}
+		UE_LOG(LogModuleGeneration, Display, TEXT("Packed '%s' into '%s' (%lld bytes)"), *TemplateDirectory, *ArchivePath, IFileManager::Get().FileSize(*ArchivePath));
+		return 0;
+	}
+
+	static TSharedRef<const FIncludeModuleMap> LoadIncludeModuleMap(const FString& ProjectDirectory)
+	{
+		// Shares the cache with the editor, so whichever runs first pays for indexing the engine
+		const FString CacheFilePath = FPaths::Combine(ProjectDirectory, TEXT("Saved/ModuleGeneration/IncludeModuleMap.json"));
+		return FIncludeModuleMap::LoadOrBuild(FIncludeModuleMap::MakeDefaultSettings(FPaths::ConvertRelativePathToFull(FPaths::EngineDir()), ProjectDirectory, CacheFilePath));
+	}
+
+	static int32 AnalyzeHeaders(const FString& ProjectDirectory, const FString& HeaderList)
+	{
+		TArray<FString> HeaderPaths;
+		HeaderList.ParseIntoArray(HeaderPaths, TEXT("+"));
+		TArray<FSourceFileToAnalyze> Headers;
+		for (const FString& HeaderPath : HeaderPaths)
+		{
+			FSourceFileToAnalyze& Header = Headers.Add_GetRef({ MakeFullPathFromWorkingDirectory(HeaderPath), FString(), true });
+			if (!FFileHelper::LoadFileToString(Header.Contents, *Header.Path))
+			{
+				UE_LOG(LogModuleGeneration, Error, TEXT("Failed to read header '%s'"), *Header.Path);
+				return 1;
+			}
+		}
+
+		const FModuleDependencies Dependencies = AnalyzeModuleDependencies(*LoadIncludeModuleMap(ProjectDirectory), FString(), Headers);
+		UE_LOG(LogModuleGeneration, Display, TEXT("Public dependencies: %s"), *FormatDependencyList(Dependencies.PublicDependencies));
+		for (const FString& Include : Dependencies.UnresolvedIncludes)
+		{
+			UE_LOG(LogModuleGeneration, Warning, TEXT("'%s' is not provided by any indexed module"), *Include);
+		}
+		return 0;
+	}
+
+	static int32 SyncTemplate(const TCHAR* CommandLine, const FString& ProjectDirectory)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FModuleSyncSettings Settings;
+		Settings.ProjectDirectory = ProjectDirectory;
+		Settings.TemplatesDirectory = FParse::Value(CommandLine, TEXT("Templates="), Settings.TemplatesDirectory)
+			? MakeFullPathFromWorkingDirectory(Settings.TemplatesDirectory)
+			: FindDefaultModuleTemplatesDirectory(ProjectDirectory);
+		if (FParse::Param(CommandLine, TEXT("IncludeUntracked")))
+		{
+			FString TemplateName = DefaultModuleTemplateName;
+			FParse::Value(CommandLine, TEXT("Template="), TemplateName);
+			Settings.UntrackedModulesTemplateName = TemplateName;
+		}
+		if (!FParse::Value(CommandLine, TEXT("Copyright="), Settings.CopyrightNotice))
+		{
+			Settings.CopyrightNotice = ReadCopyrightNotice(ProjectDirectory);
+		}
+		Settings.bApply = FParse::Param(CommandLine, TEXT("Apply"));
+
+		const FModuleSyncReport Report = SyncModulesWithTemplate(Settings);
+		LogModuleSyncReport(Report, Settings.bApply);
+		FModuleCreationTimings::Get().LogSummary(TEXT("template sync"), FPlatformTime::Seconds() - StartTime, true);
+		return Report.Modules.ContainsByPredicate([](const FModuleSyncResult& Module) { return Module.ErrorMessage.IsSet(); }) ? 1 : 0;
+	}
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	FTaskTagScope Scope(ETaskTag::EGameThread);
+	ON_SCOPE_EXIT
+	{
+		RequestEngineExit(TEXT("ModuleGenerationCli exiting"));
+		FEngineLoop::AppPreExit();
+		FModuleManager::Get().UnloadModulesAtShutdown();
+		FEngineLoop::AppExit();
+	};
+
+	if (const int32 PreInitResult = GEngineLoop.PreInit(ArgC, ArgV))
+	{
+		return PreInitResult;
+	}
+	return UE::ModuleGeneration::RunModuleGenerationCli(FCommandLine::Get());
+}